@@ -0,0 +1,91 @@
+#include "bench_report.hpp"
+
+#include <cmath>
+#include <fmt/format.h>
+#include <fmt/ostream.h>
+#include <string_view>
+
+namespace vultex::bench
+{
+namespace
+{
+std::string quoted(const std::string_view text)
+{
+    std::string result{"\""};
+    for (const auto character : text)
+    {
+        switch (character)
+        {
+        case '"':
+            result += "\\\"";
+            break;
+        case '\\':
+            result += "\\\\";
+            break;
+        default:
+            if (static_cast<unsigned char>(character) < 0x20)
+            {
+                result += fmt::format("\\u{:04x}", static_cast<unsigned>(character));
+            }
+            else
+            {
+                result += character;
+            }
+            break;
+        }
+    }
+    return result + "\"";
+}
+
+std::string number(const double value)
+{
+    // JSON has no representation for NaN and infinity
+    return std::isfinite(value) ? fmt::format("{}", value) : "null";
+}
+
+template <typename Value, typename Format>
+void write_members(std::ostream& out,
+                   const std::vector<std::pair<std::string, Value>>& members,
+                   const std::string_view indent,
+                   Format format)
+{
+    for (std::size_t index = 0; index < members.size(); ++index)
+    {
+        fmt::print(out,
+                   "{}{}: {}{}\n",
+                   indent,
+                   quoted(members[index].first),
+                   format(members[index].second),
+                   index + 1 < members.size() ? "," : "");
+    }
+}
+} // namespace
+
+void write_json(std::ostream& out, const BenchReport& report)
+{
+    fmt::print(out, "{{\n");
+    fmt::print(out,
+               "  \"device\": {{\"name\": {}, \"type\": {}, \"api_version\": {}, \"driver_version\": {}}},\n",
+               quoted(report.device_name),
+               quoted(report.device_type),
+               quoted(report.api_version),
+               report.driver_version);
+
+    fmt::print(out, "  \"settings\": {{\n");
+    write_members(out, report.settings, "    ", number);
+    fmt::print(out, "  }},\n");
+
+    fmt::print(out, "  \"benchmarks\": [\n");
+    for (std::size_t index = 0; index < report.results.size(); ++index)
+    {
+        const auto& result = report.results[index];
+        fmt::print(out, "    {{\n      \"name\": {},\n", quoted(result.name));
+        fmt::print(out, "      \"metrics\": {{\n");
+        write_members(out, result.metrics, "        ", number);
+        fmt::print(out, "      }},\n      \"attributes\": {{\n");
+        write_members(out, result.attributes, "        ", quoted);
+        fmt::print(out, "      }}\n    }}{}\n", index + 1 < report.results.size() ? "," : "");
+    }
+    fmt::print(out, "  ]\n}}\n");
+}
+} // namespace vultex::bench
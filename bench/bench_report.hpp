@@ -0,0 +1,32 @@
+#pragma once
+
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace vultex::bench
+{
+
+struct BenchResult
+{
+    std::string name;
+    // written in insertion order
+    std::vector<std::pair<std::string, double>> metrics{};
+    std::vector<std::pair<std::string, std::string>> attributes{};
+};
+
+struct BenchReport
+{
+    std::string device_name;
+    std::string device_type;
+    std::string api_version;
+    std::uint32_t driver_version;
+    std::vector<std::pair<std::string, double>> settings{};
+    std::vector<BenchResult> results{};
+};
+
+// one JSON object, stable key order so reports of two runs can be diffed
+void write_json(std::ostream& out, const BenchReport& report);
+} // namespace vultex::bench
@@ -0,0 +1,340 @@
+#include "cpu_bench.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <fmt/format.h>
+#include <glm/gtc/matrix_transform.hpp>
+#include <iterator>
+#include <memory>
+#include <random>
+#include <spdlog/spdlog.h>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "draw_batcher.hpp"
+#include "frustum_culling.hpp"
+#include "job_system.hpp"
+#include "radix_sort.hpp"
+#include "render_queue.hpp"
+#include "scene_graph.hpp"
+
+namespace vultex::bench
+{
+namespace
+{
+constexpr std::uint32_t scene_graph_nodes = 256 * 1024;
+constexpr std::uint32_t scene_graph_roots = 256;
+constexpr std::uint32_t culled_objects = 1024 * 1024;
+constexpr std::uint32_t batched_draws = 100 * 1000;
+constexpr std::uint32_t batched_meshes = 256;
+constexpr std::uint32_t batched_pipelines = 8;
+constexpr std::uint32_t batched_materials = 64;
+constexpr std::uint32_t queued_items = 1024 * 1024;
+
+[[nodiscard]] double median_of(std::vector<double> samples)
+{
+    const auto middle = std::next(samples.begin(), static_cast<std::ptrdiff_t>(samples.size() / 2));
+    std::ranges::nth_element(samples, middle);
+    return *middle;
+}
+
+template <typename Function>
+[[nodiscard]] double median_ms(const std::uint32_t iterations, const std::uint32_t warmup, Function&& function)
+{
+    for (std::uint32_t iteration = 0; iteration < warmup; ++iteration)
+    {
+        function();
+    }
+
+    std::vector<double> samples{};
+    samples.reserve(iterations);
+    for (std::uint32_t iteration = 0; iteration < iterations; ++iteration)
+    {
+        const auto start = std::chrono::steady_clock::now();
+        function();
+        samples.push_back(
+            std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count());
+    }
+    return median_of(std::move(samples));
+}
+
+// same transforms, one heap allocation per node and children reached by pointer
+struct PointerNode
+{
+    LocalTransform local{};
+    glm::mat4 world{1.0F};
+    std::vector<std::unique_ptr<PointerNode>> children{};
+};
+
+void update_pointer_tree(PointerNode& node, const glm::mat4& parent)
+{
+    node.world = parent * glm::translate(glm::mat4{1.0F}, node.local.translation) *
+                 glm::mat4_cast(node.local.rotation) * glm::scale(glm::mat4{1.0F}, node.local.scale);
+    for (const auto& child : node.children)
+    {
+        update_pointer_tree(*child, node.world);
+    }
+}
+
+// Random forest with the parent of every node drawn from the previous ones,
+// depths grow logarithmically like in a real level. Fixed seed, same tree
+// on every run.
+[[nodiscard]] std::vector<std::uint32_t> random_parents()
+{
+    std::mt19937 generator{7};
+    std::vector<std::uint32_t> parents(scene_graph_nodes);
+    for (std::uint32_t node = 0; node < scene_graph_nodes; ++node)
+    {
+        parents[node] = node < scene_graph_roots
+                            ? node
+                            : std::uniform_int_distribution<std::uint32_t>{0, node - 1}(generator);
+    }
+    return parents;
+}
+
+[[nodiscard]] LocalTransform random_transform(std::mt19937& generator)
+{
+    std::uniform_real_distribution<float> offset{-1.0F, 1.0F};
+    std::uniform_real_distribution<float> angle{0.0F, 6.2831853F};
+    return LocalTransform{.translation = {offset(generator), offset(generator), offset(generator)},
+                          .rotation = glm::angleAxis(angle(generator), glm::vec3{0.0F, 1.0F, 0.0F}),
+                          .scale = glm::vec3{1.0F}};
+}
+
+// Objects scattered around the camera, about a tenth of them end up visible
+[[nodiscard]] CullingBounds random_bounds()
+{
+    std::mt19937 generator{13};
+    std::uniform_real_distribution<float> position{-500.0F, 500.0F};
+    std::uniform_real_distribution<float> size{0.25F, 8.0F};
+
+    CullingBounds bounds{};
+    for (std::uint32_t object = 0; object < culled_objects; ++object)
+    {
+        const glm::vec3 extent{size(generator), size(generator), size(generator)};
+        bounds.add({position(generator), position(generator), position(generator)}, extent, glm::length(extent));
+    }
+    return bounds;
+}
+} // namespace
+
+BenchResult run_scene_graph_benchmark(const std::uint32_t iterations, const std::uint32_t warmup)
+{
+    spdlog::info("Run scene_graph_update: {} nodes, {} iterations", scene_graph_nodes, iterations);
+
+    const auto parents = random_parents();
+    std::mt19937 generator{11};
+
+    SceneGraph graph{};
+    std::vector<std::unique_ptr<PointerNode>> roots{};
+    std::vector<PointerNode*> pointerNodes{};
+    pointerNodes.reserve(scene_graph_nodes);
+    for (std::uint32_t node = 0; node < scene_graph_nodes; ++node)
+    {
+        const auto local = random_transform(generator);
+        auto pointerNode = std::make_unique<PointerNode>(PointerNode{.local = local});
+        pointerNodes.push_back(pointerNode.get());
+        if (node < scene_graph_roots)
+        {
+            graph.create_node(local);
+            roots.push_back(std::move(pointerNode));
+        }
+        else
+        {
+            graph.create_node(local, parents[node]);
+            pointerNodes[parents[node]]->children.push_back(std::move(pointerNode));
+        }
+    }
+
+    JobSystem workers{};
+    JobSystem callingThread{0};
+
+    BenchResult result{.name = "scene_graph_update"};
+    result.metrics.emplace_back("nodes", scene_graph_nodes);
+    result.metrics.emplace_back("ms_per_update", median_ms(iterations, warmup, [&] { graph.update(workers); }));
+    result.metrics.emplace_back("ms_per_update_single_thread",
+                                median_ms(iterations, warmup, [&] { graph.update(callingThread); }));
+    result.metrics.emplace_back("ms_per_update_pointer_tree",
+                                median_ms(iterations,
+                                          warmup,
+                                          [&]
+                                          {
+                                              for (const auto& root : roots)
+                                              {
+                                                  update_pointer_tree(*root, glm::mat4{1.0F});
+                                              }
+                                          }));
+    result.metrics.emplace_back("depth_levels", static_cast<double>(graph.depth_count()));
+    result.attributes.emplace_back("worker_count", std::to_string(workers.worker_count()));
+    return result;
+}
+
+BenchResult run_frustum_culling_benchmark(const std::uint32_t iterations, const std::uint32_t warmup)
+{
+    spdlog::info("Run frustum_culling: {} objects, {} iterations", culled_objects, iterations);
+
+    const auto bounds = random_bounds();
+    const auto projection = glm::perspective(glm::radians(70.0F), 16.0F / 9.0F, 0.1F, 1000.0F);
+    const auto view = glm::lookAt(glm::vec3{0.0F}, glm::vec3{1.0F, 0.0F, 0.0F}, glm::vec3{0.0F, 1.0F, 0.0F});
+    const auto frustum = Frustum::from_view_projection(projection * view);
+
+    JobSystem workers{};
+    JobSystem callingThread{0};
+
+    BenchResult result{.name = "frustum_culling"};
+    result.metrics.emplace_back("objects", culled_objects);
+
+    std::vector<std::uint32_t> reference{};
+    std::vector<std::uint32_t> visible{};
+    auto pathsAgree = true;
+    for (const auto path : available_culling_paths())
+    {
+        result.metrics.emplace_back(fmt::format("ms_per_cull_{}_single_thread", culling_path_name(path)),
+                                    median_ms(iterations,
+                                              warmup,
+                                              [&] { cull(callingThread, frustum, bounds, visible, path); }));
+        if (CullingPath::scalar == path)
+        {
+            reference = visible;
+        }
+        pathsAgree = pathsAgree && reference == visible;
+    }
+
+    result.metrics.emplace_back("ms_per_cull",
+                                median_ms(iterations, warmup, [&] { cull(workers, frustum, bounds, visible); }));
+    result.metrics.emplace_back("visible_objects", static_cast<double>(visible.size()));
+    result.attributes.emplace_back("best_path", std::string{culling_path_name(best_culling_path())});
+    result.attributes.emplace_back("paths_agree", pathsAgree ? "true" : "false");
+    result.attributes.emplace_back("worker_count", std::to_string(workers.worker_count()));
+    return result;
+}
+
+BenchResult run_draw_batching_benchmark(const std::uint32_t iterations, const std::uint32_t warmup)
+{
+    spdlog::info("Run draw_batching: {} draws of {} meshes, {} iterations", batched_draws, batched_meshes, iterations);
+
+    // every mesh has one material and pipeline, instances of a mesh come in random order
+    std::vector<MeshDrawRange> meshes(batched_meshes);
+    for (std::uint32_t mesh = 0; mesh < batched_meshes; ++mesh)
+    {
+        meshes[mesh] = MeshDrawRange{.first_index = mesh * 3072, .index_count = 3072, .vertex_offset = 0};
+    }
+    std::mt19937 generator{17};
+    std::uniform_int_distribution<std::uint32_t> randomMesh{0, batched_meshes - 1};
+    std::vector<std::uint32_t> drawMeshes(batched_draws);
+    std::ranges::generate(drawMeshes, [&] { return randomMesh(generator); });
+
+    DrawBatcher batcher{};
+    const auto addDraws = [&]
+    {
+        batcher.clear();
+        for (std::uint32_t draw = 0; draw < batched_draws; ++draw)
+        {
+            const auto mesh = drawMeshes[draw];
+            batcher.add(static_cast<std::uint16_t>(mesh % batched_pipelines),
+                        static_cast<std::uint16_t>(mesh % batched_materials),
+                        mesh,
+                        draw);
+        }
+    };
+
+    BenchResult result{.name = "draw_batching"};
+    result.metrics.emplace_back("draws", batched_draws);
+    result.metrics.emplace_back("ms_per_build",
+                                median_ms(iterations,
+                                          warmup,
+                                          [&]
+                                          {
+                                              addDraws();
+                                              batcher.build(meshes);
+                                          }));
+    result.metrics.emplace_back("commands", static_cast<double>(batcher.commands().size()));
+    result.metrics.emplace_back("batches", static_cast<double>(batcher.batches().size()));
+
+    // the keys DrawBatcher sorts, fresh copies for every run
+    std::vector<SortItem> keys(batched_draws);
+    for (std::uint32_t draw = 0; draw < batched_draws; ++draw)
+    {
+        const std::uint64_t mesh = drawMeshes[draw];
+        keys[draw] = SortItem{.key = (mesh % batched_pipelines) << 48U | (mesh % batched_materials) << 32U | mesh,
+                              .value = draw};
+    }
+    std::vector<SortItem> sorted(batched_draws);
+    std::vector<SortItem> scratch(batched_draws);
+    result.metrics.emplace_back("ms_per_radix_sort",
+                                median_ms(iterations,
+                                          warmup,
+                                          [&]
+                                          {
+                                              sorted = keys;
+                                              radix_sort(sorted, scratch);
+                                          }));
+    result.metrics.emplace_back("ms_per_std_sort",
+                                median_ms(iterations,
+                                          warmup,
+                                          [&]
+                                          {
+                                              sorted = keys;
+                                              std::ranges::stable_sort(sorted, {}, &SortItem::key);
+                                          }));
+    return result;
+}
+
+BenchResult run_render_queue_benchmark(const std::uint32_t iterations, const std::uint32_t warmup)
+{
+    spdlog::info("Run render_queue: {} items, {} iterations", queued_items, iterations);
+
+    std::mt19937 generator{23};
+    std::uniform_int_distribution<std::uint32_t> randomLayer{0, 3};
+    std::uniform_int_distribution<std::uint32_t> randomPipeline{0, 63};
+    std::uniform_int_distribution<std::uint32_t> randomMaterial{0, 1023};
+    std::uniform_real_distribution<float> randomDepth{0.0F, 1.0F};
+    std::vector<RenderKey> keys(queued_items);
+    std::ranges::generate(keys,
+                          [&]
+                          {
+                              return RenderKey{.layer = static_cast<std::uint8_t>(randomLayer(generator)),
+                                               .pipeline = static_cast<std::uint16_t>(randomPipeline(generator)),
+                                               .material = static_cast<std::uint16_t>(randomMaterial(generator)),
+                                               .depth = randomDepth(generator)};
+                          });
+
+    JobSystem workers{};
+    JobSystem callingThread{0};
+    RenderQueue queue{workers};
+    RenderQueue singleThreadQueue{callingThread};
+    const auto pushAll = [&](JobSystem& jobs, RenderQueue& target)
+    {
+        target.clear();
+        jobs.parallel_for(queued_items,
+                          16 * 1024,
+                          [&](const std::size_t begin, const std::size_t end)
+                          {
+                              for (auto item = begin; item < end; ++item)
+                              {
+                                  target.push(keys[item], static_cast<std::uint32_t>(item));
+                              }
+                          });
+    };
+
+    BenchResult result{.name = "render_queue"};
+    result.metrics.emplace_back("items", queued_items);
+    result.metrics.emplace_back("ms_per_push", median_ms(iterations, warmup, [&] { pushAll(workers, queue); }));
+    // sort() merges the buckets again every time, so it is timed on its own
+    result.metrics.emplace_back("ms_per_sort", median_ms(iterations, warmup, [&] { queue.sort(); }));
+
+    pushAll(callingThread, singleThreadQueue);
+    result.metrics.emplace_back("ms_per_sort_single_thread",
+                                median_ms(iterations, warmup, [&] { singleThreadQueue.sort(); }));
+
+    const auto sortedEqual = std::ranges::equal(queue.sorted(),
+                                                singleThreadQueue.sorted(),
+                                                [](const SortItem& left, const SortItem& right)
+                                                { return left.key == right.key && left.value == right.value; });
+    result.attributes.emplace_back("deterministic", sortedEqual ? "true" : "false");
+    result.attributes.emplace_back("worker_count", std::to_string(workers.worker_count()));
+    return result;
+}
+} // namespace vultex::bench
@@ -0,0 +1,28 @@
+#pragma once
+
+#include <cstdint>
+
+#include "bench_report.hpp"
+
+namespace vultex::bench
+{
+
+// CPU only benchmarks, they need no Vulkan device. Every one runs `warmup`
+// untimed iterations, then reports the median of `iterations` timed ones.
+
+// Transform propagation of a 256k node hierarchy: SceneGraph on all workers,
+// SceneGraph on the calling thread only, and a pointer based tree as baseline.
+[[nodiscard]] BenchResult run_scene_graph_benchmark(std::uint32_t iterations, std::uint32_t warmup);
+
+// Culling of 1M bounding volumes against a perspective frustum, every compiled
+// path on the calling thread, and the best one on all workers.
+[[nodiscard]] BenchResult run_frustum_culling_benchmark(std::uint32_t iterations, std::uint32_t warmup);
+
+// DrawBatcher::build() of 100k draws of 256 meshes, and the radix sort of its
+// keys against std::sort.
+[[nodiscard]] BenchResult run_draw_batching_benchmark(std::uint32_t iterations, std::uint32_t warmup);
+
+// RenderQueue with 1M items pushed from all workers, merged and radix sorted
+// on all workers and on the calling thread.
+[[nodiscard]] BenchResult run_render_queue_benchmark(std::uint32_t iterations, std::uint32_t warmup);
+} // namespace vultex::bench
@@ -0,0 +1,336 @@
+#include "gpu_resources.hpp"
+
+#include <array>
+#include <cstring>
+#include <span>
+#include <stdexcept>
+
+#include "hash.hpp"
+#include "host_allocator.hpp"
+#include "vulkan_memory.hpp"
+
+namespace vultex::bench
+{
+namespace
+{
+VkDeviceMemory allocate_memory(const VulkanContext& context,
+                               const VkMemoryRequirements& requirements,
+                               const bool host_visible)
+{
+    const auto memoryType =
+        host_visible ? find_memory_type(context.physical_device(),
+                                        requirements.memoryTypeBits,
+                                        {VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT |
+                                             VK_MEMORY_PROPERTY_HOST_CACHED_BIT,
+                                         VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT})
+                     : find_memory_type(context.physical_device(),
+                                        requirements.memoryTypeBits,
+                                        {VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, 0});
+    if (!memoryType)
+    {
+        throw std::runtime_error("Cannot find memory type for benchmark resource!");
+    }
+
+    const VkMemoryAllocateInfo allocateInfo{.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO,
+                                            .allocationSize = requirements.size,
+                                            .memoryTypeIndex = memoryType.value()};
+
+    VkDeviceMemory memory{nullptr};
+    if (VK_SUCCESS != vkAllocateMemory(context.logical_device(), &allocateInfo, allocation_callbacks(), &memory))
+    {
+        throw std::runtime_error("Failed to allocate benchmark resource memory!");
+    }
+    return memory;
+}
+} // namespace
+
+GpuBuffer create_buffer(const VulkanContext& context,
+                        const VkDeviceSize size,
+                        const VkBufferUsageFlags usage,
+                        const bool host_visible)
+{
+    const VkBufferCreateInfo bufferInfo{.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO,
+                                        .size = size,
+                                        .usage = usage,
+                                        .sharingMode = VK_SHARING_MODE_EXCLUSIVE};
+
+    GpuBuffer buffer{};
+    if (VK_SUCCESS != vkCreateBuffer(context.logical_device(), &bufferInfo, allocation_callbacks(), &buffer.buffer))
+    {
+        throw std::runtime_error("Failed to create benchmark buffer!");
+    }
+
+    VkMemoryRequirements requirements{};
+    vkGetBufferMemoryRequirements(context.logical_device(), buffer.buffer, &requirements);
+    buffer.memory = allocate_memory(context, requirements, host_visible);
+    vkBindBufferMemory(context.logical_device(), buffer.buffer, buffer.memory, 0);
+
+    if (host_visible &&
+        VK_SUCCESS != vkMapMemory(context.logical_device(), buffer.memory, 0, VK_WHOLE_SIZE, 0, &buffer.mapped))
+    {
+        throw std::runtime_error("Failed to map benchmark buffer!");
+    }
+    return buffer;
+}
+
+void destroy_buffer(VkDevice logical_device, const GpuBuffer& buffer)
+{
+    vkDestroyBuffer(logical_device, buffer.buffer, allocation_callbacks());
+    vkFreeMemory(logical_device, buffer.memory, allocation_callbacks());
+}
+
+std::vector<std::uint32_t> read_buffer(const VulkanContext& context,
+                                       QueueTimeline& timeline,
+                                       VkBuffer buffer,
+                                       const VkDeviceSize size)
+{
+    const auto logicalDevice = context.logical_device();
+    const auto readback = create_buffer(context, size, VK_BUFFER_USAGE_TRANSFER_DST_BIT, true);
+
+    const VkCommandPoolCreateInfo poolInfo{.sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO,
+                                           .flags = VK_COMMAND_POOL_CREATE_TRANSIENT_BIT,
+                                           .queueFamilyIndex = timeline.family_index()};
+    VkCommandPool commandPool{nullptr};
+    if (VK_SUCCESS != vkCreateCommandPool(logicalDevice, &poolInfo, allocation_callbacks(), &commandPool))
+    {
+        throw std::runtime_error("Failed to create read back command pool!");
+    }
+
+    const VkCommandBufferAllocateInfo allocateInfo{.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO,
+                                                   .commandPool = commandPool,
+                                                   .level = VK_COMMAND_BUFFER_LEVEL_PRIMARY,
+                                                   .commandBufferCount = 1};
+    VkCommandBuffer commandBuffer{nullptr};
+    vkAllocateCommandBuffers(logicalDevice, &allocateInfo, &commandBuffer);
+
+    const VkCommandBufferBeginInfo beginInfo{.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO,
+                                             .flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT};
+    vkBeginCommandBuffer(commandBuffer, &beginInfo);
+
+    const VkBufferCopy region{.srcOffset = 0, .dstOffset = 0, .size = size};
+    vkCmdCopyBuffer(commandBuffer, buffer, readback.buffer, 1, &region);
+
+    const VkMemoryBarrier hostRead{.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER,
+                                   .srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT,
+                                   .dstAccessMask = VK_ACCESS_HOST_READ_BIT};
+    vkCmdPipelineBarrier(commandBuffer,
+                         VK_PIPELINE_STAGE_TRANSFER_BIT,
+                         VK_PIPELINE_STAGE_HOST_BIT,
+                         0,
+                         1,
+                         &hostRead,
+                         0,
+                         nullptr,
+                         0,
+                         nullptr);
+    vkEndCommandBuffer(commandBuffer);
+
+    const std::array commandBuffers{commandBuffer};
+    timeline.wait(timeline.submit(commandBuffers));
+
+    std::vector<std::uint32_t> values(size / sizeof(std::uint32_t));
+    std::memcpy(values.data(), readback.mapped, values.size() * sizeof(std::uint32_t));
+
+    vkDestroyCommandPool(logicalDevice, commandPool, allocation_callbacks());
+    destroy_buffer(logicalDevice, readback);
+    return values;
+}
+
+GpuImage create_image(const VulkanContext& context,
+                      const VkExtent2D extent,
+                      const VkFormat format,
+                      const VkImageUsageFlags usage,
+                      const std::uint32_t mip_levels)
+{
+    const VkImageCreateInfo imageInfo{.sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO,
+                                      .imageType = VK_IMAGE_TYPE_2D,
+                                      .format = format,
+                                      .extent = {extent.width, extent.height, 1},
+                                      .mipLevels = mip_levels,
+                                      .arrayLayers = 1,
+                                      .samples = VK_SAMPLE_COUNT_1_BIT,
+                                      .tiling = VK_IMAGE_TILING_OPTIMAL,
+                                      .usage = usage,
+                                      .sharingMode = VK_SHARING_MODE_EXCLUSIVE,
+                                      .initialLayout = VK_IMAGE_LAYOUT_UNDEFINED};
+
+    GpuImage image{};
+    if (VK_SUCCESS != vkCreateImage(context.logical_device(), &imageInfo, allocation_callbacks(), &image.image))
+    {
+        throw std::runtime_error("Failed to create benchmark image!");
+    }
+
+    VkMemoryRequirements requirements{};
+    vkGetImageMemoryRequirements(context.logical_device(), image.image, &requirements);
+    image.memory = allocate_memory(context, requirements, false);
+    vkBindImageMemory(context.logical_device(), image.image, image.memory, 0);
+
+    const VkImageViewCreateInfo viewInfo{
+        .sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO,
+        .image = image.image,
+        .viewType = VK_IMAGE_VIEW_TYPE_2D,
+        .format = format,
+        .subresourceRange = {.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT, .levelCount = mip_levels, .layerCount = 1}};
+
+    if (VK_SUCCESS != vkCreateImageView(context.logical_device(), &viewInfo, allocation_callbacks(), &image.view))
+    {
+        throw std::runtime_error("Failed to create benchmark image view!");
+    }
+    return image;
+}
+
+void destroy_image(VkDevice logical_device, const GpuImage& image)
+{
+    vkDestroyImageView(logical_device, image.view, allocation_callbacks());
+    vkDestroyImage(logical_device, image.image, allocation_callbacks());
+    vkFreeMemory(logical_device, image.memory, allocation_callbacks());
+}
+
+OffscreenTarget::OffscreenTarget(const VulkanContext& context, QueueTimeline& timeline, const VkExtent2D extent)
+    : logical_device{context.logical_device()}, timeline{timeline}, target_extent{extent}
+{
+    color = create_image(
+        context, extent, format, VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_TRANSFER_SRC_BIT, 1);
+    readback = create_buffer(
+        context, VkDeviceSize{4} * extent.width * extent.height, VK_BUFFER_USAGE_TRANSFER_DST_BIT, true);
+
+    // every frame starts from a cleared target, so the content depends only on the last frame
+    const VkAttachmentDescription attachment{.format = format,
+                                             .samples = VK_SAMPLE_COUNT_1_BIT,
+                                             .loadOp = VK_ATTACHMENT_LOAD_OP_CLEAR,
+                                             .storeOp = VK_ATTACHMENT_STORE_OP_STORE,
+                                             .stencilLoadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE,
+                                             .stencilStoreOp = VK_ATTACHMENT_STORE_OP_DONT_CARE,
+                                             .initialLayout = VK_IMAGE_LAYOUT_UNDEFINED,
+                                             .finalLayout = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL};
+
+    const VkAttachmentReference colorReference{.attachment = 0,
+                                               .layout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL};
+    const VkSubpassDescription subpass{.pipelineBindPoint = VK_PIPELINE_BIND_POINT_GRAPHICS,
+                                       .colorAttachmentCount = 1,
+                                       .pColorAttachments = &colorReference};
+
+    // previous frame (or the read back) has to finish with the image first
+    const VkSubpassDependency dependency{.srcSubpass = VK_SUBPASS_EXTERNAL,
+                                         .dstSubpass = 0,
+                                         .srcStageMask = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT |
+                                                         VK_PIPELINE_STAGE_TRANSFER_BIT,
+                                         .dstStageMask = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT,
+                                         .srcAccessMask = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT,
+                                         .dstAccessMask = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT};
+
+    const VkRenderPassCreateInfo renderPassInfo{.sType = VK_STRUCTURE_TYPE_RENDER_PASS_CREATE_INFO,
+                                                .attachmentCount = 1,
+                                                .pAttachments = &attachment,
+                                                .subpassCount = 1,
+                                                .pSubpasses = &subpass,
+                                                .dependencyCount = 1,
+                                                .pDependencies = &dependency};
+
+    if (VK_SUCCESS != vkCreateRenderPass(logical_device, &renderPassInfo, allocation_callbacks(), &target_render_pass))
+    {
+        throw std::runtime_error("Failed to create offscreen render pass!");
+    }
+
+    const VkFramebufferCreateInfo framebufferInfo{.sType = VK_STRUCTURE_TYPE_FRAMEBUFFER_CREATE_INFO,
+                                                  .renderPass = target_render_pass,
+                                                  .attachmentCount = 1,
+                                                  .pAttachments = &color.view,
+                                                  .width = extent.width,
+                                                  .height = extent.height,
+                                                  .layers = 1};
+
+    if (VK_SUCCESS != vkCreateFramebuffer(logical_device, &framebufferInfo, allocation_callbacks(), &framebuffer))
+    {
+        throw std::runtime_error("Failed to create offscreen framebuffer!");
+    }
+
+    const VkCommandPoolCreateInfo poolInfo{.sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO,
+                                           .flags = VK_COMMAND_POOL_CREATE_TRANSIENT_BIT,
+                                           .queueFamilyIndex = timeline.family_index()};
+
+    if (VK_SUCCESS != vkCreateCommandPool(logical_device, &poolInfo, allocation_callbacks(), &command_pool))
+    {
+        throw std::runtime_error("Failed to create read back command pool!");
+    }
+}
+
+OffscreenTarget::~OffscreenTarget()
+{
+    vkDestroyCommandPool(logical_device, command_pool, allocation_callbacks());
+    vkDestroyFramebuffer(logical_device, framebuffer, allocation_callbacks());
+    vkDestroyRenderPass(logical_device, target_render_pass, allocation_callbacks());
+    destroy_buffer(logical_device, readback);
+    destroy_image(logical_device, color);
+}
+
+void OffscreenTarget::begin(VkCommandBuffer command_buffer) const
+{
+    const VkClearValue clearValue{.color = {.float32 = {0.0F, 0.0F, 0.0F, 1.0F}}};
+    const VkRenderPassBeginInfo beginInfo{.sType = VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO,
+                                          .renderPass = target_render_pass,
+                                          .framebuffer = framebuffer,
+                                          .renderArea = {.offset = {0, 0}, .extent = target_extent},
+                                          .clearValueCount = 1,
+                                          .pClearValues = &clearValue};
+    vkCmdBeginRenderPass(command_buffer, &beginInfo, VK_SUBPASS_CONTENTS_INLINE);
+}
+
+void OffscreenTarget::end(VkCommandBuffer command_buffer) const
+{
+    vkCmdEndRenderPass(command_buffer);
+}
+
+std::uint64_t OffscreenTarget::content_hash() const
+{
+    const VkCommandBufferAllocateInfo allocateInfo{.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO,
+                                                   .commandPool = command_pool,
+                                                   .level = VK_COMMAND_BUFFER_LEVEL_PRIMARY,
+                                                   .commandBufferCount = 1};
+    VkCommandBuffer commandBuffer{nullptr};
+    vkAllocateCommandBuffers(logical_device, &allocateInfo, &commandBuffer);
+
+    const VkCommandBufferBeginInfo beginInfo{.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO,
+                                             .flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT};
+    vkBeginCommandBuffer(commandBuffer, &beginInfo);
+
+    // the render pass left the image in TRANSFER_SRC_OPTIMAL
+    const VkBufferImageCopy region{
+        .imageSubresource = {.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT, .mipLevel = 0, .layerCount = 1},
+        .imageExtent = {target_extent.width, target_extent.height, 1}};
+    vkCmdCopyImageToBuffer(
+        commandBuffer, color.image, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, readback.buffer, 1, &region);
+
+    const VkMemoryBarrier hostRead{.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER,
+                                   .srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT,
+                                   .dstAccessMask = VK_ACCESS_HOST_READ_BIT};
+    vkCmdPipelineBarrier(commandBuffer,
+                         VK_PIPELINE_STAGE_TRANSFER_BIT,
+                         VK_PIPELINE_STAGE_HOST_BIT,
+                         0,
+                         1,
+                         &hostRead,
+                         0,
+                         nullptr,
+                         0,
+                         nullptr);
+    vkEndCommandBuffer(commandBuffer);
+
+    const std::array commandBuffers{commandBuffer};
+    timeline.wait(timeline.submit(commandBuffers));
+    vkFreeCommandBuffers(logical_device, command_pool, 1, &commandBuffer);
+
+    const auto size = std::size_t{4} * target_extent.width * target_extent.height;
+    return fnv1a(std::span{static_cast<const std::byte*>(readback.mapped), size});
+}
+
+VkRenderPass OffscreenTarget::render_pass() const
+{
+    return target_render_pass;
+}
+
+VkExtent2D OffscreenTarget::extent() const
+{
+    return target_extent;
+}
+} // namespace vultex::bench
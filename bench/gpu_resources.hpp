@@ -0,0 +1,84 @@
+#pragma once
+
+#define GLFW_INCLUDE_VULKAN
+#include <GLFW/glfw3.h>
+
+#include <cstdint>
+#include <vector>
+
+#include "queue_timeline.hpp"
+#include "vulkan_context.hpp"
+
+namespace vultex::bench
+{
+
+struct GpuBuffer
+{
+    VkBuffer buffer;
+    VkDeviceMemory memory;
+    // persistently mapped when host visible, nullptr otherwise
+    void* mapped;
+};
+
+struct GpuImage
+{
+    VkImage image;
+    VkDeviceMemory memory;
+    VkImageView view;
+};
+
+[[nodiscard]] GpuBuffer create_buffer(const VulkanContext& context,
+                                      VkDeviceSize size,
+                                      VkBufferUsageFlags usage,
+                                      bool host_visible);
+void destroy_buffer(VkDevice logical_device, const GpuBuffer& buffer);
+
+// Copies the first size bytes of a (device local) buffer with transfer source
+// usage to the host, submits on timeline and waits for it
+[[nodiscard]] std::vector<std::uint32_t> read_buffer(const VulkanContext& context,
+                                                     QueueTimeline& timeline,
+                                                     VkBuffer buffer,
+                                                     VkDeviceSize size);
+
+[[nodiscard]] GpuImage create_image(const VulkanContext& context,
+                                    VkExtent2D extent,
+                                    VkFormat format,
+                                    VkImageUsageFlags usage,
+                                    std::uint32_t mip_levels);
+void destroy_image(VkDevice logical_device, const GpuImage& image);
+
+// Color target every graphics scene renders into. There is no swapchain,
+// the result is read back and hashed so a run on a software ICD can be
+// compared bit for bit with the previous one.
+class OffscreenTarget
+{
+public:
+    static constexpr VkFormat format = VK_FORMAT_R8G8B8A8_UNORM;
+
+    OffscreenTarget(const VulkanContext& context, QueueTimeline& timeline, VkExtent2D extent);
+    OffscreenTarget(const OffscreenTarget&) = delete;
+    OffscreenTarget(OffscreenTarget&&) = delete;
+    OffscreenTarget& operator=(const OffscreenTarget&) = delete;
+    OffscreenTarget& operator=(OffscreenTarget&&) = delete;
+    ~OffscreenTarget();
+
+    void begin(VkCommandBuffer command_buffer) const;
+    void end(VkCommandBuffer command_buffer) const;
+
+    // waits for the queue, call after the measured frames
+    [[nodiscard]] std::uint64_t content_hash() const;
+
+    [[nodiscard]] VkRenderPass render_pass() const;
+    [[nodiscard]] VkExtent2D extent() const;
+
+private:
+    VkDevice logical_device{nullptr};
+    QueueTimeline& timeline;
+    VkExtent2D target_extent{};
+    GpuImage color{};
+    GpuBuffer readback{};
+    VkRenderPass target_render_pass{nullptr};
+    VkFramebuffer framebuffer{nullptr};
+    VkCommandPool command_pool{nullptr};
+};
+} // namespace vultex::bench
@@ -0,0 +1,455 @@
+// Offscreen benchmark of standardized scenes, prints a JSON report.
+//
+// Runs a fixed number of frames without a window or a swapchain, so it works
+// headless and on software ICDs (lavapipe) in CI:
+//   VK_ICD_FILENAMES=/usr/share/vulkan/icd.d/lvp_icd.x86_64.json vultex_bench --output bench.json
+// Startup of the init chain is measured with --startup N (--window to include GLFW).
+// GPU time and pipeline statistics come from GpuCounters, vendor counters are
+// added with --perf-counters when the device has VK_KHR_performance_query.
+
+#define GLFW_INCLUDE_VULKAN
+#include <GLFW/glfw3.h>
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <exception>
+#include <fmt/format.h>
+#include <fstream>
+#include <iostream>
+#include <optional>
+#include <spdlog/sinks/stdout_color_sinks.h>
+#include <spdlog/spdlog.h>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include "bench_report.hpp"
+#include "cpu_bench.hpp"
+#include "frame_statistics.hpp"
+#include "gpu_counters.hpp"
+#include "gpu_primitives.hpp"
+#include "gpu_resources.hpp"
+#include "host_allocator.hpp"
+#include "job_system.hpp"
+#include "pipeline_compiler.hpp"
+#include "queue_timeline.hpp"
+#include "scenes.hpp"
+#include "shader_module_cache.hpp"
+#include "startup_bench.hpp"
+#include "vulkan_context.hpp"
+
+namespace
+{
+const std::uint32_t MAX_FRAMES_IN_FLIGHT = 2;
+const VkExtent2D TARGET_EXTENT{1024, 1024};
+
+struct Options
+{
+    std::uint32_t frames{200};
+    std::uint32_t warmupFrames{20};
+    // init chain runs of the startup benchmark, 0 skips it, else at least 2
+    std::uint32_t startupRuns{0};
+    bool startupWindow{false};
+    // the shared memory build of the compute primitives even with subgroups
+    bool sharedMemoryKernels{false};
+    // runs only the benchmarks whose name contains it
+    std::string filter{};
+    std::optional<std::string> output{};
+    // VK_KHR_performance_query counters collected per scene, names as logged at startup
+    std::vector<std::string> performanceCounters{};
+};
+
+[[nodiscard]] auto parseOptions(const int argc, char** argv) -> Options
+{
+    Options options{};
+    const std::vector<std::string_view> arguments(argv + 1, argv + argc);
+    for (auto it = arguments.begin(); it != arguments.end(); ++it)
+    {
+        const auto value = [&]() -> std::string
+        {
+            if (std::next(it) == arguments.end())
+            {
+                throw std::runtime_error{fmt::format("Missing value of {}", *it)};
+            }
+            return std::string{*++it};
+        };
+
+        if (*it == "--frames")
+        {
+            options.frames = std::max(1U, static_cast<std::uint32_t>(std::stoul(value())));
+        }
+        else if (*it == "--warmup")
+        {
+            options.warmupFrames = static_cast<std::uint32_t>(std::stoul(value()));
+        }
+        else if (*it == "--startup")
+        {
+            options.startupRuns = static_cast<std::uint32_t>(std::stoul(value()));
+            if (1 == options.startupRuns)
+            {
+                throw std::runtime_error{"--startup needs 2 runs at least, the first one is reported on its own"};
+            }
+        }
+        else if (*it == "--window")
+        {
+            options.startupWindow = true;
+        }
+        else if (*it == "--shared-memory-kernels")
+        {
+            options.sharedMemoryKernels = true;
+        }
+        else if (*it == "--filter")
+        {
+            options.filter = value();
+        }
+        else if (*it == "--output")
+        {
+            options.output = value();
+        }
+        else if (*it == "--perf-counters")
+        {
+            const auto names = value();
+            for (std::size_t begin = 0; begin <= names.size();)
+            {
+                const auto end = std::min(names.find(',', begin), names.size());
+                if (end != begin)
+                {
+                    options.performanceCounters.push_back(names.substr(begin, end - begin));
+                }
+                begin = end + 1;
+            }
+        }
+        else
+        {
+            throw std::runtime_error{
+                fmt::format("Unknown argument {}, usage: vultex_bench [--frames N] [--warmup N] [--startup N] "
+                            "[--window] [--filter name] [--shared-memory-kernels] [--perf-counters a,b] "
+                            "[--output file.json]",
+                            *it)};
+        }
+    }
+    return options;
+}
+
+[[nodiscard]] auto totalAllocations(const vultex::HostAllocator& hostAllocator) -> std::uint64_t
+{
+    std::uint64_t allocations = 0;
+    for (auto scope = static_cast<int>(VK_SYSTEM_ALLOCATION_SCOPE_COMMAND);
+         scope <= static_cast<int>(VK_SYSTEM_ALLOCATION_SCOPE_INSTANCE);
+         ++scope)
+    {
+        const auto statistics = hostAllocator.statistics(static_cast<VkSystemAllocationScope>(scope));
+        allocations += statistics.allocations + statistics.reallocations;
+    }
+    return allocations;
+}
+
+[[nodiscard]] auto median(std::vector<double> values) -> double
+{
+    const auto middle = std::next(values.begin(), static_cast<std::ptrdiff_t>(values.size() / 2));
+    std::nth_element(values.begin(), middle, values.end());
+    return *middle;
+}
+
+[[nodiscard]] auto deviceTypeName(const VkPhysicalDeviceType type) -> std::string_view
+{
+    switch (type)
+    {
+    case VK_PHYSICAL_DEVICE_TYPE_INTEGRATED_GPU:
+        return "integrated";
+    case VK_PHYSICAL_DEVICE_TYPE_DISCRETE_GPU:
+        return "discrete";
+    case VK_PHYSICAL_DEVICE_TYPE_VIRTUAL_GPU:
+        return "virtual";
+    case VK_PHYSICAL_DEVICE_TYPE_CPU:
+        return "cpu";
+    default:
+        return "other";
+    }
+}
+
+// one command pool per frame in flight, reset as a whole instead of per command buffer
+class FrameCommands
+{
+public:
+    FrameCommands(VkDevice logicalDevice, const std::uint32_t queueFamily) : logicalDevice{logicalDevice}
+    {
+        for (std::uint32_t frame = 0; frame < MAX_FRAMES_IN_FLIGHT; ++frame)
+        {
+            const VkCommandPoolCreateInfo poolInfo{.sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO,
+                                                   .flags = VK_COMMAND_POOL_CREATE_TRANSIENT_BIT,
+                                                   .queueFamilyIndex = queueFamily};
+            if (VK_SUCCESS !=
+                vkCreateCommandPool(logicalDevice, &poolInfo, vultex::allocation_callbacks(), &pools.at(frame)))
+            {
+                throw std::runtime_error("Failed to create benchmark command pool!");
+            }
+
+            const VkCommandBufferAllocateInfo allocateInfo{.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO,
+                                                           .commandPool = pools.at(frame),
+                                                           .level = VK_COMMAND_BUFFER_LEVEL_PRIMARY,
+                                                           .commandBufferCount = 1};
+            vkAllocateCommandBuffers(logicalDevice, &allocateInfo, &commandBuffers.at(frame));
+        }
+    }
+
+    FrameCommands(const FrameCommands&) = delete;
+    FrameCommands(FrameCommands&&) = delete;
+    FrameCommands& operator=(const FrameCommands&) = delete;
+    FrameCommands& operator=(FrameCommands&&) = delete;
+
+    ~FrameCommands()
+    {
+        for (auto* pool : pools)
+        {
+            vkDestroyCommandPool(logicalDevice, pool, vultex::allocation_callbacks());
+        }
+    }
+
+    // the previous submission of the frame slot has to be complete
+    [[nodiscard]] auto begin(const std::uint32_t frame) const -> VkCommandBuffer
+    {
+        vkResetCommandPool(logicalDevice, pools.at(frame), 0);
+
+        const VkCommandBufferBeginInfo beginInfo{.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO,
+                                                 .flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT};
+        vkBeginCommandBuffer(commandBuffers.at(frame), &beginInfo);
+        return commandBuffers.at(frame);
+    }
+
+private:
+    VkDevice logicalDevice{nullptr};
+    std::array<VkCommandPool, MAX_FRAMES_IN_FLIGHT> pools{};
+    std::array<VkCommandBuffer, MAX_FRAMES_IN_FLIGHT> commandBuffers{};
+};
+
+[[nodiscard]] auto runScene(vultex::bench::Scene& scene,
+                            const FrameCommands& frameCommands,
+                            vultex::QueueTimeline& timeline,
+                            vultex::GpuCounters& gpuCounters,
+                            const vultex::HostAllocator& hostAllocator,
+                            const Options& options) -> vultex::bench::BenchResult
+{
+    spdlog::info("Run {}: {} warmup frames, {} frames", scene.name(), options.warmupFrames, options.frames);
+
+    std::array<std::uint64_t, MAX_FRAMES_IN_FLIGHT> frameTimelineValues{};
+    std::vector<double> cpuMilliseconds{};
+    cpuMilliseconds.reserve(options.frames);
+
+    // warmup frames go to the first one, the measured ones to the second
+    std::optional<vultex::FrameStatistics> statistics{std::in_place};
+    const auto collectAll = [&]
+    {
+        timeline.wait(timeline.last_submitted_value());
+        for (std::uint32_t slot = 0; slot < MAX_FRAMES_IN_FLIGHT; ++slot)
+        {
+            gpuCounters.collect(slot, *statistics);
+        }
+    };
+
+    auto measureStart = std::chrono::steady_clock::now();
+    std::uint64_t allocationsStart = 0;
+    std::uint64_t lastFrame = 0;
+
+    for (std::uint32_t frame = 0; frame < options.warmupFrames + options.frames; ++frame)
+    {
+        if (frame == options.warmupFrames)
+        {
+            collectAll();
+            statistics.emplace();
+            measureStart = std::chrono::steady_clock::now();
+            allocationsStart = totalAllocations(hostAllocator);
+        }
+
+        const auto slot = frame % MAX_FRAMES_IN_FLIGHT;
+        timeline.wait(frameTimelineValues.at(slot));
+        gpuCounters.collect(slot, *statistics);
+
+        // CPU cost of a frame: recording and submission, not the wait for the GPU
+        const auto cpuStart = std::chrono::steady_clock::now();
+        lastFrame = statistics->begin_frame();
+        const auto asyncWait = scene.submit_async();
+        const std::array commandBuffers{frameCommands.begin(slot)};
+        gpuCounters.begin_frame(commandBuffers.front(), slot, lastFrame);
+        gpuCounters.begin_pass(commandBuffers.front(), scene.name());
+        scene.record(commandBuffers.front());
+        gpuCounters.end_pass(commandBuffers.front());
+        gpuCounters.end_frame(commandBuffers.front());
+        vkEndCommandBuffer(commandBuffers.front());
+        frameTimelineValues.at(slot) = timeline.submit(
+            commandBuffers, asyncWait ? std::span{&asyncWait.value(), 1} : std::span<const vultex::TimelineWait>{});
+        statistics->end_frame();
+        const auto cpuEnd = std::chrono::steady_clock::now();
+
+        if (frame >= options.warmupFrames)
+        {
+            cpuMilliseconds.push_back(std::chrono::duration<double, std::milli>(cpuEnd - cpuStart).count());
+        }
+    }
+
+    timeline.wait(timeline.last_submitted_value());
+    const auto seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - measureStart).count();
+    const auto allocations = totalAllocations(hostAllocator) - allocationsStart;
+    collectAll();
+
+    vultex::bench::BenchResult result{.name = std::string{scene.name()}};
+    result.metrics.emplace_back("frames_per_second", options.frames / seconds);
+    result.metrics.emplace_back("cpu_ms_per_frame", median(cpuMilliseconds));
+    result.metrics.emplace_back("cpu_ms_per_frame_max", std::ranges::max(cpuMilliseconds));
+    result.metrics.emplace_back("allocations_per_frame", static_cast<double>(allocations) / options.frames);
+
+    if (const auto& gpuTimes = statistics->gpu_time_histogram(); 0 != gpuTimes.count())
+    {
+        result.metrics.emplace_back("gpu_ms_per_frame",
+                                    std::chrono::duration<double, std::milli>(gpuTimes.percentile(50.0)).count());
+        result.metrics.emplace_back("gpu_ms_per_frame_p99",
+                                    std::chrono::duration<double, std::milli>(gpuTimes.percentile(99.0)).count());
+    }
+
+    // every frame draws the same, the counters of the last one stand for all of them
+    if (const auto* sample = statistics->sample(lastFrame); nullptr != sample && !sample->gpu_passes.empty())
+    {
+        for (const auto& counter : sample->counters_of(sample->gpu_passes.front()))
+        {
+            result.metrics.emplace_back(fmt::format("{}_per_frame", counter.name), counter.value);
+        }
+    }
+
+    // same frames on the same driver give the same output, a changed hash is a changed rendering
+    if (const auto hash = scene.output_hash())
+    {
+        result.attributes.emplace_back("output_hash", fmt::format("{:016x}", hash.value()));
+    }
+    return result;
+}
+} // namespace
+
+int main(int argc, char** argv)
+try
+{
+    // stdout is reserved for the report
+    spdlog::set_default_logger(spdlog::stderr_color_mt("vultex_bench"));
+    spdlog::set_level(spdlog::level::info);
+
+    const auto options = parseOptions(argc, argv);
+
+    // has to outlive every vulkan object
+    vultex::HostAllocator hostAllocator{};
+    vultex::install_allocation_callbacks(hostAllocator.callbacks());
+
+    vultex::bench::BenchReport report{};
+
+    // before any other context, the first run has to load the ICD
+    if (0 != options.startupRuns && std::string_view{"startup"}.find(options.filter) != std::string_view::npos)
+    {
+        report.results.push_back(vultex::bench::run_startup_benchmark(options.startupRuns, options.startupWindow));
+    }
+
+    if (std::string_view{"scene_graph_update"}.find(options.filter) != std::string_view::npos)
+    {
+        report.results.push_back(vultex::bench::run_scene_graph_benchmark(options.frames, options.warmupFrames));
+    }
+
+    if (std::string_view{"frustum_culling"}.find(options.filter) != std::string_view::npos)
+    {
+        report.results.push_back(vultex::bench::run_frustum_culling_benchmark(options.frames, options.warmupFrames));
+    }
+
+    if (std::string_view{"draw_batching"}.find(options.filter) != std::string_view::npos)
+    {
+        report.results.push_back(vultex::bench::run_draw_batching_benchmark(options.frames, options.warmupFrames));
+    }
+
+    if (std::string_view{"render_queue"}.find(options.filter) != std::string_view::npos)
+    {
+        report.results.push_back(vultex::bench::run_render_queue_benchmark(options.frames, options.warmupFrames));
+    }
+
+    {
+        const vultex::VulkanContext context{};
+
+        VkPhysicalDeviceProperties properties{};
+        vkGetPhysicalDeviceProperties(context.physical_device(), &properties);
+        report.device_name = properties.deviceName;
+        report.device_type = deviceTypeName(properties.deviceType);
+        report.api_version = fmt::format("{}.{}.{}",
+                                         VK_VERSION_MAJOR(properties.apiVersion),
+                                         VK_VERSION_MINOR(properties.apiVersion),
+                                         VK_VERSION_PATCH(properties.apiVersion));
+        report.driver_version = properties.driverVersion;
+        report.settings = {{"frames", options.frames},
+                           {"warmup_frames", options.warmupFrames},
+                           {"startup_runs", options.startupRuns},
+                           {"width", TARGET_EXTENT.width},
+                           {"height", TARGET_EXTENT.height}};
+
+        vultex::QueueTimeline timeline{context.logical_device(), context.graphics_queue(), context.graphics_family()};
+        vultex::QueueTimeline computeTimeline{
+            context.logical_device(), context.compute_queue(), context.compute_family()};
+        vultex::ShaderModuleCache shaders{context.logical_device(), "shader_cache"};
+        // builds the pipelines of the scenes in parallel, owns them until the end
+        vultex::JobSystem jobs{};
+        vultex::PipelineCompiler pipelines{context.physical_device(),
+                                           context.logical_device(),
+                                           jobs,
+                                           context.graphics_pipeline_library(),
+                                           "bench_pipeline_cache.bin"};
+        vultex::bench::OffscreenTarget target{context, timeline, TARGET_EXTENT};
+        const FrameCommands frameCommands{context.logical_device(), context.graphics_family()};
+        vultex::GpuCounters gpuCounters{context, MAX_FRAMES_IN_FLIGHT, options.performanceCounters};
+
+        const vultex::GpuPrimitives primitives{
+            context,
+            shaders,
+            pipelines,
+            VULTEX_SHADER_DIR,
+            options.sharedMemoryKernels ? vultex::ComputeVariant::shared_memory()
+                                        : vultex::ComputeVariant::select(context.physical_device())};
+
+        const auto scenes = vultex::bench::create_scenes(
+            vultex::bench::SceneResources{.context = context,
+                                          .timeline = timeline,
+                                          .compute_timeline = computeTimeline,
+                                          .shaders = shaders,
+                                          .pipelines = pipelines,
+                                          .primitives = primitives,
+                                          .target = target,
+                                          .shader_directory = VULTEX_BENCH_SHADER_DIR,
+                                          .core_shader_directory = VULTEX_SHADER_DIR});
+
+        for (const auto& scene : scenes)
+        {
+            if (scene->name().find(options.filter) != std::string_view::npos)
+            {
+                report.results.push_back(
+                    runScene(*scene, frameCommands, timeline, gpuCounters, hostAllocator, options));
+            }
+        }
+
+        vkDeviceWaitIdle(context.logical_device());
+    }
+
+    if (options.output)
+    {
+        std::ofstream file{options.output.value()};
+        vultex::bench::write_json(file, report);
+    }
+    else
+    {
+        vultex::bench::write_json(std::cout, report);
+    }
+
+    hostAllocator.log_statistics();
+
+    return EXIT_SUCCESS;
+}
+catch (const std::exception& e)
+{
+    spdlog::error("{}", e.what());
+    return EXIT_FAILURE;
+}
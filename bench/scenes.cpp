@@ -0,0 +1,1544 @@
+#include "scenes.hpp"
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cmath>
+#include <cstddef>
+#include <cstring>
+#include <fmt/format.h>
+#include <glm/gtc/matrix_transform.hpp>
+#include <numeric>
+#include <random>
+#include <span>
+#include <spdlog/spdlog.h>
+#include <stdexcept>
+
+#include "clustered_lighting.hpp"
+#include "gpu_particles.hpp"
+#include "hash.hpp"
+#include "host_allocator.hpp"
+#include "lod_mesh.hpp"
+#include "pipeline_permutations.hpp"
+#include "queue_scheduler.hpp"
+#include "specialization_constants.hpp"
+#include "upload_batcher.hpp"
+#include "vertex_compression.hpp"
+
+namespace vultex::bench
+{
+namespace
+{
+constexpr std::uint32_t draw_grid_size = 128;          // many_draws: 16384 draws of two triangles
+constexpr std::uint32_t triangle_grid_size = 1024;     // many_triangles: one draw of 2M triangles
+constexpr VkExtent2D texture_extent{4096, 4096};       // large_textures: 64 MiB upload and mip chain
+constexpr std::uint32_t compute_values = 1U << 20U;    // heavy_compute: 1M invocations
+constexpr std::uint32_t compute_iterations = 1024;     // multiply-adds per invocation
+constexpr std::uint32_t compute_workgroup_size = 64;
+constexpr std::uint32_t mesh_rings = 512;              // mesh_*_vertices: 512k vertices, 1M triangles
+constexpr std::uint32_t mesh_segments = 1024;
+constexpr std::uint32_t mesh_instances = 4;            // in a 2x2 grid, see mesh.vert, each drawing
+constexpr std::uint32_t mesh_lods = 3;                 // the level select_lod() picks for it
+constexpr float mesh_pixel_error = 1.5F;
+constexpr std::uint32_t primitive_values = 1U << 20U;  // gpu_*: 1M values per compute primitive
+constexpr std::uint32_t primitive_live_values = 777777; // gpu_radix_sort_live: the ones sorted, not whole tiles
+constexpr std::uint32_t lighting_lights = 4096;        // clustered_lighting: lights over a plane of
+constexpr std::uint32_t lighting_columns = 256;        // 256x256 cells in 16x16x24 froxels
+constexpr std::uint32_t lighting_light_indices = 1U << 20U;
+constexpr std::uint32_t particle_capacity = 1U << 20U; // gpu_particles: a fountain of up to 1M particles,
+constexpr std::uint32_t particle_emit_count = 3200;    // per step, living 300 steps at most: 960k particles
+constexpr std::uint32_t upload_runs = 64;              // upload_batching: 64 runs of 256 adjacent 64 byte
+constexpr std::uint32_t upload_run_chunks = 256;       // uploads and 4x4 tiles of a 256x256 texture per frame
+constexpr std::uint32_t upload_chunk_size = 64;
+constexpr std::uint32_t upload_tile_size = 64;
+constexpr std::uint32_t upload_tiles = 4;
+
+// feature bits of mesh.vert, constant_id = bit
+constexpr std::uint32_t mesh_features = 1;
+constexpr std::uint32_t packed_vertices_feature = 1U << 0U;
+
+struct QuadGridDraw
+{
+    std::array<float, 4> rect;
+    std::array<float, 4> color;
+    std::uint32_t columns;
+    std::uint32_t rows;
+};
+
+// Fixed function state of the graphics scenes: the whole target, no culling,
+// no depth and no blending
+[[nodiscard]] VkPipeline build_graphics_pipeline(const PipelineBuildContext& context,
+                                                 const OffscreenTarget& target,
+                                                 std::span<const VkPipelineShaderStageCreateInfo> stages,
+                                                 const VkPipelineVertexInputStateCreateInfo& vertex_input,
+                                                 VkPipelineLayout layout)
+{
+    const VkPipelineInputAssemblyStateCreateInfo inputAssembly{
+        .sType = VK_STRUCTURE_TYPE_PIPELINE_INPUT_ASSEMBLY_STATE_CREATE_INFO,
+        .topology = VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST};
+
+    const auto extent = target.extent();
+    const VkViewport viewport{.x = 0.0F,
+                              .y = 0.0F,
+                              .width = static_cast<float>(extent.width),
+                              .height = static_cast<float>(extent.height),
+                              .minDepth = 0.0F,
+                              .maxDepth = 1.0F};
+    const VkRect2D scissor{.offset = {0, 0}, .extent = extent};
+    const VkPipelineViewportStateCreateInfo viewportState{
+        .sType = VK_STRUCTURE_TYPE_PIPELINE_VIEWPORT_STATE_CREATE_INFO,
+        .viewportCount = 1,
+        .pViewports = &viewport,
+        .scissorCount = 1,
+        .pScissors = &scissor};
+
+    const VkPipelineRasterizationStateCreateInfo rasterization{
+        .sType = VK_STRUCTURE_TYPE_PIPELINE_RASTERIZATION_STATE_CREATE_INFO,
+        .polygonMode = VK_POLYGON_MODE_FILL,
+        .cullMode = VK_CULL_MODE_NONE,
+        .frontFace = VK_FRONT_FACE_COUNTER_CLOCKWISE,
+        .lineWidth = 1.0F};
+    const VkPipelineMultisampleStateCreateInfo multisample{
+        .sType = VK_STRUCTURE_TYPE_PIPELINE_MULTISAMPLE_STATE_CREATE_INFO,
+        .rasterizationSamples = VK_SAMPLE_COUNT_1_BIT};
+
+    const VkPipelineColorBlendAttachmentState blendAttachment{
+        .colorWriteMask = VK_COLOR_COMPONENT_R_BIT | VK_COLOR_COMPONENT_G_BIT | VK_COLOR_COMPONENT_B_BIT |
+                          VK_COLOR_COMPONENT_A_BIT};
+    const VkPipelineColorBlendStateCreateInfo colorBlend{
+        .sType = VK_STRUCTURE_TYPE_PIPELINE_COLOR_BLEND_STATE_CREATE_INFO,
+        .attachmentCount = 1,
+        .pAttachments = &blendAttachment};
+
+    const VkGraphicsPipelineCreateInfo pipelineInfo{.sType = VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_CREATE_INFO,
+                                                    .stageCount = static_cast<std::uint32_t>(stages.size()),
+                                                    .pStages = stages.data(),
+                                                    .pVertexInputState = &vertex_input,
+                                                    .pInputAssemblyState = &inputAssembly,
+                                                    .pViewportState = &viewportState,
+                                                    .pRasterizationState = &rasterization,
+                                                    .pMultisampleState = &multisample,
+                                                    .pColorBlendState = &colorBlend,
+                                                    .layout = layout,
+                                                    .renderPass = target.render_pass(),
+                                                    .subpass = 0};
+    return vultex::create_graphics_pipeline(context, pipelineInfo);
+}
+
+// Built by the pipeline compiler which owns the pipeline, the same name is
+// built once
+[[nodiscard]] VkPipeline create_graphics_pipeline(const SceneResources& resources,
+                                                  std::span<const VkPipelineShaderStageCreateInfo> stages,
+                                                  const VkPipelineVertexInputStateCreateInfo& vertex_input,
+                                                  VkPipelineLayout layout,
+                                                  std::string_view name)
+{
+    // waited for right away, the state outlives the build
+    const auto pipeline = resources.pipelines.compile(
+        fnv1a(fmt::format("bench:{}", name)),
+        [&resources, stages, &vertex_input, layout](const PipelineBuildContext& context)
+        { return build_graphics_pipeline(context, resources.target, stages, vertex_input, layout); });
+    return PipelineCompiler::wait(pipeline, name);
+}
+
+// pipeline of quad_grid.vert / quad_grid.frag, no vertex input and no blending
+class QuadGridPipeline
+{
+public:
+    explicit QuadGridPipeline(const SceneResources& resources) : logical_device{resources.context.logical_device()}
+    {
+        const VkPushConstantRange pushConstants{
+            .stageFlags = VK_SHADER_STAGE_VERTEX_BIT, .offset = 0, .size = sizeof(QuadGridDraw)};
+        const VkPipelineLayoutCreateInfo layoutInfo{.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO,
+                                                    .pushConstantRangeCount = 1,
+                                                    .pPushConstantRanges = &pushConstants};
+        if (VK_SUCCESS != vkCreatePipelineLayout(logical_device, &layoutInfo, allocation_callbacks(), &layout))
+        {
+            throw std::runtime_error("Failed to create quad grid pipeline layout!");
+        }
+
+        const std::array stages{
+            VkPipelineShaderStageCreateInfo{
+                .sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO,
+                .stage = VK_SHADER_STAGE_VERTEX_BIT,
+                .module = resources.shaders.load(resources.shader_directory / "quad_grid.vert.spv",
+                                                 VK_SHADER_STAGE_VERTEX_BIT),
+                .pName = "main"},
+            VkPipelineShaderStageCreateInfo{
+                .sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO,
+                .stage = VK_SHADER_STAGE_FRAGMENT_BIT,
+                .module = resources.shaders.load(resources.shader_directory / "quad_grid.frag.spv",
+                                                 VK_SHADER_STAGE_FRAGMENT_BIT),
+                .pName = "main"}};
+
+        const VkPipelineVertexInputStateCreateInfo vertexInput{
+            .sType = VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_STATE_CREATE_INFO};
+        pipeline = create_graphics_pipeline(resources, stages, vertexInput, layout, "quad grid");
+    }
+
+    QuadGridPipeline(const QuadGridPipeline&) = delete;
+    QuadGridPipeline(QuadGridPipeline&&) = delete;
+    QuadGridPipeline& operator=(const QuadGridPipeline&) = delete;
+    QuadGridPipeline& operator=(QuadGridPipeline&&) = delete;
+
+    ~QuadGridPipeline()
+    {
+        vkDestroyPipelineLayout(logical_device, layout, allocation_callbacks());
+    }
+
+    void bind(VkCommandBuffer command_buffer) const
+    {
+        vkCmdBindPipeline(command_buffer, VK_PIPELINE_BIND_POINT_GRAPHICS, pipeline);
+    }
+
+    void draw(VkCommandBuffer command_buffer, const QuadGridDraw& draw) const
+    {
+        vkCmdPushConstants(command_buffer, layout, VK_SHADER_STAGE_VERTEX_BIT, 0, sizeof(draw), &draw);
+        vkCmdDraw(command_buffer, 6 * draw.columns * draw.rows, 1, 0, 0);
+    }
+
+private:
+    VkDevice logical_device{nullptr};
+    VkPipelineLayout layout{nullptr};
+    VkPipeline pipeline{nullptr};
+};
+
+struct MeshDraw
+{
+    glm::mat4 view_projection;
+    // dequantization of packed vertices, unused for float vertices
+    glm::vec4 quantization_offset;
+    glm::vec4 quantization_scale;
+};
+
+// Sphere with waves on it, seams duplicated so every vertex has one uv. With
+// its LODs, in vertex cache order and packed like the output of vultex_lod.
+[[nodiscard]] LodMesh wavy_sphere()
+{
+    constexpr float pi = 3.14159265F;
+
+    LodMesh mesh{.center = glm::vec3{0.0F}, .radius = 1.03F};
+    mesh.vertices.reserve(static_cast<std::size_t>(mesh_rings + 1) * (mesh_segments + 1));
+    for (std::uint32_t ring = 0; ring <= mesh_rings; ++ring)
+    {
+        const auto theta = pi * static_cast<float>(ring) / mesh_rings;
+        for (std::uint32_t segment = 0; segment <= mesh_segments; ++segment)
+        {
+            const auto phi = 2.0F * pi * static_cast<float>(segment) / mesh_segments;
+            const glm::vec3 normal{std::sin(theta) * std::cos(phi), std::cos(theta), std::sin(theta) * std::sin(phi)};
+            const auto radius = 1.0F + 0.03F * std::sin(9.0F * theta) * std::cos(13.0F * phi);
+            mesh.vertices.push_back(
+                MeshVertex{.position = normal * radius,
+                           .normal = normal,
+                           .tangent = glm::vec4{-std::sin(phi), 0.0F, std::cos(phi), 1.0F},
+                           .uv = glm::vec2{static_cast<float>(segment) / mesh_segments,
+                                           static_cast<float>(ring) / mesh_rings}});
+        }
+    }
+
+    for (std::uint32_t ring = 0; ring < mesh_rings; ++ring)
+    {
+        for (std::uint32_t segment = 0; segment < mesh_segments; ++segment)
+        {
+            const auto corner = ring * (mesh_segments + 1) + segment;
+            const auto below = corner + mesh_segments + 1;
+            mesh.indices.insert(mesh.indices.end(), {corner, corner + 1, below, corner + 1, below + 1, below});
+        }
+    }
+
+    mesh.lods = {MeshLod{.first_index = 0, .index_count = static_cast<std::uint32_t>(mesh.indices.size()), .error = 0}};
+    build_lods(mesh, LodSettings{.max_lods = mesh_lods});
+    optimize_vertex_order(mesh);
+    compress_vertices(mesh);
+    return mesh;
+}
+
+// Permutation of mesh.vert, the feature mask selects the vertex layout
+[[nodiscard]] VkPipeline build_mesh_pipeline(const PipelineBuildContext& context,
+                                             const OffscreenTarget& target,
+                                             VkShaderModule vertex_shader,
+                                             VkShaderModule fragment_shader,
+                                             VkPipelineLayout layout,
+                                             const std::uint32_t mask)
+{
+    const auto packed = (mask & packed_vertices_feature) != 0;
+    const FeatureSpecialization<mesh_features> features{mask};
+    const auto specialization = features.info();
+    const std::array stages{
+        VkPipelineShaderStageCreateInfo{.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO,
+                                        .stage = VK_SHADER_STAGE_VERTEX_BIT,
+                                        .module = vertex_shader,
+                                        .pName = "main",
+                                        .pSpecializationInfo = &specialization},
+        VkPipelineShaderStageCreateInfo{.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO,
+                                        .stage = VK_SHADER_STAGE_FRAGMENT_BIT,
+                                        .module = fragment_shader,
+                                        .pName = "main"}};
+
+    const auto packedInput = packed_vertex_input(0);
+    const VkVertexInputBindingDescription floatBinding{
+        .binding = 0, .stride = sizeof(MeshVertex), .inputRate = VK_VERTEX_INPUT_RATE_VERTEX};
+    const auto floatAttribute = [](const std::uint32_t location, const VkFormat format, const std::uint32_t offset)
+    {
+        return VkVertexInputAttributeDescription{
+            .location = location, .binding = 0, .format = format, .offset = offset};
+    };
+    const std::array floatAttributes{
+        floatAttribute(0, VK_FORMAT_R32G32B32_SFLOAT, offsetof(MeshVertex, position)),
+        floatAttribute(1, VK_FORMAT_R32G32B32_SFLOAT, offsetof(MeshVertex, normal)),
+        floatAttribute(2, VK_FORMAT_R32G32B32A32_SFLOAT, offsetof(MeshVertex, tangent)),
+        floatAttribute(3, VK_FORMAT_R32G32_SFLOAT, offsetof(MeshVertex, uv))};
+
+    const VkPipelineVertexInputStateCreateInfo vertexInput{
+        .sType = VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_STATE_CREATE_INFO,
+        .vertexBindingDescriptionCount = 1,
+        .pVertexBindingDescriptions = packed ? &packedInput.binding : &floatBinding,
+        .vertexAttributeDescriptionCount = 4,
+        .pVertexAttributeDescriptions = packed ? packedInput.attributes.data() : floatAttributes.data()};
+    return build_graphics_pipeline(context, target, stages, vertexInput, layout);
+}
+
+// Vertex fetch bound: the same mesh with float vertices or PackedVertex, a
+// permutation of mesh.vert each. Both upload their buffers to device local memory with the first frame.
+// Every instance draws the level select_lod() picks at its distance, the nearer row a finer one.
+class MeshScene final : public Scene
+{
+public:
+    MeshScene(const SceneResources& resources, const LodMesh& mesh, const bool packed)
+        : logical_device{resources.context.logical_device()},
+          target{resources.target},
+          packed_vertices{packed},
+          index_count{static_cast<std::uint32_t>(mesh.indices.size())}
+    {
+        const auto vertexBytes = packed ? std::as_bytes(std::span{mesh.packed_vertices})
+                                        : std::as_bytes(std::span{mesh.vertices});
+        const auto indexBytes = std::as_bytes(std::span{mesh.indices});
+        vertex_bytes = vertexBytes.size();
+
+        staging = create_buffer(
+            resources.context, vertexBytes.size() + indexBytes.size(), VK_BUFFER_USAGE_TRANSFER_SRC_BIT, true);
+        std::memcpy(staging.mapped, vertexBytes.data(), vertexBytes.size());
+        std::memcpy(std::next(static_cast<std::byte*>(staging.mapped), static_cast<std::ptrdiff_t>(vertexBytes.size())),
+                    indexBytes.data(),
+                    indexBytes.size());
+        vertices = create_buffer(resources.context,
+                                 vertexBytes.size(),
+                                 VK_BUFFER_USAGE_VERTEX_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+                                 false);
+        indices = create_buffer(resources.context,
+                                indexBytes.size(),
+                                VK_BUFFER_USAGE_INDEX_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+                                false);
+
+        // a little above the spheres, all four fill most of the target
+        auto projection = glm::perspective(glm::radians(60.0F), 1.0F, 0.1F, 20.0F);
+        projection[1][1] *= -1.0F;
+        const auto view = glm::lookAt(glm::vec3{0.0F, 1.0F, 4.5F}, glm::vec3{0.0F}, glm::vec3{0.0F, 1.0F, 0.0F});
+        draw = MeshDraw{.view_projection = projection * view,
+                        .quantization_offset = glm::vec4{mesh.quantization.offset, 0.0F},
+                        .quantization_scale = glm::vec4{mesh.quantization.scale, 0.0F}};
+
+        // the camera doesn't move, the levels are selected once
+        std::array<LodInstance, mesh_instances> instances{};
+        std::array<std::uint32_t, mesh_instances> visible{};
+        for (std::uint32_t instance = 0; instance < mesh_instances; ++instance)
+        {
+            instances.at(instance) = LodInstance{.position = glm::vec3{static_cast<float>(instance % 2) * 2.2F - 1.1F,
+                                                                       static_cast<float>(instance / 2) * 2.2F - 1.1F,
+                                                                       0.0F},
+                                                 .scale = 1.0F};
+            visible.at(instance) = instance;
+        }
+        const auto extent = resources.target.extent();
+        const auto camera = LodCamera::from_perspective(
+            glm::vec3{0.0F, 1.0F, 4.5F}, glm::radians(60.0F), static_cast<float>(extent.height), mesh_pixel_error);
+        append_lod_draws(mesh, camera, instances, visible, draws);
+
+        const VkPushConstantRange pushConstants{
+            .stageFlags = VK_SHADER_STAGE_VERTEX_BIT, .offset = 0, .size = sizeof(MeshDraw)};
+        const VkPipelineLayoutCreateInfo layoutInfo{.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO,
+                                                    .pushConstantRangeCount = 1,
+                                                    .pPushConstantRanges = &pushConstants};
+        if (VK_SUCCESS != vkCreatePipelineLayout(logical_device, &layoutInfo, allocation_callbacks(), &layout))
+        {
+            throw std::runtime_error("Failed to create mesh pipeline layout!");
+        }
+
+        const auto vertexShader =
+            resources.shaders.load(resources.shader_directory / "mesh.vert.spv", VK_SHADER_STAGE_VERTEX_BIT);
+        const auto fragmentShader =
+            resources.shaders.load(resources.shader_directory / "mesh.frag.spv", VK_SHADER_STAGE_FRAGMENT_BIT);
+        permutations.emplace(
+            resources.pipelines,
+            fnv1a("bench:mesh"),
+            [&target = resources.target, vertexShader, fragmentShader, layout = layout](
+                const PipelineBuildContext& context, const std::uint32_t mask)
+            { return build_mesh_pipeline(context, target, vertexShader, fragmentShader, layout, mask); });
+        pipeline = permutations->wait(packed ? packed_vertices_feature : 0);
+    }
+
+    MeshScene(const MeshScene&) = delete;
+    MeshScene(MeshScene&&) = delete;
+    MeshScene& operator=(const MeshScene&) = delete;
+    MeshScene& operator=(MeshScene&&) = delete;
+
+    ~MeshScene() override
+    {
+        vkDestroyPipelineLayout(logical_device, layout, allocation_callbacks());
+        destroy_buffer(logical_device, indices);
+        destroy_buffer(logical_device, vertices);
+        destroy_buffer(logical_device, staging);
+    }
+
+    [[nodiscard]] std::string_view name() const override
+    {
+        return packed_vertices ? "mesh_packed_vertices" : "mesh_float_vertices";
+    }
+
+    void record(VkCommandBuffer command_buffer) override
+    {
+        if (!uploaded)
+        {
+            upload(command_buffer);
+        }
+
+        target.begin(command_buffer);
+        vkCmdBindPipeline(command_buffer, VK_PIPELINE_BIND_POINT_GRAPHICS, pipeline);
+        const VkDeviceSize offset = 0;
+        vkCmdBindVertexBuffers(command_buffer, 0, 1, &vertices.buffer, &offset);
+        vkCmdBindIndexBuffer(command_buffer, indices.buffer, 0, VK_INDEX_TYPE_UINT32);
+        vkCmdPushConstants(command_buffer, layout, VK_SHADER_STAGE_VERTEX_BIT, 0, sizeof(draw), &draw);
+        for (const auto& lodDraw : draws)
+        {
+            vkCmdDrawIndexed(command_buffer,
+                             lodDraw.indexCount,
+                             lodDraw.instanceCount,
+                             lodDraw.firstIndex,
+                             lodDraw.vertexOffset,
+                             lodDraw.firstInstance);
+        }
+        target.end(command_buffer);
+    }
+
+    [[nodiscard]] std::optional<std::uint64_t> output_hash() const override
+    {
+        return target.content_hash();
+    }
+
+private:
+    void upload(VkCommandBuffer command_buffer)
+    {
+        const VkBufferCopy vertexRegion{.srcOffset = 0, .dstOffset = 0, .size = vertex_bytes};
+        vkCmdCopyBuffer(command_buffer, staging.buffer, vertices.buffer, 1, &vertexRegion);
+        const VkBufferCopy indexRegion{
+            .srcOffset = vertex_bytes, .dstOffset = 0, .size = VkDeviceSize{sizeof(std::uint32_t)} * index_count};
+        vkCmdCopyBuffer(command_buffer, staging.buffer, indices.buffer, 1, &indexRegion);
+
+        const VkMemoryBarrier barrier{.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER,
+                                      .srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT,
+                                      .dstAccessMask = VK_ACCESS_VERTEX_ATTRIBUTE_READ_BIT | VK_ACCESS_INDEX_READ_BIT};
+        vkCmdPipelineBarrier(command_buffer,
+                             VK_PIPELINE_STAGE_TRANSFER_BIT,
+                             VK_PIPELINE_STAGE_VERTEX_INPUT_BIT,
+                             0,
+                             1,
+                             &barrier,
+                             0,
+                             nullptr,
+                             0,
+                             nullptr);
+        uploaded = true;
+    }
+
+    VkDevice logical_device{nullptr};
+    OffscreenTarget& target;
+    bool packed_vertices{false};
+    std::uint32_t index_count{0};
+    VkDeviceSize vertex_bytes{0};
+    bool uploaded{false};
+    MeshDraw draw{};
+    std::vector<VkDrawIndexedIndirectCommand> draws{};
+    GpuBuffer staging{};
+    GpuBuffer vertices{};
+    GpuBuffer indices{};
+    VkPipelineLayout layout{nullptr};
+    std::optional<PipelinePermutations> permutations{};
+    VkPipeline pipeline{nullptr};
+};
+
+// CPU bound: command recording and per draw driver overhead
+class ManyDrawsScene final : public Scene
+{
+public:
+    explicit ManyDrawsScene(const SceneResources& resources) : target{resources.target}, pipeline{resources}
+    {
+    }
+
+    [[nodiscard]] std::string_view name() const override
+    {
+        return "many_draws";
+    }
+
+    void record(VkCommandBuffer command_buffer) override
+    {
+        constexpr auto cell = 1.0F / draw_grid_size;
+
+        target.begin(command_buffer);
+        pipeline.bind(command_buffer);
+        for (std::uint32_t index = 0; index < draw_grid_size * draw_grid_size; ++index)
+        {
+            // Knuth multiplicative hash, a stable color per draw
+            const auto hash = index * 2654435761U;
+            pipeline.draw(command_buffer,
+                          QuadGridDraw{.rect = {static_cast<float>(index % draw_grid_size) * cell,
+                                                static_cast<float>(index / draw_grid_size) * cell,
+                                                cell,
+                                                cell},
+                                       .color = {static_cast<float>(hash & 255U) / 255.0F,
+                                                 static_cast<float>((hash >> 8U) & 255U) / 255.0F,
+                                                 static_cast<float>((hash >> 16U) & 255U) / 255.0F,
+                                                 1.0F},
+                                       .columns = 1,
+                                       .rows = 1});
+        }
+        target.end(command_buffer);
+    }
+
+    [[nodiscard]] std::optional<std::uint64_t> output_hash() const override
+    {
+        return target.content_hash();
+    }
+
+private:
+    OffscreenTarget& target;
+    QuadGridPipeline pipeline;
+};
+
+// GPU bound: vertex and raster throughput of small triangles
+class ManyTrianglesScene final : public Scene
+{
+public:
+    explicit ManyTrianglesScene(const SceneResources& resources) : target{resources.target}, pipeline{resources}
+    {
+    }
+
+    [[nodiscard]] std::string_view name() const override
+    {
+        return "many_triangles";
+    }
+
+    void record(VkCommandBuffer command_buffer) override
+    {
+        target.begin(command_buffer);
+        pipeline.bind(command_buffer);
+        pipeline.draw(command_buffer,
+                      QuadGridDraw{.rect = {0.0F, 0.0F, 1.0F, 1.0F},
+                                   .color = {0.2F, 0.6F, 1.0F, 1.0F},
+                                   .columns = triangle_grid_size,
+                                   .rows = triangle_grid_size});
+        target.end(command_buffer);
+    }
+
+    [[nodiscard]] std::optional<std::uint64_t> output_hash() const override
+    {
+        return target.content_hash();
+    }
+
+private:
+    OffscreenTarget& target;
+    QuadGridPipeline pipeline;
+};
+
+// transfer bound: full upload of a large texture and its mip chain every frame
+class LargeTexturesScene final : public Scene
+{
+public:
+    explicit LargeTexturesScene(const SceneResources& resources)
+        : logical_device{resources.context.logical_device()},
+          mip_levels{static_cast<std::uint32_t>(std::bit_width(std::max(texture_extent.width, texture_extent.height)))}
+    {
+        const auto size = VkDeviceSize{4} * texture_extent.width * texture_extent.height;
+        staging = create_buffer(resources.context, size, VK_BUFFER_USAGE_TRANSFER_SRC_BIT, true);
+
+        // texels depend only on their coordinates
+        auto* texels = static_cast<std::uint32_t*>(staging.mapped);
+        for (std::uint32_t y = 0; y < texture_extent.height; ++y)
+        {
+            for (std::uint32_t x = 0; x < texture_extent.width; ++x)
+            {
+                texels[y * texture_extent.width + x] = (x ^ y) * 0x01010101U | 0xff000000U;
+            }
+        }
+
+        texture = create_image(resources.context,
+                               texture_extent,
+                               VK_FORMAT_R8G8B8A8_UNORM,
+                               VK_IMAGE_USAGE_TRANSFER_SRC_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT |
+                                   VK_IMAGE_USAGE_SAMPLED_BIT,
+                               mip_levels);
+    }
+
+    LargeTexturesScene(const LargeTexturesScene&) = delete;
+    LargeTexturesScene(LargeTexturesScene&&) = delete;
+    LargeTexturesScene& operator=(const LargeTexturesScene&) = delete;
+    LargeTexturesScene& operator=(LargeTexturesScene&&) = delete;
+
+    ~LargeTexturesScene() override
+    {
+        destroy_image(logical_device, texture);
+        destroy_buffer(logical_device, staging);
+    }
+
+    [[nodiscard]] std::string_view name() const override
+    {
+        return "large_textures";
+    }
+
+    void record(VkCommandBuffer command_buffer) override
+    {
+        // previous contents are discarded, the previous frame's transfers have to finish first
+        transition(command_buffer,
+                   0,
+                   mip_levels,
+                   VK_IMAGE_LAYOUT_UNDEFINED,
+                   VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+                   VK_ACCESS_TRANSFER_WRITE_BIT,
+                   VK_ACCESS_TRANSFER_WRITE_BIT);
+
+        const VkBufferImageCopy region{
+            .imageSubresource = {.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT, .mipLevel = 0, .layerCount = 1},
+            .imageExtent = {texture_extent.width, texture_extent.height, 1}};
+        vkCmdCopyBufferToImage(
+            command_buffer, staging.buffer, texture.image, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 1, &region);
+
+        auto width = static_cast<std::int32_t>(texture_extent.width);
+        auto height = static_cast<std::int32_t>(texture_extent.height);
+        for (std::uint32_t level = 1; level < mip_levels; ++level)
+        {
+            transition(command_buffer,
+                       level - 1,
+                       1,
+                       VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+                       VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
+                       VK_ACCESS_TRANSFER_WRITE_BIT,
+                       VK_ACCESS_TRANSFER_READ_BIT);
+
+            const auto nextWidth = std::max(width / 2, 1);
+            const auto nextHeight = std::max(height / 2, 1);
+            const VkImageBlit blit{
+                .srcSubresource = {.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT, .mipLevel = level - 1, .layerCount = 1},
+                .srcOffsets = {{0, 0, 0}, {width, height, 1}},
+                .dstSubresource = {.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT, .mipLevel = level, .layerCount = 1},
+                .dstOffsets = {{0, 0, 0}, {nextWidth, nextHeight, 1}}};
+            vkCmdBlitImage(command_buffer,
+                           texture.image,
+                           VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
+                           texture.image,
+                           VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+                           1,
+                           &blit,
+                           VK_FILTER_LINEAR);
+
+            width = nextWidth;
+            height = nextHeight;
+        }
+    }
+
+    [[nodiscard]] std::optional<std::uint64_t> output_hash() const override
+    {
+        return std::nullopt;
+    }
+
+private:
+    void transition(VkCommandBuffer command_buffer,
+                    const std::uint32_t base_level,
+                    const std::uint32_t level_count,
+                    const VkImageLayout old_layout,
+                    const VkImageLayout new_layout,
+                    const VkAccessFlags src_access,
+                    const VkAccessFlags dst_access) const
+    {
+        const VkImageMemoryBarrier barrier{
+            .sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER,
+            .srcAccessMask = src_access,
+            .dstAccessMask = dst_access,
+            .oldLayout = old_layout,
+            .newLayout = new_layout,
+            .srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+            .dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+            .image = texture.image,
+            .subresourceRange = {.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT,
+                                 .baseMipLevel = base_level,
+                                 .levelCount = level_count,
+                                 .layerCount = 1}};
+        vkCmdPipelineBarrier(command_buffer,
+                             VK_PIPELINE_STAGE_TRANSFER_BIT,
+                             VK_PIPELINE_STAGE_TRANSFER_BIT,
+                             0,
+                             0,
+                             nullptr,
+                             0,
+                             nullptr,
+                             1,
+                             &barrier);
+    }
+
+    VkDevice logical_device{nullptr};
+    std::uint32_t mip_levels{1};
+    GpuBuffer staging{};
+    GpuImage texture{};
+};
+
+// ALU bound compute dispatch, like a simulation or post-processing pass
+class HeavyComputeScene final : public Scene
+{
+public:
+    explicit HeavyComputeScene(const SceneResources& resources)
+        : logical_device{resources.context.logical_device()}
+    {
+        // host visible so the result can be hashed without a copy, the shader is not memory bound
+        values = create_buffer(resources.context,
+                               VkDeviceSize{sizeof(float)} * compute_values,
+                               VK_BUFFER_USAGE_STORAGE_BUFFER_BIT,
+                               true);
+        std::memset(values.mapped, 0, sizeof(float) * compute_values);
+
+        const VkDescriptorSetLayoutBinding binding{.binding = 0,
+                                                   .descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
+                                                   .descriptorCount = 1,
+                                                   .stageFlags = VK_SHADER_STAGE_COMPUTE_BIT};
+        const VkDescriptorSetLayoutCreateInfo setLayoutInfo{
+            .sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO, .bindingCount = 1, .pBindings = &binding};
+        if (VK_SUCCESS !=
+            vkCreateDescriptorSetLayout(logical_device, &setLayoutInfo, allocation_callbacks(), &set_layout))
+        {
+            throw std::runtime_error("Failed to create heavy compute descriptor set layout!");
+        }
+
+        const VkDescriptorPoolSize poolSize{.type = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, .descriptorCount = 1};
+        const VkDescriptorPoolCreateInfo poolInfo{.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO,
+                                                  .maxSets = 1,
+                                                  .poolSizeCount = 1,
+                                                  .pPoolSizes = &poolSize};
+        if (VK_SUCCESS != vkCreateDescriptorPool(logical_device, &poolInfo, allocation_callbacks(), &pool))
+        {
+            throw std::runtime_error("Failed to create heavy compute descriptor pool!");
+        }
+
+        const VkDescriptorSetAllocateInfo setInfo{.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO,
+                                                  .descriptorPool = pool,
+                                                  .descriptorSetCount = 1,
+                                                  .pSetLayouts = &set_layout};
+        vkAllocateDescriptorSets(logical_device, &setInfo, &set);
+
+        const VkDescriptorBufferInfo bufferInfo{.buffer = values.buffer, .offset = 0, .range = VK_WHOLE_SIZE};
+        const VkWriteDescriptorSet write{.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET,
+                                         .dstSet = set,
+                                         .dstBinding = 0,
+                                         .descriptorCount = 1,
+                                         .descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
+                                         .pBufferInfo = &bufferInfo};
+        vkUpdateDescriptorSets(logical_device, 1, &write, 0, nullptr);
+
+        const VkPushConstantRange pushConstants{
+            .stageFlags = VK_SHADER_STAGE_COMPUTE_BIT, .offset = 0, .size = sizeof(std::uint32_t)};
+        const VkPipelineLayoutCreateInfo layoutInfo{.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO,
+                                                    .setLayoutCount = 1,
+                                                    .pSetLayouts = &set_layout,
+                                                    .pushConstantRangeCount = 1,
+                                                    .pPushConstantRanges = &pushConstants};
+        if (VK_SUCCESS != vkCreatePipelineLayout(logical_device, &layoutInfo, allocation_callbacks(), &layout))
+        {
+            throw std::runtime_error("Failed to create heavy compute pipeline layout!");
+        }
+
+        const auto module =
+            resources.shaders.load(resources.shader_directory / "alu_heavy.comp.spv", VK_SHADER_STAGE_COMPUTE_BIT);
+        pipeline = PipelineCompiler::wait(
+            compile_compute_kernel(resources.pipelines, fnv1a("bench:heavy compute"), module, layout), "heavy compute");
+    }
+
+    HeavyComputeScene(const HeavyComputeScene&) = delete;
+    HeavyComputeScene(HeavyComputeScene&&) = delete;
+    HeavyComputeScene& operator=(const HeavyComputeScene&) = delete;
+    HeavyComputeScene& operator=(HeavyComputeScene&&) = delete;
+
+    ~HeavyComputeScene() override
+    {
+        vkDestroyPipelineLayout(logical_device, layout, allocation_callbacks());
+        vkDestroyDescriptorPool(logical_device, pool, allocation_callbacks());
+        vkDestroyDescriptorSetLayout(logical_device, set_layout, allocation_callbacks());
+        destroy_buffer(logical_device, values);
+    }
+
+    [[nodiscard]] std::string_view name() const override
+    {
+        return "heavy_compute";
+    }
+
+    void record(VkCommandBuffer command_buffer) override
+    {
+        // every frame reads what the previous one wrote
+        const VkMemoryBarrier barrier{.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER,
+                                      .srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT,
+                                      .dstAccessMask = VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT};
+        vkCmdPipelineBarrier(command_buffer,
+                             VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+                             VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+                             0,
+                             1,
+                             &barrier,
+                             0,
+                             nullptr,
+                             0,
+                             nullptr);
+
+        vkCmdBindPipeline(command_buffer, VK_PIPELINE_BIND_POINT_COMPUTE, pipeline);
+        vkCmdBindDescriptorSets(command_buffer, VK_PIPELINE_BIND_POINT_COMPUTE, layout, 0, 1, &set, 0, nullptr);
+        vkCmdPushConstants(command_buffer,
+                           layout,
+                           VK_SHADER_STAGE_COMPUTE_BIT,
+                           0,
+                           sizeof(compute_iterations),
+                           &compute_iterations);
+        vkCmdDispatch(command_buffer, compute_values / compute_workgroup_size, 1, 1);
+    }
+
+    [[nodiscard]] std::optional<std::uint64_t> output_hash() const override
+    {
+        return fnv1a(std::span{static_cast<const std::byte*>(values.mapped), sizeof(float) * compute_values});
+    }
+
+private:
+    VkDevice logical_device{nullptr};
+    GpuBuffer values{};
+    VkDescriptorSetLayout set_layout{nullptr};
+    VkDescriptorPool pool{nullptr};
+    VkDescriptorSet set{nullptr};
+    VkPipelineLayout layout{nullptr};
+    VkPipeline pipeline{nullptr};
+};
+
+enum class ComputePrimitive : std::uint8_t
+{
+    reduce,
+    scan,
+    compact,
+    radix_sort,
+    // the first primitive_live_values, a count read from a buffer
+    radix_sort_live
+};
+
+// A compute primitive over 1M values in device local memory. The result is
+// read back once and compared with the same primitive on the CPU.
+class ComputePrimitiveScene final : public Scene
+{
+public:
+    ComputePrimitiveScene(const SceneResources& resources, const ComputePrimitive primitive)
+        : context{resources.context}, timeline{resources.timeline}, primitive{primitive}
+    {
+        // values, then flags (compact) or indices (radix_sort); small values
+        // for the sums, all 32 bits for the sort
+        std::mt19937 generator{29};
+        std::vector<std::uint32_t> data(std::size_t{2} * primitive_values);
+        for (std::uint32_t index = 0; index < primitive_values; ++index)
+        {
+            data[index] = sorts() ? generator() : generator() % 1024;
+            data[primitive_values + index] = ComputePrimitive::compact == primitive ? generator() % 2 : index;
+        }
+        expected = reference_result(data);
+
+        const auto bytes = std::as_bytes(std::span{data});
+        staging = create_buffer(resources.context, bytes.size(), VK_BUFFER_USAGE_TRANSFER_SRC_BIT, true);
+        std::memcpy(staging.mapped, bytes.data(), bytes.size());
+        constexpr VkBufferUsageFlags usage =
+            VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_SRC_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT;
+        input = create_buffer(resources.context, bytes.size(), usage, false);
+        // the compacted count after the values
+        output = create_buffer(resources.context, bytes.size() + sizeof(std::uint32_t), usage, false);
+
+        const VkDeviceSize half = VkDeviceSize{sizeof(std::uint32_t)} * primitive_values;
+        const GpuBufferRange values{.buffer = input.buffer, .offset = 0, .size = half};
+        const GpuBufferRange second{.buffer = input.buffer, .offset = half, .size = half};
+        const GpuBufferRange result{.buffer = output.buffer, .offset = 0, .size = half};
+        switch (primitive)
+        {
+        case ComputePrimitive::reduce:
+            plan = std::make_unique<GpuReduce>(resources.primitives, values, result, primitive_values);
+            break;
+        case ComputePrimitive::scan:
+            plan = std::make_unique<GpuScan>(resources.primitives, values, result, primitive_values);
+            break;
+        case ComputePrimitive::compact:
+            plan = std::make_unique<GpuCompact>(
+                resources.primitives,
+                values,
+                second,
+                result,
+                GpuBufferRange{.buffer = output.buffer, .offset = 2 * half, .size = sizeof(std::uint32_t)},
+                primitive_values);
+            break;
+        case ComputePrimitive::radix_sort:
+        case ComputePrimitive::radix_sort_live:
+            // sorts a copy of the input in place, the live count after it
+            plan = std::make_unique<GpuRadixSort>(
+                resources.primitives,
+                result,
+                GpuBufferRange{.buffer = output.buffer, .offset = half, .size = half},
+                primitive_values,
+                ComputePrimitive::radix_sort_live == primitive
+                    ? std::optional{GpuBufferRange{
+                          .buffer = output.buffer, .offset = 2 * half, .size = sizeof(std::uint32_t)}}
+                    : std::nullopt);
+            break;
+        }
+    }
+
+    ComputePrimitiveScene(const ComputePrimitiveScene&) = delete;
+    ComputePrimitiveScene(ComputePrimitiveScene&&) = delete;
+    ComputePrimitiveScene& operator=(const ComputePrimitiveScene&) = delete;
+    ComputePrimitiveScene& operator=(ComputePrimitiveScene&&) = delete;
+
+    ~ComputePrimitiveScene() override
+    {
+        plan.reset();
+        destroy_buffer(context.logical_device(), output);
+        destroy_buffer(context.logical_device(), input);
+        destroy_buffer(context.logical_device(), staging);
+    }
+
+    [[nodiscard]] std::string_view name() const override
+    {
+        switch (primitive)
+        {
+        case ComputePrimitive::reduce:
+            return "gpu_reduce";
+        case ComputePrimitive::scan:
+            return "gpu_scan";
+        case ComputePrimitive::compact:
+            return "gpu_compact";
+        case ComputePrimitive::radix_sort:
+            return "gpu_radix_sort";
+        case ComputePrimitive::radix_sort_live:
+            return "gpu_radix_sort_live";
+        }
+        return "gpu_primitive";
+    }
+
+    void record(VkCommandBuffer command_buffer) override
+    {
+        if (!uploaded)
+        {
+            const VkBufferCopy region{.srcOffset = 0, .dstOffset = 0, .size = VkDeviceSize{8} * primitive_values};
+            vkCmdCopyBuffer(command_buffer, staging.buffer, input.buffer, 1, &region);
+            transfer_barrier(command_buffer);
+            uploaded = true;
+        }
+
+        // the sort works in place, every frame starts from the unsorted keys
+        if (sorts())
+        {
+            const VkBufferCopy region{.srcOffset = 0, .dstOffset = 0, .size = VkDeviceSize{8} * primitive_values};
+            vkCmdCopyBuffer(command_buffer, input.buffer, output.buffer, 1, &region);
+            if (ComputePrimitive::radix_sort_live == primitive)
+            {
+                vkCmdFillBuffer(command_buffer,
+                                output.buffer,
+                                region.size,
+                                sizeof(std::uint32_t),
+                                primitive_live_values);
+            }
+            transfer_barrier(command_buffer);
+        }
+        plan->record(command_buffer);
+    }
+
+    [[nodiscard]] std::optional<std::uint64_t> output_hash() const override
+    {
+        const auto readback = read_buffer(
+            context, timeline, output.buffer, VkDeviceSize{sizeof(std::uint32_t)} * (2 * primitive_values + 1));
+        const auto result = primitive_result(readback);
+        // fails the run, and with it the ctest of the kernels
+        if (result != expected)
+        {
+            throw std::runtime_error(fmt::format("{} differs from the CPU result!", name()));
+        }
+        return fnv1a(std::as_bytes(std::span{result}));
+    }
+
+private:
+    [[nodiscard]] bool sorts() const
+    {
+        return ComputePrimitive::radix_sort == primitive || ComputePrimitive::radix_sort_live == primitive;
+    }
+
+    // the part of the output the primitive writes
+    [[nodiscard]] std::vector<std::uint32_t> primitive_result(const std::vector<std::uint32_t>& output) const
+    {
+        switch (primitive)
+        {
+        case ComputePrimitive::reduce:
+            return {output.front()};
+        case ComputePrimitive::scan:
+            return {output.begin(), std::next(output.begin(), primitive_values)};
+        case ComputePrimitive::compact:
+        {
+            const auto count = std::min(output[2 * primitive_values], primitive_values);
+            std::vector<std::uint32_t> result{output.begin(), std::next(output.begin(), count)};
+            result.push_back(output[2 * primitive_values]);
+            return result;
+        }
+        case ComputePrimitive::radix_sort:
+        case ComputePrimitive::radix_sort_live:
+            return {output.begin(), std::next(output.begin(), 2 * primitive_values)};
+        }
+        return {};
+    }
+
+    [[nodiscard]] std::vector<std::uint32_t> reference_result(const std::vector<std::uint32_t>& values) const
+    {
+        const auto first = values.begin();
+        const auto middle = std::next(first, primitive_values);
+        switch (primitive)
+        {
+        case ComputePrimitive::reduce:
+            return {std::accumulate(first, middle, std::uint32_t{0})};
+        case ComputePrimitive::scan:
+        {
+            std::vector<std::uint32_t> prefixes(primitive_values);
+            std::exclusive_scan(first, middle, prefixes.begin(), std::uint32_t{0});
+            return prefixes;
+        }
+        case ComputePrimitive::compact:
+        {
+            std::vector<std::uint32_t> kept{};
+            for (std::uint32_t index = 0; index < primitive_values; ++index)
+            {
+                if (values[primitive_values + index] != 0)
+                {
+                    kept.push_back(values[index]);
+                }
+            }
+            kept.push_back(static_cast<std::uint32_t>(kept.size()));
+            return kept;
+        }
+        case ComputePrimitive::radix_sort:
+        case ComputePrimitive::radix_sort_live:
+        {
+            // the values past the live ones stay where they are
+            const auto sorted =
+                ComputePrimitive::radix_sort_live == primitive ? primitive_live_values : primitive_values;
+            std::vector<std::uint32_t> order(primitive_values);
+            std::iota(order.begin(), order.end(), 0U);
+            std::stable_sort(order.begin(),
+                             std::next(order.begin(), sorted),
+                             [&values](const std::uint32_t left, const std::uint32_t right)
+                             { return values[left] < values[right]; });
+            std::vector<std::uint32_t> result(std::size_t{2} * primitive_values);
+            for (std::uint32_t index = 0; index < primitive_values; ++index)
+            {
+                result[index] = values[order[index]];
+                result[primitive_values + index] = order[index];
+            }
+            return result;
+        }
+        }
+        return {};
+    }
+
+    static void transfer_barrier(VkCommandBuffer command_buffer)
+    {
+        const VkMemoryBarrier barrier{.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER,
+                                      .srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT,
+                                      .dstAccessMask = VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT |
+                                                       VK_ACCESS_TRANSFER_READ_BIT};
+        vkCmdPipelineBarrier(command_buffer,
+                             VK_PIPELINE_STAGE_TRANSFER_BIT,
+                             VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT | VK_PIPELINE_STAGE_TRANSFER_BIT,
+                             0,
+                             1,
+                             &barrier,
+                             0,
+                             nullptr,
+                             0,
+                             nullptr);
+    }
+
+    const VulkanContext& context;
+    QueueTimeline& timeline;
+    ComputePrimitive primitive;
+    std::vector<std::uint32_t> expected{};
+    bool uploaded{false};
+    GpuBuffer staging{};
+    GpuBuffer input{};
+    GpuBuffer output{};
+    std::unique_ptr<ComputePlan> plan{};
+};
+
+struct PlaneDraw
+{
+    glm::mat4 view_projection;
+    float half_size;
+    std::uint32_t columns;
+};
+
+// Fragment bound: a plane lit by thousands of small point lights, binned
+// into froxels every frame. A fragment only shades the lights of its froxel,
+// see lit_plane.frag and clustered_lighting.glsl.
+class ClusteredLightingScene final : public Scene
+{
+public:
+    explicit ClusteredLightingScene(const SceneResources& resources)
+        : logical_device{resources.context.logical_device()}, target{resources.target}
+    {
+        constexpr float half_size = 30.0F;
+        std::mt19937 generator{31};
+        std::uniform_real_distribution<float> unit{0.0F, 1.0F};
+        std::vector<PointLight> lights(lighting_lights);
+        for (auto& light : lights)
+        {
+            light = PointLight{.position = glm::vec3{(unit(generator) * 2.0F - 1.0F) * half_size,
+                                                     0.2F + 1.3F * unit(generator),
+                                                     (unit(generator) * 2.0F - 1.0F) * half_size},
+                               .radius = 1.0F + 2.0F * unit(generator),
+                               .color = glm::vec3{unit(generator), unit(generator), unit(generator)},
+                               .intensity = 4.0F};
+        }
+
+        const auto bytes = std::as_bytes(std::span{lights});
+        light_bytes = bytes.size();
+        staging = create_buffer(resources.context, bytes.size(), VK_BUFFER_USAGE_TRANSFER_SRC_BIT, true);
+        std::memcpy(staging.mapped, bytes.data(), bytes.size());
+        light_buffer = create_buffer(resources.context,
+                                     bytes.size(),
+                                     VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+                                     false);
+
+        // the grid spans the depth range of the projection
+        const ClusterGrid grid{
+            .tiles_x = 16, .tiles_y = 16, .depth_slices = 24, .near_plane = 0.1F, .far_plane = 100.0F};
+        lighting = std::make_unique<ClusteredLighting>(
+            resources.primitives,
+            resources.shaders,
+            resources.pipelines,
+            resources.core_shader_directory,
+            grid,
+            GpuBufferRange{.buffer = light_buffer.buffer, .offset = 0, .size = bytes.size()},
+            lighting_light_indices);
+
+        // looking down the plane, froxels from close by to far away are lit
+        auto projection = glm::perspective(glm::radians(60.0F), 1.0F, grid.near_plane, grid.far_plane);
+        projection[1][1] *= -1.0F;
+        const auto view =
+            glm::lookAt(glm::vec3{0.0F, 6.0F, 24.0F}, glm::vec3{0.0F, 0.0F, 0.0F}, glm::vec3{0.0F, 1.0F, 0.0F});
+        cluster_view = ClusterView{
+            .view = view, .projection = projection, .extent = target.extent(), .light_count = lighting_lights};
+        draw = PlaneDraw{.view_projection = projection * view, .half_size = half_size, .columns = lighting_columns};
+
+        const auto setLayout = lighting->set_layout();
+        const VkPushConstantRange pushConstants{
+            .stageFlags = VK_SHADER_STAGE_VERTEX_BIT, .offset = 0, .size = sizeof(PlaneDraw)};
+        const VkPipelineLayoutCreateInfo layoutInfo{.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO,
+                                                    .setLayoutCount = 1,
+                                                    .pSetLayouts = &setLayout,
+                                                    .pushConstantRangeCount = 1,
+                                                    .pPushConstantRanges = &pushConstants};
+        if (VK_SUCCESS != vkCreatePipelineLayout(logical_device, &layoutInfo, allocation_callbacks(), &layout))
+        {
+            throw std::runtime_error("Failed to create lit plane pipeline layout!");
+        }
+
+        const std::array stages{
+            VkPipelineShaderStageCreateInfo{
+                .sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO,
+                .stage = VK_SHADER_STAGE_VERTEX_BIT,
+                .module = resources.shaders.load(resources.shader_directory / "lit_plane.vert.spv",
+                                                 VK_SHADER_STAGE_VERTEX_BIT),
+                .pName = "main"},
+            VkPipelineShaderStageCreateInfo{
+                .sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO,
+                .stage = VK_SHADER_STAGE_FRAGMENT_BIT,
+                .module = resources.shaders.load(resources.shader_directory / "lit_plane.frag.spv",
+                                                 VK_SHADER_STAGE_FRAGMENT_BIT),
+                .pName = "main"}};
+
+        const VkPipelineVertexInputStateCreateInfo vertexInput{
+            .sType = VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_STATE_CREATE_INFO};
+        pipeline = create_graphics_pipeline(resources, stages, vertexInput, layout, "lit plane");
+    }
+
+    ClusteredLightingScene(const ClusteredLightingScene&) = delete;
+    ClusteredLightingScene(ClusteredLightingScene&&) = delete;
+    ClusteredLightingScene& operator=(const ClusteredLightingScene&) = delete;
+    ClusteredLightingScene& operator=(ClusteredLightingScene&&) = delete;
+
+    ~ClusteredLightingScene() override
+    {
+        vkDestroyPipelineLayout(logical_device, layout, allocation_callbacks());
+        lighting.reset();
+        destroy_buffer(logical_device, light_buffer);
+        destroy_buffer(logical_device, staging);
+    }
+
+    [[nodiscard]] std::string_view name() const override
+    {
+        return "clustered_lighting";
+    }
+
+    void record(VkCommandBuffer command_buffer) override
+    {
+        if (!uploaded)
+        {
+            const VkBufferCopy region{.srcOffset = 0, .dstOffset = 0, .size = light_bytes};
+            vkCmdCopyBuffer(command_buffer, staging.buffer, light_buffer.buffer, 1, &region);
+            const VkMemoryBarrier barrier{.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER,
+                                          .srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT,
+                                          .dstAccessMask = VK_ACCESS_SHADER_READ_BIT};
+            vkCmdPipelineBarrier(command_buffer,
+                                 VK_PIPELINE_STAGE_TRANSFER_BIT,
+                                 VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT | VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT,
+                                 0,
+                                 1,
+                                 &barrier,
+                                 0,
+                                 nullptr,
+                                 0,
+                                 nullptr);
+            uploaded = true;
+        }
+
+        lighting->record(command_buffer, cluster_view);
+
+        target.begin(command_buffer);
+        vkCmdBindPipeline(command_buffer, VK_PIPELINE_BIND_POINT_GRAPHICS, pipeline);
+        const auto set = lighting->descriptor_set();
+        vkCmdBindDescriptorSets(command_buffer, VK_PIPELINE_BIND_POINT_GRAPHICS, layout, 0, 1, &set, 0, nullptr);
+        vkCmdPushConstants(command_buffer, layout, VK_SHADER_STAGE_VERTEX_BIT, 0, sizeof(draw), &draw);
+        vkCmdDraw(command_buffer, 6 * lighting_columns * lighting_columns, 1, 0, 0);
+        target.end(command_buffer);
+    }
+
+    [[nodiscard]] std::optional<std::uint64_t> output_hash() const override
+    {
+        return target.content_hash();
+    }
+
+private:
+    VkDevice logical_device{nullptr};
+    OffscreenTarget& target;
+    VkDeviceSize light_bytes{0};
+    bool uploaded{false};
+    GpuBuffer staging{};
+    GpuBuffer light_buffer{};
+    std::unique_ptr<ClusteredLighting> lighting{};
+    ClusterView cluster_view{};
+    PlaneDraw draw{};
+    VkPipelineLayout layout{nullptr};
+    VkPipeline pipeline{nullptr};
+};
+
+struct ParticleDraw
+{
+    glm::mat4 view_projection;
+    glm::vec4 camera_right;
+    glm::vec4 camera_up;
+};
+
+// Async compute: a particle fountain simulated and sorted back to front on
+// the compute queue, then drawn with one indirect draw on the graphics
+// queue. The CPU records the same commands for any number of particles.
+class GpuParticlesScene final : public Scene
+{
+public:
+    explicit GpuParticlesScene(const SceneResources& resources)
+        : logical_device{resources.context.logical_device()},
+          target{resources.target}
+    {
+        particles = std::make_unique<GpuParticles>(resources.context,
+                                                   resources.primitives,
+                                                   resources.shaders,
+                                                   resources.pipelines,
+                                                   resources.core_shader_directory,
+                                                   particle_capacity,
+                                                   true);
+
+        auto projection = glm::perspective(glm::radians(60.0F), 1.0F, 0.1F, 100.0F);
+        projection[1][1] *= -1.0F;
+        const auto view =
+            glm::lookAt(glm::vec3{0.0F, 4.0F, 16.0F}, glm::vec3{0.0F, 3.0F, 0.0F}, glm::vec3{0.0F, 1.0F, 0.0F});
+        // a fixed step, the same frame count produces the same particles
+        frame = ParticleFrame{.view = view,
+                              .emitter_position = glm::vec3{0.0F},
+                              .emitter_radius = 0.2F,
+                              .emitter_velocity = glm::vec3{0.0F, 8.0F, 0.0F},
+                              .velocity_variance = 3.0F,
+                              .gravity = glm::vec3{0.0F, -9.81F, 0.0F},
+                              .drag = 0.1F,
+                              .delta_time = 1.0F / 60.0F,
+                              .lifetime = 4.0F,
+                              .lifetime_variance = 1.0F,
+                              .size = 0.03F,
+                              .emit_count = particle_emit_count};
+        draw = ParticleDraw{.view_projection = projection * view,
+                            .camera_right = glm::vec4{view[0][0], view[1][0], view[2][0], 0.0F},
+                            .camera_up = glm::vec4{view[0][1], view[1][1], view[2][1], 0.0F}};
+
+        // the simulation of a frame overlaps with the draw of the previous one
+        scheduler.emplace(logical_device, resources.timeline, resources.compute_timeline, compute_slots);
+        scheduler->add_pass(QueuePass{.name = "particle_simulation",
+                                      .queue = PassQueue::async_compute,
+                                      .buffers = {particles->simulation_buffer()},
+                                      .record = [this](VkCommandBuffer command_buffer)
+                                      { particles->record_simulation(command_buffer, frame); }});
+        scheduler->add_pass(QueuePass{.name = "particle_draw",
+                                      .queue = PassQueue::graphics,
+                                      .buffers = {particles->draw_buffer()},
+                                      .record = [this](VkCommandBuffer command_buffer)
+                                      { record_draw(command_buffer); }});
+
+        const auto setLayout = particles->set_layout();
+        const VkPushConstantRange pushConstants{
+            .stageFlags = VK_SHADER_STAGE_VERTEX_BIT, .offset = 0, .size = sizeof(ParticleDraw)};
+        const VkPipelineLayoutCreateInfo layoutInfo{.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO,
+                                                    .setLayoutCount = 1,
+                                                    .pSetLayouts = &setLayout,
+                                                    .pushConstantRangeCount = 1,
+                                                    .pPushConstantRanges = &pushConstants};
+        if (VK_SUCCESS != vkCreatePipelineLayout(logical_device, &layoutInfo, allocation_callbacks(), &layout))
+        {
+            throw std::runtime_error("Failed to create particle pipeline layout!");
+        }
+
+        // sorted back to front, the quads need no depth buffer
+        const std::array stages{
+            VkPipelineShaderStageCreateInfo{
+                .sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO,
+                .stage = VK_SHADER_STAGE_VERTEX_BIT,
+                .module = resources.shaders.load(resources.shader_directory / "particle.vert.spv",
+                                                 VK_SHADER_STAGE_VERTEX_BIT),
+                .pName = "main"},
+            VkPipelineShaderStageCreateInfo{
+                .sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO,
+                .stage = VK_SHADER_STAGE_FRAGMENT_BIT,
+                .module = resources.shaders.load(resources.shader_directory / "quad_grid.frag.spv",
+                                                 VK_SHADER_STAGE_FRAGMENT_BIT),
+                .pName = "main"}};
+
+        const VkPipelineVertexInputStateCreateInfo vertexInput{
+            .sType = VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_STATE_CREATE_INFO};
+        pipeline = create_graphics_pipeline(resources, stages, vertexInput, layout, "particle");
+    }
+
+    GpuParticlesScene(const GpuParticlesScene&) = delete;
+    GpuParticlesScene(GpuParticlesScene&&) = delete;
+    GpuParticlesScene& operator=(const GpuParticlesScene&) = delete;
+    GpuParticlesScene& operator=(GpuParticlesScene&&) = delete;
+
+    ~GpuParticlesScene() override
+    {
+        scheduler.reset();
+        vkDestroyPipelineLayout(logical_device, layout, allocation_callbacks());
+        particles.reset();
+    }
+
+    [[nodiscard]] std::string_view name() const override
+    {
+        return "gpu_particles";
+    }
+
+    [[nodiscard]] std::optional<TimelineWait> submit_async() override
+    {
+        return scheduler->submit_compute();
+    }
+
+    void record(VkCommandBuffer command_buffer) override
+    {
+        scheduler->record_graphics(command_buffer);
+    }
+
+    // the particles of every step are deterministic, only their slots are not
+    [[nodiscard]] std::optional<std::uint64_t> output_hash() const override
+    {
+        return target.content_hash();
+    }
+
+private:
+    static constexpr std::uint32_t compute_slots = 2;
+
+    void record_draw(VkCommandBuffer command_buffer) const
+    {
+        target.begin(command_buffer);
+        vkCmdBindPipeline(command_buffer, VK_PIPELINE_BIND_POINT_GRAPHICS, pipeline);
+        const auto set = particles->descriptor_set();
+        vkCmdBindDescriptorSets(command_buffer, VK_PIPELINE_BIND_POINT_GRAPHICS, layout, 0, 1, &set, 0, nullptr);
+        vkCmdPushConstants(command_buffer, layout, VK_SHADER_STAGE_VERTEX_BIT, 0, sizeof(draw), &draw);
+        particles->draw(command_buffer);
+        target.end(command_buffer);
+    }
+
+    VkDevice logical_device{nullptr};
+    OffscreenTarget& target;
+    std::unique_ptr<GpuParticles> particles{};
+    ParticleFrame frame{};
+    ParticleDraw draw{};
+    std::optional<QueueScheduler> scheduler{};
+    VkPipelineLayout layout{nullptr};
+    VkPipeline pipeline{nullptr};
+};
+
+// CPU bound: 16k tiny buffer uploads and 16 texture tiles every frame go
+// through UploadBatcher, which merges them into a few copy commands and one
+// submission. With unified memory the buffer is written in place, with host
+// image copy the texture too. output_hash reads the buffer back.
+class UploadBatchingScene final : public Scene
+{
+public:
+    explicit UploadBatchingScene(const SceneResources& resources)
+        : context{resources.context},
+          timeline{resources.timeline},
+          batcher{resources.context, resources.timeline, arena_size, 2}
+    {
+        // a gap after every run, runs are not adjacent to each other
+        destination = create_buffer(context,
+                                    destination_size,
+                                    VK_BUFFER_USAGE_TRANSFER_SRC_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+                                    batcher.unified_memory());
+        if (nullptr != destination.mapped)
+        {
+            batcher.register_buffer(MappedBuffer{.buffer = destination.buffer,
+                                                 .memory = destination.memory,
+                                                 .memory_offset = 0,
+                                                 .size = destination_size,
+                                                 .mapped = static_cast<std::byte*>(destination.mapped),
+                                                 .coherent = true});
+        }
+        texture = create_image(context,
+                               VkExtent2D{upload_tiles * upload_tile_size, upload_tiles * upload_tile_size},
+                               VK_FORMAT_R8G8B8A8_UNORM,
+                               VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_SAMPLED_BIT | batcher.image_usage(),
+                               1);
+
+        tiles.resize(std::size_t{upload_tiles} * upload_tiles * upload_tile_size * upload_tile_size);
+        for (std::size_t texel = 0; texel < tiles.size(); ++texel)
+        {
+            tiles[texel] = static_cast<std::uint32_t>(texel) * 0x9E3779B9U | 0xff000000U;
+        }
+    }
+
+    UploadBatchingScene(const UploadBatchingScene&) = delete;
+    UploadBatchingScene(UploadBatchingScene&&) = delete;
+    UploadBatchingScene& operator=(const UploadBatchingScene&) = delete;
+    UploadBatchingScene& operator=(UploadBatchingScene&&) = delete;
+
+    ~UploadBatchingScene() override
+    {
+        timeline.wait(timeline.last_submitted_value());
+        batcher.unregister_buffer(destination.buffer);
+        destroy_image(context.logical_device(), texture);
+        destroy_buffer(context.logical_device(), destination);
+    }
+
+    [[nodiscard]] std::string_view name() const override
+    {
+        return "upload_batching";
+    }
+
+    // on the frame's queue, the copies are ordered before the frame by their barrier
+    [[nodiscard]] std::optional<TimelineWait> submit_async() override
+    {
+        std::array<std::uint32_t, upload_chunk_size / sizeof(std::uint32_t)> chunk{};
+        for (std::uint32_t run = 0; run < upload_runs; ++run)
+        {
+            for (std::uint32_t index = 0; index < upload_run_chunks; ++index)
+            {
+                const auto chunkIndex = run * upload_run_chunks + index;
+                std::ranges::fill(chunk, chunkIndex * 0x9E3779B9U ^ frame);
+                batcher.upload_buffer(destination.buffer,
+                                      (VkDeviceSize{2} * run * upload_run_chunks + index) * upload_chunk_size,
+                                      std::as_bytes(std::span{chunk}));
+            }
+        }
+
+        const auto tileTexels = std::size_t{upload_tile_size} * upload_tile_size;
+        for (std::uint32_t tile = 0; tile < upload_tiles * upload_tiles; ++tile)
+        {
+            const ImageUpload upload{
+                .image = texture.image,
+                .old_layout = frame == 0 ? VK_IMAGE_LAYOUT_UNDEFINED : VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
+                .new_layout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
+                .subresource = {.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT, .mipLevel = 0, .layerCount = 1},
+                .offset = {static_cast<std::int32_t>(tile % upload_tiles * upload_tile_size),
+                           static_cast<std::int32_t>(tile / upload_tiles * upload_tile_size),
+                           0},
+                .extent = {upload_tile_size, upload_tile_size, 1},
+                .host_transfer = 0 != batcher.image_usage()};
+            batcher.upload_image(upload, std::as_bytes(std::span{tiles}.subspan(tile * tileTexels, tileTexels)));
+        }
+
+        batcher.flush();
+        statistics = batcher.take_statistics();
+        ++frame;
+        return std::nullopt;
+    }
+
+    // the uploads are the workload
+    void record(VkCommandBuffer /*command_buffer*/) override
+    {
+    }
+
+    [[nodiscard]] std::optional<std::uint64_t> output_hash() const override
+    {
+        spdlog::info("{}: {} uploads ({} direct) of {} bytes, {} copy commands, {} regions, {} submits per frame",
+                     name(),
+                     statistics.uploads,
+                     statistics.direct_uploads,
+                     statistics.bytes,
+                     statistics.copy_commands,
+                     statistics.regions,
+                     statistics.submits);
+        const auto readback = read_buffer(context, timeline, destination.buffer, destination_size);
+        return fnv1a(std::as_bytes(std::span{readback}));
+    }
+
+private:
+    static constexpr VkDeviceSize arena_size = 4 * 1024 * 1024;
+    static constexpr VkDeviceSize destination_size =
+        VkDeviceSize{2} * upload_runs * upload_run_chunks * upload_chunk_size;
+
+    const VulkanContext& context;
+    QueueTimeline& timeline;
+    UploadBatcher batcher;
+    GpuBuffer destination{};
+    GpuImage texture{};
+    std::vector<std::uint32_t> tiles{};
+    std::uint32_t frame{0};
+    UploadStatistics statistics{};
+};
+} // namespace
+
+std::vector<std::unique_ptr<Scene>> create_scenes(const SceneResources& resources)
+{
+    std::vector<std::unique_ptr<Scene>> scenes{};
+    scenes.push_back(std::make_unique<ManyDrawsScene>(resources));
+    scenes.push_back(std::make_unique<ManyTrianglesScene>(resources));
+    scenes.push_back(std::make_unique<LargeTexturesScene>(resources));
+    scenes.push_back(std::make_unique<HeavyComputeScene>(resources));
+
+    const auto mesh = wavy_sphere();
+    scenes.push_back(std::make_unique<MeshScene>(resources, mesh, false));
+    scenes.push_back(std::make_unique<MeshScene>(resources, mesh, true));
+
+    for (const auto primitive : {ComputePrimitive::reduce,
+                                 ComputePrimitive::scan,
+                                 ComputePrimitive::compact,
+                                 ComputePrimitive::radix_sort,
+                                 ComputePrimitive::radix_sort_live})
+    {
+        scenes.push_back(std::make_unique<ComputePrimitiveScene>(resources, primitive));
+    }
+    scenes.push_back(std::make_unique<ClusteredLightingScene>(resources));
+    scenes.push_back(std::make_unique<GpuParticlesScene>(resources));
+    scenes.push_back(std::make_unique<UploadBatchingScene>(resources));
+    return scenes;
+}
+} // namespace vultex::bench
@@ -0,0 +1,71 @@
+#pragma once
+
+#define GLFW_INCLUDE_VULKAN
+#include <GLFW/glfw3.h>
+
+#include <cstdint>
+#include <filesystem>
+#include <memory>
+#include <optional>
+#include <string_view>
+#include <vector>
+
+#include "gpu_primitives.hpp"
+#include "gpu_resources.hpp"
+#include "pipeline_compiler.hpp"
+#include "queue_timeline.hpp"
+#include "shader_module_cache.hpp"
+#include "vulkan_context.hpp"
+
+namespace vultex::bench
+{
+
+// A standardized workload recorded every frame. Scenes are procedural and
+// seeded with constants, the same frame count produces the same image.
+class Scene
+{
+public:
+    Scene() = default;
+    Scene(const Scene&) = delete;
+    Scene(Scene&&) = delete;
+    Scene& operator=(const Scene&) = delete;
+    Scene& operator=(Scene&&) = delete;
+    virtual ~Scene() = default;
+
+    [[nodiscard]] virtual std::string_view name() const = 0;
+
+    // before record(): work of the frame in its own submission, on another
+    // queue the frame's submission waits for the returned value
+    [[nodiscard]] virtual std::optional<TimelineWait> submit_async()
+    {
+        return std::nullopt;
+    }
+
+    // the previous frame using the command buffer has completed
+    virtual void record(VkCommandBuffer command_buffer) = 0;
+
+    // read back after the queue is idle, std::nullopt for scenes without an output
+    [[nodiscard]] virtual std::optional<std::uint64_t> output_hash() const = 0;
+};
+
+struct SceneResources
+{
+    const VulkanContext& context;
+    QueueTimeline& timeline;
+    // compute queue, the graphics one without a separate compute family
+    QueueTimeline& compute_timeline;
+    ShaderModuleCache& shaders;
+    // owns the pipelines of the scenes
+    PipelineCompiler& pipelines;
+    const GpuPrimitives& primitives;
+    OffscreenTarget& target;
+    std::filesystem::path shader_directory;
+    // SPIR-V of vultex_core, VULTEX_SHADER_DIR
+    std::filesystem::path core_shader_directory;
+};
+
+// many_draws, many_triangles, large_textures, heavy_compute, mesh_float_vertices, mesh_packed_vertices,
+// gpu_reduce, gpu_scan, gpu_compact, gpu_radix_sort, clustered_lighting, gpu_particles
+// and upload_batching
+[[nodiscard]] std::vector<std::unique_ptr<Scene>> create_scenes(const SceneResources& resources);
+} // namespace vultex::bench
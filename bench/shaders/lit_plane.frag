@@ -0,0 +1,16 @@
+#version 450
+#extension GL_GOOGLE_include_directive : require
+
+#define CLUSTER_SET 0
+#include "clustered_lighting.glsl"
+
+layout(location = 0) in vec3 inPosition;
+layout(location = 0) out vec4 outColor;
+
+// lit by the lights of its froxel only
+void main()
+{
+    const vec3 light = clustered_point_lights(inPosition, vec3(0.0, 1.0, 0.0), gl_FragCoord.xy);
+    const float checker = mod(floor(inPosition.x) + floor(inPosition.z), 2.0);
+    outColor = vec4((0.02 + light) * (0.6 + 0.4 * checker), 1.0);
+}
@@ -0,0 +1,25 @@
+#version 450
+
+// A square of columns x columns cells at y = 0, two triangles per cell,
+// generated from gl_VertexIndex like quad_grid.vert
+layout(push_constant) uniform Draw
+{
+    mat4 viewProjection;
+    float halfSize;
+    uint columns;
+} draw;
+
+layout(location = 0) out vec3 outPosition;
+
+const vec2 corners[6] = vec2[](vec2(0.0, 0.0), vec2(1.0, 0.0), vec2(0.0, 1.0),
+                               vec2(1.0, 0.0), vec2(1.0, 1.0), vec2(0.0, 1.0));
+
+void main()
+{
+    const uint cell = uint(gl_VertexIndex) / 6u;
+    const vec2 corner = corners[uint(gl_VertexIndex) % 6u];
+    const vec2 position = (vec2(cell % draw.columns, cell / draw.columns) + corner) / float(draw.columns);
+
+    outPosition = vec3(position.x * 2.0 - 1.0, 0.0, position.y * 2.0 - 1.0) * draw.halfSize;
+    gl_Position = draw.viewProjection * vec4(outPosition, 1.0);
+}
@@ -0,0 +1,16 @@
+#version 450
+
+// Uses every attribute, so no vertex input can be optimized away
+layout(location = 0) in vec3 inNormal;
+layout(location = 1) in vec4 inTangent;
+layout(location = 2) in vec2 inUv;
+
+layout(location = 0) out vec4 outColor;
+
+void main()
+{
+    const vec3 normal = normalize(inNormal);
+    const vec3 bitangent = cross(normal, inTangent.xyz) * inTangent.w;
+    const float checker = mod(floor(inUv.x * 64.0) + floor(inUv.y * 32.0), 2.0);
+    outColor = vec4((normal * 0.5 + 0.5) * (0.75 + 0.25 * checker) + 0.1 * bitangent, 1.0);
+}
@@ -0,0 +1,58 @@
+#version 450
+
+// Both vertex layouts of the mesh scenes, PACKED_VERTICES is baked into the
+// pipeline (PipelinePermutations). Float MeshVertex is 48 bytes per vertex;
+// PackedVertex is 20 bytes, the vertex fetch converts its formats and only the
+// position scale and the octahedral directions are decoded here. Attributes
+// with fewer components than declared read as (x, y, 0, 1).
+layout(constant_id = 0) const bool PACKED_VERTICES = false;
+
+layout(push_constant) uniform Draw
+{
+    mat4 viewProjection;
+    vec4 quantizationOffset;
+    vec4 quantizationScale;
+} draw;
+
+layout(location = 0) in vec4 inPosition; // packed: unorm16 within the mesh bounds, w is the bitangent sign as 0 or 1
+layout(location = 1) in vec4 inNormal;   // packed: octahedral snorm16
+layout(location = 2) in vec4 inTangent;  // packed: octahedral snorm16
+layout(location = 3) in vec2 inUv;       // packed: half float
+
+layout(location = 0) out vec3 outNormal;
+layout(location = 1) out vec4 outTangent;
+layout(location = 2) out vec2 outUv;
+
+vec3 octahedralDecode(vec2 encoded)
+{
+    vec3 direction = vec3(encoded, 1.0 - abs(encoded.x) - abs(encoded.y));
+    const float fold = max(-direction.z, 0.0);
+    direction.x += direction.x >= 0.0 ? -fold : fold;
+    direction.y += direction.y >= 0.0 ? -fold : fold;
+    return normalize(direction);
+}
+
+void main()
+{
+    vec3 position = inPosition.xyz;
+    if (PACKED_VERTICES)
+    {
+        position = draw.quantizationOffset.xyz + inPosition.xyz * draw.quantizationScale.xyz;
+    }
+
+    // instances in a 2x2 grid
+    const vec3 offset = vec3(float(gl_InstanceIndex % 2) * 2.2 - 1.1, float(gl_InstanceIndex / 2) * 2.2 - 1.1, 0.0);
+    gl_Position = draw.viewProjection * vec4(position + offset, 1.0);
+
+    if (PACKED_VERTICES)
+    {
+        outNormal = octahedralDecode(inNormal.xy);
+        outTangent = vec4(octahedralDecode(inTangent.xy), inPosition.w * 2.0 - 1.0);
+    }
+    else
+    {
+        outNormal = inNormal.xyz;
+        outTangent = inTangent;
+    }
+    outUv = inUv;
+}
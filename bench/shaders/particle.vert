@@ -0,0 +1,30 @@
+#version 450
+#extension GL_GOOGLE_include_directive : require
+
+// One camera facing quad per instance of GpuParticles::draw(), colored by
+// the age of the particle. The instances come sorted back to front.
+#include "particles.glsl"
+
+layout(push_constant) uniform Draw
+{
+    mat4 viewProjection;
+    vec4 cameraRight;
+    vec4 cameraUp;
+} draw;
+
+layout(location = 0) out vec4 outColor;
+
+const vec2 corners[6] = vec2[](vec2(-1.0, -1.0), vec2(1.0, -1.0), vec2(-1.0, 1.0),
+                               vec2(1.0, -1.0), vec2(1.0, 1.0), vec2(-1.0, 1.0));
+
+void main()
+{
+    const Particle particle = drawn_particle(uint(gl_InstanceIndex));
+    const vec2 corner = corners[uint(gl_VertexIndex) % 6u] * parameters.timing.w;
+    const vec3 position = particle.position + draw.cameraRight.xyz * corner.x + draw.cameraUp.xyz * corner.y;
+    gl_Position = draw.viewProjection * vec4(position, 1.0);
+
+    // young particles are bright yellow, old ones fade to dark red
+    const float age = clamp(particle.age / particle.lifetime, 0.0, 1.0);
+    outColor = vec4(mix(vec3(1.0, 0.9, 0.3), vec3(0.3, 0.02, 0.0), age), 1.0);
+}
@@ -0,0 +1,29 @@
+#version 450
+
+// A rect split into columns x rows cells, two triangles per cell, generated
+// from gl_VertexIndex so the benchmark needs no vertex buffers.
+layout(push_constant) uniform Draw
+{
+    vec4 rect; // xy offset, zw size, in [0, 1]
+    vec4 color;
+    uint columns;
+    uint rows;
+} draw;
+
+layout(location = 0) out vec4 outColor;
+
+const vec2 corners[6] = vec2[](vec2(0.0, 0.0), vec2(1.0, 0.0), vec2(0.0, 1.0),
+                               vec2(1.0, 0.0), vec2(1.0, 1.0), vec2(0.0, 1.0));
+
+void main()
+{
+    const uint cell = uint(gl_VertexIndex) / 6u;
+    const vec2 corner = corners[uint(gl_VertexIndex) % 6u];
+    const vec2 position = vec2(cell % draw.columns, cell / draw.columns) + corner;
+
+    const vec2 uv = draw.rect.xy + position / vec2(draw.columns, draw.rows) * draw.rect.zw;
+    gl_Position = vec4(uv * 2.0 - 1.0, 0.0, 1.0);
+
+    // neighbouring cells get different shades, so a lost triangle changes the image hash
+    outColor = vec4(draw.color.rgb * (0.5 + 0.5 * fract(float(cell) * 0.618034)), draw.color.a);
+}
@@ -0,0 +1,195 @@
+#include "startup_bench.hpp"
+
+#define GLFW_INCLUDE_VULKAN
+#include <GLFW/glfw3.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <fmt/format.h>
+#include <future>
+#include <iterator>
+#include <memory>
+#include <optional>
+#include <spdlog/spdlog.h>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "vulkan_context.hpp"
+
+namespace vultex::bench
+{
+namespace
+{
+using Milliseconds = std::chrono::duration<double, std::milli>;
+
+// samples of every stage, stages in the order they first ran
+class StageSamples
+{
+public:
+    void add(const std::string_view stage, const double milliseconds)
+    {
+        auto it = std::ranges::find(stages, stage, &Stage::name);
+        if (it == stages.end())
+        {
+            it = stages.insert(stages.end(), Stage{.name = std::string{stage}});
+        }
+        it->samples.push_back(milliseconds);
+    }
+
+    void append_medians(BenchResult& result, const std::string_view prefix) const
+    {
+        for (const auto& stage : stages)
+        {
+            result.metrics.emplace_back(fmt::format("{}{}_ms", prefix, stage.name), median_of(stage.samples));
+        }
+    }
+
+private:
+    struct Stage
+    {
+        std::string name;
+        std::vector<double> samples{};
+    };
+
+    [[nodiscard]] static double median_of(std::vector<double> samples)
+    {
+        const auto middle = std::next(samples.begin(), static_cast<std::ptrdiff_t>(samples.size() / 2));
+        std::ranges::nth_element(samples, middle);
+        return *middle;
+    }
+
+    std::vector<Stage> stages{};
+};
+
+template <typename Stage>
+auto timed(StageSamples& samples, const std::string_view name, Stage stage)
+{
+    const auto start = std::chrono::steady_clock::now();
+    auto result = stage();
+    samples.add(name, Milliseconds(std::chrono::steady_clock::now() - start).count());
+    return result;
+}
+
+[[nodiscard]] std::vector<const char*> surface_extensions()
+{
+    std::uint32_t count = 0;
+    const auto** names = glfwGetRequiredInstanceExtensions(&count);
+    return {names, std::next(names, count)};
+}
+
+[[nodiscard]] GLFWwindow* create_hidden_window()
+{
+    glfwWindowHint(GLFW_CLIENT_API, GLFW_NO_API);
+    glfwWindowHint(GLFW_VISIBLE, GLFW_FALSE);
+    return glfwCreateWindow(800, 600, "vultex_bench", nullptr, nullptr);
+}
+
+void init_glfw(StageSamples& samples)
+{
+    if (GLFW_TRUE != timed(samples, "glfw_init", [] { return glfwInit(); }))
+    {
+        throw std::runtime_error("Cannot initialize GLFW, run the startup benchmark without --window");
+    }
+}
+
+// every stage one after another, the way the application started before
+void run_sequential(StageSamples& samples, const bool with_window)
+{
+    const auto runStart = std::chrono::steady_clock::now();
+
+    GLFWwindow* window{nullptr};
+    std::vector<const char*> extensions{};
+    if (with_window)
+    {
+        init_glfw(samples);
+        extensions = surface_extensions();
+        window = timed(samples, "create_window", create_hidden_window);
+    }
+
+    std::optional<VulkanContext> context{};
+    context.emplace(extensions);
+    for (const auto& stage : context->startup_stages())
+    {
+        samples.add(stage.name, Milliseconds(stage.duration).count());
+    }
+    samples.add("total", Milliseconds(std::chrono::steady_clock::now() - runStart).count());
+
+    timed(samples,
+          "destroy_context",
+          [&context]
+          {
+              context.reset();
+              return 0;
+          });
+
+    if (with_window)
+    {
+        glfwDestroyWindow(window);
+        glfwTerminate();
+    }
+}
+
+// the application path: the context is created on a worker while the main thread creates the window
+void run_overlapped(StageSamples& samples)
+{
+    const auto runStart = std::chrono::steady_clock::now();
+
+    if (GLFW_TRUE != glfwInit())
+    {
+        throw std::runtime_error("Cannot initialize GLFW, run the startup benchmark without --window");
+    }
+    const auto extensions = surface_extensions();
+
+    auto context = std::async(std::launch::async,
+                              [&extensions] { return std::make_unique<VulkanContext>(extensions); });
+    auto* window = create_hidden_window();
+    auto created = context.get();
+    samples.add("overlapped_total", Milliseconds(std::chrono::steady_clock::now() - runStart).count());
+
+    created.reset();
+    glfwDestroyWindow(window);
+    glfwTerminate();
+}
+} // namespace
+
+BenchResult run_startup_benchmark(const std::uint32_t runs, const bool with_window)
+{
+    if (runs < 2)
+    {
+        throw std::invalid_argument(
+            "The startup benchmark needs 2 runs at least, the first one is reported on its own!");
+    }
+    spdlog::info("Run startup: {} runs, window: {}", runs, with_window);
+
+    StageSamples samples{};
+    StageSamples coldSamples{};
+
+    for (std::uint32_t run = 0; run < runs; ++run)
+    {
+        // the first run loads the loader and the ICD, warm runs reuse the shared objects
+        run_sequential(run == 0 ? coldSamples : samples, with_window);
+    }
+
+    if (with_window)
+    {
+        for (std::uint32_t run = 0; run < runs; ++run)
+        {
+            run_overlapped(samples);
+        }
+    }
+
+    BenchResult result{.name = "startup"};
+    // samples behind the medians: the sequential runs after the first one, every overlapped run
+    result.metrics.emplace_back("warm_runs", runs - 1);
+    if (with_window)
+    {
+        result.metrics.emplace_back("overlapped_runs", runs);
+    }
+    samples.append_medians(result, "");
+    coldSamples.append_medians(result, "first_run_");
+    return result;
+}
+} // namespace vultex::bench
@@ -0,0 +1,17 @@
+#pragma once
+
+#include <cstdint>
+
+#include "bench_report.hpp"
+
+namespace vultex::bench
+{
+
+// Creates and destroys the whole init chain `runs` times (at least 2) and
+// reports the median of every stage over the warm runs. The first run also
+// pays for loading the ICD and is reported on its own. With a window GLFW is
+// initialized and a hidden window created, then the same number of runs
+// measure the application's startup where the window is created while a
+// worker creates the context.
+[[nodiscard]] BenchResult run_startup_benchmark(std::uint32_t runs, bool with_window);
+} // namespace vultex::bench
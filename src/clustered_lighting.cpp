@@ -0,0 +1,352 @@
+#include "clustered_lighting.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <fmt/format.h>
+#include <future>
+#include <spdlog/spdlog.h>
+#include <stdexcept>
+
+#include "hash.hpp"
+#include "host_allocator.hpp"
+#include "vulkan_memory.hpp"
+
+namespace vultex
+{
+namespace
+{
+// one froxel per invocation, see light_binning.comp
+constexpr std::uint32_t workgroup_size = 64;
+constexpr std::uint32_t set_bindings = 6;
+
+// pass_index of light_binning.comp
+constexpr std::uint32_t count_pass = 0;
+constexpr std::uint32_t write_pass = 1;
+
+// std140 ClusterParameters of clustered_lighting.glsl
+struct ClusterParameters
+{
+    glm::mat4 view;
+    glm::mat4 inverse_projection;
+    glm::uvec4 grid;   // tiles x, tiles y, depth slices, light count
+    glm::vec4 depth;   // near, far, slice scale, slice bias
+    glm::vec4 screen;  // tile width and height in pixels, target width and height
+    glm::uvec4 limits; // light index capacity
+};
+
+// min and max corner of a froxel in view space
+constexpr VkDeviceSize froxel_bounds_size = 2 * sizeof(glm::vec4);
+
+void compute_barrier(VkCommandBuffer command_buffer,
+                     const VkAccessFlags destination_access,
+                     const VkPipelineStageFlags destination_stages)
+{
+    const VkMemoryBarrier barrier{.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER,
+                                  .srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT,
+                                  .dstAccessMask = destination_access};
+    vkCmdPipelineBarrier(command_buffer,
+                         VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+                         destination_stages,
+                         0,
+                         1,
+                         &barrier,
+                         0,
+                         nullptr,
+                         0,
+                         nullptr);
+}
+} // namespace
+
+std::uint32_t ClusterGrid::cluster_count() const
+{
+    return tiles_x * tiles_y * depth_slices;
+}
+
+std::uint32_t ClusterGrid::depth_slice(const float view_depth) const
+{
+    const auto slice = std::log(std::max(view_depth, near_plane) / near_plane) /
+                       std::log(far_plane / near_plane) * static_cast<float>(depth_slices);
+    return std::min(static_cast<std::uint32_t>(slice), depth_slices - 1);
+}
+
+float ClusterGrid::slice_depth(const std::uint32_t slice) const
+{
+    return near_plane *
+           std::pow(far_plane / near_plane, static_cast<float>(slice) / static_cast<float>(depth_slices));
+}
+
+ClusteredLighting::ClusteredLighting(const GpuPrimitives& primitives,
+                                     ShaderModuleCache& shaders,
+                                     PipelineCompiler& compiler,
+                                     const std::filesystem::path& shader_directory,
+                                     const ClusterGrid& grid,
+                                     const GpuBufferRange& lights,
+                                     const std::uint32_t max_light_indices)
+    : physical_device{primitives.physical_device()},
+      logical_device{primitives.logical_device()},
+      cluster_grid{grid},
+      light_capacity{static_cast<std::uint32_t>(lights.size / sizeof(PointLight))},
+      max_light_indices{max_light_indices}
+{
+    if (grid.cluster_count() == 0 || grid.near_plane <= 0.0F || grid.far_plane <= grid.near_plane)
+    {
+        throw std::invalid_argument(fmt::format("Invalid cluster grid {}x{}x{} from {} to {}!",
+                                                grid.tiles_x,
+                                                grid.tiles_y,
+                                                grid.depth_slices,
+                                                grid.near_plane,
+                                                grid.far_plane));
+    }
+    spdlog::info("Create clustered lighting: {}x{}x{} froxels, {} lights, {} light indices",
+                 grid.tiles_x,
+                 grid.tiles_y,
+                 grid.depth_slices,
+                 light_capacity,
+                 max_light_indices);
+
+    // parameters, froxel bounds, counts, offsets and the light index list in
+    // one buffer, each at a valid offset for its descriptor type
+    VkPhysicalDeviceProperties properties{};
+    vkGetPhysicalDeviceProperties(physical_device, &properties);
+    const auto alignment = std::max({properties.limits.minStorageBufferOffsetAlignment,
+                                     properties.limits.minUniformBufferOffsetAlignment,
+                                     VkDeviceSize{4}});
+    const auto clusters = grid.cluster_count();
+    VkDeviceSize bufferSize = 0;
+    const auto region = [&bufferSize, alignment](const VkDeviceSize size)
+    {
+        const GpuBufferRange range{.buffer = nullptr, .offset = bufferSize, .size = size};
+        bufferSize += align_up(size, alignment);
+        return range;
+    };
+    parameters = region(sizeof(ClusterParameters));
+    bounds = region(froxel_bounds_size * clusters);
+    counts = region(VkDeviceSize{sizeof(std::uint32_t)} * clusters);
+    offsets = region(VkDeviceSize{sizeof(std::uint32_t)} * clusters);
+    indices = region(VkDeviceSize{sizeof(std::uint32_t)} * std::max<std::uint32_t>(max_light_indices, 1));
+
+    const VkBufferCreateInfo bufferInfo{.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO,
+                                        .size = bufferSize,
+                                        .usage = VK_BUFFER_USAGE_STORAGE_BUFFER_BIT |
+                                                 VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT |
+                                                 VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+                                        .sharingMode = VK_SHARING_MODE_EXCLUSIVE};
+    if (VK_SUCCESS != vkCreateBuffer(logical_device, &bufferInfo, allocation_callbacks(), &buffer))
+    {
+        throw std::runtime_error("Failed to create clustered lighting buffer!");
+    }
+
+    VkMemoryRequirements requirements{};
+    vkGetBufferMemoryRequirements(logical_device, buffer, &requirements);
+    const auto memoryType =
+        find_memory_type(physical_device, requirements.memoryTypeBits, {VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, 0});
+    if (!memoryType)
+    {
+        throw std::runtime_error("Cannot find memory for clustered lighting buffer!");
+    }
+
+    const VkMemoryAllocateInfo allocateInfo{.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO,
+                                            .allocationSize = requirements.size,
+                                            .memoryTypeIndex = memoryType.value()};
+    if (VK_SUCCESS != vkAllocateMemory(logical_device, &allocateInfo, allocation_callbacks(), &memory))
+    {
+        throw std::runtime_error("Failed to allocate clustered lighting memory!");
+    }
+    vkBindBufferMemory(logical_device, buffer, memory, 0);
+
+    for (auto* range : {&parameters, &bounds, &counts, &offsets, &indices})
+    {
+        range->buffer = buffer;
+    }
+    scan = std::make_unique<GpuScan>(primitives, counts, offsets, clusters);
+
+    // lights, counts, offsets, indices, parameters and the bounds only the compute passes use
+    constexpr VkShaderStageFlags stages = VK_SHADER_STAGE_COMPUTE_BIT | VK_SHADER_STAGE_FRAGMENT_BIT;
+    std::array<VkDescriptorSetLayoutBinding, set_bindings> bindings{};
+    for (std::uint32_t binding = 0; binding < set_bindings; ++binding)
+    {
+        bindings[binding] = VkDescriptorSetLayoutBinding{
+            .binding = binding,
+            .descriptorType = binding == 4 ? VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER : VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
+            .descriptorCount = 1,
+            .stageFlags = binding == 5 ? VkShaderStageFlags{VK_SHADER_STAGE_COMPUTE_BIT} : stages};
+    }
+    const VkDescriptorSetLayoutCreateInfo setLayoutInfo{.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO,
+                                                        .bindingCount = set_bindings,
+                                                        .pBindings = bindings.data()};
+    if (VK_SUCCESS !=
+        vkCreateDescriptorSetLayout(logical_device, &setLayoutInfo, allocation_callbacks(), &descriptor_set_layout))
+    {
+        throw std::runtime_error("Failed to create clustered lighting descriptor set layout!");
+    }
+
+    const std::array poolSizes{
+        VkDescriptorPoolSize{.type = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, .descriptorCount = set_bindings - 1},
+        VkDescriptorPoolSize{.type = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, .descriptorCount = 1}};
+    const VkDescriptorPoolCreateInfo poolInfo{.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO,
+                                              .maxSets = 1,
+                                              .poolSizeCount = static_cast<std::uint32_t>(poolSizes.size()),
+                                              .pPoolSizes = poolSizes.data()};
+    if (VK_SUCCESS != vkCreateDescriptorPool(logical_device, &poolInfo, allocation_callbacks(), &pool))
+    {
+        throw std::runtime_error("Failed to create clustered lighting descriptor pool!");
+    }
+
+    const VkDescriptorSetAllocateInfo setInfo{.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO,
+                                              .descriptorPool = pool,
+                                              .descriptorSetCount = 1,
+                                              .pSetLayouts = &descriptor_set_layout};
+    if (VK_SUCCESS != vkAllocateDescriptorSets(logical_device, &setInfo, &set))
+    {
+        throw std::runtime_error("Failed to allocate clustered lighting descriptor set!");
+    }
+
+    const std::array<GpuBufferRange, set_bindings> ranges{lights, counts, offsets, indices, parameters, bounds};
+    std::array<VkDescriptorBufferInfo, set_bindings> bufferInfos{};
+    std::array<VkWriteDescriptorSet, set_bindings> writes{};
+    for (std::uint32_t binding = 0; binding < set_bindings; ++binding)
+    {
+        bufferInfos[binding] = VkDescriptorBufferInfo{
+            .buffer = ranges[binding].buffer, .offset = ranges[binding].offset, .range = ranges[binding].size};
+        writes[binding] = VkWriteDescriptorSet{.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET,
+                                               .dstSet = set,
+                                               .dstBinding = binding,
+                                               .descriptorCount = 1,
+                                               .descriptorType = bindings[binding].descriptorType,
+                                               .pBufferInfo = &bufferInfos[binding]};
+    }
+    vkUpdateDescriptorSets(logical_device, set_bindings, writes.data(), 0, nullptr);
+
+    const VkPushConstantRange pushConstants{
+        .stageFlags = VK_SHADER_STAGE_COMPUTE_BIT, .offset = 0, .size = sizeof(std::uint32_t)};
+    const VkPipelineLayoutCreateInfo layoutInfo{.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO,
+                                                .setLayoutCount = 1,
+                                                .pSetLayouts = &descriptor_set_layout,
+                                                .pushConstantRangeCount = 1,
+                                                .pPushConstantRanges = &pushConstants};
+    if (VK_SUCCESS != vkCreatePipelineLayout(logical_device, &layoutInfo, allocation_callbacks(), &layout))
+    {
+        throw std::runtime_error("Failed to create clustered lighting pipeline layout!");
+    }
+
+    const auto boundsFile = shader_directory / "cluster_bounds.comp.spv";
+    const auto binningFile = shader_directory / "light_binning.comp.spv";
+    const auto bounds = compile_compute_kernel(
+        compiler, fnv1a(boundsFile.string()), shaders.load(boundsFile, VK_SHADER_STAGE_COMPUTE_BIT), layout);
+    const auto binning = compile_compute_kernel(
+        compiler, fnv1a(binningFile.string()), shaders.load(binningFile, VK_SHADER_STAGE_COMPUTE_BIT), layout);
+    bounds_pipeline = PipelineCompiler::wait(bounds, "cluster bounds");
+    binning_pipeline = PipelineCompiler::wait(binning, "light binning");
+}
+
+ClusteredLighting::~ClusteredLighting()
+{
+    // pipelines belong to the compiler
+    vkDestroyPipelineLayout(logical_device, layout, allocation_callbacks());
+    vkDestroyDescriptorPool(logical_device, pool, allocation_callbacks());
+    vkDestroyDescriptorSetLayout(logical_device, descriptor_set_layout, allocation_callbacks());
+    scan.reset();
+    vkDestroyBuffer(logical_device, buffer, allocation_callbacks());
+    vkFreeMemory(logical_device, memory, allocation_callbacks());
+}
+
+const ClusterGrid& ClusteredLighting::grid() const
+{
+    return cluster_grid;
+}
+
+std::uint32_t ClusteredLighting::max_lights() const
+{
+    return light_capacity;
+}
+
+VkDescriptorSetLayout ClusteredLighting::set_layout() const
+{
+    return descriptor_set_layout;
+}
+
+VkDescriptorSet ClusteredLighting::descriptor_set() const
+{
+    return set;
+}
+
+void ClusteredLighting::record(VkCommandBuffer command_buffer, const ClusterView& view)
+{
+    if (view.light_count > light_capacity)
+    {
+        throw std::invalid_argument(
+            fmt::format("Cannot bin {} lights, the lights buffer holds {}!", view.light_count, light_capacity));
+    }
+
+    const auto logRange = std::log(cluster_grid.far_plane / cluster_grid.near_plane);
+    const auto sliceScale = static_cast<float>(cluster_grid.depth_slices) / logRange;
+    const glm::vec2 tile{
+        static_cast<float>((view.extent.width + cluster_grid.tiles_x - 1) / cluster_grid.tiles_x),
+        static_cast<float>((view.extent.height + cluster_grid.tiles_y - 1) / cluster_grid.tiles_y)};
+    const ClusterParameters clusterParameters{
+        .view = view.view,
+        .inverse_projection = glm::inverse(view.projection),
+        .grid = {cluster_grid.tiles_x, cluster_grid.tiles_y, cluster_grid.depth_slices, view.light_count},
+        .depth = {cluster_grid.near_plane,
+                  cluster_grid.far_plane,
+                  sliceScale,
+                  -sliceScale * std::log(cluster_grid.near_plane)},
+        .screen = {tile.x, tile.y, static_cast<float>(view.extent.width), static_cast<float>(view.extent.height)},
+        .limits = {max_light_indices, 0, 0, 0}};
+
+    // the previous frame's shaders are done with the parameters and lists
+    // before they are written again
+    vkCmdPipelineBarrier(command_buffer,
+                         VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT | VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT,
+                         VK_PIPELINE_STAGE_TRANSFER_BIT | VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+                         0,
+                         0,
+                         nullptr,
+                         0,
+                         nullptr,
+                         0,
+                         nullptr);
+    // recorded with the commands, no host memory the GPU may still read
+    vkCmdUpdateBuffer(command_buffer, buffer, parameters.offset, sizeof(clusterParameters), &clusterParameters);
+    const VkMemoryBarrier parametersBarrier{.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER,
+                                            .srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT,
+                                            .dstAccessMask = VK_ACCESS_UNIFORM_READ_BIT};
+    vkCmdPipelineBarrier(command_buffer,
+                         VK_PIPELINE_STAGE_TRANSFER_BIT,
+                         VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT | VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT,
+                         0,
+                         1,
+                         &parametersBarrier,
+                         0,
+                         nullptr,
+                         0,
+                         nullptr);
+
+    const auto groups = (cluster_grid.cluster_count() + workgroup_size - 1) / workgroup_size;
+    vkCmdBindDescriptorSets(command_buffer, VK_PIPELINE_BIND_POINT_COMPUTE, layout, 0, 1, &set, 0, nullptr);
+    if (view.projection != bounds_projection || view.extent.width != bounds_extent.width ||
+        view.extent.height != bounds_extent.height)
+    {
+        vkCmdBindPipeline(command_buffer, VK_PIPELINE_BIND_POINT_COMPUTE, bounds_pipeline);
+        vkCmdDispatch(command_buffer, groups, 1, 1);
+        compute_barrier(command_buffer, VK_ACCESS_SHADER_READ_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT);
+        bounds_projection = view.projection;
+        bounds_extent = view.extent;
+    }
+
+    vkCmdBindPipeline(command_buffer, VK_PIPELINE_BIND_POINT_COMPUTE, binning_pipeline);
+    vkCmdPushConstants(command_buffer, layout, VK_SHADER_STAGE_COMPUTE_BIT, 0, sizeof(count_pass), &count_pass);
+    vkCmdDispatch(command_buffer, groups, 1, 1);
+    compute_barrier(command_buffer, VK_ACCESS_SHADER_READ_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT);
+
+    scan->record(command_buffer);
+
+    // the scan binds its own pipeline and set
+    vkCmdBindPipeline(command_buffer, VK_PIPELINE_BIND_POINT_COMPUTE, binning_pipeline);
+    vkCmdBindDescriptorSets(command_buffer, VK_PIPELINE_BIND_POINT_COMPUTE, layout, 0, 1, &set, 0, nullptr);
+    vkCmdPushConstants(command_buffer, layout, VK_SHADER_STAGE_COMPUTE_BIT, 0, sizeof(write_pass), &write_pass);
+    vkCmdDispatch(command_buffer, groups, 1, 1);
+    compute_barrier(command_buffer, VK_ACCESS_SHADER_READ_BIT, VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT);
+}
+} // namespace vultex
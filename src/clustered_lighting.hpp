@@ -0,0 +1,119 @@
+#pragma once
+
+#define GLFW_INCLUDE_VULKAN
+#include <GLFW/glfw3.h>
+
+#include <cstdint>
+#include <filesystem>
+#include <glm/glm.hpp>
+#include <memory>
+
+#include "gpu_primitives.hpp"
+#include "pipeline_compiler.hpp"
+#include "shader_module_cache.hpp"
+
+namespace vultex
+{
+
+// std430 layout of a light in the lights buffer, see clustered_lighting.glsl.
+// Position in world space, the light has no effect beyond radius.
+struct PointLight
+{
+    glm::vec3 position;
+    float radius;
+    glm::vec3 color;
+    float intensity;
+};
+
+static_assert(sizeof(PointLight) == 32);
+
+// Froxels: the view split into tiles_x * tiles_y screen tiles and
+// depth_slices slices between near_plane and far_plane. Slices grow
+// exponentially with the distance, so froxels stay about as deep as wide.
+struct ClusterGrid
+{
+    std::uint32_t tiles_x{16};
+    std::uint32_t tiles_y{9};
+    std::uint32_t depth_slices{24};
+    float near_plane{0.1F};
+    float far_plane{100.0F};
+
+    [[nodiscard]] std::uint32_t cluster_count() const;
+    // slice of a positive view space depth, clamped to the grid
+    [[nodiscard]] std::uint32_t depth_slice(float view_depth) const;
+    // view space depth where a slice begins, slice_depth(depth_slices) is the far plane
+    [[nodiscard]] float slice_depth(std::uint32_t slice) const;
+};
+
+// Camera of a frame, projection as used by the vertex shaders (y flipped for
+// Vulkan) with the near and far planes of the grid
+struct ClusterView
+{
+    glm::mat4 view;
+    glm::mat4 projection;
+    VkExtent2D extent;
+    std::uint32_t light_count;
+};
+
+// Clustered forward lighting. record() bins the lights into the froxels of
+// the view on the GPU: a first pass counts the lights intersecting each
+// froxel, a GpuScan turns the counts into offsets and a second pass writes
+// the light indices of every froxel there, one compact list for all of them.
+// A fragment shader includes clustered_lighting.glsl, binds descriptor_set()
+// and only shades the lights of its froxel, so its cost depends on the lights
+// nearby and not on all lights. Froxel bounds are only rebuilt when the
+// projection or the extent change.
+class ClusteredLighting
+{
+public:
+    // lights holds up to size / sizeof(PointLight) lights, written by the
+    // caller and visible to compute shaders before record(); a froxel only
+    // gets the lights which still fit in max_light_indices
+    ClusteredLighting(const GpuPrimitives& primitives,
+                      ShaderModuleCache& shaders,
+                      PipelineCompiler& compiler,
+                      const std::filesystem::path& shader_directory,
+                      const ClusterGrid& grid,
+                      const GpuBufferRange& lights,
+                      std::uint32_t max_light_indices);
+    ClusteredLighting(const ClusteredLighting&) = delete;
+    ClusteredLighting(ClusteredLighting&&) = delete;
+    ClusteredLighting& operator=(const ClusteredLighting&) = delete;
+    ClusteredLighting& operator=(ClusteredLighting&&) = delete;
+    ~ClusteredLighting();
+
+    [[nodiscard]] const ClusterGrid& grid() const;
+    [[nodiscard]] std::uint32_t max_lights() const;
+
+    // set of clustered_lighting.glsl, compute and fragment stages
+    [[nodiscard]] VkDescriptorSetLayout set_layout() const;
+    [[nodiscard]] VkDescriptorSet descriptor_set() const;
+
+    // outside of a render pass, the lists are visible to fragment shaders after it
+    void record(VkCommandBuffer command_buffer, const ClusterView& view);
+
+private:
+    VkPhysicalDevice physical_device{VK_NULL_HANDLE};
+    VkDevice logical_device{nullptr};
+    ClusterGrid cluster_grid{};
+    std::uint32_t light_capacity{0};
+    std::uint32_t max_light_indices{0};
+    VkBuffer buffer{nullptr};
+    VkDeviceMemory memory{nullptr};
+    GpuBufferRange parameters{};
+    GpuBufferRange bounds{};
+    GpuBufferRange counts{};
+    GpuBufferRange offsets{};
+    GpuBufferRange indices{};
+    std::unique_ptr<GpuScan> scan{};
+    VkDescriptorSetLayout descriptor_set_layout{nullptr};
+    VkDescriptorPool pool{nullptr};
+    VkDescriptorSet set{nullptr};
+    VkPipelineLayout layout{nullptr};
+    VkPipeline bounds_pipeline{nullptr};
+    VkPipeline binning_pipeline{nullptr};
+    // projection and extent of the current bounds
+    glm::mat4 bounds_projection{0.0F};
+    VkExtent2D bounds_extent{};
+};
+} // namespace vultex
@@ -0,0 +1,148 @@
+#include "deletion_queue.hpp"
+
+#include <limits>
+#include <spdlog/spdlog.h>
+#include <utility>
+
+#include "host_allocator.hpp"
+
+namespace vultex
+{
+namespace
+{
+template <typename Handle>
+Handle to_handle(const std::uint64_t handle)
+{
+    return reinterpret_cast<Handle>(handle);
+}
+} // namespace
+
+DeletionQueue::DeletionQueue(VkDevice logical_device, const QueueTimeline& graphics, const QueueTimeline& compute)
+    : logical_device{logical_device}, graphics_timeline{graphics}, compute_timeline{compute}
+{
+}
+
+DeletionQueue::~DeletionQueue()
+{
+    collect(std::numeric_limits<std::uint64_t>::max(), std::numeric_limits<std::uint64_t>::max());
+}
+
+void DeletionQueue::push(const VkObjectType type,
+                         const std::uint64_t handle,
+                         const TimelineKind timeline,
+                         const std::uint64_t timeline_value)
+{
+    auto* node = new Node{
+        .object = {.type = type, .handle = handle, .timeline = timeline, .timeline_value = timeline_value},
+        .next = head.load(std::memory_order_relaxed)};
+    while (!head.compare_exchange_weak(node->next, node, std::memory_order_release, std::memory_order_relaxed))
+    {
+    }
+}
+
+void DeletionQueue::collect()
+{
+    collect(graphics_timeline.completed_value(), compute_timeline.completed_value());
+}
+
+void DeletionQueue::collect(const std::uint64_t graphics_completed, const std::uint64_t compute_completed)
+{
+    // only this thread takes nodes out, grabbing the whole list is ABA free
+    for (auto* node = head.exchange(nullptr, std::memory_order_acquire); nullptr != node;)
+    {
+        retired.push_back(node->object);
+        delete std::exchange(node, node->next);
+    }
+
+    const auto destroyed = std::erase_if(retired,
+                                         [this, graphics_completed, compute_completed](const Retired& object)
+                                         {
+                                             const auto completed = TimelineKind::graphics == object.timeline
+                                                                        ? graphics_completed
+                                                                        : compute_completed;
+                                             if (object.timeline_value > completed)
+                                             {
+                                                 return false;
+                                             }
+                                             destroy(object);
+                                             return true;
+                                         });
+    if (0 != destroyed)
+    {
+        spdlog::debug("Destroyed {} retired objects, {} pending", destroyed, retired.size());
+    }
+}
+
+std::size_t DeletionQueue::pending() const
+{
+    return retired.size();
+}
+
+void DeletionQueue::destroy(const Retired& object) const
+{
+    switch (object.type)
+    {
+    case VK_OBJECT_TYPE_BUFFER:
+        vkDestroyBuffer(logical_device, to_handle<VkBuffer>(object.handle), allocation_callbacks());
+        break;
+    case VK_OBJECT_TYPE_BUFFER_VIEW:
+        vkDestroyBufferView(logical_device, to_handle<VkBufferView>(object.handle), allocation_callbacks());
+        break;
+    case VK_OBJECT_TYPE_IMAGE:
+        vkDestroyImage(logical_device, to_handle<VkImage>(object.handle), allocation_callbacks());
+        break;
+    case VK_OBJECT_TYPE_IMAGE_VIEW:
+        vkDestroyImageView(logical_device, to_handle<VkImageView>(object.handle), allocation_callbacks());
+        break;
+    case VK_OBJECT_TYPE_DEVICE_MEMORY:
+        vkFreeMemory(logical_device, to_handle<VkDeviceMemory>(object.handle), allocation_callbacks());
+        break;
+    case VK_OBJECT_TYPE_SAMPLER:
+        vkDestroySampler(logical_device, to_handle<VkSampler>(object.handle), allocation_callbacks());
+        break;
+    case VK_OBJECT_TYPE_SHADER_MODULE:
+        vkDestroyShaderModule(logical_device, to_handle<VkShaderModule>(object.handle), allocation_callbacks());
+        break;
+    case VK_OBJECT_TYPE_PIPELINE:
+        vkDestroyPipeline(logical_device, to_handle<VkPipeline>(object.handle), allocation_callbacks());
+        break;
+    case VK_OBJECT_TYPE_PIPELINE_LAYOUT:
+        vkDestroyPipelineLayout(logical_device, to_handle<VkPipelineLayout>(object.handle), allocation_callbacks());
+        break;
+    case VK_OBJECT_TYPE_PIPELINE_CACHE:
+        vkDestroyPipelineCache(logical_device, to_handle<VkPipelineCache>(object.handle), allocation_callbacks());
+        break;
+    case VK_OBJECT_TYPE_DESCRIPTOR_SET_LAYOUT:
+        vkDestroyDescriptorSetLayout(
+            logical_device, to_handle<VkDescriptorSetLayout>(object.handle), allocation_callbacks());
+        break;
+    case VK_OBJECT_TYPE_DESCRIPTOR_POOL:
+        vkDestroyDescriptorPool(logical_device, to_handle<VkDescriptorPool>(object.handle), allocation_callbacks());
+        break;
+    case VK_OBJECT_TYPE_RENDER_PASS:
+        vkDestroyRenderPass(logical_device, to_handle<VkRenderPass>(object.handle), allocation_callbacks());
+        break;
+    case VK_OBJECT_TYPE_FRAMEBUFFER:
+        vkDestroyFramebuffer(logical_device, to_handle<VkFramebuffer>(object.handle), allocation_callbacks());
+        break;
+    case VK_OBJECT_TYPE_QUERY_POOL:
+        vkDestroyQueryPool(logical_device, to_handle<VkQueryPool>(object.handle), allocation_callbacks());
+        break;
+    case VK_OBJECT_TYPE_COMMAND_POOL:
+        vkDestroyCommandPool(logical_device, to_handle<VkCommandPool>(object.handle), allocation_callbacks());
+        break;
+    case VK_OBJECT_TYPE_SEMAPHORE:
+        vkDestroySemaphore(logical_device, to_handle<VkSemaphore>(object.handle), allocation_callbacks());
+        break;
+    case VK_OBJECT_TYPE_FENCE:
+        vkDestroyFence(logical_device, to_handle<VkFence>(object.handle), allocation_callbacks());
+        break;
+    case VK_OBJECT_TYPE_EVENT:
+        vkDestroyEvent(logical_device, to_handle<VkEvent>(object.handle), allocation_callbacks());
+        break;
+    default:
+        spdlog::error("Cannot destroy retired object of type {}", static_cast<int>(object.type));
+        break;
+    }
+}
+} // namespace vultex
@@ -0,0 +1,112 @@
+#pragma once
+
+#define GLFW_INCLUDE_VULKAN
+#include <GLFW/glfw3.h>
+
+#include <atomic>
+#include <cstdint>
+#include <vector>
+
+#include "queue_timeline.hpp"
+
+namespace vultex
+{
+
+template <typename Handle>
+struct ObjectType;
+
+#define VULTEX_OBJECT_TYPE(Handle, Type)                                                                              \
+    template <>                                                                                                       \
+    struct ObjectType<Handle>                                                                                         \
+    {                                                                                                                 \
+        static constexpr VkObjectType value = Type;                                                                   \
+    };
+
+VULTEX_OBJECT_TYPE(VkBuffer, VK_OBJECT_TYPE_BUFFER)
+VULTEX_OBJECT_TYPE(VkBufferView, VK_OBJECT_TYPE_BUFFER_VIEW)
+VULTEX_OBJECT_TYPE(VkImage, VK_OBJECT_TYPE_IMAGE)
+VULTEX_OBJECT_TYPE(VkImageView, VK_OBJECT_TYPE_IMAGE_VIEW)
+VULTEX_OBJECT_TYPE(VkDeviceMemory, VK_OBJECT_TYPE_DEVICE_MEMORY)
+VULTEX_OBJECT_TYPE(VkSampler, VK_OBJECT_TYPE_SAMPLER)
+VULTEX_OBJECT_TYPE(VkShaderModule, VK_OBJECT_TYPE_SHADER_MODULE)
+VULTEX_OBJECT_TYPE(VkPipeline, VK_OBJECT_TYPE_PIPELINE)
+VULTEX_OBJECT_TYPE(VkPipelineLayout, VK_OBJECT_TYPE_PIPELINE_LAYOUT)
+VULTEX_OBJECT_TYPE(VkPipelineCache, VK_OBJECT_TYPE_PIPELINE_CACHE)
+VULTEX_OBJECT_TYPE(VkDescriptorSetLayout, VK_OBJECT_TYPE_DESCRIPTOR_SET_LAYOUT)
+VULTEX_OBJECT_TYPE(VkDescriptorPool, VK_OBJECT_TYPE_DESCRIPTOR_POOL)
+VULTEX_OBJECT_TYPE(VkRenderPass, VK_OBJECT_TYPE_RENDER_PASS)
+VULTEX_OBJECT_TYPE(VkFramebuffer, VK_OBJECT_TYPE_FRAMEBUFFER)
+VULTEX_OBJECT_TYPE(VkQueryPool, VK_OBJECT_TYPE_QUERY_POOL)
+VULTEX_OBJECT_TYPE(VkCommandPool, VK_OBJECT_TYPE_COMMAND_POOL)
+VULTEX_OBJECT_TYPE(VkSemaphore, VK_OBJECT_TYPE_SEMAPHORE)
+VULTEX_OBJECT_TYPE(VkFence, VK_OBJECT_TYPE_FENCE)
+VULTEX_OBJECT_TYPE(VkEvent, VK_OBJECT_TYPE_EVENT)
+
+#undef VULTEX_OBJECT_TYPE
+
+// The queue whose timeline value a retired object waits for
+enum class TimelineKind : std::uint8_t
+{
+    graphics,
+    compute
+};
+
+// Destroys Vulkan objects once the timeline of the queue which last used them
+// reaches the value of that submission, so freeing a resource never needs
+// vkDeviceWaitIdle. Graphics and compute values are counted separately, an
+// object is checked against the timeline it was retired with. Any thread may
+// retire objects (lock free push), objects are destroyed in batches by
+// collect on the frame loop thread. Descriptor sets and command buffers go
+// back with their pools.
+class DeletionQueue
+{
+public:
+    // both timelines have to outlive this
+    DeletionQueue(VkDevice logical_device, const QueueTimeline& graphics, const QueueTimeline& compute);
+    DeletionQueue(const DeletionQueue&) = delete;
+    DeletionQueue(DeletionQueue&&) = delete;
+    DeletionQueue& operator=(const DeletionQueue&) = delete;
+    DeletionQueue& operator=(DeletionQueue&&) = delete;
+    // device has to be idle, everything left is destroyed
+    ~DeletionQueue();
+
+    template <typename Handle>
+    void retire(Handle handle, const TimelineKind timeline, const std::uint64_t timeline_value)
+    {
+        if (VK_NULL_HANDLE != handle)
+        {
+            push(ObjectType<Handle>::value, reinterpret_cast<std::uint64_t>(handle), timeline, timeline_value);
+        }
+    }
+
+    // destroys objects whose timeline completed the value they were retired with
+    void collect();
+
+    [[nodiscard]] std::size_t pending() const;
+
+private:
+    struct Retired
+    {
+        VkObjectType type;
+        std::uint64_t handle;
+        TimelineKind timeline;
+        std::uint64_t timeline_value;
+    };
+
+    struct Node
+    {
+        Retired object;
+        Node* next;
+    };
+
+    void push(VkObjectType type, std::uint64_t handle, TimelineKind timeline, std::uint64_t timeline_value);
+    void collect(std::uint64_t graphics_completed, std::uint64_t compute_completed);
+    void destroy(const Retired& object) const;
+
+    VkDevice logical_device{nullptr};
+    const QueueTimeline& graphics_timeline;
+    const QueueTimeline& compute_timeline;
+    std::atomic<Node*> head{nullptr};
+    std::vector<Retired> retired{};
+};
+} // namespace vultex
@@ -0,0 +1,118 @@
+#include "draw_batcher.hpp"
+
+#include <fmt/format.h>
+#include <stdexcept>
+
+namespace vultex
+{
+namespace
+{
+// the most expensive state change in the highest bits, so it changes least often
+[[nodiscard]] std::uint64_t draw_key(const std::uint16_t pipeline,
+                                     const std::uint16_t material,
+                                     const std::uint32_t mesh)
+{
+    return (static_cast<std::uint64_t>(pipeline) << 48U) | (static_cast<std::uint64_t>(material) << 32U) | mesh;
+}
+} // namespace
+
+void DrawBatcher::add(const std::uint16_t pipeline,
+                      const std::uint16_t material,
+                      const std::uint32_t mesh,
+                      const std::uint32_t instance)
+{
+    items.push_back(SortItem{.key = draw_key(pipeline, material, mesh), .value = instance});
+}
+
+void DrawBatcher::clear()
+{
+    items.clear();
+    instances.clear();
+    draw_commands.clear();
+    draw_batches.clear();
+}
+
+void DrawBatcher::build(std::span<const MeshDrawRange> meshes)
+{
+    scratch.resize(items.size());
+    radix_sort(items, scratch);
+
+    instances.clear();
+    draw_commands.clear();
+    draw_batches.clear();
+    instances.reserve(items.size());
+
+    for (std::size_t begin = 0; begin < items.size();)
+    {
+        const auto key = items[begin].key;
+        const auto firstInstance = static_cast<std::uint32_t>(instances.size());
+        auto end = begin;
+        for (; end < items.size() && items[end].key == key; ++end)
+        {
+            instances.push_back(items[end].value);
+        }
+
+        const auto mesh = static_cast<std::uint32_t>(key & 0xFFFFFFFFU);
+        if (mesh >= meshes.size())
+        {
+            throw std::out_of_range(fmt::format("Draw of unknown mesh {}!", mesh));
+        }
+        draw_commands.push_back(VkDrawIndexedIndirectCommand{.indexCount = meshes[mesh].index_count,
+                                                             .instanceCount = static_cast<std::uint32_t>(end - begin),
+                                                             .firstIndex = meshes[mesh].first_index,
+                                                             .vertexOffset = meshes[mesh].vertex_offset,
+                                                             .firstInstance = firstInstance});
+
+        const auto pipeline = static_cast<std::uint16_t>(key >> 48U);
+        const auto material = static_cast<std::uint16_t>(key >> 32U);
+        if (draw_batches.empty() || draw_batches.back().pipeline != pipeline ||
+            draw_batches.back().material != material)
+        {
+            draw_batches.push_back(DrawBatch{.pipeline = pipeline,
+                                             .material = material,
+                                             .first_command = static_cast<std::uint32_t>(draw_commands.size() - 1),
+                                             .command_count = 0});
+        }
+        ++draw_batches.back().command_count;
+        begin = end;
+    }
+}
+
+std::span<const DrawBatch> DrawBatcher::batches() const
+{
+    return draw_batches;
+}
+
+std::span<const VkDrawIndexedIndirectCommand> DrawBatcher::commands() const
+{
+    return draw_commands;
+}
+
+std::span<const std::uint32_t> DrawBatcher::instance_order() const
+{
+    return instances;
+}
+
+std::size_t DrawBatcher::draw_count() const
+{
+    return items.size();
+}
+
+void DrawBatcher::record(VkCommandBuffer command_buffer,
+                         const std::function<void(std::uint16_t pipeline, std::uint16_t material)>& bind) const
+{
+    for (const auto& batch : draw_batches)
+    {
+        bind(batch.pipeline, batch.material);
+        for (const auto& command : std::span{draw_commands}.subspan(batch.first_command, batch.command_count))
+        {
+            vkCmdDrawIndexed(command_buffer,
+                             command.indexCount,
+                             command.instanceCount,
+                             command.firstIndex,
+                             command.vertexOffset,
+                             command.firstInstance);
+        }
+    }
+}
+} // namespace vultex
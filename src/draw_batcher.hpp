@@ -0,0 +1,87 @@
+#pragma once
+
+#define GLFW_INCLUDE_VULKAN
+#include <GLFW/glfw3.h>
+
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <optional>
+#include <span>
+#include <vector>
+
+#include "frame_allocator.hpp"
+#include "radix_sort.hpp"
+
+namespace vultex
+{
+
+// Index range of a mesh in the shared vertex and index buffers
+struct MeshDrawRange
+{
+    std::uint32_t first_index;
+    std::uint32_t index_count;
+    std::int32_t vertex_offset;
+};
+
+// Commands [first_command, first_command + command_count) share the pipeline
+// and the material descriptor set, both are bound once for all of them.
+struct DrawBatch
+{
+    std::uint16_t pipeline;
+    std::uint16_t material;
+    std::uint32_t first_command;
+    std::uint32_t command_count;
+};
+
+// Draw submission of a frame. Draws are sorted by pipeline, material and mesh
+// with a radix sort on a 64 bit key, then draws of the same mesh with the
+// same material are merged into one instanced draw. The instances of a draw
+// are consecutive in instance_order() and its firstInstance points at the
+// first of them, so a vertex shader reads per instance data at
+// gl_InstanceIndex from a storage buffer written by write_instances().
+// Pipelines, materials, meshes and instances are indices into tables of the
+// caller.
+class DrawBatcher
+{
+public:
+    void add(std::uint16_t pipeline, std::uint16_t material, std::uint32_t mesh, std::uint32_t instance);
+    void clear();
+
+    // Sorts and merges everything added since clear()
+    void build(std::span<const MeshDrawRange> meshes);
+
+    [[nodiscard]] std::span<const DrawBatch> batches() const;
+    [[nodiscard]] std::span<const VkDrawIndexedIndirectCommand> commands() const;
+    [[nodiscard]] std::span<const std::uint32_t> instance_order() const;
+    [[nodiscard]] std::size_t draw_count() const;
+
+    // Per instance data in instance order, bound as a dynamic storage buffer
+    template <typename T>
+    [[nodiscard]] std::optional<FrameAllocation> write_instances(FrameAllocator& allocator,
+                                                                 std::span<const T> instance_data) const
+    {
+        auto allocation = allocator.allocate(sizeof(T) * instances.size());
+        if (allocation)
+        {
+            auto* destination = static_cast<T*>(allocation->data);
+            for (const auto instance : instances)
+            {
+                std::memcpy(destination++, &instance_data[instance], sizeof(T));
+            }
+        }
+        return allocation;
+    }
+
+    // bind(pipeline, material) is called once per batch, before its draws
+    void record(VkCommandBuffer command_buffer,
+                const std::function<void(std::uint16_t pipeline, std::uint16_t material)>& bind) const;
+
+private:
+    std::vector<SortItem> items{};
+    std::vector<SortItem> scratch{};
+    std::vector<std::uint32_t> instances{};
+    std::vector<VkDrawIndexedIndirectCommand> draw_commands{};
+    std::vector<DrawBatch> draw_batches{};
+};
+} // namespace vultex
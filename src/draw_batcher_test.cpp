@@ -0,0 +1,121 @@
+#include "draw_batcher.hpp"
+
+#include <algorithm>
+#include <cstdint>
+#include <gtest/gtest.h>
+#include <map>
+#include <random>
+#include <stdexcept>
+#include <tuple>
+#include <vector>
+
+namespace vultex
+{
+namespace
+{
+const std::vector<MeshDrawRange> meshes{MeshDrawRange{.first_index = 0, .index_count = 36, .vertex_offset = 0},
+                                        MeshDrawRange{.first_index = 36, .index_count = 6, .vertex_offset = 24},
+                                        MeshDrawRange{.first_index = 42, .index_count = 960, .vertex_offset = 28}};
+
+TEST(DrawBatcher, MergesDrawsOfTheSameMeshAndMaterial)
+{
+    DrawBatcher batcher{};
+    batcher.add(1, 0, 2, 10);
+    batcher.add(0, 3, 1, 11);
+    batcher.add(1, 0, 2, 12);
+    batcher.add(0, 3, 1, 13);
+    batcher.add(0, 3, 0, 14);
+    batcher.add(0, 4, 1, 15);
+    batcher.build(meshes);
+
+    EXPECT_EQ(batcher.draw_count(), 6U);
+    // sorted by pipeline, material, mesh; instances in the order they were added
+    EXPECT_EQ((std::vector<std::uint32_t>{batcher.instance_order().begin(), batcher.instance_order().end()}),
+              (std::vector<std::uint32_t>{14, 11, 13, 15, 10, 12}));
+
+    const auto commands = batcher.commands();
+    ASSERT_EQ(commands.size(), 4U);
+    const std::vector<std::tuple<std::uint32_t, std::uint32_t, std::uint32_t, std::int32_t, std::uint32_t>> expected{
+        {36, 1, 0, 0, 0}, {6, 2, 36, 24, 1}, {6, 1, 36, 24, 3}, {960, 2, 42, 28, 4}};
+    for (std::size_t index = 0; index < commands.size(); ++index)
+    {
+        const auto& command = commands[index];
+        EXPECT_EQ(std::tuple(command.indexCount,
+                             command.instanceCount,
+                             command.firstIndex,
+                             command.vertexOffset,
+                             command.firstInstance),
+                  expected[index])
+            << index;
+    }
+
+    const auto batches = batcher.batches();
+    ASSERT_EQ(batches.size(), 3U);
+    EXPECT_EQ(std::tuple(batches[0].pipeline, batches[0].material, batches[0].first_command, batches[0].command_count),
+              std::tuple(std::uint16_t{0}, std::uint16_t{3}, 0U, 2U));
+    EXPECT_EQ(std::tuple(batches[1].pipeline, batches[1].material, batches[1].first_command, batches[1].command_count),
+              std::tuple(std::uint16_t{0}, std::uint16_t{4}, 2U, 1U));
+    EXPECT_EQ(std::tuple(batches[2].pipeline, batches[2].material, batches[2].first_command, batches[2].command_count),
+              std::tuple(std::uint16_t{1}, std::uint16_t{0}, 3U, 1U));
+}
+
+TEST(DrawBatcher, EveryDrawIsCoveredOnce)
+{
+    // random draws, every (pipeline, material, mesh) gets one command with all of its instances
+    std::mt19937 random{11};
+    std::map<std::tuple<std::uint16_t, std::uint16_t, std::uint32_t>, std::vector<std::uint32_t>> draws{};
+    DrawBatcher batcher{};
+    for (std::uint32_t instance = 0; instance < 5000; ++instance)
+    {
+        const auto pipeline = static_cast<std::uint16_t>(random() % 4);
+        const auto material = static_cast<std::uint16_t>(random() % 300);
+        const auto mesh = static_cast<std::uint32_t>(random() % meshes.size());
+        batcher.add(pipeline, material, mesh, instance);
+        draws[{pipeline, material, mesh}].push_back(instance);
+    }
+    batcher.build(meshes);
+
+    ASSERT_EQ(batcher.commands().size(), draws.size());
+    std::uint32_t command = 0;
+    for (const auto& batch : batcher.batches())
+    {
+        EXPECT_EQ(batch.first_command, command);
+        for (std::uint32_t index = 0; index < batch.command_count; ++index, ++command)
+        {
+            const auto& drawCommand = batcher.commands()[command];
+            const auto mesh = static_cast<std::uint32_t>(
+                std::find_if(meshes.begin(),
+                             meshes.end(),
+                             [&](const MeshDrawRange& range) { return range.first_index == drawCommand.firstIndex; }) -
+                meshes.begin());
+            const auto instances =
+                batcher.instance_order().subspan(drawCommand.firstInstance, drawCommand.instanceCount);
+            EXPECT_EQ((std::vector<std::uint32_t>{instances.begin(), instances.end()}),
+                      (draws[{batch.pipeline, batch.material, mesh}]));
+        }
+    }
+    EXPECT_EQ(command, batcher.commands().size());
+    EXPECT_EQ(batcher.instance_order().size(), 5000U);
+}
+
+TEST(DrawBatcher, ClearStartsAnEmptyFrame)
+{
+    DrawBatcher batcher{};
+    batcher.add(0, 0, 0, 0);
+    batcher.build(meshes);
+    batcher.clear();
+    batcher.build(meshes);
+    EXPECT_EQ(batcher.draw_count(), 0U);
+    EXPECT_TRUE(batcher.commands().empty());
+    EXPECT_TRUE(batcher.batches().empty());
+    EXPECT_TRUE(batcher.instance_order().empty());
+}
+
+TEST(DrawBatcher, UnknownMeshThrows)
+{
+    DrawBatcher batcher{};
+    batcher.add(0, 0, 3, 0);
+    EXPECT_THROW(batcher.build(meshes), std::out_of_range);
+}
+} // namespace
+} // namespace vultex
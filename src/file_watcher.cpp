@@ -0,0 +1,118 @@
+#include "file_watcher.hpp"
+
+#include <algorithm>
+#include <array>
+#include <spdlog/spdlog.h>
+#include <system_error>
+
+#ifdef __linux__
+#include <sys/inotify.h>
+#include <unistd.h>
+#endif
+
+namespace vultex
+{
+
+FileWatcher::FileWatcher()
+{
+#ifdef __linux__
+    inotify_fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    if (-1 == inotify_fd)
+    {
+        spdlog::warn("Cannot initialize inotify, file changes are not detected");
+    }
+#endif
+}
+
+FileWatcher::~FileWatcher()
+{
+#ifdef __linux__
+    if (-1 != inotify_fd)
+    {
+        close(inotify_fd);
+    }
+#endif
+}
+
+void FileWatcher::watch(const std::filesystem::path& file)
+{
+    std::error_code error{};
+    const auto path = std::filesystem::weakly_canonical(file, error);
+    if (files.contains(path))
+    {
+        return;
+    }
+    files[path] = std::filesystem::last_write_time(path, error);
+
+#ifdef __linux__
+    const auto directory = path.parent_path();
+    const auto already_watched = std::ranges::any_of(
+        watched_directories, [&directory](const auto& watched) { return watched.second == directory; });
+
+    if (-1 != inotify_fd && !already_watched)
+    {
+        const auto descriptor =
+            inotify_add_watch(inotify_fd, directory.c_str(), IN_CLOSE_WRITE | IN_MOVED_TO | IN_CREATE);
+        if (-1 == descriptor)
+        {
+            spdlog::warn("Cannot watch directory: {}", directory.string());
+            return;
+        }
+        watched_directories[descriptor] = directory;
+    }
+#endif
+}
+
+std::vector<std::filesystem::path> FileWatcher::poll()
+{
+    std::vector<std::filesystem::path> changed{};
+    const auto mark_changed = [&changed](const std::filesystem::path& path)
+    {
+        if (std::ranges::find(changed, path) == changed.end())
+        {
+            changed.push_back(path);
+        }
+    };
+
+#ifdef __linux__
+    if (-1 != inotify_fd)
+    {
+        alignas(inotify_event) std::array<char, 4096> buffer{};
+        for (auto length = read(inotify_fd, buffer.data(), buffer.size()); length > 0;
+             length = read(inotify_fd, buffer.data(), buffer.size()))
+        {
+            for (auto offset = 0L; offset < length;)
+            {
+                const auto* event = reinterpret_cast<const inotify_event*>(std::next(buffer.data(), offset));
+                offset += static_cast<long>(sizeof(inotify_event) + event->len);
+
+                const auto directory = watched_directories.find(event->wd);
+                if (0 == event->len || directory == watched_directories.end())
+                {
+                    continue;
+                }
+
+                const auto path = directory->second / event->name;
+                if (files.contains(path))
+                {
+                    mark_changed(path);
+                }
+            }
+        }
+        return changed;
+    }
+#endif
+
+    for (auto& [path, last_write_time] : files)
+    {
+        std::error_code error{};
+        const auto current_write_time = std::filesystem::last_write_time(path, error);
+        if (!error && current_write_time != last_write_time)
+        {
+            last_write_time = current_write_time;
+            mark_changed(path);
+        }
+    }
+    return changed;
+}
+} // namespace vultex
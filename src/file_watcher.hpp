@@ -0,0 +1,35 @@
+#pragma once
+
+#include <filesystem>
+#include <map>
+#include <vector>
+
+namespace vultex
+{
+
+// Reports files modified since the last poll. On Linux directories of the
+// watched files are observed with inotify (editors often save by renaming a
+// temporary file), elsewhere modification times are compared.
+class FileWatcher
+{
+public:
+    FileWatcher();
+    FileWatcher(const FileWatcher&) = delete;
+    FileWatcher(FileWatcher&&) = delete;
+    FileWatcher& operator=(const FileWatcher&) = delete;
+    FileWatcher& operator=(FileWatcher&&) = delete;
+    ~FileWatcher();
+
+    void watch(const std::filesystem::path& file);
+
+    // non blocking, safe to call every frame
+    [[nodiscard]] std::vector<std::filesystem::path> poll();
+
+private:
+    std::map<std::filesystem::path, std::filesystem::file_time_type> files{};
+#ifdef __linux__
+    int inotify_fd{-1};
+    std::map<int, std::filesystem::path> watched_directories{};
+#endif
+};
+} // namespace vultex
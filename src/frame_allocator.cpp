@@ -0,0 +1,114 @@
+#include "frame_allocator.hpp"
+
+#include <algorithm>
+#include <iterator>
+#include <spdlog/spdlog.h>
+#include <stdexcept>
+
+#include "host_allocator.hpp"
+#include "vulkan_memory.hpp"
+
+namespace vultex
+{
+FrameAllocator::FrameAllocator(VkPhysicalDevice physical_device,
+                               VkDevice logical_device,
+                               const VkDeviceSize frame_size,
+                               const std::uint32_t frame_count)
+    : logical_device{logical_device}
+{
+    VkPhysicalDeviceProperties properties{};
+    vkGetPhysicalDeviceProperties(physical_device, &properties);
+
+    // every allocation can be bound as an uniform or a storage dynamic offset
+    alignment = std::max({properties.limits.minUniformBufferOffsetAlignment,
+                          properties.limits.minStorageBufferOffsetAlignment,
+                          VkDeviceSize{16}});
+    this->frame_size = align_up(frame_size, alignment);
+
+    const VkBufferCreateInfo bufferInfo{.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO,
+                                        .size = this->frame_size * frame_count,
+                                        .usage = VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT |
+                                                 VK_BUFFER_USAGE_STORAGE_BUFFER_BIT |
+                                                 VK_BUFFER_USAGE_VERTEX_BUFFER_BIT | VK_BUFFER_USAGE_INDEX_BUFFER_BIT,
+                                        .sharingMode = VK_SHARING_MODE_EXCLUSIVE};
+
+    if (VK_SUCCESS != vkCreateBuffer(logical_device, &bufferInfo, allocation_callbacks(), &frames_buffer))
+    {
+        throw std::runtime_error("Failed to create frame buffer!");
+    }
+
+    VkMemoryRequirements requirements{};
+    vkGetBufferMemoryRequirements(logical_device, frames_buffer, &requirements);
+
+    // device local host visible memory (UMA, resizable BAR) saves a PCIe read per access
+    const auto memoryType =
+        find_memory_type(physical_device,
+                         requirements.memoryTypeBits,
+                         {VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT | VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT |
+                              VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
+                          VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT});
+    if (!memoryType)
+    {
+        throw std::runtime_error("Cannot find host visible memory for frame buffer!");
+    }
+
+    const VkMemoryAllocateInfo allocateInfo{.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO,
+                                            .allocationSize = requirements.size,
+                                            .memoryTypeIndex = memoryType.value()};
+
+    if (VK_SUCCESS != vkAllocateMemory(logical_device, &allocateInfo, allocation_callbacks(), &memory))
+    {
+        throw std::runtime_error("Failed to allocate frame buffer memory!");
+    }
+    vkBindBufferMemory(logical_device, frames_buffer, memory, 0);
+
+    // persistently mapped, coherent memory needs no flush
+    void* data{nullptr};
+    if (VK_SUCCESS != vkMapMemory(logical_device, memory, 0, VK_WHOLE_SIZE, 0, &data))
+    {
+        throw std::runtime_error("Failed to map frame buffer memory!");
+    }
+    mapped = static_cast<std::byte*>(data);
+
+    spdlog::info("Frame allocator: {} frames of {} bytes, alignment {}", frame_count, this->frame_size, alignment);
+}
+
+FrameAllocator::~FrameAllocator()
+{
+    vkUnmapMemory(logical_device, memory);
+    vkDestroyBuffer(logical_device, frames_buffer, allocation_callbacks());
+    vkFreeMemory(logical_device, memory, allocation_callbacks());
+}
+
+void FrameAllocator::begin_frame(const std::uint32_t frame_index)
+{
+    frame_begin = frame_index * frame_size;
+    head.store(0, std::memory_order_relaxed);
+}
+
+std::optional<FrameAllocation> FrameAllocator::allocate(const VkDeviceSize size)
+{
+    // sizes are rounded up, so every offset stays aligned
+    const auto aligned_size = align_up(size, alignment);
+    const auto offset = head.fetch_add(aligned_size, std::memory_order_relaxed);
+    if (offset + aligned_size > frame_size)
+    {
+        spdlog::warn("Frame allocator exhausted, {} bytes requested", size);
+        return std::nullopt;
+    }
+
+    return FrameAllocation{.buffer = frames_buffer,
+                           .offset = frame_begin + offset,
+                           .data = std::next(mapped, static_cast<std::ptrdiff_t>(frame_begin + offset))};
+}
+
+VkBuffer FrameAllocator::buffer() const
+{
+    return frames_buffer;
+}
+
+VkDeviceSize FrameAllocator::used() const
+{
+    return std::min(head.load(std::memory_order_relaxed), frame_size);
+}
+} // namespace vultex
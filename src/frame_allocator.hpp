@@ -0,0 +1,74 @@
+#pragma once
+
+#define GLFW_INCLUDE_VULKAN
+#include <GLFW/glfw3.h>
+
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <optional>
+
+namespace vultex
+{
+
+struct FrameAllocation
+{
+    VkBuffer buffer;
+    VkDeviceSize offset;
+    void* data;
+
+    // for VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC / STORAGE_BUFFER_DYNAMIC
+    [[nodiscard]] std::uint32_t dynamic_offset() const
+    {
+        return static_cast<std::uint32_t>(offset);
+    }
+};
+
+// Uniforms and dynamic vertex data of a frame. One host visible buffer is
+// mapped once at creation and split into a region per frame in flight, an
+// allocation is a bump of an atomic offset so workers can record in
+// parallel. Nothing is created nor mapped in the frame loop.
+class FrameAllocator
+{
+public:
+    FrameAllocator(VkPhysicalDevice physical_device,
+                   VkDevice logical_device,
+                   VkDeviceSize frame_size,
+                   std::uint32_t frame_count);
+    FrameAllocator(const FrameAllocator&) = delete;
+    FrameAllocator(FrameAllocator&&) = delete;
+    FrameAllocator& operator=(const FrameAllocator&) = delete;
+    FrameAllocator& operator=(FrameAllocator&&) = delete;
+    ~FrameAllocator();
+
+    // region of the frame is reused, GPU must have finished with it
+    void begin_frame(std::uint32_t frame_index);
+
+    // std::nullopt when the frame region is exhausted
+    [[nodiscard]] std::optional<FrameAllocation> allocate(VkDeviceSize size);
+
+    template <typename T>
+    [[nodiscard]] std::optional<FrameAllocation> push(const T& value)
+    {
+        auto allocation = allocate(sizeof(T));
+        if (allocation)
+        {
+            std::memcpy(allocation->data, &value, sizeof(T));
+        }
+        return allocation;
+    }
+
+    [[nodiscard]] VkBuffer buffer() const;
+    [[nodiscard]] VkDeviceSize used() const;
+
+private:
+    VkDevice logical_device{nullptr};
+    VkBuffer frames_buffer{nullptr};
+    VkDeviceMemory memory{nullptr};
+    std::byte* mapped{nullptr};
+    VkDeviceSize alignment{1};
+    VkDeviceSize frame_size{0};
+    VkDeviceSize frame_begin{0};
+    std::atomic<VkDeviceSize> head{0};
+};
+} // namespace vultex
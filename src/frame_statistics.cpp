@@ -0,0 +1,423 @@
+#include "frame_statistics.hpp"
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cmath>
+#include <fmt/format.h>
+#include <fmt/ostream.h>
+#include <spdlog/spdlog.h>
+#include <utility>
+
+namespace vultex
+{
+namespace
+{
+double to_ms(const std::chrono::nanoseconds duration)
+{
+    return std::chrono::duration<double, std::milli>(duration).count();
+}
+
+std::string summary(const LatencyHistogram& histogram)
+{
+    return fmt::format("p50 {:.2f} p95 {:.2f} p99 {:.2f} max {:.2f} ms",
+                       to_ms(histogram.percentile(50.0)),
+                       to_ms(histogram.percentile(95.0)),
+                       to_ms(histogram.percentile(99.0)),
+                       to_ms(histogram.max()));
+}
+
+// names are strings of the caller, they may contain anything
+std::string json_string(const std::string_view text)
+{
+    std::string quoted{"\""};
+    for (const auto character : text)
+    {
+        switch (character)
+        {
+        case '"':
+            quoted += "\\\"";
+            break;
+        case '\\':
+            quoted += "\\\\";
+            break;
+        case '\n':
+            quoted += "\\n";
+            break;
+        default:
+            if (static_cast<unsigned char>(character) < 0x20)
+            {
+                quoted += fmt::format("\\u{:04x}", static_cast<unsigned>(character));
+            }
+            else
+            {
+                quoted += character;
+            }
+        }
+    }
+    return quoted + '"';
+}
+
+void write_histogram(std::ostream& out, const std::string_view name, const LatencyHistogram& histogram)
+{
+    fmt::print(out,
+               "    {}: {{\"count\": {}, \"p50_ms\": {}, \"p95_ms\": {}, \"p99_ms\": {}, \"max_ms\": {}}}",
+               json_string(name),
+               histogram.count(),
+               to_ms(histogram.percentile(50.0)),
+               to_ms(histogram.percentile(95.0)),
+               to_ms(histogram.percentile(99.0)),
+               to_ms(histogram.max()));
+}
+
+// hitch sources by bit, cpu time first
+constexpr std::array<std::string_view, 8> hitch_sources{
+    "", "cpu", "gpu", "cpu, gpu", "present", "cpu, present", "gpu, present", "cpu, gpu, present"};
+
+// later frames are measured in order, so a time of the frame is not coming once a later frame has one
+bool is_pending(const std::optional<std::chrono::nanoseconds>& time,
+                const std::optional<std::uint64_t>& last_measured_frame,
+                const std::uint64_t frame)
+{
+    return !time && last_measured_frame && *last_measured_frame <= frame;
+}
+
+std::string optional_ms(const std::optional<std::chrono::nanoseconds>& duration)
+{
+    return duration ? fmt::format("{}", to_ms(*duration)) : "null";
+}
+} // namespace
+
+std::span<const GpuCounterValue> FrameSample::counters_of(const GpuPassTime& pass) const
+{
+    return std::span{gpu_counters}.subspan(pass.first_counter, pass.counter_count);
+}
+
+void LatencyHistogram::record(const std::chrono::nanoseconds value)
+{
+    const auto nanoseconds = static_cast<std::uint64_t>(std::max<std::int64_t>(value.count(), 0));
+    ++buckets[bucket_index(nanoseconds)];
+    ++total;
+    max_value = std::max(max_value, nanoseconds);
+}
+
+void LatencyHistogram::reset()
+{
+    buckets.fill(0);
+    total = 0;
+    max_value = 0;
+}
+
+std::chrono::nanoseconds LatencyHistogram::percentile(const double percent) const
+{
+    if (0 == total)
+    {
+        return {};
+    }
+
+    const auto rank = std::max<std::uint64_t>(
+        1, static_cast<std::uint64_t>(std::ceil(std::clamp(percent, 0.0, 100.0) / 100.0 * static_cast<double>(total))));
+    std::uint64_t seen = 0;
+    for (std::size_t index = 0; index < buckets.size(); ++index)
+    {
+        seen += buckets[index];
+        if (seen >= rank)
+        {
+            // the bucket bound can overshoot the largest recorded value
+            return std::chrono::nanoseconds{std::min(bucket_upper_bound(index), max_value)};
+        }
+    }
+    return std::chrono::nanoseconds{max_value};
+}
+
+std::chrono::nanoseconds LatencyHistogram::max() const
+{
+    return std::chrono::nanoseconds{max_value};
+}
+
+std::uint64_t LatencyHistogram::count() const
+{
+    return total;
+}
+
+// Values below 2^sub_bucket_bits map to themselves. Larger ones keep their
+// sub_bucket_bits most significant bits, shifted right by `shift`, and every
+// shift adds half of the sub-buckets, the upper half of the previous range.
+std::size_t LatencyHistogram::bucket_index(const std::uint64_t value)
+{
+    constexpr auto half = std::uint64_t{1} << (sub_bucket_bits - 1);
+    const auto clamped = std::min(value, (std::uint64_t{1} << max_value_bits) - 1);
+    const auto bits = static_cast<unsigned>(std::bit_width(clamped));
+    if (bits <= sub_bucket_bits)
+    {
+        return static_cast<std::size_t>(clamped);
+    }
+    const auto shift = bits - sub_bucket_bits;
+    return static_cast<std::size_t>(shift * half + (clamped >> shift));
+}
+
+std::uint64_t LatencyHistogram::bucket_upper_bound(const std::size_t index)
+{
+    constexpr auto half = std::size_t{1} << (sub_bucket_bits - 1);
+    if (index < 2 * half)
+    {
+        return index;
+    }
+    const auto shift = index / half - 1;
+    const auto sub_bucket = static_cast<std::uint64_t>(index - shift * half);
+    return ((sub_bucket + 1) << shift) - 1;
+}
+
+void FrameStatistics::Metric::record(const std::chrono::nanoseconds value)
+{
+    interval.record(value);
+    total.record(value);
+}
+
+FrameStatistics::FrameStatistics(const FrameStatisticsSettings settings)
+    : settings{settings}, last_summary{std::chrono::steady_clock::now()}
+{
+}
+
+std::uint64_t FrameStatistics::begin_frame()
+{
+    // the frame leaving the ring is checked with the times it got
+    if (next_frame >= history_size)
+    {
+        check_hitches(next_frame - history_size + 1, true);
+    }
+
+    auto& sample = history[next_frame % history_size];
+    sample.frame = next_frame;
+    sample.cpu_time = {};
+    sample.gpu_time.reset();
+    sample.present_latency.reset();
+    // keeps the capacity, passes stop allocating once the ring went around
+    sample.passes.clear();
+    sample.gpu_passes.clear();
+    sample.gpu_counters.clear();
+
+    frame_start = std::chrono::steady_clock::now();
+    return next_frame;
+}
+
+void FrameStatistics::record_pass(const std::string_view name, const std::chrono::nanoseconds duration)
+{
+    history[next_frame % history_size].passes.push_back(PassTime{.name = name, .duration = duration});
+}
+
+void FrameStatistics::end_frame()
+{
+    const auto now = std::chrono::steady_clock::now();
+    auto& sample = history[next_frame % history_size];
+    sample.cpu_time = now - frame_start;
+    ++next_frame;
+
+    cpu_time.record(sample.cpu_time);
+    check_hitches(next_frame, false);
+
+    if (now - last_summary >= settings.summary_interval)
+    {
+        log_interval_summary();
+        last_summary = now;
+    }
+}
+
+void FrameStatistics::record_gpu_pass(const std::uint64_t frame,
+                                      const std::string_view name,
+                                      const std::chrono::nanoseconds duration,
+                                      const std::span<const GpuCounterValue> counters)
+{
+    auto* sample = find_sample(frame);
+    if (nullptr == sample)
+    {
+        return;
+    }
+
+    sample->gpu_passes.push_back(GpuPassTime{.name = name,
+                                             .duration = duration,
+                                             .first_counter = static_cast<std::uint32_t>(sample->gpu_counters.size()),
+                                             .counter_count = static_cast<std::uint32_t>(counters.size())});
+    sample->gpu_counters.insert(sample->gpu_counters.end(), counters.begin(), counters.end());
+}
+
+void FrameStatistics::record_gpu_time(const std::uint64_t frame, const std::chrono::nanoseconds duration)
+{
+    gpu_time.record(duration);
+    last_gpu_frame = std::max(last_gpu_frame.value_or(0), frame);
+    if (auto* sample = find_sample(frame); nullptr != sample)
+    {
+        sample->gpu_time = duration;
+    }
+    check_hitches(next_frame, false);
+}
+
+void FrameStatistics::record_present_latency(const std::uint64_t frame, const std::chrono::nanoseconds latency)
+{
+    present_latency.record(latency);
+    last_present_frame = std::max(last_present_frame.value_or(0), frame);
+    if (auto* sample = find_sample(frame); nullptr != sample)
+    {
+        sample->present_latency = latency;
+    }
+    check_hitches(next_frame, false);
+}
+
+void FrameStatistics::on_hitch(std::function<void(const HitchEvent&)> callback)
+{
+    hitch_callbacks.push_back(std::move(callback));
+}
+
+const FrameSample* FrameStatistics::sample(const std::uint64_t frame) const
+{
+    const auto& sample = history[frame % history_size];
+    return frame < next_frame && sample.frame == frame ? &sample : nullptr;
+}
+
+const LatencyHistogram& FrameStatistics::cpu_time_histogram() const
+{
+    return cpu_time.total;
+}
+
+const LatencyHistogram& FrameStatistics::gpu_time_histogram() const
+{
+    return gpu_time.total;
+}
+
+void FrameStatistics::log_summary() const
+{
+    spdlog::info("Frame statistics: {} frames, {} hitches over {:.1f} ms",
+                 next_frame,
+                 total_hitches,
+                 to_ms(settings.hitch_threshold));
+    spdlog::info("  cpu {}", summary(cpu_time.total));
+    if (0 != gpu_time.total.count())
+    {
+        spdlog::info("  gpu {}", summary(gpu_time.total));
+    }
+    if (0 != present_latency.total.count())
+    {
+        spdlog::info("  present latency {}", summary(present_latency.total));
+    }
+}
+
+void FrameStatistics::write_json(std::ostream& out) const
+{
+    fmt::print(out, "{{\n  \"frames\": {},\n  \"hitches\": {},\n", next_frame, total_hitches);
+    fmt::print(out, "  \"hitch_threshold_ms\": {},\n  \"histograms\": {{\n", to_ms(settings.hitch_threshold));
+    write_histogram(out, "cpu_time", cpu_time.total);
+    fmt::print(out, ",\n");
+    write_histogram(out, "gpu_time", gpu_time.total);
+    fmt::print(out, ",\n");
+    write_histogram(out, "present_latency", present_latency.total);
+    fmt::print(out, "\n  }},\n  \"recent_frames\": [");
+
+    // oldest first, the frame in progress is skipped
+    const auto first = next_frame > history_size ? next_frame - history_size : 0;
+    for (auto frame = first; frame < next_frame; ++frame)
+    {
+        const auto& sample = history[frame % history_size];
+        fmt::print(out,
+                   "{}\n    {{\"frame\": {}, \"cpu_ms\": {}, \"gpu_ms\": {}, "
+                   "\"present_latency_ms\": {}, \"passes\": {{",
+                   frame == first ? "" : ",",
+                   sample.frame,
+                   to_ms(sample.cpu_time),
+                   optional_ms(sample.gpu_time),
+                   optional_ms(sample.present_latency));
+        for (std::size_t index = 0; index < sample.passes.size(); ++index)
+        {
+            fmt::print(out,
+                       "{}{}: {}",
+                       0 == index ? "" : ", ",
+                       json_string(sample.passes[index].name),
+                       to_ms(sample.passes[index].duration));
+        }
+        fmt::print(out, "}}, \"gpu_passes\": {{");
+        for (std::size_t index = 0; index < sample.gpu_passes.size(); ++index)
+        {
+            const auto& pass = sample.gpu_passes[index];
+            fmt::print(
+                out, "{}{}: {{\"ms\": {}", 0 == index ? "" : ", ", json_string(pass.name), to_ms(pass.duration));
+            for (const auto& counter : sample.counters_of(pass))
+            {
+                fmt::print(out, ", {}: {}", json_string(counter.name), counter.value);
+            }
+            fmt::print(out, "}}");
+        }
+        fmt::print(out, "}}}}");
+    }
+    fmt::print(out, "\n  ]\n}}\n");
+}
+
+FrameStatistics::ScopedPass::ScopedPass(FrameStatistics& statistics, const std::string_view name)
+    : statistics{statistics}, name{name}, start{std::chrono::steady_clock::now()}
+{
+}
+
+FrameStatistics::ScopedPass::~ScopedPass()
+{
+    statistics.record_pass(name, std::chrono::steady_clock::now() - start);
+}
+
+FrameStatistics::ScopedPass FrameStatistics::time_pass(const std::string_view name)
+{
+    return ScopedPass{*this, name};
+}
+
+FrameSample* FrameStatistics::find_sample(const std::uint64_t frame)
+{
+    return const_cast<FrameSample*>(std::as_const(*this).sample(frame));
+}
+
+void FrameStatistics::check_hitches(const std::uint64_t end, const bool force)
+{
+    for (; next_hitch_check < end; ++next_hitch_check)
+    {
+        const auto& sample = history[next_hitch_check % history_size];
+        if (!force && (is_pending(sample.gpu_time, last_gpu_frame, sample.frame) ||
+                       is_pending(sample.present_latency, last_present_frame, sample.frame)))
+        {
+            return;
+        }
+        check_hitch(sample);
+    }
+}
+
+void FrameStatistics::check_hitch(const FrameSample& sample)
+{
+    const auto over = [this](const std::optional<std::chrono::nanoseconds>& time)
+    { return time && *time > settings.hitch_threshold; };
+    const auto sources = (over(sample.cpu_time) ? 1U : 0U) | (over(sample.gpu_time) ? 2U : 0U) |
+                         (over(sample.present_latency) ? 4U : 0U);
+    if (0 == sources)
+    {
+        return;
+    }
+
+    ++interval_hitches;
+    ++total_hitches;
+    for (const auto& callback : hitch_callbacks)
+    {
+        callback(HitchEvent{.sample = sample, .source = hitch_sources.at(sources)});
+    }
+}
+
+void FrameStatistics::log_interval_summary()
+{
+    spdlog::info("Frames {}: cpu {}, {} hitches", next_frame, summary(cpu_time.interval), interval_hitches);
+    if (0 != gpu_time.interval.count())
+    {
+        spdlog::info("Frames {}: gpu {}", next_frame, summary(gpu_time.interval));
+    }
+    if (0 != present_latency.interval.count())
+    {
+        spdlog::info("Frames {}: present latency {}", next_frame, summary(present_latency.interval));
+    }
+
+    cpu_time.interval.reset();
+    gpu_time.interval.reset();
+    present_latency.interval.reset();
+    interval_hitches = 0;
+}
+} // namespace vultex
@@ -0,0 +1,193 @@
+#pragma once
+
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <optional>
+#include <ostream>
+#include <span>
+#include <string_view>
+#include <vector>
+
+namespace vultex
+{
+
+// Log-linear histogram of durations in the spirit of HdrHistogram. Every
+// power of two range is split into linear sub-buckets, so percentiles have a
+// bounded relative error (about 3%) with a fixed 4.6 KB footprint and
+// recording never allocates.
+class LatencyHistogram
+{
+public:
+    void record(std::chrono::nanoseconds value);
+    void reset();
+
+    // highest duration not larger than percentile of the recorded values, with
+    // the precision of its bucket; 0 when nothing was recorded
+    [[nodiscard]] std::chrono::nanoseconds percentile(double percent) const;
+
+    // exact, not rounded to a bucket
+    [[nodiscard]] std::chrono::nanoseconds max() const;
+    [[nodiscard]] std::uint64_t count() const;
+
+private:
+    static constexpr unsigned sub_bucket_bits = 6;
+    static constexpr unsigned max_value_bits = 40; // ~18 minutes
+    static constexpr std::size_t bucket_count =
+        (max_value_bits - sub_bucket_bits + 1) * (1U << (sub_bucket_bits - 1)) + (1U << (sub_bucket_bits - 1));
+
+    [[nodiscard]] static std::size_t bucket_index(std::uint64_t value);
+    [[nodiscard]] static std::uint64_t bucket_upper_bound(std::size_t index);
+
+    std::array<std::uint32_t, bucket_count> buckets{};
+    std::uint64_t total{0};
+    std::uint64_t max_value{0};
+};
+
+struct PassTime
+{
+    // has to outlive the statistics, pass a string literal
+    std::string_view name;
+    std::chrono::nanoseconds duration;
+};
+
+struct GpuCounterValue
+{
+    // has to outlive the statistics, like pass names
+    std::string_view name;
+    double value;
+};
+
+struct GpuPassTime
+{
+    std::string_view name;
+    std::chrono::nanoseconds duration;
+    // range in FrameSample::gpu_counters
+    std::uint32_t first_counter;
+    std::uint32_t counter_count;
+};
+
+struct FrameSample
+{
+    std::uint64_t frame{0};
+    std::chrono::nanoseconds cpu_time{};
+    std::optional<std::chrono::nanoseconds> gpu_time{};
+    std::optional<std::chrono::nanoseconds> present_latency{};
+    std::vector<PassTime> passes{};
+    std::vector<GpuPassTime> gpu_passes{};
+    std::vector<GpuCounterValue> gpu_counters{};
+
+    [[nodiscard]] std::span<const GpuCounterValue> counters_of(const GpuPassTime& pass) const;
+};
+
+// once per frame, when all of its times are known
+struct HitchEvent
+{
+    const FrameSample& sample;
+    // the measured times over the threshold, e.g. "cpu, gpu"
+    std::string_view source;
+};
+
+struct FrameStatisticsSettings
+{
+    std::chrono::nanoseconds hitch_threshold{std::chrono::milliseconds{33}};
+    std::chrono::nanoseconds summary_interval{std::chrono::seconds{10}};
+};
+
+// Frame time SLO tracking of the run loop. The last frames are kept in a
+// fixed ring together with their pass breakdown, the distributions go to
+// LatencyHistograms. GPU time and present latency are known only frames
+// later, they are attached to the sample by its frame number; a frame is
+// checked for a hitch once the times of a later frame arrived (by its CPU
+// time alone before the first GPU time or present latency).
+// Not thread safe, every call comes from the thread running the frame loop.
+class FrameStatistics
+{
+public:
+    static constexpr std::size_t history_size = 512;
+
+    explicit FrameStatistics(FrameStatisticsSettings settings = {});
+    FrameStatistics(const FrameStatistics&) = delete;
+    FrameStatistics(FrameStatistics&&) = delete;
+    FrameStatistics& operator=(const FrameStatistics&) = delete;
+    FrameStatistics& operator=(FrameStatistics&&) = delete;
+    ~FrameStatistics() = default;
+
+    // Starts the CPU timer of the next frame, returns its frame number
+    std::uint64_t begin_frame();
+    void record_pass(std::string_view name, std::chrono::nanoseconds duration);
+    // Stops the CPU timer, checks for a hitch and logs the summary when due
+    void end_frame();
+
+    // ignored when the frame already left the ring
+    void record_gpu_pass(std::uint64_t frame,
+                         std::string_view name,
+                         std::chrono::nanoseconds duration,
+                         std::span<const GpuCounterValue> counters);
+    // GPU passes of the frame have to be recorded before, hitch callbacks see them
+    void record_gpu_time(std::uint64_t frame, std::chrono::nanoseconds duration);
+    void record_present_latency(std::uint64_t frame, std::chrono::nanoseconds latency);
+
+    void on_hitch(std::function<void(const HitchEvent&)> callback);
+
+    // nullptr when the frame already left the ring or didn't start yet
+    [[nodiscard]] const FrameSample* sample(std::uint64_t frame) const;
+    [[nodiscard]] const LatencyHistogram& cpu_time_histogram() const;
+    [[nodiscard]] const LatencyHistogram& gpu_time_histogram() const;
+
+    void log_summary() const;
+    // percentiles over the whole run and the frames still in the ring
+    void write_json(std::ostream& out) const;
+
+    // records the duration of its scope as a pass of the current frame
+    class ScopedPass
+    {
+    public:
+        ScopedPass(FrameStatistics& statistics, std::string_view name);
+        ScopedPass(const ScopedPass&) = delete;
+        ScopedPass(ScopedPass&&) = delete;
+        ScopedPass& operator=(const ScopedPass&) = delete;
+        ScopedPass& operator=(ScopedPass&&) = delete;
+        ~ScopedPass();
+
+    private:
+        FrameStatistics& statistics;
+        std::string_view name;
+        std::chrono::steady_clock::time_point start;
+    };
+
+    [[nodiscard]] ScopedPass time_pass(std::string_view name);
+
+private:
+    struct Metric
+    {
+        LatencyHistogram interval{};
+        LatencyHistogram total{};
+
+        void record(std::chrono::nanoseconds value);
+    };
+
+    [[nodiscard]] FrameSample* find_sample(std::uint64_t frame);
+    // frames before end, waiting for their GPU time and present latency unless forced
+    void check_hitches(std::uint64_t end, bool force);
+    void check_hitch(const FrameSample& sample);
+    void log_interval_summary();
+
+    FrameStatisticsSettings settings;
+    std::array<FrameSample, history_size> history{};
+    std::uint64_t next_frame{0};
+    std::chrono::steady_clock::time_point frame_start{};
+    std::chrono::steady_clock::time_point last_summary{};
+    Metric cpu_time{};
+    Metric gpu_time{};
+    Metric present_latency{};
+    std::uint64_t next_hitch_check{0};
+    std::optional<std::uint64_t> last_gpu_frame{};
+    std::optional<std::uint64_t> last_present_frame{};
+    std::uint64_t interval_hitches{0};
+    std::uint64_t total_hitches{0};
+    std::vector<std::function<void(const HitchEvent&)>> hitch_callbacks{};
+};
+} // namespace vultex
@@ -0,0 +1,155 @@
+#include "frame_statistics.hpp"
+
+#include <chrono>
+#include <cstdint>
+#include <gtest/gtest.h>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace vultex
+{
+namespace
+{
+using std::chrono::nanoseconds;
+
+// bound of the bucket value falls into: recorded next to a larger value, the
+// median is the bucket bound clamped to that larger value
+std::uint64_t bucket_bound_of(const std::uint64_t value)
+{
+    LatencyHistogram histogram{};
+    histogram.record(nanoseconds{static_cast<std::int64_t>(value)});
+    histogram.record(nanoseconds{std::int64_t{1} << 50});
+    return static_cast<std::uint64_t>(histogram.percentile(50.0).count());
+}
+
+TEST(LatencyHistogram, EmptyHistogramReportsZero)
+{
+    const LatencyHistogram histogram{};
+    EXPECT_EQ(histogram.count(), 0U);
+    EXPECT_EQ(histogram.percentile(50.0), nanoseconds{0});
+    EXPECT_EQ(histogram.max(), nanoseconds{0});
+}
+
+TEST(LatencyHistogram, SmallValuesAreExact)
+{
+    for (std::uint64_t value = 0; value < 64; ++value)
+    {
+        EXPECT_EQ(bucket_bound_of(value), value);
+    }
+}
+
+TEST(LatencyHistogram, BucketBoundStaysWithinRelativeError)
+{
+    // every power of two, its neighbours and values in between up to 2^40
+    std::vector<std::uint64_t> values{};
+    for (unsigned bits = 6; bits < 40; ++bits)
+    {
+        const auto power = std::uint64_t{1} << bits;
+        values.insert(values.end(), {power - 1, power, power + 1, power + power / 3, 2 * power - 1});
+    }
+
+    for (const auto value : values)
+    {
+        const auto bound = bucket_bound_of(value);
+        EXPECT_GE(bound, value) << value;
+        // 32 sub-buckets per power of two range
+        EXPECT_LE(static_cast<double>(bound - value), static_cast<double>(value) / 32.0) << value;
+    }
+}
+
+TEST(LatencyHistogram, BucketBoundsAreMonotonic)
+{
+    std::uint64_t previous = 0;
+    for (std::uint64_t value = 1; value < (std::uint64_t{1} << 20); value += value / 64 + 1)
+    {
+        const auto bound = bucket_bound_of(value);
+        EXPECT_GE(bound, previous) << value;
+        previous = bound;
+    }
+}
+
+TEST(LatencyHistogram, ValuesPastTheRangeGoToTheLastBucket)
+{
+    LatencyHistogram histogram{};
+    const nanoseconds huge{std::int64_t{1} << 45};
+    histogram.record(huge);
+    histogram.record(huge * 2);
+    EXPECT_EQ(histogram.count(), 2U);
+    EXPECT_EQ(histogram.max(), huge * 2);
+    // percentiles saturate at the bound of the last bucket, max() stays exact
+    EXPECT_EQ(histogram.percentile(50.0), nanoseconds{(std::int64_t{1} << 40) - 1});
+}
+
+TEST(LatencyHistogram, NegativeDurationsCountAsZero)
+{
+    LatencyHistogram histogram{};
+    histogram.record(nanoseconds{-5});
+    EXPECT_EQ(histogram.count(), 1U);
+    EXPECT_EQ(histogram.percentile(100.0), nanoseconds{0});
+}
+
+TEST(LatencyHistogram, PercentilesFollowTheRank)
+{
+    LatencyHistogram histogram{};
+    for (std::int64_t value = 1; value <= 100; ++value)
+    {
+        histogram.record(nanoseconds{value * 1000});
+    }
+
+    EXPECT_EQ(histogram.count(), 100U);
+    EXPECT_EQ(histogram.max(), nanoseconds{100000});
+    EXPECT_EQ(histogram.percentile(100.0), nanoseconds{100000});
+    for (const auto percent : {1.0, 50.0, 90.0, 99.0})
+    {
+        const auto expected = percent * 1000.0;
+        const auto actual = static_cast<double>(histogram.percentile(percent).count());
+        EXPECT_GE(actual, expected) << percent;
+        EXPECT_LE(actual, expected * (1.0 + 1.0 / 32.0)) << percent;
+    }
+    // out of range percentages are clamped
+    EXPECT_EQ(histogram.percentile(-10.0), histogram.percentile(0.0));
+    EXPECT_EQ(histogram.percentile(150.0), histogram.percentile(100.0));
+}
+
+TEST(LatencyHistogram, ResetForgetsEverything)
+{
+    LatencyHistogram histogram{};
+    histogram.record(nanoseconds{12345});
+    histogram.reset();
+    EXPECT_EQ(histogram.count(), 0U);
+    EXPECT_EQ(histogram.max(), nanoseconds{0});
+    EXPECT_EQ(histogram.percentile(99.0), nanoseconds{0});
+}
+
+TEST(FrameStatistics, OneHitchPerFrameNamingAllSources)
+{
+    FrameStatistics statistics{FrameStatisticsSettings{.hitch_threshold = std::chrono::milliseconds{1}}};
+    std::vector<std::pair<std::uint64_t, std::string>> hitches{};
+    statistics.on_hitch([&hitches](const HitchEvent& event) {
+        hitches.emplace_back(event.sample.frame, std::string{event.source});
+    });
+
+    for (std::uint64_t frame = 0; frame < 4; ++frame)
+    {
+        EXPECT_EQ(statistics.begin_frame(), frame);
+        // frame 1 is slow on both, frame 2 on the GPU only
+        if (frame == 1)
+        {
+            std::this_thread::sleep_for(std::chrono::milliseconds{5});
+        }
+        statistics.end_frame();
+        statistics.record_gpu_time(frame, frame == 1 || frame == 2 ? std::chrono::milliseconds{5} : nanoseconds{100});
+    }
+    statistics.begin_frame();
+    statistics.end_frame();
+
+    ASSERT_EQ(hitches.size(), 2U);
+    EXPECT_EQ(hitches[0].first, 1U);
+    EXPECT_EQ(hitches[0].second, "cpu, gpu");
+    EXPECT_EQ(hitches[1].first, 2U);
+    EXPECT_EQ(hitches[1].second, "gpu");
+}
+} // namespace
+} // namespace vultex
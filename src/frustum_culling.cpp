@@ -0,0 +1,396 @@
+#include "frustum_culling.hpp"
+
+#include <algorithm>
+#include <bit>
+#include <cmath>
+#include <stdexcept>
+#include <vector>
+
+#if defined(__SSE__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 1)
+#include <immintrin.h>
+#define VULTEX_CULLING_SSE 1
+#endif
+
+// the AVX2 kernel is compiled for AVX2 and FMA on its own and only called
+// when the CPU has both, the rest of the binary keeps the baseline ISA
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define VULTEX_CULLING_AVX2 1
+#define VULTEX_TARGET_AVX2 __attribute__((target("avx2,fma")))
+#elif defined(_MSC_VER) && defined(_M_X64)
+#include <intrin.h>
+#define VULTEX_CULLING_AVX2 1
+#define VULTEX_TARGET_AVX2
+#endif
+
+namespace vultex
+{
+namespace
+{
+// multiple of 8, big enough to amortize a job
+constexpr std::size_t batch_size = 16 * 1024;
+
+struct BoundsView
+{
+    const float* center_x;
+    const float* center_y;
+    const float* center_z;
+    const float* radius;
+    const float* extent_x;
+    const float* extent_y;
+    const float* extent_z;
+};
+
+// Plane components splatted once per call. The absolute normal projects the
+// half extent onto the plane normal, the AABB's radius against that plane.
+struct Planes
+{
+    std::array<float, 6> normal_x;
+    std::array<float, 6> normal_y;
+    std::array<float, 6> normal_z;
+    std::array<float, 6> distance;
+    std::array<float, 6> abs_normal_x;
+    std::array<float, 6> abs_normal_y;
+    std::array<float, 6> abs_normal_z;
+
+    explicit Planes(const Frustum& frustum)
+    {
+        for (std::size_t plane = 0; plane < frustum.planes.size(); ++plane)
+        {
+            const auto& value = frustum.planes[plane];
+            normal_x[plane] = value.x;
+            normal_y[plane] = value.y;
+            normal_z[plane] = value.z;
+            distance[plane] = value.w;
+            abs_normal_x[plane] = std::abs(value.x);
+            abs_normal_y[plane] = std::abs(value.y);
+            abs_normal_z[plane] = std::abs(value.z);
+        }
+    }
+};
+
+// Reference path, one object at a time with glm
+std::size_t cull_scalar(const Frustum& frustum,
+                        const BoundsView& bounds,
+                        const std::size_t begin,
+                        const std::size_t end,
+                        std::uint32_t* visible)
+{
+    std::size_t count = 0;
+    for (auto index = begin; index < end; ++index)
+    {
+        const glm::vec3 center{bounds.center_x[index], bounds.center_y[index], bounds.center_z[index]};
+        const glm::vec3 extent{bounds.extent_x[index], bounds.extent_y[index], bounds.extent_z[index]};
+
+        auto inside = true;
+        for (const auto& plane : frustum.planes)
+        {
+            const glm::vec3 normal{plane.x, plane.y, plane.z};
+            const auto radius = std::min(bounds.radius[index], glm::dot(glm::abs(normal), extent));
+            inside = inside && glm::dot(normal, center) + plane.w >= -radius;
+        }
+
+        visible[count] = static_cast<std::uint32_t>(index);
+        count += inside ? 1 : 0;
+    }
+    return count;
+}
+
+// bit N of mask set, object begin + N is visible
+std::size_t append_visible(std::uint32_t mask, const std::size_t base, std::uint32_t* visible)
+{
+    std::size_t count = 0;
+    for (; 0 != mask; mask &= mask - 1)
+    {
+        visible[count++] = static_cast<std::uint32_t>(base + std::countr_zero(mask));
+    }
+    return count;
+}
+
+#ifdef VULTEX_CULLING_SSE
+std::size_t cull_sse(const Planes& planes,
+                     const BoundsView& bounds,
+                     const std::size_t begin,
+                     const std::size_t end,
+                     std::uint32_t* visible)
+{
+    std::size_t count = 0;
+    auto index = begin;
+    for (; index + 4 <= end; index += 4)
+    {
+        const auto centerX = _mm_loadu_ps(bounds.center_x + index);
+        const auto centerY = _mm_loadu_ps(bounds.center_y + index);
+        const auto centerZ = _mm_loadu_ps(bounds.center_z + index);
+        const auto sphereRadius = _mm_loadu_ps(bounds.radius + index);
+        const auto extentX = _mm_loadu_ps(bounds.extent_x + index);
+        const auto extentY = _mm_loadu_ps(bounds.extent_y + index);
+        const auto extentZ = _mm_loadu_ps(bounds.extent_z + index);
+
+        auto outside = _mm_setzero_ps();
+        for (std::size_t plane = 0; plane < 6; ++plane)
+        {
+            auto distance = _mm_add_ps(_mm_mul_ps(_mm_set1_ps(planes.normal_x[plane]), centerX),
+                                       _mm_set1_ps(planes.distance[plane]));
+            distance = _mm_add_ps(distance, _mm_mul_ps(_mm_set1_ps(planes.normal_y[plane]), centerY));
+            distance = _mm_add_ps(distance, _mm_mul_ps(_mm_set1_ps(planes.normal_z[plane]), centerZ));
+
+            auto boxRadius = _mm_mul_ps(_mm_set1_ps(planes.abs_normal_x[plane]), extentX);
+            boxRadius = _mm_add_ps(boxRadius, _mm_mul_ps(_mm_set1_ps(planes.abs_normal_y[plane]), extentY));
+            boxRadius = _mm_add_ps(boxRadius, _mm_mul_ps(_mm_set1_ps(planes.abs_normal_z[plane]), extentZ));
+            const auto radius = _mm_min_ps(sphereRadius, boxRadius);
+
+            // distance < -radius  <=>  distance + radius < 0
+            outside = _mm_or_ps(outside, _mm_cmplt_ps(_mm_add_ps(distance, radius), _mm_setzero_ps()));
+        }
+
+        const auto mask = ~static_cast<std::uint32_t>(_mm_movemask_ps(outside)) & 0xFU;
+        count += append_visible(mask, index, visible + count);
+    }
+    return count;
+}
+#endif
+
+#ifdef VULTEX_CULLING_AVX2
+VULTEX_TARGET_AVX2 std::size_t cull_avx2(const Planes& planes,
+                                         const BoundsView& bounds,
+                                         const std::size_t begin,
+                                         const std::size_t end,
+                                         std::uint32_t* visible)
+{
+    std::size_t count = 0;
+    auto index = begin;
+    for (; index + 8 <= end; index += 8)
+    {
+        const auto centerX = _mm256_loadu_ps(bounds.center_x + index);
+        const auto centerY = _mm256_loadu_ps(bounds.center_y + index);
+        const auto centerZ = _mm256_loadu_ps(bounds.center_z + index);
+        const auto sphereRadius = _mm256_loadu_ps(bounds.radius + index);
+        const auto extentX = _mm256_loadu_ps(bounds.extent_x + index);
+        const auto extentY = _mm256_loadu_ps(bounds.extent_y + index);
+        const auto extentZ = _mm256_loadu_ps(bounds.extent_z + index);
+
+        auto outside = _mm256_setzero_ps();
+        for (std::size_t plane = 0; plane < 6; ++plane)
+        {
+            auto distance = _mm256_fmadd_ps(
+                _mm256_set1_ps(planes.normal_x[plane]), centerX, _mm256_set1_ps(planes.distance[plane]));
+            distance = _mm256_fmadd_ps(_mm256_set1_ps(planes.normal_y[plane]), centerY, distance);
+            distance = _mm256_fmadd_ps(_mm256_set1_ps(planes.normal_z[plane]), centerZ, distance);
+
+            auto boxRadius = _mm256_mul_ps(_mm256_set1_ps(planes.abs_normal_x[plane]), extentX);
+            boxRadius = _mm256_fmadd_ps(_mm256_set1_ps(planes.abs_normal_y[plane]), extentY, boxRadius);
+            boxRadius = _mm256_fmadd_ps(_mm256_set1_ps(planes.abs_normal_z[plane]), extentZ, boxRadius);
+            const auto radius = _mm256_min_ps(sphereRadius, boxRadius);
+
+            outside = _mm256_or_ps(
+                outside, _mm256_cmp_ps(_mm256_add_ps(distance, radius), _mm256_setzero_ps(), _CMP_LT_OQ));
+        }
+
+        const auto mask = ~static_cast<std::uint32_t>(_mm256_movemask_ps(outside)) & 0xFFU;
+        count += append_visible(mask, index, visible + count);
+    }
+    return count;
+}
+#endif
+
+[[nodiscard]] bool cpu_has_avx2()
+{
+#if defined(VULTEX_CULLING_AVX2) && defined(__GNUC__)
+    return 0 != __builtin_cpu_supports("avx2") && 0 != __builtin_cpu_supports("fma");
+#elif defined(VULTEX_CULLING_AVX2)
+    // leaf 7 for AVX2, leaf 1 for FMA and whether the OS saves the YMM registers
+    std::array<int, 4> registers{};
+    __cpuid(registers.data(), 0);
+    if (registers[0] < 7)
+    {
+        return false;
+    }
+    __cpuidex(registers.data(), 7, 0);
+    const auto avx2 = 0 != (registers[1] & (1 << 5));
+    __cpuid(registers.data(), 1);
+    const auto fma = 0 != (registers[2] & (1 << 12));
+    const auto osxsave = 0 != (registers[2] & (1 << 27));
+    return avx2 && fma && osxsave && 6 == (_xgetbv(0) & 6);
+#else
+    return false;
+#endif
+}
+
+[[nodiscard]] const std::vector<CullingPath>& supported_paths()
+{
+    static const auto paths = []
+    {
+        std::vector<CullingPath> supported{CullingPath::scalar};
+#ifdef VULTEX_CULLING_SSE
+        supported.push_back(CullingPath::sse);
+#endif
+        if (cpu_has_avx2())
+        {
+            supported.push_back(CullingPath::avx2);
+        }
+        return supported;
+    }();
+    return paths;
+}
+} // namespace
+
+Frustum Frustum::from_view_projection(const glm::mat4& view_projection)
+{
+    // Gribb / Hartmann: -w <= x, y <= w and 0 <= z <= w as rows of the matrix
+    const auto row = [&view_projection](const int index)
+    {
+        return glm::vec4{
+            view_projection[0][index], view_projection[1][index], view_projection[2][index], view_projection[3][index]};
+    };
+
+    Frustum frustum{
+        .planes = {row(3) + row(0), row(3) - row(0), row(3) + row(1), row(3) - row(1), row(2), row(3) - row(2)}};
+    for (auto& plane : frustum.planes)
+    {
+        plane = plane / glm::length(glm::vec3{plane.x, plane.y, plane.z});
+    }
+    return frustum;
+}
+
+std::uint32_t CullingBounds::add(const glm::vec3& center, const glm::vec3& extent, const float radius)
+{
+    const auto index = static_cast<std::uint32_t>(size());
+    center_x.push_back(center.x);
+    center_y.push_back(center.y);
+    center_z.push_back(center.z);
+    this->radius.push_back(radius);
+    extent_x.push_back(extent.x);
+    extent_y.push_back(extent.y);
+    extent_z.push_back(extent.z);
+    return index;
+}
+
+void CullingBounds::set(const std::uint32_t index, const glm::vec3& center, const glm::vec3& extent, const float radius)
+{
+    if (index >= size())
+    {
+        throw std::out_of_range("Culling bounds index out of range!");
+    }
+
+    center_x[index] = center.x;
+    center_y[index] = center.y;
+    center_z[index] = center.z;
+    this->radius[index] = radius;
+    extent_x[index] = extent.x;
+    extent_y[index] = extent.y;
+    extent_z[index] = extent.z;
+}
+
+void CullingBounds::clear()
+{
+    center_x.clear();
+    center_y.clear();
+    center_z.clear();
+    radius.clear();
+    extent_x.clear();
+    extent_y.clear();
+    extent_z.clear();
+}
+
+std::size_t CullingBounds::size() const
+{
+    return center_x.size();
+}
+
+std::span<const CullingPath> available_culling_paths()
+{
+    return supported_paths();
+}
+
+CullingPath best_culling_path()
+{
+    return supported_paths().back();
+}
+
+std::string_view culling_path_name(const CullingPath path)
+{
+    switch (path)
+    {
+    case CullingPath::sse:
+        return "sse";
+    case CullingPath::avx2:
+        return "avx2";
+    default:
+        return "scalar";
+    }
+}
+
+std::size_t cull_range(const Frustum& frustum,
+                       const CullingBounds& bounds,
+                       const std::size_t begin,
+                       const std::size_t end,
+                       std::uint32_t* visible,
+                       const CullingPath path)
+{
+    if (std::ranges::find(supported_paths(), path) == supported_paths().end())
+    {
+        throw std::invalid_argument("Culling path is not supported by this build or CPU!");
+    }
+
+    const BoundsView view{.center_x = bounds.center_x.data(),
+                          .center_y = bounds.center_y.data(),
+                          .center_z = bounds.center_z.data(),
+                          .radius = bounds.radius.data(),
+                          .extent_x = bounds.extent_x.data(),
+                          .extent_y = bounds.extent_y.data(),
+                          .extent_z = bounds.extent_z.data()};
+
+    // SIMD paths stop at the last full register, the scalar one takes the tail
+    auto simdEnd = begin;
+    std::size_t count = 0;
+#ifdef VULTEX_CULLING_AVX2
+    if (CullingPath::avx2 == path)
+    {
+        simdEnd = begin + (end - begin) / 8 * 8;
+        count = cull_avx2(Planes{frustum}, view, begin, simdEnd, visible);
+    }
+#endif
+#ifdef VULTEX_CULLING_SSE
+    if (CullingPath::sse == path)
+    {
+        simdEnd = begin + (end - begin) / 4 * 4;
+        count = cull_sse(Planes{frustum}, view, begin, simdEnd, visible);
+    }
+#endif
+    return count + cull_scalar(frustum, view, simdEnd, end, visible + count);
+}
+
+void cull(JobSystem& job_system,
+          const Frustum& frustum,
+          const CullingBounds& bounds,
+          std::vector<std::uint32_t>& visible,
+          const CullingPath path)
+{
+    const auto objectCount = bounds.size();
+    const auto batchCount = (objectCount + batch_size - 1) / batch_size;
+
+    // every batch writes into its own slice, the slices are compacted after
+    visible.resize(objectCount);
+    std::vector<std::size_t> batchVisible(batchCount);
+    job_system.parallel_for(objectCount,
+                            batch_size,
+                            [&](const std::size_t begin, const std::size_t end)
+                            {
+                                batchVisible[begin / batch_size] =
+                                    cull_range(frustum, bounds, begin, end, visible.data() + begin, path);
+                            });
+
+    // slices move only towards the front, in batch order nothing is overwritten
+    // before it is read; a slice already in place is not copied onto itself
+    std::size_t count = 0;
+    for (std::size_t batch = 0; batch < batchCount; ++batch)
+    {
+        if (count != batch * batch_size)
+        {
+            const auto first = visible.begin() + static_cast<std::ptrdiff_t>(batch * batch_size);
+            std::copy(first, first + static_cast<std::ptrdiff_t>(batchVisible[batch]), visible.begin() + count);
+        }
+        count += batchVisible[batch];
+    }
+    visible.resize(count);
+}
+} // namespace vultex
@@ -0,0 +1,84 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <glm/glm.hpp>
+#include <span>
+#include <string_view>
+#include <vector>
+
+#include "job_system.hpp"
+
+namespace vultex
+{
+
+// Planes point inside, a point p is inside when dot(plane.xyz, p) + plane.w >= 0
+struct Frustum
+{
+    std::array<glm::vec4, 6> planes;
+
+    // Vulkan clip space, depth in [0, 1]
+    [[nodiscard]] static Frustum from_view_projection(const glm::mat4& view_projection);
+};
+
+// scalar is the glm reference, sse tests 4 objects at once, avx2 8
+enum class CullingPath
+{
+    scalar,
+    sse,
+    avx2
+};
+
+// Bounding volumes of the culled objects as structure of arrays, one float
+// array per component, so SIMD paths load 4 or 8 objects per instruction.
+// Every object has an AABB (center and half extent) and a bounding sphere
+// around the same center; whichever is tighter against a plane rejects it.
+class CullingBounds
+{
+public:
+    // returns the index reported by the culling functions
+    std::uint32_t add(const glm::vec3& center, const glm::vec3& extent, float radius);
+    void set(std::uint32_t index, const glm::vec3& center, const glm::vec3& extent, float radius);
+    void clear();
+
+    [[nodiscard]] std::size_t size() const;
+
+private:
+    friend std::size_t cull_range(const Frustum& frustum,
+                                  const CullingBounds& bounds,
+                                  std::size_t begin,
+                                  std::size_t end,
+                                  std::uint32_t* visible,
+                                  CullingPath path);
+
+    std::vector<float> center_x{};
+    std::vector<float> center_y{};
+    std::vector<float> center_z{};
+    std::vector<float> radius{};
+    std::vector<float> extent_x{};
+    std::vector<float> extent_y{};
+    std::vector<float> extent_z{};
+};
+
+// paths this build and CPU support, avx2 is detected at runtime
+[[nodiscard]] std::span<const CullingPath> available_culling_paths();
+[[nodiscard]] CullingPath best_culling_path();
+[[nodiscard]] std::string_view culling_path_name(CullingPath path);
+
+// Writes indices of the visible objects of [begin, end) to visible, which
+// needs room for end - begin of them, and returns how many were written.
+std::size_t cull_range(const Frustum& frustum,
+                       const CullingBounds& bounds,
+                       std::size_t begin,
+                       std::size_t end,
+                       std::uint32_t* visible,
+                       CullingPath path);
+
+// All objects in parallel batches, visible gets the sorted compact index list.
+void cull(JobSystem& job_system,
+          const Frustum& frustum,
+          const CullingBounds& bounds,
+          std::vector<std::uint32_t>& visible,
+          CullingPath path = best_culling_path());
+} // namespace vultex
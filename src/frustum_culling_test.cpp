@@ -0,0 +1,132 @@
+#include "frustum_culling.hpp"
+
+#include <algorithm>
+#include <cstdint>
+#include <gtest/gtest.h>
+#include <random>
+#include <utility>
+#include <vector>
+
+#include "job_system.hpp"
+
+namespace vultex
+{
+namespace
+{
+// with an identity view projection, clip space is world space: the frustum
+// is the box |x| <= 1, |y| <= 1, 0 <= z <= 1
+const Frustum unit_frustum = Frustum::from_view_projection(glm::mat4{1.0F});
+
+std::vector<std::uint32_t> cull_all(const Frustum& frustum,
+                                    const CullingBounds& bounds,
+                                    const std::size_t begin,
+                                    const std::size_t end,
+                                    const CullingPath path)
+{
+    std::vector<std::uint32_t> visible(end - begin);
+    visible.resize(cull_range(frustum, bounds, begin, end, visible.data(), path));
+    return visible;
+}
+
+// random boxes and spheres around the unit frustum, many of them on its planes
+CullingBounds random_bounds(const std::size_t count)
+{
+    std::mt19937 random{7};
+    std::uniform_real_distribution<float> position{-2.0F, 2.0F};
+    std::uniform_real_distribution<float> size{0.0F, 0.5F};
+    CullingBounds bounds{};
+    for (std::size_t index = 0; index < count; ++index)
+    {
+        bounds.add(glm::vec3{position(random), position(random), position(random)},
+                   glm::vec3{size(random), size(random), size(random)},
+                   size(random));
+    }
+    return bounds;
+}
+
+TEST(FrustumCulling, PlanesFollowVulkanClipSpace)
+{
+    CullingBounds bounds{};
+    const auto inside = bounds.add(glm::vec3{0.0F, 0.0F, 0.5F}, glm::vec3{0.0F}, 0.0F);
+    const auto nearCorner = bounds.add(glm::vec3{0.99F, -0.99F, 0.01F}, glm::vec3{0.0F}, 0.0F);
+    // behind the near plane at z = 0, which OpenGL clip space would keep
+    bounds.add(glm::vec3{0.0F, 0.0F, -0.5F}, glm::vec3{0.0F}, 0.0F);
+    bounds.add(glm::vec3{0.0F, 0.0F, 1.5F}, glm::vec3{0.0F}, 0.0F);
+    bounds.add(glm::vec3{1.5F, 0.0F, 0.5F}, glm::vec3{0.0F}, 0.0F);
+    bounds.add(glm::vec3{0.0F, -1.5F, 0.5F}, glm::vec3{0.0F}, 0.0F);
+
+    for (const auto path : available_culling_paths())
+    {
+        EXPECT_EQ(cull_all(unit_frustum, bounds, 0, bounds.size(), path),
+                  (std::vector<std::uint32_t>{inside, nearCorner}))
+            << culling_path_name(path);
+    }
+}
+
+TEST(FrustumCulling, TighterOfSphereAndBoxRejects)
+{
+    CullingBounds bounds{};
+    // the center is 0.5 outside of x <= 1: a box or a sphere reaching over the plane keeps it
+    const auto straddling = bounds.add(glm::vec3{1.5F, 0.0F, 0.5F}, glm::vec3{1.0F}, 1.0F);
+    bounds.add(glm::vec3{1.5F, 0.0F, 0.5F}, glm::vec3{1.0F}, 0.2F);
+    bounds.add(glm::vec3{1.5F, 0.0F, 0.5F}, glm::vec3{0.2F}, 1.0F);
+
+    for (const auto path : available_culling_paths())
+    {
+        EXPECT_EQ(cull_all(unit_frustum, bounds, 0, bounds.size(), path), (std::vector<std::uint32_t>{straddling}))
+            << culling_path_name(path);
+    }
+}
+
+TEST(FrustumCulling, SimdPathsAgreeWithScalar)
+{
+    // an odd count and an unaligned begin leave tails for every batch width
+    const auto bounds = random_bounds(1003);
+    ASSERT_EQ(bounds.size(), 1003U);
+    for (const auto& [begin, end] : {std::pair<std::size_t, std::size_t>{0, 1003}, {3, 1000}, {5, 12}, {7, 7}})
+    {
+        const auto expected = cull_all(unit_frustum, bounds, begin, end, CullingPath::scalar);
+        for (const auto path : available_culling_paths())
+        {
+            EXPECT_EQ(cull_all(unit_frustum, bounds, begin, end, path), expected)
+                << culling_path_name(path) << " [" << begin << ", " << end << ")";
+        }
+    }
+}
+
+TEST(FrustumCulling, ParallelCullMatchesOneRange)
+{
+    const auto bounds = random_bounds(100000);
+    JobSystem jobSystem{4};
+    for (const auto path : available_culling_paths())
+    {
+        std::vector<std::uint32_t> visible{};
+        cull(jobSystem, unit_frustum, bounds, visible, path);
+        EXPECT_TRUE(std::ranges::is_sorted(visible)) << culling_path_name(path);
+        EXPECT_EQ(visible, cull_all(unit_frustum, bounds, 0, bounds.size(), CullingPath::scalar))
+            << culling_path_name(path);
+    }
+}
+
+TEST(FrustumCulling, ScalarAndBestPathAreAvailable)
+{
+    const auto paths = available_culling_paths();
+    EXPECT_NE(std::ranges::find(paths, CullingPath::scalar), paths.end());
+    EXPECT_NE(std::ranges::find(paths, best_culling_path()), paths.end());
+}
+
+TEST(CullingBounds, SetReplacesAndClearEmpties)
+{
+    CullingBounds bounds{};
+    const auto index = bounds.add(glm::vec3{5.0F}, glm::vec3{0.1F}, 0.1F);
+    EXPECT_TRUE(cull_all(unit_frustum, bounds, 0, bounds.size(), CullingPath::scalar).empty());
+
+    bounds.set(index, glm::vec3{0.0F, 0.0F, 0.5F}, glm::vec3{0.1F}, 0.1F);
+    EXPECT_EQ(cull_all(unit_frustum, bounds, 0, bounds.size(), CullingPath::scalar),
+              (std::vector<std::uint32_t>{index}));
+
+    bounds.clear();
+    EXPECT_EQ(bounds.size(), 0U);
+}
+} // namespace
+} // namespace vultex
@@ -0,0 +1,424 @@
+#include "gpu_counters.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <limits>
+#include <spdlog/spdlog.h>
+#include <stdexcept>
+#include <utility>
+
+#include "host_allocator.hpp"
+
+namespace vultex
+{
+namespace
+{
+// frame begin and end, then begin and end of every pass
+constexpr std::uint32_t timestamps_per_slot = 2 + 2 * GpuCounters::max_passes;
+
+// results are written in the order of the flag bits
+constexpr std::array<std::string_view, 5> statistic_names{
+    "vertex_invocations", "clipping_invocations", "clipping_primitives", "fragment_invocations", "compute_invocations"};
+constexpr VkQueryPipelineStatisticFlags statistic_flags = VK_QUERY_PIPELINE_STATISTIC_VERTEX_SHADER_INVOCATIONS_BIT |
+                                                          VK_QUERY_PIPELINE_STATISTIC_CLIPPING_INVOCATIONS_BIT |
+                                                          VK_QUERY_PIPELINE_STATISTIC_CLIPPING_PRIMITIVES_BIT |
+                                                          VK_QUERY_PIPELINE_STATISTIC_FRAGMENT_SHADER_INVOCATIONS_BIT |
+                                                          VK_QUERY_PIPELINE_STATISTIC_COMPUTE_SHADER_INVOCATIONS_BIT;
+
+VkQueryPool create_query_pool(VkDevice logical_device, const VkQueryPoolCreateInfo& create_info)
+{
+    VkQueryPool pool{nullptr};
+    if (VK_SUCCESS != vkCreateQueryPool(logical_device, &create_info, allocation_callbacks(), &pool))
+    {
+        throw std::runtime_error("Failed to create GPU counter query pool!");
+    }
+    return pool;
+}
+
+template <typename Function>
+Function load_instance_function(VkInstance instance, const char* name)
+{
+    return reinterpret_cast<Function>(vkGetInstanceProcAddr(instance, name));
+}
+
+template <typename Function>
+Function load_device_function(VkDevice logical_device, const char* name)
+{
+    return reinterpret_cast<Function>(vkGetDeviceProcAddr(logical_device, name));
+}
+
+std::string_view unit_name(const VkPerformanceCounterUnitKHR unit)
+{
+    switch (unit)
+    {
+    case VK_PERFORMANCE_COUNTER_UNIT_PERCENTAGE_KHR:
+        return "%";
+    case VK_PERFORMANCE_COUNTER_UNIT_NANOSECONDS_KHR:
+        return "ns";
+    case VK_PERFORMANCE_COUNTER_UNIT_BYTES_KHR:
+        return "bytes";
+    case VK_PERFORMANCE_COUNTER_UNIT_BYTES_PER_SECOND_KHR:
+        return "bytes/s";
+    case VK_PERFORMANCE_COUNTER_UNIT_CYCLES_KHR:
+        return "cycles";
+    default:
+        return "generic";
+    }
+}
+
+double to_double(const VkPerformanceCounterResultKHR& result, const VkPerformanceCounterStorageKHR storage)
+{
+    switch (storage)
+    {
+    case VK_PERFORMANCE_COUNTER_STORAGE_INT32_KHR:
+        return result.int32;
+    case VK_PERFORMANCE_COUNTER_STORAGE_INT64_KHR:
+        return static_cast<double>(result.int64);
+    case VK_PERFORMANCE_COUNTER_STORAGE_UINT32_KHR:
+        return result.uint32;
+    case VK_PERFORMANCE_COUNTER_STORAGE_UINT64_KHR:
+        return static_cast<double>(result.uint64);
+    case VK_PERFORMANCE_COUNTER_STORAGE_FLOAT32_KHR:
+        return result.float32;
+    default:
+        return result.float64;
+    }
+}
+} // namespace
+
+GpuCounters::GpuCounters(const VulkanContext& context,
+                         const std::uint32_t frames_in_flight,
+                         const std::vector<std::string>& performance_counters)
+    : logical_device{context.logical_device()}, frames_in_flight{frames_in_flight}, slots(frames_in_flight)
+{
+    VkPhysicalDeviceProperties properties{};
+    vkGetPhysicalDeviceProperties(context.physical_device(), &properties);
+    timestamp_period = properties.limits.timestampPeriod;
+
+    std::uint32_t familyCount = 0;
+    vkGetPhysicalDeviceQueueFamilyProperties(context.physical_device(), &familyCount, nullptr);
+    std::vector<VkQueueFamilyProperties> families(familyCount);
+    vkGetPhysicalDeviceQueueFamilyProperties(context.physical_device(), &familyCount, families.data());
+
+    // 0 valid bits, the queue doesn't support timestamps
+    const auto validBits = families.at(context.graphics_family()).timestampValidBits;
+    if (0 != validBits)
+    {
+        timestamp_mask = validBits >= 64 ? std::numeric_limits<std::uint64_t>::max() : (1ULL << validBits) - 1;
+        timestamp_pool = create_query_pool(logical_device,
+                                           VkQueryPoolCreateInfo{.sType = VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO,
+                                                                 .queryType = VK_QUERY_TYPE_TIMESTAMP,
+                                                                 .queryCount = frames_in_flight * timestamps_per_slot});
+    }
+
+    if (context.pipeline_statistics_query())
+    {
+        statistics_pool = create_query_pool(logical_device,
+                                            VkQueryPoolCreateInfo{.sType = VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO,
+                                                                  .queryType = VK_QUERY_TYPE_PIPELINE_STATISTICS,
+                                                                  .queryCount = frames_in_flight * max_passes,
+                                                                  .pipelineStatistics = statistic_flags});
+    }
+
+    if (context.performance_query())
+    {
+        select_performance_counters(context, performance_counters);
+    }
+
+    for (auto& slot : slots)
+    {
+        slot.passes.reserve(max_passes);
+    }
+    timestamps.resize(timestamps_per_slot);
+    statistic_results.resize(max_passes * statistic_names.size());
+    performance_results.resize(max_passes * counter_indices.size());
+    pass_counters.reserve(statistic_names.size() + counter_indices.size());
+
+    spdlog::info("GPU counters: timestamps {}, pipeline statistics {}, performance counters {}",
+                 nullptr != timestamp_pool,
+                 nullptr != statistics_pool,
+                 counter_indices.size());
+}
+
+GpuCounters::~GpuCounters()
+{
+    vkDestroyQueryPool(logical_device, performance_pool, allocation_callbacks());
+    vkDestroyQueryPool(logical_device, statistics_pool, allocation_callbacks());
+    vkDestroyQueryPool(logical_device, timestamp_pool, allocation_callbacks());
+
+    if (profiling_lock)
+    {
+        const auto releaseProfilingLock =
+            load_device_function<PFN_vkReleaseProfilingLockKHR>(logical_device, "vkReleaseProfilingLockKHR");
+        releaseProfilingLock(logical_device);
+    }
+}
+
+void GpuCounters::begin_frame(VkCommandBuffer command_buffer, const std::uint32_t slot, const std::uint64_t frame)
+{
+    recording_slot = slot;
+    auto& current = slots.at(slot);
+    current.frame = frame;
+    current.passes.clear();
+
+    if (nullptr != timestamp_pool)
+    {
+        vkCmdResetQueryPool(command_buffer, timestamp_pool, slot * timestamps_per_slot, timestamps_per_slot);
+        vkCmdWriteTimestamp(
+            command_buffer, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, timestamp_pool, slot * timestamps_per_slot);
+    }
+    if (nullptr != statistics_pool)
+    {
+        vkCmdResetQueryPool(command_buffer, statistics_pool, first_query(slot), max_passes);
+    }
+    // performance queries cannot be reset in the command buffer which uses them, collect() resets them on the host
+}
+
+void GpuCounters::begin_pass(VkCommandBuffer command_buffer, const std::string_view name)
+{
+    auto& current = slots.at(recording_slot);
+    if (current.passes.size() == max_passes)
+    {
+        spdlog::warn("More than {} GPU passes in frame {}, {} is not measured", max_passes, *current.frame, name);
+        return;
+    }
+
+    const auto pass = static_cast<std::uint32_t>(current.passes.size());
+    current.passes.push_back(name);
+    pass_open = true;
+
+    if (nullptr != timestamp_pool)
+    {
+        vkCmdWriteTimestamp(command_buffer,
+                            VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT,
+                            timestamp_pool,
+                            recording_slot * timestamps_per_slot + 2 + 2 * pass);
+    }
+    if (nullptr != statistics_pool)
+    {
+        vkCmdBeginQuery(command_buffer, statistics_pool, first_query(recording_slot) + pass, 0);
+    }
+    if (nullptr != performance_pool)
+    {
+        vkCmdBeginQuery(command_buffer, performance_pool, first_query(recording_slot) + pass, 0);
+    }
+}
+
+void GpuCounters::end_pass(VkCommandBuffer command_buffer)
+{
+    if (!std::exchange(pass_open, false))
+    {
+        return;
+    }
+
+    const auto pass = static_cast<std::uint32_t>(slots.at(recording_slot).passes.size() - 1);
+    if (nullptr != performance_pool)
+    {
+        vkCmdEndQuery(command_buffer, performance_pool, first_query(recording_slot) + pass);
+    }
+    if (nullptr != statistics_pool)
+    {
+        vkCmdEndQuery(command_buffer, statistics_pool, first_query(recording_slot) + pass);
+    }
+    if (nullptr != timestamp_pool)
+    {
+        vkCmdWriteTimestamp(command_buffer,
+                            VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT,
+                            timestamp_pool,
+                            recording_slot * timestamps_per_slot + 3 + 2 * pass);
+    }
+}
+
+void GpuCounters::end_frame(VkCommandBuffer command_buffer)
+{
+    if (nullptr != timestamp_pool)
+    {
+        vkCmdWriteTimestamp(command_buffer,
+                            VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT,
+                            timestamp_pool,
+                            recording_slot * timestamps_per_slot + 1);
+    }
+}
+
+void GpuCounters::collect(const std::uint32_t slot, FrameStatistics& statistics)
+{
+    auto& pending = slots.at(slot);
+    if (!pending.frame)
+    {
+        return;
+    }
+    const auto frame = *std::exchange(pending.frame, std::nullopt);
+    const auto passCount = static_cast<std::uint32_t>(pending.passes.size());
+
+    // the slot's submission is complete, VK_NOT_READY only when a query was never written
+    const auto hasTimestamps =
+        nullptr != timestamp_pool && VK_SUCCESS == vkGetQueryPoolResults(logical_device,
+                                                                         timestamp_pool,
+                                                                         slot * timestamps_per_slot,
+                                                                         2 + 2 * passCount,
+                                                                         timestamps.size() * sizeof(std::uint64_t),
+                                                                         timestamps.data(),
+                                                                         sizeof(std::uint64_t),
+                                                                         VK_QUERY_RESULT_64_BIT);
+    const auto hasStatistics =
+        nullptr != statistics_pool && 0 != passCount &&
+        VK_SUCCESS == vkGetQueryPoolResults(logical_device,
+                                            statistics_pool,
+                                            first_query(slot),
+                                            passCount,
+                                            statistic_results.size() * sizeof(std::uint64_t),
+                                            statistic_results.data(),
+                                            statistic_names.size() * sizeof(std::uint64_t),
+                                            VK_QUERY_RESULT_64_BIT);
+    const auto hasPerformance =
+        nullptr != performance_pool && 0 != passCount &&
+        VK_SUCCESS == vkGetQueryPoolResults(logical_device,
+                                            performance_pool,
+                                            first_query(slot),
+                                            passCount,
+                                            performance_results.size() * sizeof(VkPerformanceCounterResultKHR),
+                                            performance_results.data(),
+                                            counter_indices.size() * sizeof(VkPerformanceCounterResultKHR),
+                                            0);
+    if (nullptr != performance_pool)
+    {
+        vkResetQueryPool(logical_device, performance_pool, first_query(slot), max_passes);
+    }
+
+    const auto elapsed = [this](const std::uint64_t begin, const std::uint64_t end)
+    {
+        const auto ticks = static_cast<double>((end - begin) & timestamp_mask);
+        return std::chrono::nanoseconds{static_cast<std::int64_t>(ticks * timestamp_period)};
+    };
+
+    for (std::uint32_t pass = 0; pass < passCount; ++pass)
+    {
+        pass_counters.clear();
+        if (hasStatistics)
+        {
+            for (std::size_t index = 0; index < statistic_names.size(); ++index)
+            {
+                pass_counters.push_back(GpuCounterValue{
+                    .name = statistic_names[index],
+                    .value = static_cast<double>(statistic_results[pass * statistic_names.size() + index])});
+            }
+        }
+        if (hasPerformance)
+        {
+            for (std::size_t index = 0; index < counter_indices.size(); ++index)
+            {
+                pass_counters.push_back(GpuCounterValue{
+                    .name = available_counters[counter_indices[index]].name,
+                    .value = to_double(performance_results[pass * counter_indices.size() + index],
+                                       counter_storages[index])});
+            }
+        }
+
+        const auto duration = hasTimestamps ? elapsed(timestamps[2 + 2 * pass], timestamps[3 + 2 * pass])
+                                            : std::chrono::nanoseconds{0};
+        statistics.record_gpu_pass(frame, pending.passes[pass], duration, pass_counters);
+    }
+
+    if (hasTimestamps)
+    {
+        statistics.record_gpu_time(frame, elapsed(timestamps[0], timestamps[1]));
+    }
+}
+
+const std::vector<PerformanceCounterInfo>& GpuCounters::available_performance_counters() const
+{
+    return available_counters;
+}
+
+void GpuCounters::select_performance_counters(const VulkanContext& context, const std::vector<std::string>& names)
+{
+    using EnumerateCounters = PFN_vkEnumeratePhysicalDeviceQueueFamilyPerformanceQueryCountersKHR;
+    const auto enumerateCounters = load_instance_function<EnumerateCounters>(
+        context.instance(), "vkEnumeratePhysicalDeviceQueueFamilyPerformanceQueryCountersKHR");
+    const auto getPassCount = load_instance_function<PFN_vkGetPhysicalDeviceQueueFamilyPerformanceQueryPassesKHR>(
+        context.instance(), "vkGetPhysicalDeviceQueueFamilyPerformanceQueryPassesKHR");
+    const auto acquireProfilingLock =
+        load_device_function<PFN_vkAcquireProfilingLockKHR>(logical_device, "vkAcquireProfilingLockKHR");
+    if (nullptr == enumerateCounters || nullptr == getPassCount || nullptr == acquireProfilingLock)
+    {
+        return;
+    }
+
+    std::uint32_t count = 0;
+    enumerateCounters(context.physical_device(), context.graphics_family(), &count, nullptr, nullptr);
+    std::vector<VkPerformanceCounterKHR> counters(
+        count, VkPerformanceCounterKHR{.sType = VK_STRUCTURE_TYPE_PERFORMANCE_COUNTER_KHR});
+    std::vector<VkPerformanceCounterDescriptionKHR> descriptions(
+        count, VkPerformanceCounterDescriptionKHR{.sType = VK_STRUCTURE_TYPE_PERFORMANCE_COUNTER_DESCRIPTION_KHR});
+    enumerateCounters(
+        context.physical_device(), context.graphics_family(), &count, counters.data(), descriptions.data());
+
+    spdlog::info("Performance counters of the graphics queue family: {}", count);
+    for (std::uint32_t index = 0; index < count; ++index)
+    {
+        available_counters.push_back(PerformanceCounterInfo{.name = descriptions[index].name,
+                                                            .category = descriptions[index].category,
+                                                            .description = descriptions[index].description,
+                                                            .unit = counters[index].unit});
+        const auto& counter = available_counters.back();
+        spdlog::info("  {} [{}, {}]: {}", counter.name, counter.category, unit_name(counter.unit), counter.description);
+
+        if (std::ranges::find(names, counter.name) == names.end())
+        {
+            continue;
+        }
+        // such counters have to be begun by the first command of a command buffer
+        if (VK_PERFORMANCE_COUNTER_SCOPE_COMMAND_BUFFER_KHR == counters[index].scope)
+        {
+            spdlog::warn("Performance counter {} has command buffer scope, it cannot be collected per pass",
+                         counter.name);
+            continue;
+        }
+        counter_indices.push_back(index);
+        counter_storages.push_back(counters[index].storage);
+    }
+
+    if (counter_indices.size() != names.size())
+    {
+        spdlog::warn("Selected {} of {} requested performance counters", counter_indices.size(), names.size());
+    }
+    if (counter_indices.empty())
+    {
+        return;
+    }
+
+    const VkQueryPoolPerformanceCreateInfoKHR performanceInfo{
+        .sType = VK_STRUCTURE_TYPE_QUERY_POOL_PERFORMANCE_CREATE_INFO_KHR,
+        .queueFamilyIndex = context.graphics_family(),
+        .counterIndexCount = static_cast<std::uint32_t>(counter_indices.size()),
+        .pCounterIndices = counter_indices.data()};
+
+    // a set needing more passes would have to replay the same submission
+    std::uint32_t passes = 0;
+    getPassCount(context.physical_device(), &performanceInfo, &passes);
+    const VkAcquireProfilingLockInfoKHR lockInfo{.sType = VK_STRUCTURE_TYPE_ACQUIRE_PROFILING_LOCK_INFO_KHR,
+                                                 .timeout = std::numeric_limits<std::uint64_t>::max()};
+    if (1 != passes || VK_SUCCESS != acquireProfilingLock(logical_device, &lockInfo))
+    {
+        spdlog::warn("Selected performance counters need {} submissions or the profiling lock is taken, skip them",
+                     passes);
+        counter_indices.clear();
+        counter_storages.clear();
+        return;
+    }
+    profiling_lock = true;
+
+    const auto queryCount = frames_in_flight * max_passes;
+    performance_pool = create_query_pool(logical_device,
+                                         VkQueryPoolCreateInfo{.sType = VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO,
+                                                               .pNext = &performanceInfo,
+                                                               .queryType = VK_QUERY_TYPE_PERFORMANCE_QUERY_KHR,
+                                                               .queryCount = queryCount});
+    vkResetQueryPool(logical_device, performance_pool, 0, queryCount);
+}
+
+std::uint32_t GpuCounters::first_query(const std::uint32_t slot) const
+{
+    return slot * max_passes;
+}
+} // namespace vultex
@@ -0,0 +1,101 @@
+#pragma once
+
+#define GLFW_INCLUDE_VULKAN
+#include <GLFW/glfw3.h>
+
+#include <array>
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "frame_statistics.hpp"
+#include "vulkan_context.hpp"
+
+namespace vultex
+{
+
+struct PerformanceCounterInfo
+{
+    std::string name;
+    std::string category;
+    std::string description;
+    VkPerformanceCounterUnitKHR unit;
+};
+
+// GPU side of the frame instrumentation, the counterpart of the CPU passes of
+// FrameStatistics. Per pass it collects timestamps, pipeline statistics
+// (vertex / fragment invocations, clipping) and, with VK_KHR_performance_query,
+// the selected vendor counters; collect() hands them to FrameStatistics.
+// Invocation counts tell whether a pass is vertex or fill bound.
+//
+// Every frame slot has its own range of queries, so results are read without
+// waiting once the slot's submission completed. Passes don't nest and have to
+// begin outside of render passes, counters of a pass cover the whole pass.
+class GpuCounters
+{
+public:
+    static constexpr std::uint32_t max_passes = 32;
+
+    // Performance counters are selected by name among the ones listed in the
+    // log, only those which can be collected in a single submission are used.
+    GpuCounters(const VulkanContext& context,
+                std::uint32_t frames_in_flight,
+                const std::vector<std::string>& performance_counters = {});
+    GpuCounters(const GpuCounters&) = delete;
+    GpuCounters(GpuCounters&&) = delete;
+    GpuCounters& operator=(const GpuCounters&) = delete;
+    GpuCounters& operator=(GpuCounters&&) = delete;
+    ~GpuCounters();
+
+    // first commands of the frame's command buffer, frame is the number
+    // returned by FrameStatistics::begin_frame
+    void begin_frame(VkCommandBuffer command_buffer, std::uint32_t slot, std::uint64_t frame);
+    // pass name has to outlive the statistics
+    void begin_pass(VkCommandBuffer command_buffer, std::string_view name);
+    void end_pass(VkCommandBuffer command_buffer);
+    void end_frame(VkCommandBuffer command_buffer);
+
+    // The last submission of the slot has to be complete, does nothing when
+    // the slot has no results pending
+    void collect(std::uint32_t slot, FrameStatistics& statistics);
+
+    // every counter of the graphics queue family, empty without the extension
+    [[nodiscard]] const std::vector<PerformanceCounterInfo>& available_performance_counters() const;
+
+private:
+    struct Slot
+    {
+        std::optional<std::uint64_t> frame{};
+        std::vector<std::string_view> passes{};
+    };
+
+    void select_performance_counters(const VulkanContext& context, const std::vector<std::string>& names);
+    [[nodiscard]] std::uint32_t first_query(std::uint32_t slot) const;
+
+    VkDevice logical_device{nullptr};
+    std::uint32_t frames_in_flight{0};
+    std::uint64_t timestamp_mask{0};
+    double timestamp_period{0.0};
+
+    VkQueryPool timestamp_pool{nullptr};
+    VkQueryPool statistics_pool{nullptr};
+    VkQueryPool performance_pool{nullptr};
+    bool profiling_lock{false};
+
+    std::vector<PerformanceCounterInfo> available_counters{};
+    std::vector<std::uint32_t> counter_indices{};
+    std::vector<VkPerformanceCounterStorageKHR> counter_storages{};
+
+    std::vector<Slot> slots{};
+    std::uint32_t recording_slot{0};
+    bool pass_open{false};
+
+    // scratch space of collect(), sized once
+    std::vector<std::uint64_t> timestamps{};
+    std::vector<std::uint64_t> statistic_results{};
+    std::vector<VkPerformanceCounterResultKHR> performance_results{};
+    std::vector<GpuCounterValue> pass_counters{};
+};
+} // namespace vultex
@@ -0,0 +1,401 @@
+#include "gpu_particles.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <fmt/format.h>
+#include <future>
+#include <spdlog/spdlog.h>
+#include <stdexcept>
+
+#include "hash.hpp"
+#include "host_allocator.hpp"
+#include "vulkan_memory.hpp"
+
+namespace vultex
+{
+namespace
+{
+constexpr std::uint32_t workgroup_size = 256;
+constexpr std::uint32_t set_bindings = 6;
+
+// pass_index of particle_counters.comp
+constexpr std::uint32_t after_emission = 0;
+constexpr std::uint32_t after_simulation = 1;
+
+// std140 ParticleParameters of particles.glsl
+struct ParticleParameters
+{
+    glm::mat4 view;
+    glm::vec4 emitter_position; // xyz, w spawn radius
+    glm::vec4 emitter_velocity; // xyz, w velocity variance
+    glm::vec4 gravity;          // xyz, w drag
+    glm::vec4 timing;           // delta time, lifetime, lifetime variance, size
+    glm::uvec4 frame;           // emit count, random seed, current alive list, first drawn entry of particle_order
+    glm::uvec4 limits;          // capacity
+};
+
+// std430 ParticleCounters of particles.glsl, the indirect arguments first
+struct ParticleCounters
+{
+    VkDispatchIndirectCommand dispatch;
+    std::uint32_t unused;
+    VkDrawIndirectCommand draw;
+    std::array<std::uint32_t, 2> alive_count;
+    std::int32_t dead_count;
+};
+
+static_assert(offsetof(ParticleCounters, draw) == 16);
+
+[[nodiscard]] std::uint32_t group_count(const std::uint32_t count)
+{
+    return (count + workgroup_size - 1) / workgroup_size;
+}
+
+// every step reads what the one before wrote, as storage, uniform or indirect arguments
+void step_barrier(VkCommandBuffer command_buffer)
+{
+    const VkMemoryBarrier barrier{.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER,
+                                  .srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT | VK_ACCESS_TRANSFER_WRITE_BIT,
+                                  .dstAccessMask = VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT |
+                                                   VK_ACCESS_UNIFORM_READ_BIT | VK_ACCESS_INDIRECT_COMMAND_READ_BIT |
+                                                   VK_ACCESS_TRANSFER_WRITE_BIT};
+    vkCmdPipelineBarrier(command_buffer,
+                         VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT | VK_PIPELINE_STAGE_TRANSFER_BIT,
+                         VK_PIPELINE_STAGE_DRAW_INDIRECT_BIT | VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT |
+                             VK_PIPELINE_STAGE_TRANSFER_BIT,
+                         0,
+                         1,
+                         &barrier,
+                         0,
+                         nullptr,
+                         0,
+                         nullptr);
+}
+} // namespace
+
+GpuParticles::GpuParticles(const VulkanContext& context,
+                           const GpuPrimitives& primitives,
+                           ShaderModuleCache& shaders,
+                           PipelineCompiler& compiler,
+                           const std::filesystem::path& shader_directory,
+                           const std::uint32_t capacity,
+                           const bool sort_by_depth)
+    : logical_device{context.logical_device()},
+      particle_capacity{capacity},
+      sort_by_depth{sort_by_depth}
+{
+    if (capacity == 0 || capacity > max_capacity)
+    {
+        throw std::invalid_argument(
+            fmt::format("Particle capacity {} is out of range, at most {} are supported!", capacity, max_capacity));
+    }
+    spdlog::info("Create GPU particles: {} particles{}", capacity, sort_by_depth ? ", sorted by depth" : "");
+
+    // parameters, counters, particles, dead list, draw order and sort keys in
+    // one buffer, so a single barrier moves everything between queue families
+    VkPhysicalDeviceProperties properties{};
+    vkGetPhysicalDeviceProperties(context.physical_device(), &properties);
+    const auto alignment = std::max({properties.limits.minStorageBufferOffsetAlignment,
+                                     properties.limits.minUniformBufferOffsetAlignment,
+                                     VkDeviceSize{4}});
+    VkDeviceSize bufferSize = 0;
+    const auto region = [&bufferSize, alignment](const VkDeviceSize size)
+    {
+        const GpuBufferRange range{.buffer = nullptr, .offset = bufferSize, .size = size};
+        bufferSize += align_up(size, alignment);
+        return range;
+    };
+    const VkDeviceSize listSize = VkDeviceSize{sizeof(std::uint32_t)} * capacity;
+    parameters = region(sizeof(ParticleParameters));
+    counters = region(sizeof(ParticleCounters));
+    particles = region(VkDeviceSize{2 * sizeof(glm::vec4)} * capacity);
+    dead = region(listSize);
+    // two alive lists, then the sorted order at a storage buffer offset of its own, the sort binds it
+    const auto sortedOffset = align_up(2 * listSize, alignment);
+    sorted_first = static_cast<std::uint32_t>(sortedOffset / sizeof(std::uint32_t));
+    order = region(sort_by_depth ? sortedOffset + listSize : 2 * listSize);
+    keys = region(sort_by_depth ? listSize : sizeof(std::uint32_t));
+
+    const VkBufferCreateInfo bufferInfo{.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO,
+                                        .size = bufferSize,
+                                        .usage = VK_BUFFER_USAGE_STORAGE_BUFFER_BIT |
+                                                 VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT |
+                                                 VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT |
+                                                 VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+                                        .sharingMode = VK_SHARING_MODE_EXCLUSIVE};
+    if (VK_SUCCESS != vkCreateBuffer(logical_device, &bufferInfo, allocation_callbacks(), &buffer))
+    {
+        throw std::runtime_error("Failed to create particle buffer!");
+    }
+
+    VkMemoryRequirements requirements{};
+    vkGetBufferMemoryRequirements(logical_device, buffer, &requirements);
+    const auto memoryType = find_memory_type(
+        context.physical_device(), requirements.memoryTypeBits, {VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, 0});
+    if (!memoryType)
+    {
+        throw std::runtime_error("Cannot find memory for particle buffer!");
+    }
+
+    const VkMemoryAllocateInfo allocateInfo{.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO,
+                                            .allocationSize = requirements.size,
+                                            .memoryTypeIndex = memoryType.value()};
+    if (VK_SUCCESS != vkAllocateMemory(logical_device, &allocateInfo, allocation_callbacks(), &memory))
+    {
+        throw std::runtime_error("Failed to allocate particle memory!");
+    }
+    vkBindBufferMemory(logical_device, buffer, memory, 0);
+
+    for (auto* range : {&parameters, &counters, &particles, &dead, &order, &keys})
+    {
+        range->buffer = buffer;
+    }
+    if (sort_by_depth)
+    {
+        // only the survivors are sorted, counted by the draw's instance count which
+        // particle_counters.comp sets to the alive count of the step
+        sort = std::make_unique<GpuRadixSort>(
+            primitives,
+            keys,
+            GpuBufferRange{.buffer = buffer, .offset = order.offset + sortedOffset, .size = listSize},
+            capacity,
+            GpuBufferRange{.buffer = buffer,
+                           .offset = counters.offset + offsetof(ParticleCounters, draw) +
+                                     offsetof(VkDrawIndirectCommand, instanceCount),
+                           .size = sizeof(std::uint32_t)});
+    }
+
+    // parameters, counters, particles, dead list, order and keys; the vertex
+    // shaders only read parameters, particles and order
+    constexpr VkShaderStageFlags drawn = VK_SHADER_STAGE_COMPUTE_BIT | VK_SHADER_STAGE_VERTEX_BIT;
+    std::array<VkDescriptorSetLayoutBinding, set_bindings> bindings{};
+    for (std::uint32_t binding = 0; binding < set_bindings; ++binding)
+    {
+        bindings[binding] = VkDescriptorSetLayoutBinding{
+            .binding = binding,
+            .descriptorType = binding == 0 ? VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER : VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
+            .descriptorCount = 1,
+            .stageFlags = binding % 2 == 0 ? drawn : VkShaderStageFlags{VK_SHADER_STAGE_COMPUTE_BIT}};
+    }
+    const VkDescriptorSetLayoutCreateInfo setLayoutInfo{.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO,
+                                                        .bindingCount = set_bindings,
+                                                        .pBindings = bindings.data()};
+    if (VK_SUCCESS !=
+        vkCreateDescriptorSetLayout(logical_device, &setLayoutInfo, allocation_callbacks(), &descriptor_set_layout))
+    {
+        throw std::runtime_error("Failed to create particle descriptor set layout!");
+    }
+
+    const std::array poolSizes{
+        VkDescriptorPoolSize{.type = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, .descriptorCount = set_bindings - 1},
+        VkDescriptorPoolSize{.type = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, .descriptorCount = 1}};
+    const VkDescriptorPoolCreateInfo poolInfo{.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO,
+                                              .maxSets = 1,
+                                              .poolSizeCount = static_cast<std::uint32_t>(poolSizes.size()),
+                                              .pPoolSizes = poolSizes.data()};
+    if (VK_SUCCESS != vkCreateDescriptorPool(logical_device, &poolInfo, allocation_callbacks(), &pool))
+    {
+        throw std::runtime_error("Failed to create particle descriptor pool!");
+    }
+
+    const VkDescriptorSetAllocateInfo setInfo{.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO,
+                                              .descriptorPool = pool,
+                                              .descriptorSetCount = 1,
+                                              .pSetLayouts = &descriptor_set_layout};
+    if (VK_SUCCESS != vkAllocateDescriptorSets(logical_device, &setInfo, &set))
+    {
+        throw std::runtime_error("Failed to allocate particle descriptor set!");
+    }
+
+    const std::array<GpuBufferRange, set_bindings> ranges{parameters, counters, particles, dead, order, keys};
+    std::array<VkDescriptorBufferInfo, set_bindings> bufferInfos{};
+    std::array<VkWriteDescriptorSet, set_bindings> writes{};
+    for (std::uint32_t binding = 0; binding < set_bindings; ++binding)
+    {
+        bufferInfos[binding] = VkDescriptorBufferInfo{
+            .buffer = ranges[binding].buffer, .offset = ranges[binding].offset, .range = ranges[binding].size};
+        writes[binding] = VkWriteDescriptorSet{.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET,
+                                               .dstSet = set,
+                                               .dstBinding = binding,
+                                               .descriptorCount = 1,
+                                               .descriptorType = bindings[binding].descriptorType,
+                                               .pBufferInfo = &bufferInfos[binding]};
+    }
+    vkUpdateDescriptorSets(logical_device, set_bindings, writes.data(), 0, nullptr);
+
+    const VkPushConstantRange pushConstants{
+        .stageFlags = VK_SHADER_STAGE_COMPUTE_BIT, .offset = 0, .size = sizeof(std::uint32_t)};
+    const VkPipelineLayoutCreateInfo layoutInfo{.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO,
+                                                .setLayoutCount = 1,
+                                                .pSetLayouts = &descriptor_set_layout,
+                                                .pushConstantRangeCount = 1,
+                                                .pPushConstantRanges = &pushConstants};
+    if (VK_SUCCESS != vkCreatePipelineLayout(logical_device, &layoutInfo, allocation_callbacks(), &layout))
+    {
+        throw std::runtime_error("Failed to create particle pipeline layout!");
+    }
+
+    const auto kernel = [&](const std::string_view name)
+    {
+        const auto file = shader_directory / fmt::format("{}.comp.spv", name);
+        return compile_compute_kernel(
+            compiler, fnv1a(file.string()), shaders.load(file, VK_SHADER_STAGE_COMPUTE_BIT), layout);
+    };
+    const std::array builds{kernel("particle_init"),
+                            kernel("particle_emit"),
+                            kernel("particle_counters"),
+                            kernel("particle_simulate"),
+                            kernel("particle_sort_keys")};
+    init_pipeline = PipelineCompiler::wait(builds[0], "particle init");
+    emit_pipeline = PipelineCompiler::wait(builds[1], "particle emit");
+    counters_pipeline = PipelineCompiler::wait(builds[2], "particle counters");
+    simulate_pipeline = PipelineCompiler::wait(builds[3], "particle simulate");
+    sort_keys_pipeline = PipelineCompiler::wait(builds[4], "particle sort keys");
+}
+
+GpuParticles::~GpuParticles()
+{
+    // pipelines belong to the compiler
+    vkDestroyPipelineLayout(logical_device, layout, allocation_callbacks());
+    vkDestroyDescriptorPool(logical_device, pool, allocation_callbacks());
+    vkDestroyDescriptorSetLayout(logical_device, descriptor_set_layout, allocation_callbacks());
+    sort.reset();
+    vkDestroyBuffer(logical_device, buffer, allocation_callbacks());
+    vkFreeMemory(logical_device, memory, allocation_callbacks());
+}
+
+std::uint32_t GpuParticles::capacity() const
+{
+    return particle_capacity;
+}
+
+VkDescriptorSetLayout GpuParticles::set_layout() const
+{
+    return descriptor_set_layout;
+}
+
+VkDescriptorSet GpuParticles::descriptor_set() const
+{
+    return set;
+}
+
+PassBuffer GpuParticles::simulation_buffer() const
+{
+    return PassBuffer{.buffer = buffer,
+                      .stage = VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT | VK_PIPELINE_STAGE_DRAW_INDIRECT_BIT |
+                               VK_PIPELINE_STAGE_TRANSFER_BIT,
+                      .access = VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT |
+                                VK_ACCESS_INDIRECT_COMMAND_READ_BIT | VK_ACCESS_TRANSFER_WRITE_BIT};
+}
+
+PassBuffer GpuParticles::draw_buffer() const
+{
+    return PassBuffer{
+        .buffer = buffer,
+        .stage = VK_PIPELINE_STAGE_DRAW_INDIRECT_BIT | VK_PIPELINE_STAGE_VERTEX_SHADER_BIT,
+        .access = VK_ACCESS_INDIRECT_COMMAND_READ_BIT | VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_UNIFORM_READ_BIT};
+}
+
+void GpuParticles::record_simulation(VkCommandBuffer command_buffer, const ParticleFrame& frame)
+{
+    if (frame.emit_count > particle_capacity)
+    {
+        throw std::invalid_argument(fmt::format(
+            "Cannot emit {} particles at once, the capacity is {}!", frame.emit_count, particle_capacity));
+    }
+
+    // the lists swap every step, the survivors of this one are drawn
+    const auto current = step % 2;
+    const auto next = 1 - current;
+    const ParticleParameters particleParameters{
+        .view = frame.view,
+        .emitter_position = glm::vec4{frame.emitter_position, frame.emitter_radius},
+        .emitter_velocity = glm::vec4{frame.emitter_velocity, frame.velocity_variance},
+        .gravity = glm::vec4{frame.gravity, frame.drag},
+        .timing = {frame.delta_time, frame.lifetime, frame.lifetime_variance, frame.size},
+        .frame = {frame.emit_count, step, current, sort_by_depth ? sorted_first : next * particle_capacity},
+        .limits = {particle_capacity, 0, 0, 0}};
+
+    // the previous step's shaders and indirect reads are done before the
+    // parameters are written again
+    vkCmdPipelineBarrier(command_buffer,
+                         VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT | VK_PIPELINE_STAGE_DRAW_INDIRECT_BIT,
+                         VK_PIPELINE_STAGE_TRANSFER_BIT,
+                         0,
+                         0,
+                         nullptr,
+                         0,
+                         nullptr,
+                         0,
+                         nullptr);
+    vkCmdUpdateBuffer(command_buffer, buffer, parameters.offset, sizeof(particleParameters), &particleParameters);
+    if (!initialized)
+    {
+        const ParticleCounters initialCounters{.dispatch = {0, 1, 1},
+                                               .unused = 0,
+                                               .draw = {6, 0, 0, 0},
+                                               .alive_count = {0, 0},
+                                               .dead_count = static_cast<std::int32_t>(particle_capacity)};
+        vkCmdUpdateBuffer(command_buffer, buffer, counters.offset, sizeof(initialCounters), &initialCounters);
+    }
+    step_barrier(command_buffer);
+
+    vkCmdBindDescriptorSets(command_buffer, VK_PIPELINE_BIND_POINT_COMPUTE, layout, 0, 1, &set, 0, nullptr);
+    if (!initialized)
+    {
+        dispatch(command_buffer, init_pipeline, 0, group_count(particle_capacity));
+        step_barrier(command_buffer);
+        initialized = true;
+    }
+
+    if (frame.emit_count > 0)
+    {
+        dispatch(command_buffer, emit_pipeline, 0, group_count(frame.emit_count));
+        step_barrier(command_buffer);
+    }
+
+    dispatch(command_buffer, counters_pipeline, after_emission, 1);
+    step_barrier(command_buffer);
+
+    dispatch_indirect(command_buffer, simulate_pipeline);
+    step_barrier(command_buffer);
+
+    dispatch(command_buffer, counters_pipeline, after_simulation, 1);
+    step_barrier(command_buffer);
+
+    if (sort_by_depth)
+    {
+        dispatch_indirect(command_buffer, sort_keys_pipeline);
+        step_barrier(command_buffer);
+        sort->record(command_buffer);
+    }
+
+    ++step;
+}
+
+void GpuParticles::draw(VkCommandBuffer command_buffer) const
+{
+    vkCmdDrawIndirect(command_buffer,
+                      buffer,
+                      counters.offset + offsetof(ParticleCounters, draw),
+                      1,
+                      sizeof(VkDrawIndirectCommand));
+}
+
+void GpuParticles::dispatch(VkCommandBuffer command_buffer,
+                            VkPipeline pipeline,
+                            const std::uint32_t pass_index,
+                            const std::uint32_t groups) const
+{
+    vkCmdBindPipeline(command_buffer, VK_PIPELINE_BIND_POINT_COMPUTE, pipeline);
+    vkCmdPushConstants(command_buffer, layout, VK_SHADER_STAGE_COMPUTE_BIT, 0, sizeof(pass_index), &pass_index);
+    vkCmdDispatch(command_buffer, groups, 1, 1);
+}
+
+void GpuParticles::dispatch_indirect(VkCommandBuffer command_buffer, VkPipeline pipeline) const
+{
+    vkCmdBindPipeline(command_buffer, VK_PIPELINE_BIND_POINT_COMPUTE, pipeline);
+    vkCmdDispatchIndirect(command_buffer, buffer, counters.offset + offsetof(ParticleCounters, dispatch));
+}
+} // namespace vultex
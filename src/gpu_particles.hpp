@@ -0,0 +1,116 @@
+#pragma once
+
+#define GLFW_INCLUDE_VULKAN
+#include <GLFW/glfw3.h>
+
+#include <cstdint>
+#include <filesystem>
+#include <glm/glm.hpp>
+#include <memory>
+
+#include "gpu_primitives.hpp"
+#include "pipeline_compiler.hpp"
+#include "queue_scheduler.hpp"
+#include "shader_module_cache.hpp"
+#include "vulkan_context.hpp"
+
+namespace vultex
+{
+
+// Emission and forces of one simulation step, the same for all particles
+struct ParticleFrame
+{
+    // for the depth sort, the view the particles are drawn with
+    glm::mat4 view;
+    glm::vec3 emitter_position;
+    float emitter_radius;
+    glm::vec3 emitter_velocity;
+    float velocity_variance;
+    glm::vec3 gravity;
+    float drag;
+    float delta_time;
+    float lifetime;
+    float lifetime_variance;
+    // half the side of a particle's quad in world units
+    float size;
+    // particles emitted in this step, as many as there are dead ones
+    std::uint32_t emit_count;
+};
+
+// Particles living on the GPU only. The simulation is recorded on the compute
+// queue: emitted particles are taken from a dead list, every alive one is
+// integrated and appended to the next alive list or back to the dead list,
+// which keeps the alive particles compact without touching dead ones.
+// Optionally the alive list is sorted back to front with GpuRadixSort.
+// The graphics queue draws them with one indirect draw whose instance count
+// the simulation wrote, so neither queue's CPU cost depends on the number of
+// particles. Everything is in one buffer; as passes of a QueueScheduler with
+// simulation_buffer() and draw_buffer(), it moves between the queue families
+// and the two submissions wait for each other.
+class GpuParticles
+{
+public:
+    // one invocation per alive particle, maxComputeWorkGroupCount[0] is at least 65535
+    static constexpr std::uint32_t max_capacity = 65535 * 256;
+
+    GpuParticles(const VulkanContext& context,
+                 const GpuPrimitives& primitives,
+                 ShaderModuleCache& shaders,
+                 PipelineCompiler& compiler,
+                 const std::filesystem::path& shader_directory,
+                 std::uint32_t capacity,
+                 bool sort_by_depth);
+    GpuParticles(const GpuParticles&) = delete;
+    GpuParticles(GpuParticles&&) = delete;
+    GpuParticles& operator=(const GpuParticles&) = delete;
+    GpuParticles& operator=(GpuParticles&&) = delete;
+    ~GpuParticles();
+
+    [[nodiscard]] std::uint32_t capacity() const;
+
+    // set of particles.glsl, compute and vertex stages
+    [[nodiscard]] VkDescriptorSetLayout set_layout() const;
+    [[nodiscard]] VkDescriptorSet descriptor_set() const;
+
+    [[nodiscard]] PassBuffer simulation_buffer() const;
+    [[nodiscard]] PassBuffer draw_buffer() const;
+
+    // compute queue, after the previous step's draw
+    void record_simulation(VkCommandBuffer command_buffer, const ParticleFrame& frame);
+
+    // 6 vertices per particle, instances in draw order; the bound pipeline's
+    // layout has set_layout() as set 0
+    void draw(VkCommandBuffer command_buffer) const;
+
+private:
+    void dispatch(VkCommandBuffer command_buffer, VkPipeline pipeline, std::uint32_t pass_index, std::uint32_t groups)
+        const;
+    void dispatch_indirect(VkCommandBuffer command_buffer, VkPipeline pipeline) const;
+
+    VkDevice logical_device{nullptr};
+    std::uint32_t particle_capacity{0};
+    bool sort_by_depth{false};
+    // entry of particle_order where the sorted draw order starts
+    std::uint32_t sorted_first{0};
+    VkBuffer buffer{nullptr};
+    VkDeviceMemory memory{nullptr};
+    GpuBufferRange parameters{};
+    GpuBufferRange counters{};
+    GpuBufferRange particles{};
+    GpuBufferRange dead{};
+    GpuBufferRange order{};
+    GpuBufferRange keys{};
+    std::unique_ptr<GpuRadixSort> sort{};
+    VkDescriptorSetLayout descriptor_set_layout{nullptr};
+    VkDescriptorPool pool{nullptr};
+    VkDescriptorSet set{nullptr};
+    VkPipelineLayout layout{nullptr};
+    VkPipeline init_pipeline{nullptr};
+    VkPipeline emit_pipeline{nullptr};
+    VkPipeline counters_pipeline{nullptr};
+    VkPipeline simulate_pipeline{nullptr};
+    VkPipeline sort_keys_pipeline{nullptr};
+    std::uint32_t step{0};
+    bool initialized{false};
+};
+} // namespace vultex
@@ -0,0 +1,613 @@
+#include "gpu_primitives.hpp"
+
+#include <algorithm>
+#include <bit>
+#include <fmt/format.h>
+#include <spdlog/spdlog.h>
+#include <stdexcept>
+
+#include "hash.hpp"
+#include "host_allocator.hpp"
+#include "vulkan_memory.hpp"
+
+namespace vultex
+{
+namespace
+{
+constexpr std::uint32_t workgroup_size = 256;
+constexpr std::uint32_t buffer_bindings = 5;
+// the deepest plan, a scan of max_count elements, has 5 steps
+constexpr std::uint32_t max_plan_steps = 16;
+constexpr std::uint32_t radix_digits = 4;
+constexpr std::uint32_t radix = 256;
+// histograms of all digits, the tile counter of every pass, the number of
+// elements sorted and the indirect dispatch of the passes, see radix_onesweep.comp
+constexpr std::uint32_t radix_element_count = radix_digits * radix + radix_digits;
+constexpr std::uint32_t radix_dispatch_size = radix_element_count + 1;
+constexpr std::uint32_t radix_state_header = radix_dispatch_size + 3;
+
+constexpr std::array<std::string_view, 7> kernel_names{
+    "reduce", "scan", "scan_add", "compact", "radix_histogram", "radix_onesweep", "radix_dispatch"};
+
+[[nodiscard]] std::uint32_t tile_count(const std::uint32_t count)
+{
+    return std::max<std::uint32_t>((count + GpuPrimitives::tile_size - 1) / GpuPrimitives::tile_size, 1);
+}
+
+void check_count(const std::uint32_t count)
+{
+    if (count > GpuPrimitives::max_count)
+    {
+        throw std::invalid_argument(fmt::format(
+            "Compute primitive over {} elements, at most {} are supported!", count, GpuPrimitives::max_count));
+    }
+}
+
+// the whole range is bound as a storage buffer
+void check_range(const GpuPrimitives& primitives,
+                 const GpuBufferRange& range,
+                 const std::uint32_t elements,
+                 const std::string_view name)
+{
+    if (range.size < VkDeviceSize{sizeof(std::uint32_t)} * elements)
+    {
+        throw std::invalid_argument(fmt::format(
+            "Compute primitive {} range of {} bytes is too small for {} elements!", name, range.size, elements));
+    }
+    if (range.size > primitives.max_storage_buffer_range())
+    {
+        throw std::invalid_argument(fmt::format("Compute primitive {} range of {} bytes is over maxStorageBufferRange "
+                                                "({} bytes)!",
+                                                name,
+                                                range.size,
+                                                primitives.max_storage_buffer_range()));
+    }
+}
+
+// offsets of the kept values, then the scan levels
+[[nodiscard]] std::vector<std::uint32_t> compact_scratch(const std::uint32_t count,
+                                                         const std::vector<std::uint32_t>& levels)
+{
+    std::vector<std::uint32_t> sizes{count};
+    sizes.insert(sizes.end(), levels.begin(), levels.end());
+    return sizes;
+}
+
+// keys and values to ping pong with, then the state header and the tile
+// status of one pass
+[[nodiscard]] std::vector<std::uint32_t> radix_sort_scratch(const std::uint32_t count)
+{
+    return {count, count, radix_state_header + tile_count(count) * radix};
+}
+} // namespace
+
+ComputeVariant ComputeVariant::select(VkPhysicalDevice physical_device)
+{
+    VkPhysicalDeviceSubgroupProperties subgroupProperties{
+        .sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_SUBGROUP_PROPERTIES};
+    VkPhysicalDeviceProperties2 properties{.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PROPERTIES_2,
+                                           .pNext = &subgroupProperties};
+    vkGetPhysicalDeviceProperties2(physical_device, &properties);
+
+    // the shaders take the subgroup size of the pipeline, the partials of up to workgroup_size subgroups fit
+    constexpr VkSubgroupFeatureFlags required = VK_SUBGROUP_FEATURE_BASIC_BIT | VK_SUBGROUP_FEATURE_ARITHMETIC_BIT;
+    const auto subgroups = (subgroupProperties.supportedStages & VK_SHADER_STAGE_COMPUTE_BIT) != 0 &&
+                           (subgroupProperties.supportedOperations & required) == required &&
+                           std::has_single_bit(subgroupProperties.subgroupSize) &&
+                           subgroupProperties.subgroupSize <= workgroup_size;
+    return ComputeVariant{.subgroups = subgroups, .subgroup_size = subgroups ? subgroupProperties.subgroupSize : 1};
+}
+
+ComputeVariant ComputeVariant::shared_memory()
+{
+    return ComputeVariant{.subgroups = false, .subgroup_size = 1};
+}
+
+GpuPrimitives::GpuPrimitives(const VulkanContext& context,
+                             ShaderModuleCache& shaders,
+                             PipelineCompiler& compiler,
+                             const std::filesystem::path& shader_directory,
+                             const ComputeVariant& variant)
+    : vk_physical_device{context.physical_device()},
+      vk_logical_device{context.logical_device()},
+      compute_variant{variant}
+{
+    VkPhysicalDeviceProperties properties{};
+    vkGetPhysicalDeviceProperties(vk_physical_device, &properties);
+    max_storage_range = properties.limits.maxStorageBufferRange;
+    storage_offset_alignment = std::max<VkDeviceSize>(properties.limits.minStorageBufferOffsetAlignment, 4);
+
+    spdlog::info("Create compute primitives: {}",
+                 compute_variant.subgroups ? fmt::format("subgroups of {}", compute_variant.subgroup_size)
+                                           : std::string{"shared memory"});
+
+    std::array<VkDescriptorSetLayoutBinding, buffer_bindings> bindings{};
+    for (std::uint32_t binding = 0; binding < buffer_bindings; ++binding)
+    {
+        bindings[binding] = VkDescriptorSetLayoutBinding{.binding = binding,
+                                                         .descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
+                                                         .descriptorCount = 1,
+                                                         .stageFlags = VK_SHADER_STAGE_COMPUTE_BIT};
+    }
+    const VkDescriptorSetLayoutCreateInfo setLayoutInfo{.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO,
+                                                        .bindingCount = buffer_bindings,
+                                                        .pBindings = bindings.data()};
+    if (VK_SUCCESS !=
+        vkCreateDescriptorSetLayout(vk_logical_device, &setLayoutInfo, allocation_callbacks(), &descriptor_set_layout))
+    {
+        throw std::runtime_error("Failed to create compute primitive descriptor set layout!");
+    }
+
+    const VkPushConstantRange pushConstants{.stageFlags = VK_SHADER_STAGE_COMPUTE_BIT,
+                                            .offset = 0,
+                                            .size = sizeof(std::array<std::uint32_t, 3>)};
+    const VkPipelineLayoutCreateInfo layoutInfo{.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO,
+                                                .setLayoutCount = 1,
+                                                .pSetLayouts = &descriptor_set_layout,
+                                                .pushConstantRangeCount = 1,
+                                                .pPushConstantRanges = &pushConstants};
+    if (VK_SUCCESS != vkCreatePipelineLayout(vk_logical_device, &layoutInfo, allocation_callbacks(), &pipeline_layout))
+    {
+        throw std::runtime_error("Failed to create compute primitive pipeline layout!");
+    }
+
+    // all kernels compile in parallel
+    std::array<std::shared_future<VkPipeline>, kernel_names.size()> builds{};
+    for (std::size_t kernel = 0; kernel < kernel_names.size(); ++kernel)
+    {
+        const auto file =
+            shader_directory /
+            fmt::format("{}.comp{}", kernel_names[kernel], compute_variant.subgroups ? ".subgroup.spv" : ".spv");
+        builds[kernel] =
+            compile_compute_kernel(compiler,
+                                   fnv1a(fmt::format("{}:{}", file.string(), compute_variant.subgroup_size)),
+                                   shaders.load(file, VK_SHADER_STAGE_COMPUTE_BIT),
+                                   pipeline_layout);
+    }
+    for (std::size_t kernel = 0; kernel < kernel_names.size(); ++kernel)
+    {
+        pipelines[kernel] = PipelineCompiler::wait(builds[kernel], kernel_names[kernel]);
+    }
+}
+
+GpuPrimitives::~GpuPrimitives()
+{
+    // pipelines belong to the compiler
+    vkDestroyPipelineLayout(vk_logical_device, pipeline_layout, allocation_callbacks());
+    vkDestroyDescriptorSetLayout(vk_logical_device, descriptor_set_layout, allocation_callbacks());
+}
+
+const ComputeVariant& GpuPrimitives::variant() const
+{
+    return compute_variant;
+}
+
+VkPhysicalDevice GpuPrimitives::physical_device() const
+{
+    return vk_physical_device;
+}
+
+VkDevice GpuPrimitives::logical_device() const
+{
+    return vk_logical_device;
+}
+
+VkDescriptorSetLayout GpuPrimitives::set_layout() const
+{
+    return descriptor_set_layout;
+}
+
+VkPipelineLayout GpuPrimitives::layout() const
+{
+    return pipeline_layout;
+}
+
+VkPipeline GpuPrimitives::pipeline(const ComputeKernel kernel) const
+{
+    return pipelines[static_cast<std::size_t>(kernel)];
+}
+
+VkDeviceSize GpuPrimitives::max_storage_buffer_range() const
+{
+    return max_storage_range;
+}
+
+VkDeviceSize GpuPrimitives::min_storage_buffer_offset_alignment() const
+{
+    return storage_offset_alignment;
+}
+
+ComputePlan::ComputePlan(const GpuPrimitives& primitives, const std::vector<std::uint32_t>& scratch_sizes)
+    : primitives{primitives}
+{
+    for (const auto elements : scratch_sizes)
+    {
+        const VkDeviceSize size = VkDeviceSize{sizeof(std::uint32_t)} * std::max<std::uint32_t>(elements, 1);
+        check_range(primitives, GpuBufferRange{.buffer = nullptr, .offset = 0, .size = size}, elements, "scratch");
+    }
+
+    const auto logicalDevice = primitives.logical_device();
+
+    const VkDescriptorPoolSize poolSize{.type = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
+                                        .descriptorCount = max_plan_steps * buffer_bindings};
+    const VkDescriptorPoolCreateInfo poolInfo{.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO,
+                                              .maxSets = max_plan_steps,
+                                              .poolSizeCount = 1,
+                                              .pPoolSizes = &poolSize};
+    if (VK_SUCCESS != vkCreateDescriptorPool(logicalDevice, &poolInfo, allocation_callbacks(), &pool))
+    {
+        throw std::runtime_error("Failed to create compute plan descriptor pool!");
+    }
+
+    if (scratch_sizes.empty())
+    {
+        return;
+    }
+
+    // all regions in one buffer, each at a valid storage buffer offset
+    const auto alignment = primitives.min_storage_buffer_offset_alignment();
+    VkDeviceSize scratchSize = 0;
+    for (const auto elements : scratch_sizes)
+    {
+        const VkDeviceSize size = VkDeviceSize{sizeof(std::uint32_t)} * std::max<std::uint32_t>(elements, 1);
+        scratch_regions.push_back(GpuBufferRange{.buffer = nullptr, .offset = scratchSize, .size = size});
+        scratchSize += align_up(size, alignment);
+    }
+
+    const VkBufferCreateInfo bufferInfo{.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO,
+                                        .size = scratchSize,
+                                        .usage = VK_BUFFER_USAGE_STORAGE_BUFFER_BIT |
+                                                 VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT |
+                                                 VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+                                        .sharingMode = VK_SHARING_MODE_EXCLUSIVE};
+    if (VK_SUCCESS != vkCreateBuffer(logicalDevice, &bufferInfo, allocation_callbacks(), &scratch_buffer))
+    {
+        throw std::runtime_error("Failed to create compute plan scratch buffer!");
+    }
+
+    VkMemoryRequirements requirements{};
+    vkGetBufferMemoryRequirements(logicalDevice, scratch_buffer, &requirements);
+    const auto memoryType = find_memory_type(
+        primitives.physical_device(), requirements.memoryTypeBits, {VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, 0});
+    if (!memoryType)
+    {
+        throw std::runtime_error("Cannot find memory for compute plan scratch buffer!");
+    }
+
+    const VkMemoryAllocateInfo allocateInfo{.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO,
+                                            .allocationSize = requirements.size,
+                                            .memoryTypeIndex = memoryType.value()};
+    if (VK_SUCCESS != vkAllocateMemory(logicalDevice, &allocateInfo, allocation_callbacks(), &scratch_memory))
+    {
+        throw std::runtime_error("Failed to allocate compute plan scratch memory!");
+    }
+    vkBindBufferMemory(logicalDevice, scratch_buffer, scratch_memory, 0);
+
+    for (auto& region : scratch_regions)
+    {
+        region.buffer = scratch_buffer;
+    }
+}
+
+ComputePlan::~ComputePlan()
+{
+    const auto logicalDevice = primitives.logical_device();
+    vkDestroyDescriptorPool(logicalDevice, pool, allocation_callbacks());
+    vkDestroyBuffer(logicalDevice, scratch_buffer, allocation_callbacks());
+    vkFreeMemory(logicalDevice, scratch_memory, allocation_callbacks());
+}
+
+void ComputePlan::record(VkCommandBuffer command_buffer) const
+{
+    for (const auto& step : steps)
+    {
+        if (step.fill)
+        {
+            vkCmdFillBuffer(command_buffer, step.fill->buffer, step.fill->offset, step.fill->size, step.fill_value);
+        }
+        else
+        {
+            vkCmdBindPipeline(command_buffer, VK_PIPELINE_BIND_POINT_COMPUTE, step.pipeline);
+            vkCmdBindDescriptorSets(
+                command_buffer, VK_PIPELINE_BIND_POINT_COMPUTE, primitives.layout(), 0, 1, &step.set, 0, nullptr);
+            vkCmdPushConstants(command_buffer,
+                               primitives.layout(),
+                               VK_SHADER_STAGE_COMPUTE_BIT,
+                               0,
+                               sizeof(step.constants),
+                               step.constants.data());
+            if (step.indirect)
+            {
+                vkCmdDispatchIndirect(command_buffer, step.indirect->buffer, step.indirect->offset);
+            }
+            else
+            {
+                vkCmdDispatch(command_buffer, step.group_count, 1, 1);
+            }
+        }
+
+        // every step reads what the previous ones wrote, as storage or indirect arguments
+        const VkMemoryBarrier barrier{
+            .sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER,
+            .srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT | VK_ACCESS_TRANSFER_WRITE_BIT,
+            .dstAccessMask = VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT | VK_ACCESS_TRANSFER_READ_BIT |
+                             VK_ACCESS_TRANSFER_WRITE_BIT | VK_ACCESS_INDIRECT_COMMAND_READ_BIT};
+        vkCmdPipelineBarrier(command_buffer,
+                             VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT | VK_PIPELINE_STAGE_TRANSFER_BIT,
+                             VK_PIPELINE_STAGE_DRAW_INDIRECT_BIT | VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT |
+                                 VK_PIPELINE_STAGE_TRANSFER_BIT,
+                             0,
+                             1,
+                             &barrier,
+                             0,
+                             nullptr,
+                             0,
+                             nullptr);
+    }
+}
+
+GpuBufferRange ComputePlan::scratch(const std::size_t region) const
+{
+    return scratch_regions.at(region);
+}
+
+void ComputePlan::add_fill(const GpuBufferRange& range, const std::uint32_t value)
+{
+    steps.push_back(Step{.fill = range,
+                         .fill_value = value,
+                         .pipeline = nullptr,
+                         .set = nullptr,
+                         .constants = {},
+                         .group_count = 0,
+                         .indirect = std::nullopt});
+}
+
+void ComputePlan::add_dispatch(const ComputeKernel kernel,
+                               const std::initializer_list<GpuBufferRange> buffers,
+                               const std::uint32_t count,
+                               const std::uint32_t group_count,
+                               const std::uint32_t shift,
+                               const std::uint32_t pass_index)
+{
+    steps.push_back(Step{.fill = std::nullopt,
+                         .fill_value = 0,
+                         .pipeline = primitives.pipeline(kernel),
+                         .set = allocate_set(buffers),
+                         .constants = {count, shift, pass_index},
+                         .group_count = group_count,
+                         .indirect = std::nullopt});
+}
+
+void ComputePlan::add_dispatch(const ComputeKernel kernel,
+                               const std::initializer_list<GpuBufferRange> buffers,
+                               const std::uint32_t count,
+                               const GpuBufferRange& arguments,
+                               const std::uint32_t shift,
+                               const std::uint32_t pass_index)
+{
+    steps.push_back(Step{.fill = std::nullopt,
+                         .fill_value = 0,
+                         .pipeline = primitives.pipeline(kernel),
+                         .set = allocate_set(buffers),
+                         .constants = {count, shift, pass_index},
+                         .group_count = 0,
+                         .indirect = arguments});
+}
+
+VkDescriptorSet ComputePlan::allocate_set(const std::initializer_list<GpuBufferRange> buffers)
+{
+    const auto logicalDevice = primitives.logical_device();
+    const auto setLayout = primitives.set_layout();
+    const VkDescriptorSetAllocateInfo setInfo{.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO,
+                                              .descriptorPool = pool,
+                                              .descriptorSetCount = 1,
+                                              .pSetLayouts = &setLayout};
+    VkDescriptorSet set{nullptr};
+    if (VK_SUCCESS != vkAllocateDescriptorSets(logicalDevice, &setInfo, &set))
+    {
+        throw std::runtime_error("Failed to allocate compute plan descriptor set!");
+    }
+
+    // bindings the kernel doesn't use stay unwritten
+    std::array<VkDescriptorBufferInfo, buffer_bindings> bufferInfos{};
+    std::array<VkWriteDescriptorSet, buffer_bindings> writes{};
+    std::uint32_t binding = 0;
+    for (const auto& buffer : buffers)
+    {
+        bufferInfos[binding] =
+            VkDescriptorBufferInfo{.buffer = buffer.buffer, .offset = buffer.offset, .range = buffer.size};
+        writes[binding] = VkWriteDescriptorSet{.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET,
+                                               .dstSet = set,
+                                               .dstBinding = binding,
+                                               .descriptorCount = 1,
+                                               .descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
+                                               .pBufferInfo = &bufferInfos[binding]};
+        ++binding;
+    }
+    vkUpdateDescriptorSets(logicalDevice, binding, writes.data(), 0, nullptr);
+    return set;
+}
+
+std::vector<std::uint32_t> ComputePlan::scan_levels(const std::uint32_t count)
+{
+    std::vector<std::uint32_t> levels{};
+    auto elements = count;
+    do
+    {
+        elements = tile_count(elements);
+        levels.push_back(elements);
+    } while (elements > 1);
+    return levels;
+}
+
+void ComputePlan::add_scan(const GpuBufferRange& input,
+                           const GpuBufferRange& output,
+                           const std::uint32_t count,
+                           const std::size_t first_region)
+{
+    // level 0 scans the tiles of the input, every further level the block sums
+    // of the one below, until they fit in a single tile
+    const auto levels = scan_levels(count);
+    add_dispatch(ComputeKernel::scan, {input, output, scratch(first_region)}, count, levels[0]);
+    for (std::size_t level = 1; level < levels.size(); ++level)
+    {
+        const auto sums = scratch(first_region + level - 1);
+        add_dispatch(
+            ComputeKernel::scan, {sums, sums, scratch(first_region + level)}, levels[level - 1], levels[level]);
+    }
+
+    // then down again, adding the scanned sums of each level to the tiles below
+    for (auto level = levels.size() - 1; level-- > 0;)
+    {
+        const auto prefixes = level == 0 ? output : scratch(first_region + level - 1);
+        const auto elements = level == 0 ? count : levels[level - 1];
+        add_dispatch(ComputeKernel::scan_add, {prefixes, scratch(first_region + level)}, elements, levels[level]);
+    }
+}
+
+GpuReduce::GpuReduce(const GpuPrimitives& primitives,
+                     const GpuBufferRange& input,
+                     const GpuBufferRange& output,
+                     const std::uint32_t count)
+    : ComputePlan{primitives, scan_levels(count)}
+{
+    check_count(count);
+    check_range(primitives, input, count, "input");
+    check_range(primitives, output, 1, "output");
+
+    // every workgroup sums a tile, until one is left
+    auto source = input;
+    auto elements = count;
+    for (std::size_t level = 0;; ++level)
+    {
+        const auto groups = tile_count(elements);
+        const auto target = groups == 1 ? output : scratch(level);
+        add_dispatch(ComputeKernel::reduce, {source, target}, elements, groups);
+        if (groups == 1)
+        {
+            break;
+        }
+        source = target;
+        elements = groups;
+    }
+}
+
+GpuScan::GpuScan(const GpuPrimitives& primitives,
+                 const GpuBufferRange& input,
+                 const GpuBufferRange& output,
+                 const std::uint32_t count)
+    : ComputePlan{primitives, scan_levels(count)}
+{
+    check_count(count);
+    check_range(primitives, input, count, "input");
+    check_range(primitives, output, count, "output");
+    add_scan(input, output, count, 0);
+}
+
+GpuCompact::GpuCompact(const GpuPrimitives& primitives,
+                       const GpuBufferRange& values,
+                       const GpuBufferRange& flags,
+                       const GpuBufferRange& output,
+                       const GpuBufferRange& output_count,
+                       const std::uint32_t count)
+    : ComputePlan{primitives, compact_scratch(count, scan_levels(count))}
+{
+    check_count(count);
+    check_range(primitives, values, count, "values");
+    check_range(primitives, flags, count, "flags");
+    check_range(primitives, output, count, "output");
+    check_range(primitives, output_count, 1, "output count");
+
+    const auto offsets = scratch(0);
+    add_scan(flags, offsets, count, 1);
+    add_dispatch(ComputeKernel::compact, {values, flags, offsets, output, output_count}, count, tile_count(count));
+}
+
+GpuRadixSort::GpuRadixSort(const GpuPrimitives& primitives,
+                           const GpuBufferRange& keys,
+                           const GpuBufferRange& values,
+                           const std::uint32_t count,
+                           const std::optional<GpuBufferRange>& live_count)
+    : ComputePlan{primitives, radix_sort_scratch(count)}
+{
+    check_count(count);
+    check_range(primitives, keys, count, "keys");
+    check_range(primitives, values, count, "values");
+    if (live_count && live_count->offset % sizeof(std::uint32_t) != 0)
+    {
+        throw std::invalid_argument("Radix sort live count is not at a 4 byte offset!");
+    }
+    if (count == 0)
+    {
+        return;
+    }
+
+    const auto otherKeys = scratch(0);
+    const auto otherValues = scratch(1);
+    const auto state = scratch(2);
+    const auto tiles = tile_count(count);
+    const auto stateWords = [&state](const std::uint32_t first, const std::uint32_t words)
+    {
+        return GpuBufferRange{.buffer = state.buffer,
+                              .offset = state.offset + VkDeviceSize{sizeof(std::uint32_t)} * first,
+                              .size = VkDeviceSize{sizeof(std::uint32_t)} * words};
+    };
+    // the status of every tile in the pass being sorted, it is looked back at by the later tiles
+    const auto tileStatus = stateWords(radix_state_header, tiles * radix);
+    const auto arguments = stateWords(radix_dispatch_size, 3);
+
+    add_fill(state);
+    if (live_count)
+    {
+        // bound from a valid storage buffer offset, the count is an element of the range
+        const auto alignment = primitives.min_storage_buffer_offset_alignment();
+        const auto boundOffset = live_count->offset / alignment * alignment;
+        const GpuBufferRange bound{.buffer = live_count->buffer,
+                                   .offset = boundOffset,
+                                   .size = live_count->offset - boundOffset + sizeof(std::uint32_t)};
+        check_range(primitives, bound, 1, "live count");
+        add_dispatch(ComputeKernel::radix_dispatch,
+                     {bound, state},
+                     count,
+                     1,
+                     static_cast<std::uint32_t>((live_count->offset - boundOffset) / sizeof(std::uint32_t)));
+    }
+    else
+    {
+        add_fill(stateWords(radix_element_count, 1), count);
+    }
+
+    const auto addPass = [&](const ComputeKernel kernel,
+                             const std::initializer_list<GpuBufferRange> buffers,
+                             const std::uint32_t shift,
+                             const std::uint32_t pass_index)
+    {
+        if (live_count)
+        {
+            add_dispatch(kernel, buffers, count, arguments, shift, pass_index);
+        }
+        else
+        {
+            add_dispatch(kernel, buffers, count, tiles, shift, pass_index);
+        }
+    };
+    addPass(ComputeKernel::radix_histogram, {keys, state}, 0, 0);
+    // an even number of passes ends in keys and values again
+    for (std::uint32_t pass = 0; pass < radix_digits; ++pass)
+    {
+        if (pass > 0)
+        {
+            add_fill(tileStatus);
+        }
+        const auto even = pass % 2 == 0;
+        addPass(ComputeKernel::radix_onesweep,
+                {even ? keys : otherKeys,
+                 even ? values : otherValues,
+                 even ? otherKeys : keys,
+                 even ? otherValues : values,
+                 state},
+                pass * 8,
+                pass);
+    }
+}
+} // namespace vultex
@@ -0,0 +1,222 @@
+#pragma once
+
+#define GLFW_INCLUDE_VULKAN
+#include <GLFW/glfw3.h>
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <initializer_list>
+#include <optional>
+#include <vector>
+
+#include "pipeline_compiler.hpp"
+#include "shader_module_cache.hpp"
+#include "vulkan_context.hpp"
+
+namespace vultex
+{
+
+// Part of a buffer with 32 bit elements, the buffer needs storage usage
+struct GpuBufferRange
+{
+    VkBuffer buffer;
+    VkDeviceSize offset;
+    VkDeviceSize size;
+};
+
+// Build of the primitives for a device. With subgroup arithmetic in compute
+// shaders a workgroup scans and reduces within subgroups and combines one
+// partial result per subgroup, otherwise everything goes through shared
+// memory. subgroup_size is what the device reports, the shaders use the size
+// of the pipeline.
+struct ComputeVariant
+{
+    bool subgroups;
+    std::uint32_t subgroup_size;
+
+    [[nodiscard]] static ComputeVariant select(VkPhysicalDevice physical_device);
+    // the shared memory build, which every device runs
+    [[nodiscard]] static ComputeVariant shared_memory();
+};
+
+enum class ComputeKernel : std::uint8_t
+{
+    reduce,
+    scan,
+    scan_add,
+    compact,
+    radix_histogram,
+    radix_onesweep,
+    radix_dispatch
+};
+
+// Pipelines of the compute primitives (src/shaders), shared by all plans.
+// Kernels are loaded as <kernel>.comp.spv or, for the subgroup variant,
+// <kernel>.comp.subgroup.spv from shader_directory.
+class GpuPrimitives
+{
+public:
+    // elements one workgroup processes, 256 invocations with 4 each
+    static constexpr std::uint32_t tile_size = 1024;
+    // one tile per workgroup, maxComputeWorkGroupCount[0] is at least 65535.
+    // Every range is also limited to maxStorageBufferRange, at least 2^27
+    // bytes or 32M elements, plans over larger ranges throw.
+    static constexpr std::uint32_t max_count = 65535 * tile_size;
+
+    // pipelines are built by and belong to compiler, it has to outlive this;
+    // variant is ComputeVariant::select() of the device, or shared_memory()
+    // to run that build on a device with subgroups as well
+    GpuPrimitives(const VulkanContext& context,
+                  ShaderModuleCache& shaders,
+                  PipelineCompiler& compiler,
+                  const std::filesystem::path& shader_directory,
+                  const ComputeVariant& variant);
+    GpuPrimitives(const GpuPrimitives&) = delete;
+    GpuPrimitives(GpuPrimitives&&) = delete;
+    GpuPrimitives& operator=(const GpuPrimitives&) = delete;
+    GpuPrimitives& operator=(GpuPrimitives&&) = delete;
+    ~GpuPrimitives();
+
+    [[nodiscard]] const ComputeVariant& variant() const;
+
+    [[nodiscard]] VkPhysicalDevice physical_device() const;
+    [[nodiscard]] VkDevice logical_device() const;
+    [[nodiscard]] VkDescriptorSetLayout set_layout() const;
+    [[nodiscard]] VkPipelineLayout layout() const;
+    [[nodiscard]] VkPipeline pipeline(ComputeKernel kernel) const;
+    [[nodiscard]] VkDeviceSize max_storage_buffer_range() const;
+    [[nodiscard]] VkDeviceSize min_storage_buffer_offset_alignment() const;
+
+private:
+    VkPhysicalDevice vk_physical_device{VK_NULL_HANDLE};
+    VkDevice vk_logical_device{nullptr};
+    ComputeVariant compute_variant{};
+    VkDeviceSize max_storage_range{0};
+    VkDeviceSize storage_offset_alignment{4};
+    VkDescriptorSetLayout descriptor_set_layout{nullptr};
+    VkPipelineLayout pipeline_layout{nullptr};
+    std::array<VkPipeline, 7> pipelines{};
+};
+
+// A primitive on fixed buffers: scratch memory and descriptor sets are
+// created once, record() only dispatches. Inputs have to be visible to
+// compute shaders before record(), results are visible to compute shaders
+// and transfers recorded after it.
+class ComputePlan
+{
+public:
+    ComputePlan(const ComputePlan&) = delete;
+    ComputePlan(ComputePlan&&) = delete;
+    ComputePlan& operator=(const ComputePlan&) = delete;
+    ComputePlan& operator=(ComputePlan&&) = delete;
+    virtual ~ComputePlan();
+
+    void record(VkCommandBuffer command_buffer) const;
+
+protected:
+    // scratch_sizes in elements, one region each
+    ComputePlan(const GpuPrimitives& primitives, const std::vector<std::uint32_t>& scratch_sizes);
+
+    [[nodiscard]] GpuBufferRange scratch(std::size_t region) const;
+
+    void add_fill(const GpuBufferRange& range, std::uint32_t value = 0);
+    void add_dispatch(ComputeKernel kernel,
+                      std::initializer_list<GpuBufferRange> buffers,
+                      std::uint32_t count,
+                      std::uint32_t group_count,
+                      std::uint32_t shift = 0,
+                      std::uint32_t pass_index = 0);
+    // group count from a VkDispatchIndirectCommand in arguments, written by an earlier step
+    void add_dispatch(ComputeKernel kernel,
+                      std::initializer_list<GpuBufferRange> buffers,
+                      std::uint32_t count,
+                      const GpuBufferRange& arguments,
+                      std::uint32_t shift = 0,
+                      std::uint32_t pass_index = 0);
+
+    // Block sums of every level of a scan over count elements, the last level
+    // is a single block
+    [[nodiscard]] static std::vector<std::uint32_t> scan_levels(std::uint32_t count);
+    // exclusive scan using one scratch region per entry of scan_levels(count),
+    // starting at first_region; input and output may be the same range
+    void add_scan(const GpuBufferRange& input,
+                  const GpuBufferRange& output,
+                  std::uint32_t count,
+                  std::size_t first_region);
+
+private:
+    struct Step
+    {
+        std::optional<GpuBufferRange> fill;
+        std::uint32_t fill_value;
+        VkPipeline pipeline;
+        VkDescriptorSet set;
+        std::array<std::uint32_t, 3> constants;
+        std::uint32_t group_count;
+        std::optional<GpuBufferRange> indirect;
+    };
+
+    [[nodiscard]] VkDescriptorSet allocate_set(std::initializer_list<GpuBufferRange> buffers);
+
+    const GpuPrimitives& primitives;
+    VkBuffer scratch_buffer{nullptr};
+    VkDeviceMemory scratch_memory{nullptr};
+    std::vector<GpuBufferRange> scratch_regions{};
+    VkDescriptorPool pool{nullptr};
+    std::vector<Step> steps{};
+};
+
+// Sum of count elements into output[0]
+class GpuReduce final : public ComputePlan
+{
+public:
+    GpuReduce(const GpuPrimitives& primitives,
+              const GpuBufferRange& input,
+              const GpuBufferRange& output,
+              std::uint32_t count);
+};
+
+// Exclusive prefix sum, output[i] = input[0] + ... + input[i - 1]
+class GpuScan final : public ComputePlan
+{
+public:
+    GpuScan(const GpuPrimitives& primitives,
+            const GpuBufferRange& input,
+            const GpuBufferRange& output,
+            std::uint32_t count);
+};
+
+// Values with a flag of 1 (flags are 0 or 1) in their order to output, their
+// number to output_count[0]
+class GpuCompact final : public ComputePlan
+{
+public:
+    GpuCompact(const GpuPrimitives& primitives,
+               const GpuBufferRange& values,
+               const GpuBufferRange& flags,
+               const GpuBufferRange& output,
+               const GpuBufferRange& output_count,
+               std::uint32_t count);
+};
+
+// Stable in place sort of 32 bit keys with a value each (an index for
+// example). Onesweep: one histogram pass over all digits, then per 8 bit
+// digit a single pass where every tile sorts locally and finds its global
+// offset by looking back at the tiles before it (decoupled look-back). The
+// passes share one tile status array, zeroed before each of them.
+// With live_count only the first live_count[0] elements (at most count) are
+// sorted, a number written on the GPU before record(), e.g. by a culling
+// pass: the passes are dispatched indirectly over the tiles of those
+// elements, the rest of keys and values is left as it is.
+class GpuRadixSort final : public ComputePlan
+{
+public:
+    GpuRadixSort(const GpuPrimitives& primitives,
+                 const GpuBufferRange& keys,
+                 const GpuBufferRange& values,
+                 std::uint32_t count,
+                 const std::optional<GpuBufferRange>& live_count = std::nullopt);
+};
+} // namespace vultex
@@ -0,0 +1,29 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <string_view>
+
+namespace vultex
+{
+
+// 64 bit FNV-1a, cheap and stable between runs so it can name files on disk
+constexpr std::uint64_t fnv1a_offset_basis = 0xcbf29ce484222325ULL;
+
+constexpr std::uint64_t fnv1a(std::span<const std::byte> bytes, std::uint64_t hash = fnv1a_offset_basis)
+{
+    constexpr std::uint64_t prime = 0x100000001b3ULL;
+    for (const auto byte : bytes)
+    {
+        hash ^= static_cast<std::uint64_t>(byte);
+        hash *= prime;
+    }
+    return hash;
+}
+
+inline std::uint64_t fnv1a(std::string_view text, std::uint64_t hash = fnv1a_offset_basis)
+{
+    return fnv1a(std::as_bytes(std::span{text}), hash);
+}
+} // namespace vultex
@@ -0,0 +1,255 @@
+#include "host_allocator.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <cstdlib>
+#include <cstring>
+#include <iterator>
+#include <spdlog/spdlog.h>
+
+namespace vultex
+{
+namespace
+{
+std::atomic<const VkAllocationCallbacks*> installed_callbacks{nullptr};
+
+constexpr std::size_t smallest_size_class = 16;
+constexpr std::size_t slab_size = 64 * 1024;
+
+struct BlockHeader
+{
+    void* raw;
+    std::size_t size;
+    std::uint32_t size_class;
+    std::uint32_t scope;
+};
+
+constexpr std::size_t size_of_class(const std::size_t size_class)
+{
+    return smallest_size_class << size_class;
+}
+
+BlockHeader* header_of(void* memory)
+{
+    return std::prev(static_cast<BlockHeader*>(memory));
+}
+
+const char* get_scope_name(const std::size_t scope)
+{
+    switch (scope)
+    {
+    case VK_SYSTEM_ALLOCATION_SCOPE_COMMAND:
+        return "Command";
+    case VK_SYSTEM_ALLOCATION_SCOPE_OBJECT:
+        return "Object";
+    case VK_SYSTEM_ALLOCATION_SCOPE_CACHE:
+        return "Cache";
+    case VK_SYSTEM_ALLOCATION_SCOPE_DEVICE:
+        return "Device";
+    case VK_SYSTEM_ALLOCATION_SCOPE_INSTANCE:
+        return "Instance";
+    default:
+        return "Unknown";
+    }
+}
+} // namespace
+
+const VkAllocationCallbacks* allocation_callbacks()
+{
+    return installed_callbacks.load(std::memory_order_acquire);
+}
+
+void install_allocation_callbacks(const VkAllocationCallbacks* callbacks)
+{
+    installed_callbacks.store(callbacks, std::memory_order_release);
+}
+
+HostAllocator::HostAllocator()
+{
+    vk_callbacks = VkAllocationCallbacks{
+        .pUserData = this,
+        .pfnAllocation = [](void* user_data, const std::size_t size, const std::size_t alignment,
+                            const VkSystemAllocationScope scope) -> void*
+        { return static_cast<HostAllocator*>(user_data)->allocate(size, alignment, scope); },
+        .pfnReallocation = [](void* user_data, void* original, const std::size_t size, const std::size_t alignment,
+                              const VkSystemAllocationScope scope) -> void*
+        { return static_cast<HostAllocator*>(user_data)->reallocate(original, size, alignment, scope); },
+        .pfnFree = [](void* user_data, void* memory) { static_cast<HostAllocator*>(user_data)->free(memory); },
+        .pfnInternalAllocation = [](void* user_data, const std::size_t size, VkInternalAllocationType /*type*/,
+                                    const VkSystemAllocationScope scope)
+        { static_cast<HostAllocator*>(user_data)->notify_internal(size, scope, true); },
+        .pfnInternalFree = [](void* user_data, const std::size_t size, VkInternalAllocationType /*type*/,
+                              const VkSystemAllocationScope scope)
+        { static_cast<HostAllocator*>(user_data)->notify_internal(size, scope, false); }};
+}
+
+HostAllocator::~HostAllocator()
+{
+    for (auto& pool : pools)
+    {
+        std::ranges::for_each(pool.slabs, [](void* slab) { std::free(slab); });
+    }
+}
+
+const VkAllocationCallbacks* HostAllocator::callbacks() const
+{
+    return &vk_callbacks;
+}
+
+HostAllocator::Statistics HostAllocator::statistics(const VkSystemAllocationScope scope) const
+{
+    const auto& pool = pools.at(scope);
+    const std::scoped_lock lock{pool.mutex};
+    return pool.statistics;
+}
+
+void HostAllocator::log_statistics() const
+{
+    spdlog::info("Driver host memory per allocation scope:");
+    for (std::size_t scope = 0; scope < scope_count; ++scope)
+    {
+        const auto statistics = this->statistics(static_cast<VkSystemAllocationScope>(scope));
+        spdlog::info("\t {:8} allocations: {:7} reallocations: {:5} frees: {:7} peak: {:9} B internal peak: {:9} B "
+                     "leaked: {} B",
+                     get_scope_name(scope),
+                     statistics.allocations,
+                     statistics.reallocations,
+                     statistics.frees,
+                     statistics.peak_bytes,
+                     statistics.peak_internal_bytes,
+                     statistics.bytes);
+    }
+}
+
+void* HostAllocator::allocate(const std::size_t size, const std::size_t alignment, const VkSystemAllocationScope scope)
+{
+    if (0 == size)
+    {
+        return nullptr;
+    }
+
+    // the header lives right before the returned (aligned) pointer
+    const auto align = std::max(alignment, alignof(BlockHeader));
+    const auto needed = size + sizeof(BlockHeader) + align - 1;
+
+    std::uint32_t size_class = 0;
+    while (size_class < size_class_count && size_of_class(size_class) < needed)
+    {
+        ++size_class;
+    }
+
+    auto& pool = pools.at(scope);
+    const std::scoped_lock lock{pool.mutex};
+
+    void* raw = size_class < size_class_count ? take_block(pool, size_class) : std::malloc(needed);
+    if (nullptr == raw)
+    {
+        return nullptr;
+    }
+
+    const auto first_free = reinterpret_cast<std::uintptr_t>(raw) + sizeof(BlockHeader);
+    auto* memory = reinterpret_cast<void*>((first_free + align - 1) / align * align);
+    *header_of(memory) = BlockHeader{
+        .raw = raw, .size = size, .size_class = size_class, .scope = static_cast<std::uint32_t>(scope)};
+
+    auto& statistics = pool.statistics;
+    ++statistics.allocations;
+    statistics.bytes += size;
+    statistics.peak_bytes = std::max(statistics.peak_bytes, statistics.bytes);
+    return memory;
+}
+
+void* HostAllocator::reallocate(void* original,
+                                const std::size_t size,
+                                const std::size_t alignment,
+                                const VkSystemAllocationScope scope)
+{
+    if (nullptr == original)
+    {
+        return allocate(size, alignment, scope);
+    }
+    if (0 == size)
+    {
+        free(original);
+        return nullptr;
+    }
+
+    // on failure the original allocation has to stay untouched
+    auto* memory = allocate(size, alignment, scope);
+    if (nullptr == memory)
+    {
+        return nullptr;
+    }
+    std::memcpy(memory, original, std::min(size, header_of(original)->size));
+    free(original);
+
+    auto& pool = pools.at(scope);
+    const std::scoped_lock lock{pool.mutex};
+    ++pool.statistics.reallocations;
+    return memory;
+}
+
+void HostAllocator::free(void* memory)
+{
+    if (nullptr == memory)
+    {
+        return;
+    }
+
+    const auto header = *header_of(memory);
+    auto& pool = pools.at(header.scope);
+    const std::scoped_lock lock{pool.mutex};
+
+    if (header.size_class < size_class_count)
+    {
+        pool.free_blocks.at(header.size_class).push_back(header.raw);
+    }
+    else
+    {
+        std::free(header.raw);
+    }
+
+    ++pool.statistics.frees;
+    pool.statistics.bytes -= header.size;
+}
+
+void HostAllocator::notify_internal(const std::size_t size, const VkSystemAllocationScope scope, const bool allocated)
+{
+    auto& pool = pools.at(scope);
+    const std::scoped_lock lock{pool.mutex};
+
+    auto& statistics = pool.statistics;
+    statistics.internal_bytes = allocated ? statistics.internal_bytes + size : statistics.internal_bytes - size;
+    statistics.peak_internal_bytes = std::max(statistics.peak_internal_bytes, statistics.internal_bytes);
+}
+
+void* HostAllocator::take_block(Pool& pool, const std::size_t size_class)
+{
+    auto& free_blocks = pool.free_blocks.at(size_class);
+    if (!free_blocks.empty())
+    {
+        auto* block = free_blocks.back();
+        free_blocks.pop_back();
+        return block;
+    }
+
+    const auto block_size = size_of_class(size_class);
+    if (pool.slab_left < block_size)
+    {
+        // the tail of the previous slab is dropped, it is smaller than a block
+        auto* slab = std::malloc(slab_size);
+        if (nullptr == slab)
+        {
+            return nullptr;
+        }
+        pool.slabs.push_back(slab);
+        pool.slab_cursor = static_cast<std::byte*>(slab);
+        pool.slab_left = slab_size;
+    }
+
+    auto* block = pool.slab_cursor;
+    pool.slab_cursor = std::next(pool.slab_cursor, static_cast<std::ptrdiff_t>(block_size));
+    pool.slab_left -= block_size;
+    return block;
+}
+} // namespace vultex
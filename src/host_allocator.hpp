@@ -0,0 +1,74 @@
+#pragma once
+
+#define GLFW_INCLUDE_VULKAN
+#include <GLFW/glfw3.h>
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <vector>
+
+namespace vultex
+{
+
+// Callbacks passed to every vkCreate* / vkDestroy* call, nullptr (driver
+// allocator) until some are installed. They have to be installed before the
+// instance is created and stay valid until it is destroyed.
+[[nodiscard]] const VkAllocationCallbacks* allocation_callbacks();
+void install_allocation_callbacks(const VkAllocationCallbacks* callbacks);
+
+// Host memory of the driver served from size class pools, separated per
+// VkSystemAllocationScope so short lived command allocations don't fragment
+// long lived instance / device ones. Bytes and calls are counted per scope.
+class HostAllocator
+{
+public:
+    HostAllocator();
+    HostAllocator(const HostAllocator&) = delete;
+    HostAllocator(HostAllocator&&) = delete;
+    HostAllocator& operator=(const HostAllocator&) = delete;
+    HostAllocator& operator=(HostAllocator&&) = delete;
+    ~HostAllocator();
+
+    [[nodiscard]] const VkAllocationCallbacks* callbacks() const;
+
+    void log_statistics() const;
+
+    struct Statistics
+    {
+        std::uint64_t allocations;
+        std::uint64_t reallocations;
+        std::uint64_t frees;
+        std::uint64_t bytes;
+        std::uint64_t peak_bytes;
+        std::uint64_t internal_bytes;
+        std::uint64_t peak_internal_bytes;
+    };
+    [[nodiscard]] Statistics statistics(VkSystemAllocationScope scope) const;
+
+private:
+    static constexpr std::size_t scope_count = VK_SYSTEM_ALLOCATION_SCOPE_INSTANCE + 1;
+    static constexpr std::size_t size_class_count = 9; // 16 B .. 4 KiB, bigger go to malloc
+
+    struct Pool
+    {
+        mutable std::mutex mutex{};
+        std::array<std::vector<void*>, size_class_count> free_blocks{};
+        std::vector<void*> slabs{};
+        std::byte* slab_cursor{nullptr};
+        std::size_t slab_left{0};
+        Statistics statistics{};
+    };
+
+    void* allocate(std::size_t size, std::size_t alignment, VkSystemAllocationScope scope);
+    void* reallocate(void* original, std::size_t size, std::size_t alignment, VkSystemAllocationScope scope);
+    void free(void* memory);
+    void notify_internal(std::size_t size, VkSystemAllocationScope scope, bool allocated);
+
+    [[nodiscard]] static void* take_block(Pool& pool, std::size_t size_class);
+
+    VkAllocationCallbacks vk_callbacks{};
+    std::array<Pool, scope_count> pools{};
+};
+} // namespace vultex
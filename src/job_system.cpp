@@ -0,0 +1,128 @@
+#include "job_system.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <spdlog/spdlog.h>
+
+namespace vultex
+{
+namespace
+{
+thread_local const JobSystem* thread_pool = nullptr;
+thread_local std::uint32_t thread_index = 0;
+} // namespace
+
+JobSystem::JobSystem(const std::uint32_t worker_count)
+{
+    spdlog::info("Start job system with {} workers", worker_count);
+
+    workers.reserve(worker_count);
+    for (std::uint32_t index = 1; index <= worker_count; ++index)
+    {
+        workers.emplace_back([this, index](const std::stop_token& stop_token) { worker_loop(stop_token, index); });
+    }
+}
+
+JobSystem::~JobSystem()
+{
+    for (auto& worker : workers)
+    {
+        worker.request_stop();
+    }
+    condition.notify_all();
+}
+
+void JobSystem::parallel_for(const std::size_t count,
+                             const std::size_t batch_size,
+                             const std::function<void(std::size_t, std::size_t)>& body)
+{
+    const auto batch = std::max<std::size_t>(batch_size, 1);
+    const auto batch_count = (count + batch - 1) / batch;
+    if (batch_count <= 1 || workers.empty())
+    {
+        body(0, count);
+        return;
+    }
+
+    struct State
+    {
+        std::atomic<std::size_t> next_batch{0};
+        std::atomic<std::size_t> finished_batches{0};
+    };
+    auto state = std::make_shared<State>();
+
+    // helpers which start after all batches are taken return immediately,
+    // so the caller never waits on a job that is still in the queue
+    const auto run_batches = [state, &body, count, batch, batch_count]()
+    {
+        for (auto index = state->next_batch++; index < batch_count; index = state->next_batch++)
+        {
+            const auto begin = index * batch;
+            body(begin, std::min(begin + batch, count));
+            if (++state->finished_batches == batch_count)
+            {
+                state->finished_batches.notify_all();
+            }
+        }
+    };
+
+    const auto helpers = std::min<std::size_t>(workers.size(), batch_count - 1);
+    for (std::size_t i = 0; i < helpers; ++i)
+    {
+        push(run_batches);
+    }
+    run_batches();
+
+    for (auto finished = state->finished_batches.load(); finished != batch_count;
+         finished = state->finished_batches.load())
+    {
+        state->finished_batches.wait(finished);
+    }
+}
+
+std::uint32_t JobSystem::worker_count() const
+{
+    return static_cast<std::uint32_t>(workers.size());
+}
+
+std::uint32_t JobSystem::current_thread_index() const
+{
+    return this == thread_pool ? thread_index : 0;
+}
+
+std::uint32_t JobSystem::default_worker_count()
+{
+    // main thread is busy with the frame loop
+    return std::max(std::thread::hardware_concurrency(), 2U) - 1;
+}
+
+void JobSystem::push(std::function<void()> job)
+{
+    {
+        const std::scoped_lock lock{mutex};
+        jobs.push_back(std::move(job));
+    }
+    condition.notify_one();
+}
+
+void JobSystem::worker_loop(const std::stop_token& stop_token, const std::uint32_t index)
+{
+    thread_pool = this;
+    thread_index = index;
+
+    while (true)
+    {
+        std::function<void()> job{};
+        {
+            std::unique_lock lock{mutex};
+            if (!condition.wait(lock, stop_token, [this]() { return !jobs.empty(); }))
+            {
+                return;
+            }
+            job = std::move(jobs.front());
+            jobs.pop_front();
+        }
+        job();
+    }
+}
+} // namespace vultex
@@ -0,0 +1,62 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+namespace vultex
+{
+
+// Fixed pool of worker threads shared by all CPU side subsystems
+class JobSystem
+{
+public:
+    explicit JobSystem(std::uint32_t worker_count = default_worker_count());
+    JobSystem(const JobSystem&) = delete;
+    JobSystem(JobSystem&&) = delete;
+    JobSystem& operator=(const JobSystem&) = delete;
+    JobSystem& operator=(JobSystem&&) = delete;
+    ~JobSystem();
+
+    template <typename Function>
+    [[nodiscard]] auto submit(Function&& function) -> std::future<std::invoke_result_t<Function>>
+    {
+        using Result = std::invoke_result_t<Function>;
+        auto task = std::make_shared<std::packaged_task<Result()>>(std::forward<Function>(function));
+        auto future = task->get_future();
+        push([task = std::move(task)]() { (*task)(); });
+        return future;
+    }
+
+    // Calls body(begin, end) for batches of [0, count). The calling thread
+    // takes part in the work, so it is safe to call it from a job.
+    void parallel_for(std::size_t count,
+                      std::size_t batch_size,
+                      const std::function<void(std::size_t, std::size_t)>& body);
+
+    [[nodiscard]] std::uint32_t worker_count() const;
+
+    // 1..worker_count() for the workers of this pool, 0 for every other
+    // thread, including the workers of other pools
+    [[nodiscard]] std::uint32_t current_thread_index() const;
+
+    [[nodiscard]] static std::uint32_t default_worker_count();
+
+private:
+    void push(std::function<void()> job);
+    void worker_loop(const std::stop_token& stop_token, std::uint32_t index);
+
+    std::mutex mutex{};
+    std::condition_variable_any condition{};
+    std::deque<std::function<void()>> jobs{};
+    std::vector<std::jthread> workers{};
+};
+} // namespace vultex
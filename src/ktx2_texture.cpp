@@ -0,0 +1,202 @@
+#include "ktx2_texture.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cstring>
+#include <fmt/format.h>
+#include <fstream>
+#include <stdexcept>
+
+namespace vultex
+{
+namespace
+{
+constexpr std::array<unsigned char, 12> ktx2_identifier = {
+    0xAB, 0x4B, 0x54, 0x58, 0x20, 0x32, 0x30, 0xBB, 0x0D, 0x0A, 0x1A, 0x0A};
+
+constexpr std::size_t header_offset = ktx2_identifier.size();
+constexpr std::size_t level_index_offset = 80;
+constexpr std::size_t level_index_entry_size = 3 * sizeof(std::uint64_t);
+
+// Khronos Data Format descriptor values
+constexpr std::uint8_t dfd_model_etc1s = 163;
+constexpr std::uint8_t dfd_model_uastc = 166;
+constexpr std::uint8_t dfd_transfer_srgb = 2;
+
+template <typename T>
+T read(const std::vector<std::byte>& bytes, const std::size_t offset)
+{
+    if (offset + sizeof(T) > bytes.size())
+    {
+        throw std::runtime_error("KTX2 file is truncated!");
+    }
+    T value{};
+    std::memcpy(&value, std::next(bytes.data(), offset), sizeof(T));
+    return value;
+}
+
+std::vector<std::byte> read_file(const std::filesystem::path& path)
+{
+    std::ifstream file{path, std::ios::binary | std::ios::ate};
+    if (!file)
+    {
+        throw std::runtime_error(fmt::format("Cannot open texture: {}", path.string()));
+    }
+
+    std::vector<std::byte> bytes(static_cast<std::size_t>(file.tellg()));
+    file.seekg(0);
+    file.read(reinterpret_cast<char*>(bytes.data()), static_cast<std::streamsize>(bytes.size()));
+    return bytes;
+}
+} // namespace
+
+Ktx2Texture::Ktx2Texture(const std::filesystem::path& path) : Ktx2Texture(read_file(path))
+{
+}
+
+Ktx2Texture::Ktx2Texture(std::vector<std::byte>&& bytes) : data{std::move(bytes)}
+{
+    if (data.size() < level_index_offset ||
+        0 != std::memcmp(data.data(), ktx2_identifier.data(), ktx2_identifier.size()))
+    {
+        throw std::runtime_error("Not a KTX2 file!");
+    }
+
+    // fields are read one by one, the file layout has no padding before sgd
+    std::array<std::uint32_t, 13> fields{};
+    for (std::size_t i = 0; i < fields.size(); ++i)
+    {
+        fields[i] = read<std::uint32_t>(data, header_offset + i * sizeof(std::uint32_t));
+    }
+    const auto [vk_format,
+                type_size,
+                pixel_width,
+                pixel_height,
+                pixel_depth,
+                layers,
+                faces,
+                mip_levels,
+                scheme,
+                dfd_offset,
+                dfd_length,
+                kvd_offset,
+                kvd_length] = fields;
+
+    header = Header{.vk_format = vk_format,
+                    .type_size = type_size,
+                    .pixel_width = pixel_width,
+                    .pixel_height = pixel_height,
+                    .pixel_depth = pixel_depth,
+                    .layer_count = layers,
+                    .face_count = faces,
+                    .level_count = mip_levels,
+                    .supercompression_scheme = scheme,
+                    .dfd_byte_offset = dfd_offset,
+                    .dfd_byte_length = dfd_length,
+                    .kvd_byte_offset = kvd_offset,
+                    .kvd_byte_length = kvd_length,
+                    .sgd_byte_offset = read<std::uint64_t>(data, 64),
+                    .sgd_byte_length = read<std::uint64_t>(data, 72)};
+
+    // level count 0 means that mipmaps should be generated at load time
+    const auto stored_levels = std::max(header.level_count, 1U);
+    for (std::uint32_t level = 0; level < stored_levels; ++level)
+    {
+        const auto entry = level_index_offset + level * level_index_entry_size;
+        const Ktx2Level info{.byte_offset = read<std::uint64_t>(data, entry),
+                             .byte_length = read<std::uint64_t>(data, entry + sizeof(std::uint64_t)),
+                             .uncompressed_byte_length =
+                                 read<std::uint64_t>(data, entry + 2 * sizeof(std::uint64_t))};
+
+        // no sum of the two, it could wrap around in a crafted file
+        if (info.byte_offset > data.size() || info.byte_length > data.size() - info.byte_offset)
+        {
+            throw std::runtime_error(fmt::format("KTX2 level {} is out of the file bounds!", level));
+        }
+        levels.push_back(info);
+    }
+}
+
+VkFormat Ktx2Texture::format() const
+{
+    return static_cast<VkFormat>(header.vk_format);
+}
+
+VkExtent3D Ktx2Texture::extent() const
+{
+    return VkExtent3D{.width = header.pixel_width,
+                      .height = std::max(header.pixel_height, 1U),
+                      .depth = std::max(header.pixel_depth, 1U)};
+}
+
+std::uint32_t Ktx2Texture::level_count() const
+{
+    return static_cast<std::uint32_t>(levels.size());
+}
+
+std::uint32_t Ktx2Texture::layer_count() const
+{
+    return std::max(header.layer_count, 1U);
+}
+
+std::uint32_t Ktx2Texture::face_count() const
+{
+    return std::max(header.face_count, 1U);
+}
+
+Ktx2Supercompression Ktx2Texture::supercompression() const
+{
+    return static_cast<Ktx2Supercompression>(header.supercompression_scheme);
+}
+
+bool Ktx2Texture::is_basis_universal() const
+{
+    const auto model = dfd_color_model();
+    return supercompression() == Ktx2Supercompression::basis_lz || model == dfd_model_etc1s ||
+           model == dfd_model_uastc;
+}
+
+bool Ktx2Texture::is_srgb() const
+{
+    return dfd_transfer_function() == dfd_transfer_srgb;
+}
+
+bool Ktx2Texture::can_upload_directly(const TextureFormatSupport& support) const
+{
+    return supercompression() == Ktx2Supercompression::none && format() != VK_FORMAT_UNDEFINED &&
+           support.is_supported(format());
+}
+
+std::span<const std::byte> Ktx2Texture::level_data(const std::uint32_t level) const
+{
+    const auto& info = levels.at(level);
+    return std::span{data}.subspan(info.byte_offset, info.byte_length);
+}
+
+std::span<const std::byte> Ktx2Texture::bytes() const
+{
+    return data;
+}
+
+std::uint8_t Ktx2Texture::dfd_color_model() const
+{
+    // dfdTotalSize followed by the first descriptor block, the color model is
+    // the first byte of its third word
+    constexpr std::size_t color_model_offset = 12;
+    if (header.dfd_byte_length <= color_model_offset)
+    {
+        return 0;
+    }
+    return read<std::uint8_t>(data, header.dfd_byte_offset + color_model_offset);
+}
+
+std::uint8_t Ktx2Texture::dfd_transfer_function() const
+{
+    constexpr std::size_t transfer_function_offset = 14;
+    if (header.dfd_byte_length <= transfer_function_offset)
+    {
+        return 0;
+    }
+    return read<std::uint8_t>(data, header.dfd_byte_offset + transfer_function_offset);
+}
+} // namespace vultex
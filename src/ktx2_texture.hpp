@@ -0,0 +1,84 @@
+#pragma once
+
+#define GLFW_INCLUDE_VULKAN
+#include <GLFW/glfw3.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <span>
+#include <vector>
+
+#include "texture_format_support.hpp"
+
+namespace vultex
+{
+
+enum class Ktx2Supercompression : std::uint32_t
+{
+    none = 0,
+    basis_lz = 1,
+    zstandard = 2,
+    zlib = 3
+};
+
+struct Ktx2Level
+{
+    std::uint64_t byte_offset;
+    std::uint64_t byte_length;
+    std::uint64_t uncompressed_byte_length;
+};
+
+// KTX2 container reader. Payloads stored in a block compressed VkFormat are
+// handed to the upload as they are, Basis Universal payloads (ETC1S and
+// UASTC) have to be transcoded to a TranscodeTarget first.
+class Ktx2Texture
+{
+public:
+    explicit Ktx2Texture(const std::filesystem::path& path);
+    explicit Ktx2Texture(std::vector<std::byte>&& bytes);
+
+    [[nodiscard]] VkFormat format() const;
+    [[nodiscard]] VkExtent3D extent() const;
+    [[nodiscard]] std::uint32_t level_count() const;
+    [[nodiscard]] std::uint32_t layer_count() const;
+    [[nodiscard]] std::uint32_t face_count() const;
+    [[nodiscard]] Ktx2Supercompression supercompression() const;
+
+    [[nodiscard]] bool is_basis_universal() const;
+    [[nodiscard]] bool is_srgb() const;
+    [[nodiscard]] bool can_upload_directly(const TextureFormatSupport& support) const;
+
+    // level data as stored in the file (still supercompressed if any)
+    [[nodiscard]] std::span<const std::byte> level_data(std::uint32_t level) const;
+    // the whole file, for the Basis Universal transcoder
+    [[nodiscard]] std::span<const std::byte> bytes() const;
+
+private:
+    struct Header
+    {
+        std::uint32_t vk_format;
+        std::uint32_t type_size;
+        std::uint32_t pixel_width;
+        std::uint32_t pixel_height;
+        std::uint32_t pixel_depth;
+        std::uint32_t layer_count;
+        std::uint32_t face_count;
+        std::uint32_t level_count;
+        std::uint32_t supercompression_scheme;
+        std::uint32_t dfd_byte_offset;
+        std::uint32_t dfd_byte_length;
+        std::uint32_t kvd_byte_offset;
+        std::uint32_t kvd_byte_length;
+        std::uint64_t sgd_byte_offset;
+        std::uint64_t sgd_byte_length;
+    };
+
+    [[nodiscard]] std::uint8_t dfd_color_model() const;
+    [[nodiscard]] std::uint8_t dfd_transfer_function() const;
+
+    std::vector<std::byte> data{};
+    Header header{};
+    std::vector<Ktx2Level> levels{};
+};
+} // namespace vultex
@@ -0,0 +1,109 @@
+#include "ktx2_texture.hpp"
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <gtest/gtest.h>
+#include <limits>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+namespace vultex
+{
+namespace
+{
+constexpr std::array<unsigned char, 12> identifier = {
+    0xAB, 0x4B, 0x54, 0x58, 0x20, 0x32, 0x30, 0xBB, 0x0D, 0x0A, 0x1A, 0x0A};
+constexpr std::size_t level_index_offset = 80;
+constexpr std::size_t level_entry_size = 3 * sizeof(std::uint64_t);
+
+struct Level
+{
+    std::uint64_t offset;
+    std::uint64_t length;
+};
+
+// an 8x8 BC1 texture with the given level index, followed by payload_size bytes
+std::vector<std::byte> make_ktx2(const std::vector<Level>& levels, const std::size_t payload_size)
+{
+    std::vector<std::byte> bytes(level_index_offset + levels.size() * level_entry_size + payload_size);
+    std::memcpy(bytes.data(), identifier.data(), identifier.size());
+
+    const auto levelCount = static_cast<std::uint32_t>(levels.size());
+    const std::array<std::uint32_t, 13> header = {
+        VK_FORMAT_BC1_RGB_UNORM_BLOCK, 1, 8, 8, 0, 0, 1, levelCount, 0, 0, 0, 0, 0};
+    std::memcpy(bytes.data() + identifier.size(), header.data(), sizeof(header));
+
+    for (std::size_t level = 0; level < levels.size(); ++level)
+    {
+        const std::array<std::uint64_t, 3> entry = {levels[level].offset, levels[level].length, levels[level].length};
+        std::memcpy(bytes.data() + level_index_offset + level * level_entry_size, entry.data(), sizeof(entry));
+    }
+    return bytes;
+}
+
+TEST(Ktx2Texture, ReadsLevelsWithinTheFile)
+{
+    auto bytes = make_ktx2({{128, 32}, {160, 8}}, 40);
+    bytes[160] = std::byte{7};
+    const Ktx2Texture texture{std::move(bytes)};
+
+    EXPECT_EQ(texture.format(), VK_FORMAT_BC1_RGB_UNORM_BLOCK);
+    EXPECT_EQ(texture.extent().width, 8U);
+    EXPECT_EQ(texture.extent().depth, 1U);
+    ASSERT_EQ(texture.level_count(), 2U);
+    EXPECT_EQ(texture.level_data(0).size(), 32U);
+    ASSERT_EQ(texture.level_data(1).size(), 8U);
+    EXPECT_EQ(texture.level_data(1)[0], std::byte{7});
+    EXPECT_THROW((void)texture.level_data(2), std::out_of_range);
+}
+
+TEST(Ktx2Texture, LevelCountZeroStoresOneLevel)
+{
+    auto bytes = make_ktx2({{104, 16}}, 16);
+    constexpr std::uint32_t generateMipmaps = 0;
+    std::memcpy(bytes.data() + identifier.size() + 7 * sizeof(std::uint32_t), &generateMipmaps, sizeof(std::uint32_t));
+
+    const Ktx2Texture texture{std::move(bytes)};
+    ASSERT_EQ(texture.level_count(), 1U);
+    EXPECT_EQ(texture.level_data(0).size(), 16U);
+}
+
+TEST(Ktx2Texture, RejectsOtherFiles)
+{
+    EXPECT_THROW(Ktx2Texture{std::vector<std::byte>(level_index_offset - 1)}, std::runtime_error);
+    EXPECT_THROW(Ktx2Texture{std::vector<std::byte>(256)}, std::runtime_error);
+
+    auto bytes = make_ktx2({{104, 16}}, 16);
+    bytes[1] = std::byte{0};
+    EXPECT_THROW(Ktx2Texture{std::move(bytes)}, std::runtime_error);
+}
+
+TEST(Ktx2Texture, RejectsATruncatedLevelIndex)
+{
+    // three levels announced, the file ends within the second entry
+    auto bytes = make_ktx2({{0, 0}, {0, 0}, {0, 0}}, 0);
+    bytes.resize(level_index_offset + level_entry_size + 8);
+    EXPECT_THROW(Ktx2Texture{std::move(bytes)}, std::runtime_error);
+}
+
+TEST(Ktx2Texture, RejectsLevelsOutOfTheFileBounds)
+{
+    constexpr std::size_t size = level_index_offset + level_entry_size + 16;
+
+    // starting after the end
+    EXPECT_THROW(Ktx2Texture{make_ktx2({{size + 1, 0}}, 16)}, std::runtime_error);
+    // ending after the end
+    EXPECT_THROW(Ktx2Texture{make_ktx2({{size - 16, 17}}, 16)}, std::runtime_error);
+    // offset + length wraps around to within the file
+    constexpr auto max = std::numeric_limits<std::uint64_t>::max();
+    EXPECT_THROW(Ktx2Texture{make_ktx2({{16, max - 8}}, 16)}, std::runtime_error);
+    EXPECT_THROW(Ktx2Texture{make_ktx2({{max, 2}}, 16)}, std::runtime_error);
+
+    // a level ending exactly at the end of the file is fine
+    EXPECT_NO_THROW(Ktx2Texture{make_ktx2({{size - 16, 16}}, 16)});
+}
+} // namespace
+} // namespace vultex
@@ -0,0 +1,488 @@
+#include "lod_mesh.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstring>
+#include <fmt/format.h>
+#include <fstream>
+#include <map>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <utility>
+
+#include "mesh_simplifier.hpp"
+#include "vertex_cache.hpp"
+
+namespace vultex
+{
+namespace
+{
+constexpr std::array<char, 4> lod_mesh_magic = {'V', 'L', 'O', 'D'};
+constexpr std::uint32_t lod_mesh_version = 2;
+
+// closer than this the projected error is treated as infinite
+constexpr float min_lod_distance = 1.0e-4F;
+
+struct LodMeshHeader
+{
+    std::array<char, 4> magic;
+    std::uint32_t version;
+    std::uint32_t vertex_count;
+    std::uint32_t index_count;
+    std::uint32_t lod_count;
+    std::array<float, 3> center;
+    float radius;
+    std::array<float, 3> quantization_offset;
+    std::array<float, 3> quantization_scale;
+};
+
+// OBJ indices start at 1, negative ones count back from the last element
+[[nodiscard]] std::uint32_t resolve_index(const long index, const std::size_t count)
+{
+    const auto resolved = index < 0 ? static_cast<long>(count) + index : index - 1;
+    if (resolved < 0 || static_cast<std::size_t>(resolved) >= count)
+    {
+        throw std::runtime_error(fmt::format("OBJ index {} is out of range!", index));
+    }
+    return static_cast<std::uint32_t>(resolved);
+}
+
+void compute_missing_normals(LodMesh& mesh, const std::vector<bool>& has_normal)
+{
+    for (std::size_t triangle = 0; triangle + 2 < mesh.indices.size(); triangle += 3)
+    {
+        auto& v0 = mesh.vertices[mesh.indices[triangle]];
+        auto& v1 = mesh.vertices[mesh.indices[triangle + 1]];
+        auto& v2 = mesh.vertices[mesh.indices[triangle + 2]];
+        // area weighted, the cross product is twice the area
+        const auto normal = glm::cross(v1.position - v0.position, v2.position - v0.position);
+        for (const auto index : {mesh.indices[triangle], mesh.indices[triangle + 1], mesh.indices[triangle + 2]})
+        {
+            if (!has_normal[index])
+            {
+                mesh.vertices[index].normal += normal;
+            }
+        }
+    }
+
+    for (std::size_t vertex = 0; vertex < mesh.vertices.size(); ++vertex)
+    {
+        auto& normal = mesh.vertices[vertex].normal;
+        if (!has_normal[vertex] && glm::length(normal) > 0.0F)
+        {
+            normal = glm::normalize(normal);
+        }
+    }
+}
+
+// Per vertex tangent frame from the texture coordinate gradients of the faces
+// around it (Lengyel), orthogonalized against the normal.
+void compute_tangents(LodMesh& mesh)
+{
+    std::vector<glm::vec3> uDirections(mesh.vertices.size(), glm::vec3{0.0F});
+    std::vector<glm::vec3> vDirections(mesh.vertices.size(), glm::vec3{0.0F});
+    for (std::size_t triangle = 0; triangle + 2 < mesh.indices.size(); triangle += 3)
+    {
+        const auto& v0 = mesh.vertices[mesh.indices[triangle]];
+        const auto& v1 = mesh.vertices[mesh.indices[triangle + 1]];
+        const auto& v2 = mesh.vertices[mesh.indices[triangle + 2]];
+        const auto edge1 = v1.position - v0.position;
+        const auto edge2 = v2.position - v0.position;
+        const auto uv1 = v1.uv - v0.uv;
+        const auto uv2 = v2.uv - v0.uv;
+
+        const auto determinant = uv1.x * uv2.y - uv2.x * uv1.y;
+        if (0.0F == determinant)
+        {
+            continue;
+        }
+        const auto uDirection = (edge1 * uv2.y - edge2 * uv1.y) / determinant;
+        const auto vDirection = (edge2 * uv1.x - edge1 * uv2.x) / determinant;
+        for (const auto index : {mesh.indices[triangle], mesh.indices[triangle + 1], mesh.indices[triangle + 2]})
+        {
+            uDirections[index] += uDirection;
+            vDirections[index] += vDirection;
+        }
+    }
+
+    for (std::size_t vertex = 0; vertex < mesh.vertices.size(); ++vertex)
+    {
+        const auto normal = mesh.vertices[vertex].normal;
+        auto tangent = uDirections[vertex] - normal * glm::dot(normal, uDirections[vertex]);
+        if (glm::length(tangent) == 0.0F)
+        {
+            // no usable texture coordinates, any direction perpendicular to the normal
+            tangent = glm::cross(normal, std::abs(normal.x) < 0.9F ? glm::vec3{1.0F, 0.0F, 0.0F}
+                                                                    : glm::vec3{0.0F, 1.0F, 0.0F});
+        }
+        const auto sign = glm::dot(glm::cross(normal, tangent), vDirections[vertex]) < 0.0F ? -1.0F : 1.0F;
+        mesh.vertices[vertex].tangent = glm::vec4{glm::normalize(tangent), sign};
+    }
+}
+
+void compute_bounds(LodMesh& mesh)
+{
+    glm::vec3 lower{mesh.vertices.front().position};
+    glm::vec3 upper{lower};
+    for (const auto& vertex : mesh.vertices)
+    {
+        lower = glm::min(lower, vertex.position);
+        upper = glm::max(upper, vertex.position);
+    }
+
+    mesh.center = (lower + upper) * 0.5F;
+    mesh.radius = 0.0F;
+    for (const auto& vertex : mesh.vertices)
+    {
+        mesh.radius = std::max(mesh.radius, glm::length(vertex.position - mesh.center));
+    }
+}
+
+template <typename T>
+T read(const std::vector<char>& bytes, const std::size_t offset)
+{
+    if (offset + sizeof(T) > bytes.size())
+    {
+        throw std::runtime_error("LOD mesh file is truncated!");
+    }
+    T value{};
+    std::memcpy(&value, std::next(bytes.data(), static_cast<std::ptrdiff_t>(offset)), sizeof(T));
+    return value;
+}
+
+template <typename T>
+std::size_t read_array(const std::vector<char>& bytes, const std::size_t offset, std::vector<T>& values)
+{
+    const auto size = values.size() * sizeof(T);
+    if (offset + size > bytes.size())
+    {
+        throw std::runtime_error("LOD mesh file is truncated!");
+    }
+    std::memcpy(values.data(), std::next(bytes.data(), static_cast<std::ptrdiff_t>(offset)), size);
+    return offset + size;
+}
+
+template <typename T>
+void write_array(std::ofstream& file, const std::vector<T>& values)
+{
+    file.write(reinterpret_cast<const char*>(values.data()), static_cast<std::streamsize>(values.size() * sizeof(T)));
+}
+} // namespace
+
+LodMesh load_obj(const std::filesystem::path& path)
+{
+    std::ifstream file{path};
+    if (!file)
+    {
+        throw std::runtime_error(fmt::format("Cannot open mesh: {}", path.string()));
+    }
+
+    std::vector<glm::vec3> positions{};
+    std::vector<glm::vec3> normals{};
+    std::vector<glm::vec2> uvs{};
+
+    // a vertex per distinct position/uv/normal triple, 0 marks a missing element
+    std::map<std::array<std::uint32_t, 3>, std::uint32_t> vertexIndices{};
+    std::vector<bool> hasNormal{};
+    LodMesh mesh{};
+
+    std::string line{};
+    std::vector<std::uint32_t> polygon{};
+    while (std::getline(file, line))
+    {
+        std::istringstream stream{line};
+        std::string type{};
+        stream >> type;
+        if ("v" == type)
+        {
+            auto& position = positions.emplace_back();
+            stream >> position.x >> position.y >> position.z;
+        }
+        else if ("vn" == type)
+        {
+            auto& normal = normals.emplace_back();
+            stream >> normal.x >> normal.y >> normal.z;
+        }
+        else if ("vt" == type)
+        {
+            auto& uv = uvs.emplace_back();
+            stream >> uv.x >> uv.y;
+        }
+        else if ("f" == type)
+        {
+            polygon.clear();
+            std::string corner{};
+            while (stream >> corner)
+            {
+                // v, v/vt, v//vn or v/vt/vn
+                std::array<std::uint32_t, 3> key{};
+                std::istringstream elements{corner};
+                std::string element{};
+                for (std::size_t slot = 0; slot < key.size() && std::getline(elements, element, '/'); ++slot)
+                {
+                    if (!element.empty())
+                    {
+                        const auto count = std::array{positions.size(), uvs.size(), normals.size()}[slot];
+                        key[slot] = resolve_index(std::stol(element), count) + 1;
+                    }
+                }
+                if (0 == key[0])
+                {
+                    throw std::runtime_error(fmt::format("OBJ face corner without a position: {}", corner));
+                }
+
+                const auto [vertex, inserted] =
+                    vertexIndices.try_emplace(key, static_cast<std::uint32_t>(mesh.vertices.size()));
+                if (inserted)
+                {
+                    mesh.vertices.push_back(MeshVertex{.position = positions[key[0] - 1],
+                                                       .normal = 0 != key[2] ? normals[key[2] - 1] : glm::vec3{0.0F},
+                                                       .tangent = glm::vec4{0.0F},
+                                                       .uv = 0 != key[1] ? uvs[key[1] - 1] : glm::vec2{0.0F}});
+                    hasNormal.push_back(0 != key[2]);
+                }
+                polygon.push_back(vertex->second);
+            }
+
+            for (std::size_t corner = 2; corner < polygon.size(); ++corner)
+            {
+                mesh.indices.insert(mesh.indices.end(), {polygon[0], polygon[corner - 1], polygon[corner]});
+            }
+        }
+    }
+
+    if (mesh.indices.empty())
+    {
+        throw std::runtime_error(fmt::format("Mesh has no triangles: {}", path.string()));
+    }
+
+    compute_missing_normals(mesh, hasNormal);
+    compute_tangents(mesh);
+    compute_bounds(mesh);
+    mesh.lods = {MeshLod{.first_index = 0, .index_count = static_cast<std::uint32_t>(mesh.indices.size()), .error = 0}};
+    return mesh;
+}
+
+void build_lods(LodMesh& mesh, const LodSettings& settings)
+{
+    if (mesh.lods.empty())
+    {
+        throw std::runtime_error("Mesh has no full detail level!");
+    }
+
+    const auto& full = mesh.lods.front();
+    const std::vector<std::uint32_t> fullIndices(
+        std::next(mesh.indices.begin(), full.first_index),
+        std::next(mesh.indices.begin(), static_cast<std::ptrdiff_t>(full.first_index + full.index_count)));
+
+    std::vector<glm::vec3> positions(mesh.vertices.size());
+    std::ranges::transform(mesh.vertices, positions.begin(), &MeshVertex::position);
+
+    mesh.indices = fullIndices;
+    mesh.lods = {MeshLod{.first_index = 0, .index_count = static_cast<std::uint32_t>(fullIndices.size()), .error = 0}};
+
+    // every level is simplified from the full mesh, so its error is measured against the original surface
+    const auto maxError = settings.max_error * mesh.radius;
+    auto target = static_cast<double>(fullIndices.size());
+    while (mesh.lods.size() < settings.max_lods)
+    {
+        target *= settings.reduction;
+        const auto targetIndexCount = static_cast<std::size_t>(target) / 3 * 3;
+        if (targetIndexCount < 3)
+        {
+            break;
+        }
+
+        const auto simplified = simplify(positions, fullIndices, targetIndexCount, maxError);
+        const auto& previous = mesh.lods.back();
+
+        // stuck on the error limit or on locked borders, a level with almost the same triangles only costs memory
+        if (simplified.indices.empty() || simplified.indices.size() > previous.index_count * 9 / 10)
+        {
+            break;
+        }
+
+        mesh.lods.push_back(MeshLod{.first_index = static_cast<std::uint32_t>(mesh.indices.size()),
+                                    .index_count = static_cast<std::uint32_t>(simplified.indices.size()),
+                                    .error = std::max(simplified.error, previous.error)});
+        mesh.indices.insert(mesh.indices.end(), simplified.indices.begin(), simplified.indices.end());
+    }
+}
+
+void optimize_vertex_order(LodMesh& mesh)
+{
+    for (const auto& lod : mesh.lods)
+    {
+        optimize_vertex_cache(std::span{mesh.indices}.subspan(lod.first_index, lod.index_count), mesh.vertices.size());
+    }
+
+    // the levels follow the full detail one, which decides the order of the shared vertices
+    const auto remap = vertex_fetch_remap(mesh.indices, mesh.vertices.size());
+    std::vector<MeshVertex> vertices(mesh.vertices.size());
+    for (std::size_t vertex = 0; vertex < vertices.size(); ++vertex)
+    {
+        vertices[remap[vertex]] = mesh.vertices[vertex];
+    }
+    mesh.vertices = std::move(vertices);
+    for (auto& index : mesh.indices)
+    {
+        index = remap[index];
+    }
+}
+
+void compress_vertices(LodMesh& mesh)
+{
+    if (mesh.vertices.empty())
+    {
+        throw std::runtime_error("Mesh has no float vertices to compress!");
+    }
+
+    glm::vec3 lower{mesh.vertices.front().position};
+    glm::vec3 upper{lower};
+    for (const auto& vertex : mesh.vertices)
+    {
+        lower = glm::min(lower, vertex.position);
+        upper = glm::max(upper, vertex.position);
+    }
+
+    mesh.quantization = VertexQuantization::from_bounds(lower, upper);
+    mesh.packed_vertices.resize(mesh.vertices.size());
+    for (std::size_t vertex = 0; vertex < mesh.vertices.size(); ++vertex)
+    {
+        const auto& source = mesh.vertices[vertex];
+        mesh.packed_vertices[vertex] =
+            pack_vertex(mesh.quantization, source.position, source.normal, source.tangent, source.uv);
+    }
+}
+
+void write_lod_mesh(const std::filesystem::path& path, const LodMesh& mesh)
+{
+    if (mesh.packed_vertices.empty())
+    {
+        throw std::runtime_error("Mesh vertices have to be compressed before they are written!");
+    }
+
+    std::ofstream file{path, std::ios::binary | std::ios::trunc};
+    if (!file)
+    {
+        throw std::runtime_error(fmt::format("Cannot write mesh: {}", path.string()));
+    }
+
+    const LodMeshHeader header{.magic = lod_mesh_magic,
+                               .version = lod_mesh_version,
+                               .vertex_count = static_cast<std::uint32_t>(mesh.packed_vertices.size()),
+                               .index_count = static_cast<std::uint32_t>(mesh.indices.size()),
+                               .lod_count = static_cast<std::uint32_t>(mesh.lods.size()),
+                               .center = {mesh.center.x, mesh.center.y, mesh.center.z},
+                               .radius = mesh.radius,
+                               .quantization_offset = {mesh.quantization.offset.x,
+                                                       mesh.quantization.offset.y,
+                                                       mesh.quantization.offset.z},
+                               .quantization_scale = {mesh.quantization.scale.x,
+                                                      mesh.quantization.scale.y,
+                                                      mesh.quantization.scale.z}};
+    file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    write_array(file, mesh.lods);
+    write_array(file, mesh.packed_vertices);
+    write_array(file, mesh.indices);
+}
+
+LodMesh read_lod_mesh(const std::filesystem::path& path)
+{
+    std::ifstream file{path, std::ios::binary};
+    if (!file)
+    {
+        throw std::runtime_error(fmt::format("Cannot open mesh: {}", path.string()));
+    }
+    const std::vector<char> bytes{std::istreambuf_iterator<char>{file}, std::istreambuf_iterator<char>{}};
+
+    const auto header = read<LodMeshHeader>(bytes, 0);
+    if (header.magic != lod_mesh_magic || header.version != lod_mesh_version)
+    {
+        throw std::runtime_error(fmt::format("Not a LOD mesh of version {}: {}", lod_mesh_version, path.string()));
+    }
+
+    // counts come from the file, nothing is allocated before they fit into it
+    const auto expectedSize = std::uint64_t{sizeof(header)} + std::uint64_t{header.lod_count} * sizeof(MeshLod) +
+                              std::uint64_t{header.vertex_count} * sizeof(PackedVertex) +
+                              std::uint64_t{header.index_count} * sizeof(std::uint32_t);
+    if (expectedSize > bytes.size())
+    {
+        throw std::runtime_error(fmt::format("LOD mesh file is truncated: {}", path.string()));
+    }
+
+    const auto& offsetValue = header.quantization_offset;
+    const auto& scaleValue = header.quantization_scale;
+    LodMesh mesh{.vertices = {},
+                 .packed_vertices = std::vector<PackedVertex>(header.vertex_count),
+                 .quantization = {.offset = {offsetValue[0], offsetValue[1], offsetValue[2]},
+                                  .scale = {scaleValue[0], scaleValue[1], scaleValue[2]}},
+                 .indices = std::vector<std::uint32_t>(header.index_count),
+                 .lods = std::vector<MeshLod>(header.lod_count),
+                 .center = {header.center[0], header.center[1], header.center[2]},
+                 .radius = header.radius};
+    auto offset = read_array(bytes, sizeof(header), mesh.lods);
+    offset = read_array(bytes, offset, mesh.packed_vertices);
+    read_array(bytes, offset, mesh.indices);
+
+    for (const auto& lod : mesh.lods)
+    {
+        if (std::uint64_t{lod.first_index} + lod.index_count > mesh.indices.size())
+        {
+            throw std::runtime_error(fmt::format("LOD mesh level is out of the index bounds: {}", path.string()));
+        }
+    }
+    if (std::ranges::any_of(mesh.indices, [&mesh](const auto index) { return index >= mesh.packed_vertices.size(); }))
+    {
+        throw std::runtime_error(fmt::format("LOD mesh index is out of the vertex bounds: {}", path.string()));
+    }
+    return mesh;
+}
+
+LodCamera LodCamera::from_perspective(const glm::vec3& position,
+                                      const float vertical_fov,
+                                      const float viewport_height,
+                                      const float pixel_error)
+{
+    return LodCamera{.position = position,
+                     .projection_scale = viewport_height / (2.0F * std::tan(vertical_fov * 0.5F)),
+                     .pixel_error = pixel_error};
+}
+
+std::uint32_t select_lod(const LodMesh& mesh, const LodCamera& camera, const LodInstance& instance)
+{
+    // Instances carry no rotation here, a sphere around the origin holding the
+    // bounding sphere covers every orientation. Its closest point is used, so
+    // the projected error is never underestimated.
+    const auto radius = (glm::length(mesh.center) + mesh.radius) * instance.scale;
+    const auto distance = std::max(glm::length(instance.position - camera.position) - radius, min_lod_distance);
+    const auto pixelsPerUnit = instance.scale * camera.projection_scale / distance;
+
+    std::uint32_t level = 0;
+    while (level + 1 < mesh.lods.size() && mesh.lods[level + 1].error * pixelsPerUnit <= camera.pixel_error)
+    {
+        ++level;
+    }
+    return level;
+}
+
+void append_lod_draws(const LodMesh& mesh,
+                      const LodCamera& camera,
+                      std::span<const LodInstance> instances,
+                      std::span<const std::uint32_t> visible,
+                      std::vector<VkDrawIndexedIndirectCommand>& draws)
+{
+    draws.reserve(draws.size() + visible.size());
+    for (const auto instance : visible)
+    {
+        const auto& lod = mesh.lods[select_lod(mesh, camera, instances[instance])];
+        draws.push_back(VkDrawIndexedIndirectCommand{.indexCount = lod.index_count,
+                                                     .instanceCount = 1,
+                                                     .firstIndex = lod.first_index,
+                                                     .vertexOffset = 0,
+                                                     .firstInstance = instance});
+    }
+}
+} // namespace vultex
@@ -0,0 +1,110 @@
+#pragma once
+
+#define GLFW_INCLUDE_VULKAN
+#include <GLFW/glfw3.h>
+
+#include <cstdint>
+#include <filesystem>
+#include <glm/glm.hpp>
+#include <span>
+#include <vector>
+
+#include "vertex_compression.hpp"
+
+namespace vultex
+{
+
+struct MeshVertex
+{
+    glm::vec3 position;
+    glm::vec3 normal;
+    // w is the bitangent sign
+    glm::vec4 tangent;
+    glm::vec2 uv;
+};
+
+struct MeshLod
+{
+    std::uint32_t first_index;
+    std::uint32_t index_count;
+    // object space distance to the full detail surface, grows with the level
+    float error;
+};
+
+// LOD chain of one mesh. All levels index the same vertex buffer, lods[0] is
+// the full detail mesh and every next one has fewer triangles.
+struct LodMesh
+{
+    // float vertices of the import, only the tools work on them
+    std::vector<MeshVertex> vertices;
+    // what is uploaded, written by compress_vertices() and the only vertices stored in *.vlod
+    std::vector<PackedVertex> packed_vertices;
+    VertexQuantization quantization;
+    std::vector<std::uint32_t> indices;
+    std::vector<MeshLod> lods;
+    // bounding sphere in object space
+    glm::vec3 center;
+    float radius;
+};
+
+struct LodSettings
+{
+    std::uint32_t max_lods{6};
+    // triangle count of a level relative to the previous one
+    float reduction{0.5F};
+    // largest error of any level, relative to the bounding radius
+    float max_error{0.05F};
+};
+
+// Wavefront OBJ positions, normals and texture coordinates. Polygons are
+// triangulated as fans, missing normals are computed from the faces and
+// tangents from the texture coordinates.
+[[nodiscard]] LodMesh load_obj(const std::filesystem::path& path);
+
+// Replaces the levels of mesh with lods[0] followed by quadric simplified ones
+void build_lods(LodMesh& mesh, const LodSettings& settings);
+
+// Forsyth order of the triangles of every level, then the vertices renumbered
+// in order of first use. Call it after build_lods(), before compress_vertices().
+void optimize_vertex_order(LodMesh& mesh);
+
+// Packs the float vertices, positions are quantized to the mesh bounds
+void compress_vertices(LodMesh& mesh);
+
+// *.vlod, the output of vultex_lod. Stores the packed vertices, the float
+// ones are left empty by read_lod_mesh().
+void write_lod_mesh(const std::filesystem::path& path, const LodMesh& mesh);
+[[nodiscard]] LodMesh read_lod_mesh(const std::filesystem::path& path);
+
+// Object space errors are projected to pixels: an error e at distance d
+// covers e * projection_scale / d pixels of the viewport height.
+struct LodCamera
+{
+    glm::vec3 position;
+    float projection_scale;
+    // largest error in pixels a selected level may show
+    float pixel_error;
+
+    [[nodiscard]] static LodCamera from_perspective(const glm::vec3& position,
+                                                    float vertical_fov,
+                                                    float viewport_height,
+                                                    float pixel_error);
+};
+
+struct LodInstance
+{
+    glm::vec3 position;
+    float scale;
+};
+
+// Coarsest level whose projected error stays within camera.pixel_error
+[[nodiscard]] std::uint32_t select_lod(const LodMesh& mesh, const LodCamera& camera, const LodInstance& instance);
+
+// One indexed draw per visible instance, with the index range of its level
+// and firstInstance set to the instance index for the per instance data.
+void append_lod_draws(const LodMesh& mesh,
+                      const LodCamera& camera,
+                      std::span<const LodInstance> instances,
+                      std::span<const std::uint32_t> visible,
+                      std::vector<VkDrawIndexedIndirectCommand>& draws);
+} // namespace vultex
@@ -0,0 +1,132 @@
+// Offline LOD generator, turns a Wavefront OBJ into a *.vlod LOD chain:
+//   vultex_lod [--levels N] [--reduction R] [--max-error E] input.obj output.vlod
+// Every level has about R times the triangles of the previous one, E limits
+// the error of all levels relative to the bounding radius of the mesh. The
+// triangles are put in vertex cache order and the vertices are packed.
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdlib>
+#include <exception>
+#include <fmt/format.h>
+#include <iterator>
+#include <span>
+#include <spdlog/spdlog.h>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "lod_mesh.hpp"
+#include "vertex_cache.hpp"
+
+namespace
+{
+struct Options
+{
+    vultex::LodSettings settings{};
+    std::string input{};
+    std::string output{};
+};
+
+[[nodiscard]] auto parseOptions(const int argc, char** argv) -> Options
+{
+    constexpr std::string_view usage =
+        "usage: vultex_lod [--levels N] [--reduction R] [--max-error E] input.obj output.vlod";
+
+    Options options{};
+    std::vector<std::string> files{};
+    const std::vector<std::string_view> arguments(argv + 1, argv + argc);
+    for (auto it = arguments.begin(); it != arguments.end(); ++it)
+    {
+        const auto value = [&]() -> std::string
+        {
+            if (std::next(it) == arguments.end())
+            {
+                throw std::runtime_error{fmt::format("Missing value of {}", *it)};
+            }
+            return std::string{*++it};
+        };
+
+        if (*it == "--levels")
+        {
+            options.settings.max_lods = std::max(1U, static_cast<std::uint32_t>(std::stoul(value())));
+        }
+        else if (*it == "--reduction")
+        {
+            options.settings.reduction = std::stof(value());
+            if (options.settings.reduction <= 0.0F || options.settings.reduction >= 1.0F)
+            {
+                throw std::runtime_error{"--reduction has to be between 0 and 1"};
+            }
+        }
+        else if (*it == "--max-error")
+        {
+            options.settings.max_error = std::stof(value());
+        }
+        else if (it->starts_with("--"))
+        {
+            throw std::runtime_error{fmt::format("Unknown argument {}, {}", *it, usage)};
+        }
+        else
+        {
+            files.emplace_back(*it);
+        }
+    }
+
+    if (2 != files.size())
+    {
+        throw std::runtime_error{std::string{usage}};
+    }
+    options.input = files[0];
+    options.output = files[1];
+    return options;
+}
+} // namespace
+
+int main(int argc, char** argv)
+try
+{
+    const auto options = parseOptions(argc, argv);
+
+    auto mesh = vultex::load_obj(options.input);
+    spdlog::info("Load {}: {} vertices, {} triangles, radius {}",
+                 options.input,
+                 mesh.vertices.size(),
+                 mesh.indices.size() / 3,
+                 mesh.radius);
+
+    vultex::build_lods(mesh, options.settings);
+    const auto fullTriangles = mesh.lods.front().index_count / 3;
+    for (std::size_t level = 0; level < mesh.lods.size(); ++level)
+    {
+        const auto& lod = mesh.lods[level];
+        spdlog::info("LOD {}: {} triangles ({:.1f}%), error {:.5f}",
+                     level,
+                     lod.index_count / 3,
+                     100.0 * lod.index_count / 3 / fullTriangles,
+                     lod.error);
+    }
+
+    // post transform cache efficiency of the full detail level, vertices per triangle
+    const auto fullIndices = std::span{mesh.indices}.first(mesh.lods.front().index_count);
+    const auto missRatioBefore = vultex::average_cache_miss_ratio(fullIndices, mesh.vertices.size());
+    vultex::optimize_vertex_order(mesh);
+    spdlog::info("Vertex cache: ACMR {:.3f} -> {:.3f}",
+                 missRatioBefore,
+                 vultex::average_cache_miss_ratio(fullIndices, mesh.vertices.size()));
+
+    vultex::compress_vertices(mesh);
+    spdlog::info("Vertices: {} bytes packed, {} bytes as floats",
+                 mesh.packed_vertices.size() * sizeof(vultex::PackedVertex),
+                 mesh.vertices.size() * sizeof(vultex::MeshVertex));
+
+    vultex::write_lod_mesh(options.output, mesh);
+    spdlog::info("Write {}", options.output);
+    return EXIT_SUCCESS;
+}
+catch (const std::exception& e)
+{
+    spdlog::error("{}", e.what());
+    return EXIT_FAILURE;
+}
@@ -3,314 +3,109 @@
 #define GLFW_INCLUDE_VULKAN
 #include <GLFW/glfw3.h>
 
-#include <algorithm>
+#include <array>
+#include <chrono>
 #include <cstdint>
 #include <cstdlib>
 #include <exception>
-#include <fmt/format.h>
-#include <iostream>
+#include <filesystem>
+#include <fstream>
+#include <future>
 #include <iterator>
-#include <map>
+#include <memory>
 #include <optional>
-#include <span>
 #include <spdlog/spdlog.h>
 #include <stdexcept>
-#include <string_view>
-
-#include "vulkan_debug.hpp"
-#include "vulkan_property_support_info.hpp"
+#include <utility>
+#include <vector>
+
+#include "deletion_queue.hpp"
+#include "frame_allocator.hpp"
+#include "frame_statistics.hpp"
+#include "host_allocator.hpp"
+#include "job_system.hpp"
+#include "queue_timeline.hpp"
+#include "shader_module_cache.hpp"
+#include "texture_format_support.hpp"
+#include "texture_loader.hpp"
+#include "upload_batcher.hpp"
+#include "vulkan_context.hpp"
 
 namespace
 {
 const uint32_t WIDTH = 800;
 const uint32_t HEIGHT = 600;
+const uint32_t MAX_FRAMES_IN_FLIGHT = 2;
+const VkDeviceSize FRAME_ALLOCATOR_SIZE = 4 * 1024 * 1024;
+const VkDeviceSize UPLOAD_ARENA_SIZE = 16 * 1024 * 1024;
 
-[[nodiscard]] auto initWindow() -> GLFWwindow*
+[[nodiscard]] auto initGlfw() -> std::vector<const char*>
 {
-    spdlog::info("Initialize window");
-
-    glfwInit();
-    glfwWindowHint(GLFW_CLIENT_API, GLFW_NO_API);
-    glfwWindowHint(GLFW_RESIZABLE, GLFW_FALSE);
-
-    return glfwCreateWindow(WIDTH, HEIGHT, "Vultex", nullptr, nullptr);
-}
-
-struct QueueFaimilyIndices
-{
-    std::optional<std::uint32_t> graphicsFamily;
-
-    [[nodiscard]] auto isComplete() const -> bool
-    {
-        return graphicsFamily.has_value();
-    }
-};
-
-[[nodiscard]] auto findQueueFamilies(VkPhysicalDevice device) -> QueueFaimilyIndices
-{
-    QueueFaimilyIndices indices{};
-
-    std::uint32_t queueFamilyCount = 0;
-    vkGetPhysicalDeviceQueueFamilyProperties(device, &queueFamilyCount, nullptr);
-
-    std::vector<VkQueueFamilyProperties> queueFamilies(queueFamilyCount);
-    vkGetPhysicalDeviceQueueFamilyProperties(device, &queueFamilyCount, queueFamilies.data());
-
-    const auto it = std::ranges::find_if(
-        queueFamilies,
-        [](const auto& queueFamily)
-        { return queueFamily.queueFlags & static_cast<std::uint32_t>(VK_QUEUE_GRAPHICS_BIT); });
-
-    if (it != queueFamilies.end())
-    {
-        indices.graphicsFamily = std::distance(queueFamilies.begin(), it);
-    }
-
-    return indices;
-}
-
-[[nodiscard]] auto rateDeviceSuitability(const auto& device) -> std::int32_t
-{
-    // get device properties
-    VkPhysicalDeviceProperties deviceProperties{};
-    vkGetPhysicalDeviceProperties(device, &deviceProperties);
-    spdlog::info("Device GPU {} of type: {}, max image dimension 2d: {}",
-                 deviceProperties.deviceName,
-                 deviceProperties.deviceType,
-                 deviceProperties.limits.maxImageDimension2D);
-
-    // get device feature
-    VkPhysicalDeviceFeatures deviceFeatures{};
-    vkGetPhysicalDeviceFeatures(device, &deviceFeatures);
-    spdlog::info("Device GPU {} support geometry shader: {}",
-                 deviceProperties.deviceName,
-                 deviceFeatures.geometryShader);
-
-    // Application can't function without geomtry shaders
-    if (!deviceFeatures.geometryShader)
-    {
-        return 0;
-    }
+    spdlog::info("Initialize GLFW");
 
-    const auto queueFamilyIndices = findQueueFamilies(device);
-    spdlog::info("Device GPU {} support graphics queue: {}",
-                 deviceProperties.deviceName,
-                 queueFamilyIndices.isComplete());
-    if (!queueFamilyIndices.isComplete())
+    if (GLFW_TRUE != glfwInit())
     {
-        return 0;
+        throw std::runtime_error("Cannot initialize GLFW!");
     }
 
-    // -----
-
-    auto score = 0;
-
-    // Discrete GPUs have a significant performance advantage
-    if (deviceProperties.deviceType == VK_PHYSICAL_DEVICE_TYPE_DISCRETE_GPU)
-    {
-        constexpr auto discrete_gpu_score = 1000;
-        score += discrete_gpu_score;
-    }
-
-    // Maximum possible size of textures affects graphics quality
-    score += deviceProperties.limits.maxImageDimension2D;
-
-    spdlog::info("Device GPU {} got score: {}", deviceProperties.deviceName, score);
-
-    return score;
-}
-
-[[nodiscard]] auto getRequiredExtensions() -> std::vector<const char*>
-{
+    // names are owned by GLFW and valid until glfwTerminate
     std::uint32_t glfwExtensionCount = 0;
     const auto** glfwExtensions = glfwGetRequiredInstanceExtensions(&glfwExtensionCount);
-
-    std::vector<const char*> extensions(glfwExtensions, std::next(glfwExtensions, glfwExtensionCount));
-
-    if constexpr (enableValidationLayers)
-    {
-        extensions.push_back(VK_EXT_DEBUG_UTILS_EXTENSION_NAME);
-    }
-    return extensions;
-}
-
-auto configureValidationLayers(auto& createInfo,
-                               const auto& required_validation_layer_names,
-                               auto& debugCreateInfo) -> void
-{
-    const auto required_validation_layers = utility::check_required_validation_layers(
-        required_validation_layer_names.size(), required_validation_layer_names.data());
-
-    required_validation_layers.log_properties();
-    if (!required_validation_layers.all_supported())
-
-    {
-        throw std::runtime_error("validation layers requested, but not available!");
-    }
-    createInfo.enabledLayerCount = required_validation_layer_names.size();
-    createInfo.ppEnabledLayerNames = required_validation_layer_names.data();
-
-    populateDebugMessengerCreateInfo(debugCreateInfo);
-    createInfo.pNext = &debugCreateInfo;
-}
-
-static auto getRequiredByGlfwVulkanExtensions(auto& createInfo, const auto& glfwExtensions) -> void
-{
-    const auto glfw_required_extensions =
-        utility::check_glfw_required_extensions(glfwExtensions.size(), glfwExtensions.data());
-
-    spdlog::info("EnabledExtensionCount: {}", glfwExtensions.size());
-    createInfo.enabledExtensionCount = glfwExtensions.size();
-    createInfo.ppEnabledExtensionNames = glfwExtensions.data();
-
-    glfw_required_extensions.log_properties();
-    if (!glfw_required_extensions.all_supported())
-    {
-        throw std::runtime_error(fmt::format("Cannot create vulkan instance! glfw all supported: {}",
-                                             glfw_required_extensions.all_supported()));
-    }
+    return {glfwExtensions, std::next(glfwExtensions, glfwExtensionCount)};
 }
 
-[[nodiscard]] auto createInstance() -> VkInstance
+[[nodiscard]] auto initWindow() -> GLFWwindow*
 {
-    // fill an optional struct with application information
-    VkApplicationInfo appInfo{.sType = VK_STRUCTURE_TYPE_APPLICATION_INFO,
-                              .pApplicationName = "Hello vultex!",
-                              .applicationVersion = VK_MAKE_VERSION(1, 0, 0),
-                              .pEngineName = "No Engine",
-                              .engineVersion = VK_MAKE_VERSION(1, 0, 0),
-                              .apiVersion = VK_API_VERSION_1_2};
-
-    // global information about the entire program about extensions etc.
-    VkInstanceCreateInfo createInfo{.sType = VK_STRUCTURE_TYPE_INSTANCE_CREATE_INFO,
-                                    .pApplicationInfo = &appInfo};
-
-    const auto glfwExtensions = getRequiredExtensions();
-
-    { // get vulkan extensions required by GLFW
-        getRequiredByGlfwVulkanExtensions(createInfo, glfwExtensions);
-    }
-
-    const std::vector<char const*> required_validation_layer_names = {"VK_LAYER_KHRONOS_validation"};
-    VkDebugUtilsMessengerCreateInfoEXT debugCreateInfo{};
-
-    { // configure validation layers
-        if constexpr (enableValidationLayers)
-        {
-            configureValidationLayers(createInfo, required_validation_layer_names, debugCreateInfo);
-        }
-    }
+    spdlog::info("Initialize window");
 
-    VkInstance instance{nullptr};
-    const auto create_instance_status = vkCreateInstance(&createInfo, nullptr, &instance);
-    if (VK_SUCCESS != create_instance_status)
-    {
-        throw std::runtime_error{fmt::format("Cannot create vulkan instance: {}", create_instance_status)};
-    }
+    glfwWindowHint(GLFW_CLIENT_API, GLFW_NO_API);
+    glfwWindowHint(GLFW_RESIZABLE, GLFW_FALSE);
 
-    spdlog::info("Instance created");
-    return instance;
+    return glfwCreateWindow(WIDTH, HEIGHT, "Vultex", nullptr, nullptr);
 }
 
-[[nodiscard]] auto setupDebugMessenger(auto* const instance) -> VkDebugUtilsMessengerEXT
+struct WindowAndContext
 {
-    if constexpr (!enableValidationLayers)
-    {
-        return nullptr;
-    }
-
-    spdlog::info("Initialize debug messenger");
-
-    VkDebugUtilsMessengerCreateInfoEXT createInfo{};
-    populateDebugMessengerCreateInfo(createInfo);
-
-    VkDebugUtilsMessengerEXT debugMessenger{nullptr};
-    if (VK_SUCCESS != CreateDebugUtilsMessengerEXT(instance, &createInfo, nullptr, &debugMessenger))
-    {
-        throw std::runtime_error("failed to set up debug messenger!");
-    }
-    return debugMessenger;
-}
+    GLFWwindow* window;
+    std::unique_ptr<vultex::VulkanContext> context;
+};
 
-[[nodiscard]] auto pickPhysicalDevice(auto* const instance) -> VkPhysicalDevice
+// Window creation has to stay on the main thread, while instance and device
+// creation only need the extension list. The Vulkan chain runs on a worker
+// meanwhile, both are joined before the first use of the two together.
+[[nodiscard]] auto initWindowAndContext() -> WindowAndContext
 {
-    std::uint32_t deviceCount = 0;
-    vkEnumeratePhysicalDevices(instance, &deviceCount, nullptr);
+    const auto surfaceExtensions = initGlfw();
 
-    if (0 == deviceCount)
-    {
-        throw std::runtime_error("failed to find GPUs with Vulkan support!");
-    }
-
-    spdlog::info("Detected {} devices", deviceCount);
-
-    std::vector<VkPhysicalDevice> devices(deviceCount);
-    vkEnumeratePhysicalDevices(instance, &deviceCount, devices.data());
+    auto context = std::async(std::launch::async,
+                              [&surfaceExtensions]
+                              { return std::make_unique<vultex::VulkanContext>(surfaceExtensions); });
 
-    std::multimap<int, VkPhysicalDevice> candidates{};
-    std::ranges::transform(devices,
-                           std::inserter(candidates, candidates.begin()),
-                           [](const auto& device)
-                           { return std::make_pair(rateDeviceSuitability(device), device); });
-
-    if (candidates.empty())
+    auto* window = initWindow();
+    try
     {
-        throw std::runtime_error("Cannot found any GPU device!");
+        return WindowAndContext{.window = window, .context = context.get()};
     }
-    if (candidates.rbegin()->first == 0)
+    catch (...)
     {
-        throw std::runtime_error("Cannot found any suitable GPU!");
-    }
-
-    spdlog::info("Device choosen with score: {}", candidates.rbegin()->first);
-    auto* physicalDevice = candidates.rbegin()->second;
-    return physicalDevice;
-}
-
-[[nodiscard]] auto createLogicalDevice(const auto physicalDevice) -> VkDevice
-{
-
-    auto indices = findQueueFamilies(physicalDevice);
-
-    float queuePriority = 1.0F;
-    VkDeviceQueueCreateInfo queueCreateInfo{.sType = VK_STRUCTURE_TYPE_DEVICE_QUEUE_CREATE_INFO,
-                                            .queueFamilyIndex = indices.graphicsFamily.value(),
-                                            .queueCount = 1,
-                                            .pQueuePriorities = &queuePriority};
-
-    VkPhysicalDeviceFeatures deviceFeatures{};
-
-    // For older implementation there is a need to configure validation layers
-    // as like for instance !
-    VkDeviceCreateInfo createInfo{.sType = VK_STRUCTURE_TYPE_DEVICE_CREATE_INFO,
-                                  .queueCreateInfoCount = 1,
-                                  .pQueueCreateInfos = &queueCreateInfo,
-                                  .pEnabledFeatures = &deviceFeatures};
-
-    VkDevice logicalDevice{nullptr};
-    if (VK_SUCCESS != vkCreateDevice(physicalDevice, &createInfo, nullptr, &logicalDevice))
-    {
-        throw std::runtime_error("Failed to create logical device!");
+        glfwDestroyWindow(window);
+        glfwTerminate();
+        throw;
     }
-
-    return logicalDevice;
 }
 } // namespace
 
 class HelloTrangleApplication
 {
 public:
-    HelloTrangleApplication()
-        : window{initWindow()},
-          instance{createInstance()},
-          debugMessenger{setupDebugMessenger(instance)},
-          physicalDevice{pickPhysicalDevice(instance)},
-          logicalDevice{createLogicalDevice(physicalDevice)}
+    // KTX2 textures loaded in the background and uploaded once decoded
+    explicit HelloTrangleApplication(const std::vector<std::filesystem::path>& texturePaths)
+        : HelloTrangleApplication{initWindowAndContext()}
     {
-        const auto indices = findQueueFamilies(physicalDevice);
-        constexpr auto firstQueueIndex = 0;
-
-        vkGetDeviceQueue(logicalDevice, indices.graphicsFamily.value(), firstQueueIndex, &graphicsQueue);
+        for (const auto& path : texturePaths)
+        {
+            textureLoader->load(path);
+        }
     }
 
     HelloTrangleApplication(const HelloTrangleApplication&) = delete;
@@ -322,14 +117,18 @@ public:
     {
         spdlog::info("Cleanup resources");
 
-        vkDestroyDevice(logicalDevice, nullptr);
+        // frames in flight still reference the resources
+        vkDeviceWaitIdle(logicalDevice);
 
-        if constexpr (enableValidationLayers)
-        {
-            DestroyDebugUtilsMessengerEXT(instance, debugMessenger, nullptr);
-        }
+        frameAllocator.reset();
+        textureLoader.reset();
+        uploadBatcher.reset();
+        shaderModuleCache.reset();
+        deletionQueue.reset();
+        computeTimeline.reset();
+        graphicsTimeline.reset();
+        context.reset();
 
-        vkDestroyInstance(instance, nullptr);
         glfwDestroyWindow(window);
         glfwTerminate();
     }
@@ -337,28 +136,127 @@ public:
     auto run()
     {
         spdlog::info("Start loop");
+        std::uint32_t currentFrame = 0;
+        std::array<std::uint64_t, MAX_FRAMES_IN_FLIGHT> frameTimelineValues{};
         while (1 != glfwWindowShouldClose(window))
         {
+            frameStatistics.begin_frame();
             glfwPollEvents();
+
+            {
+                // wait until the GPU is done with the frame which used this slot
+                const auto pass = frameStatistics.time_pass("wait_frame_slot");
+                graphicsTimeline->wait(frameTimelineValues.at(currentFrame));
+            }
+            frameAllocator->begin_frame(currentFrame);
+            {
+                const auto pass = frameStatistics.time_pass("collect_deletions");
+                deletionQueue->collect();
+            }
+            {
+                const auto pass = frameStatistics.time_pass("shader_reload");
+                shaderModuleCache->process_file_changes();
+            }
+            {
+                const auto pass = frameStatistics.time_pass("upload_textures");
+                textureLoader->upload_ready();
+            }
+            {
+                // uploads of the frame in one submission ahead of the frame's
+                const auto pass = frameStatistics.time_pass("flush_uploads");
+                uploadBatcher->flush();
+            }
+            // nothing is drawn yet, the slot is free again once the last
+            // submission made so far completes; no empty batch to get a value
+            frameTimelineValues.at(currentFrame) = graphicsTimeline->last_submitted_value();
+
+            frameStatistics.end_frame();
+            currentFrame = (currentFrame + 1) % MAX_FRAMES_IN_FLIGHT;
         }
         spdlog::info("Loop finished");
+
+        frameStatistics.log_summary();
+        std::ofstream statisticsFile{"frame_statistics.json", std::ios::trunc};
+        frameStatistics.write_json(statisticsFile);
     }
 
 private:
+    explicit HelloTrangleApplication(WindowAndContext windowAndContext)
+        : window{windowAndContext.window},
+          context{std::move(windowAndContext.context)},
+          physicalDevice{context->physical_device()},
+          logicalDevice{context->logical_device()},
+          textureFormatSupport{physicalDevice}
+    {
+        for (const auto& stage : context->startup_stages())
+        {
+            spdlog::info("Startup stage {}: {:.3f} ms",
+                         stage.name,
+                         std::chrono::duration<double, std::milli>(stage.duration).count());
+        }
+
+        textureFormatSupport.log_properties();
+
+        frameStatistics.on_hitch(
+            [](const vultex::HitchEvent& hitch)
+            {
+                spdlog::warn("Hitch in frame {}: {} time over the threshold",
+                             hitch.sample.frame,
+                             hitch.source);
+                for (const auto& pass : hitch.sample.passes)
+                {
+                    spdlog::warn("  {}: {:.3f} ms",
+                                 pass.name,
+                                 std::chrono::duration<double, std::milli>(pass.duration).count());
+                }
+                for (const auto& pass : hitch.sample.gpu_passes)
+                {
+                    spdlog::warn("  GPU {}: {:.3f} ms",
+                                 pass.name,
+                                 std::chrono::duration<double, std::milli>(pass.duration).count());
+                }
+            });
+
+        graphicsTimeline.emplace(logicalDevice, context->graphics_queue(), context->graphics_family());
+        computeTimeline.emplace(logicalDevice, context->compute_queue(), context->compute_family());
+        deletionQueue.emplace(logicalDevice, graphicsTimeline.value(), computeTimeline.value());
+
+        shaderModuleCache.emplace(logicalDevice, "shader_cache");
+
+        frameAllocator.emplace(physicalDevice, logicalDevice, FRAME_ALLOCATOR_SIZE, MAX_FRAMES_IN_FLIGHT);
+        uploadBatcher.emplace(*context, graphicsTimeline.value(), UPLOAD_ARENA_SIZE, MAX_FRAMES_IN_FLIGHT);
+        textureLoader.emplace(*context, jobSystem, textureFormatSupport, uploadBatcher.value());
+    }
+
     GLFWwindow* window{nullptr};
-    VkInstance instance{nullptr};
-    VkDebugUtilsMessengerEXT debugMessenger{nullptr};
+    std::unique_ptr<vultex::VulkanContext> context;
     VkPhysicalDevice physicalDevice{VK_NULL_HANDLE};
     VkDevice logicalDevice{nullptr};
-    VkQueue graphicsQueue{nullptr};
+    vultex::TextureFormatSupport textureFormatSupport;
+    vultex::JobSystem jobSystem{};
+    vultex::FrameStatistics frameStatistics{};
+    std::optional<vultex::ShaderModuleCache> shaderModuleCache{};
+    std::optional<vultex::QueueTimeline> graphicsTimeline{};
+    std::optional<vultex::QueueTimeline> computeTimeline{};
+    std::optional<vultex::DeletionQueue> deletionQueue{};
+    std::optional<vultex::FrameAllocator> frameAllocator{};
+    std::optional<vultex::UploadBatcher> uploadBatcher{};
+    std::optional<vultex::TextureLoader> textureLoader{};
 };
 
-int main()
+// vultex [texture.ktx2 ...]
+int main(const int argc, char** argv)
 try
 {
     spdlog::set_level(spdlog::level::info);
 
-    HelloTrangleApplication{}.run();
+    // has to outlive every vulkan object
+    vultex::HostAllocator hostAllocator{};
+    vultex::install_allocation_callbacks(hostAllocator.callbacks());
+
+    HelloTrangleApplication{std::vector<std::filesystem::path>(std::next(argv), std::next(argv, argc))}.run();
+
+    hostAllocator.log_statistics();
 
     return EXIT_SUCCESS;
 }
@@ -0,0 +1,304 @@
+#include "mesh_simplifier.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <optional>
+#include <utility>
+
+namespace vultex
+{
+namespace
+{
+// Symmetric 4x4 matrix of the squared distance to a set of planes, the upper
+// triangle in row order. Plane quadrics are not area weighted, so evaluating
+// it gives the sum of squared distances to the planes it was built from.
+struct Quadric
+{
+    double xx{}, xy{}, xz{}, xw{}, yy{}, yz{}, yw{}, zz{}, zw{}, ww{};
+
+    static Quadric from_plane(const glm::dvec3& normal, const double distance)
+    {
+        return Quadric{.xx = normal.x * normal.x,
+                       .xy = normal.x * normal.y,
+                       .xz = normal.x * normal.z,
+                       .xw = normal.x * distance,
+                       .yy = normal.y * normal.y,
+                       .yz = normal.y * normal.z,
+                       .yw = normal.y * distance,
+                       .zz = normal.z * normal.z,
+                       .zw = normal.z * distance,
+                       .ww = distance * distance};
+    }
+
+    Quadric& operator+=(const Quadric& other)
+    {
+        xx += other.xx;
+        xy += other.xy;
+        xz += other.xz;
+        xw += other.xw;
+        yy += other.yy;
+        yz += other.yz;
+        yw += other.yw;
+        zz += other.zz;
+        zw += other.zw;
+        ww += other.ww;
+        return *this;
+    }
+
+    [[nodiscard]] double evaluate(const glm::dvec3& p) const
+    {
+        const auto value = xx * p.x * p.x + yy * p.y * p.y + zz * p.z * p.z + ww +
+                           2.0 * (xy * p.x * p.y + xz * p.x * p.z + yz * p.y * p.z + xw * p.x + yw * p.y + zw * p.z);
+        // rounding can make it slightly negative for points on all planes
+        return std::max(value, 0.0);
+    }
+};
+
+struct Collapse
+{
+    std::uint32_t from;
+    std::uint32_t to;
+    double cost;
+};
+
+[[nodiscard]] std::uint64_t edge_key(const std::uint32_t a, const std::uint32_t b)
+{
+    return (static_cast<std::uint64_t>(std::min(a, b)) << 32U) | std::max(a, b);
+}
+
+[[nodiscard]] std::vector<std::uint64_t> sorted_edges(std::span<const std::uint32_t> indices)
+{
+    std::vector<std::uint64_t> edges{};
+    edges.reserve(indices.size());
+    for (std::size_t triangle = 0; triangle + 2 < indices.size(); triangle += 3)
+    {
+        edges.push_back(edge_key(indices[triangle], indices[triangle + 1]));
+        edges.push_back(edge_key(indices[triangle + 1], indices[triangle + 2]));
+        edges.push_back(edge_key(indices[triangle + 2], indices[triangle]));
+    }
+    std::ranges::sort(edges);
+    return edges;
+}
+
+// An edge used by a single triangle is on an open border or, since the
+// vertices on both sides of an attribute seam differ, on a seam.
+[[nodiscard]] std::vector<bool> border_vertices(const std::size_t vertex_count, std::span<const std::uint32_t> indices)
+{
+    std::vector<bool> border(vertex_count, false);
+    const auto edges = sorted_edges(indices);
+    for (std::size_t begin = 0; begin < edges.size();)
+    {
+        auto end = begin + 1;
+        while (end < edges.size() && edges[end] == edges[begin])
+        {
+            ++end;
+        }
+        if (1 == end - begin)
+        {
+            border[edges[begin] >> 32U] = true;
+            border[edges[begin] & 0xFFFFFFFFU] = true;
+        }
+        begin = end;
+    }
+    return border;
+}
+
+[[nodiscard]] std::vector<Quadric> vertex_quadrics(std::span<const glm::vec3> positions,
+                                                   std::span<const std::uint32_t> indices)
+{
+    std::vector<Quadric> quadrics(positions.size());
+    for (std::size_t triangle = 0; triangle + 2 < indices.size(); triangle += 3)
+    {
+        const glm::dvec3 p0{positions[indices[triangle]]};
+        const glm::dvec3 p1{positions[indices[triangle + 1]]};
+        const glm::dvec3 p2{positions[indices[triangle + 2]]};
+        const auto normal = glm::cross(p1 - p0, p2 - p0);
+        const auto length = glm::length(normal);
+        if (0.0 == length)
+        {
+            continue;
+        }
+
+        const auto unitNormal = normal / length;
+        const auto plane = Quadric::from_plane(unitNormal, -glm::dot(unitNormal, p0));
+        for (std::size_t corner = 0; corner < 3; ++corner)
+        {
+            quadrics[indices[triangle + corner]] += plane;
+        }
+    }
+    return quadrics;
+}
+
+// Triangles around every vertex, CSR layout
+struct Adjacency
+{
+    std::vector<std::uint32_t> offsets;
+    std::vector<std::uint32_t> triangles;
+
+    Adjacency(const std::size_t vertex_count, std::span<const std::uint32_t> indices) : offsets(vertex_count + 1, 0)
+    {
+        for (const auto index : indices)
+        {
+            ++offsets[index + 1];
+        }
+        for (std::size_t vertex = 0; vertex < vertex_count; ++vertex)
+        {
+            offsets[vertex + 1] += offsets[vertex];
+        }
+
+        triangles.resize(indices.size());
+        auto cursor = offsets;
+        for (std::size_t index = 0; index < indices.size(); ++index)
+        {
+            triangles[cursor[indices[index]]++] = static_cast<std::uint32_t>(index / 3);
+        }
+    }
+
+    [[nodiscard]] std::span<const std::uint32_t> of(const std::uint32_t vertex) const
+    {
+        return std::span{triangles}.subspan(offsets[vertex], offsets[vertex + 1] - offsets[vertex]);
+    }
+};
+
+// Moving `from` onto `to` must not turn any of the remaining triangles by
+// more than about 75 degrees. The quadrics don't see a fold, a collapse onto
+// a border vertex can cost nothing and leave a triangle upright on the border.
+[[nodiscard]] bool flips(std::span<const glm::vec3> positions,
+                         std::span<const std::uint32_t> indices,
+                         const Adjacency& adjacency,
+                         const Collapse& collapse)
+{
+    for (const auto triangle : adjacency.of(collapse.from))
+    {
+        const auto corners = indices.subspan(static_cast<std::size_t>(triangle) * 3, 3);
+        if (std::ranges::find(corners, collapse.to) != corners.end())
+        {
+            continue;
+        }
+
+        std::array<glm::vec3, 3> before{};
+        std::array<glm::vec3, 3> after{};
+        for (std::size_t corner = 0; corner < 3; ++corner)
+        {
+            before[corner] = positions[corners[corner]];
+            after[corner] = positions[corners[corner] == collapse.from ? collapse.to : corners[corner]];
+        }
+
+        const auto normalBefore = glm::cross(before[1] - before[0], before[2] - before[0]);
+        const auto normalAfter = glm::cross(after[1] - after[0], after[2] - after[0]);
+        if (glm::dot(normalBefore, normalAfter) <= 0.25F * glm::length(normalBefore) * glm::length(normalAfter))
+        {
+            return true;
+        }
+    }
+    return false;
+}
+} // namespace
+
+SimplifiedMesh simplify(std::span<const glm::vec3> positions,
+                        std::span<const std::uint32_t> indices,
+                        const std::size_t target_index_count,
+                        const float max_error)
+{
+    SimplifiedMesh result{.indices = {indices.begin(), indices.end()}, .error = 0.0F};
+
+    const auto vertexCount = positions.size();
+    const auto locked = border_vertices(vertexCount, indices);
+    auto quadrics = vertex_quadrics(positions, indices);
+    const auto maxCost = static_cast<double>(max_error) * static_cast<double>(max_error);
+
+    // Passes of independent collapses: sorted by cost, a collapse locks the
+    // triangles around it until the index buffer is rebuilt for the next pass.
+    std::vector<std::uint32_t> remap(vertexCount);
+    while (result.indices.size() > target_index_count)
+    {
+        std::vector<Collapse> collapses{};
+        const auto edges = sorted_edges(result.indices);
+        for (auto edge = edges.begin(); edge != edges.end(); edge = std::upper_bound(edge, edges.end(), *edge))
+        {
+            const auto a = static_cast<std::uint32_t>(*edge >> 32U);
+            const auto b = static_cast<std::uint32_t>(*edge & 0xFFFFFFFFU);
+
+            std::optional<Collapse> best{};
+            for (const auto& [from, to] : {std::pair{a, b}, std::pair{b, a}})
+            {
+                if (locked[from])
+                {
+                    continue;
+                }
+                auto combined = quadrics[from];
+                combined += quadrics[to];
+                const auto cost = combined.evaluate(glm::dvec3{positions[to]});
+                if (!best || cost < best->cost)
+                {
+                    best = Collapse{.from = from, .to = to, .cost = cost};
+                }
+            }
+            if (best && best->cost <= maxCost)
+            {
+                collapses.push_back(best.value());
+            }
+        }
+        std::ranges::sort(collapses, {}, &Collapse::cost);
+
+        const Adjacency adjacency{vertexCount, result.indices};
+        std::vector<bool> touched(vertexCount, false);
+        for (std::size_t vertex = 0; vertex < vertexCount; ++vertex)
+        {
+            remap[vertex] = static_cast<std::uint32_t>(vertex);
+        }
+
+        // every collapse of an interior edge removes two triangles
+        auto remainingIndices = result.indices.size();
+        std::size_t collapsed = 0;
+        for (const auto& collapse : collapses)
+        {
+            if (remainingIndices <= target_index_count)
+            {
+                break;
+            }
+            if (touched[collapse.from] || touched[collapse.to] ||
+                flips(positions, result.indices, adjacency, collapse))
+            {
+                continue;
+            }
+
+            for (const auto triangle : adjacency.of(collapse.from))
+            {
+                for (std::size_t corner = 0; corner < 3; ++corner)
+                {
+                    touched[result.indices[static_cast<std::size_t>(triangle) * 3 + corner]] = true;
+                }
+            }
+            remap[collapse.from] = collapse.to;
+            quadrics[collapse.to] += quadrics[collapse.from];
+            result.error = std::max(result.error, static_cast<float>(std::sqrt(collapse.cost)));
+            remainingIndices -= std::min<std::size_t>(remainingIndices, 6);
+            ++collapsed;
+        }
+
+        if (0 == collapsed)
+        {
+            break;
+        }
+
+        // collapsed triangles have two equal corners, drop them
+        std::size_t written = 0;
+        for (std::size_t triangle = 0; triangle + 2 < result.indices.size(); triangle += 3)
+        {
+            const auto a = remap[result.indices[triangle]];
+            const auto b = remap[result.indices[triangle + 1]];
+            const auto c = remap[result.indices[triangle + 2]];
+            if (a != b && b != c && c != a)
+            {
+                result.indices[written++] = a;
+                result.indices[written++] = b;
+                result.indices[written++] = c;
+            }
+        }
+        result.indices.resize(written);
+    }
+    return result;
+}
+} // namespace vultex
@@ -0,0 +1,29 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <glm/glm.hpp>
+#include <span>
+#include <vector>
+
+namespace vultex
+{
+
+struct SimplifiedMesh
+{
+    std::vector<std::uint32_t> indices;
+    // largest distance of the simplified surface to the original one, in mesh units
+    float error;
+};
+
+// Garland-Heckbert quadric edge collapse on an indexed triangle list. Vertices
+// only collapse into other existing vertices, so the result indexes the same
+// vertex buffer and every LOD of a mesh can share it. Vertices on open
+// borders and on attribute seams (same position, different vertex) stay.
+// Stops at target_index_count or when the next collapse would exceed
+// max_error, whichever comes first.
+[[nodiscard]] SimplifiedMesh simplify(std::span<const glm::vec3> positions,
+                                      std::span<const std::uint32_t> indices,
+                                      std::size_t target_index_count,
+                                      float max_error);
+} // namespace vultex
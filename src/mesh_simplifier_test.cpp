@@ -0,0 +1,197 @@
+#include "mesh_simplifier.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <functional>
+#include <gtest/gtest.h>
+#include <set>
+#include <vector>
+
+namespace vultex
+{
+namespace
+{
+struct Grid
+{
+    std::vector<glm::vec3> positions;
+    std::vector<std::uint32_t> indices;
+};
+
+// cells x cells quads in the xy plane, counter clockwise seen from +z, with
+// the height given by z(x, y)
+Grid make_grid(const std::uint32_t cells, const std::function<float(float, float)>& z)
+{
+    Grid grid{};
+    const auto side = cells + 1;
+    for (std::uint32_t row = 0; row < side; ++row)
+    {
+        for (std::uint32_t column = 0; column < side; ++column)
+        {
+            const auto x = static_cast<float>(column) / static_cast<float>(cells);
+            const auto y = static_cast<float>(row) / static_cast<float>(cells);
+            grid.positions.emplace_back(x, y, z(x, y));
+        }
+    }
+    for (std::uint32_t row = 0; row < cells; ++row)
+    {
+        for (std::uint32_t column = 0; column < cells; ++column)
+        {
+            const auto corner = row * side + column;
+            grid.indices.insert(grid.indices.end(), {corner, corner + 1, corner + side + 1});
+            grid.indices.insert(grid.indices.end(), {corner, corner + side + 1, corner + side});
+        }
+    }
+    return grid;
+}
+
+glm::vec3 face_normal(const std::vector<glm::vec3>& positions, const std::uint32_t* triangle)
+{
+    return glm::cross(positions[triangle[1]] - positions[triangle[0]], positions[triangle[2]] - positions[triangle[0]]);
+}
+
+// indices in range, no triangle with a repeated corner
+void expect_valid_triangles(const SimplifiedMesh& mesh, const std::size_t vertex_count)
+{
+    ASSERT_EQ(mesh.indices.size() % 3, 0U);
+    for (std::size_t first = 0; first < mesh.indices.size(); first += 3)
+    {
+        const auto* triangle = &mesh.indices[first];
+        EXPECT_LT(triangle[0], vertex_count);
+        EXPECT_LT(triangle[1], vertex_count);
+        EXPECT_LT(triangle[2], vertex_count);
+        EXPECT_TRUE(triangle[0] != triangle[1] && triangle[1] != triangle[2] && triangle[0] != triangle[2]) << first;
+    }
+}
+
+TEST(MeshSimplifier, FlatGridReachesTheTargetWithoutError)
+{
+    const auto grid = make_grid(16, [](float, float) { return 0.0F; });
+    const auto target = grid.indices.size() / 4;
+    const auto simplified = simplify(grid.positions, grid.indices, target, 0.01F);
+
+    expect_valid_triangles(simplified, grid.positions.size());
+    EXPECT_LE(simplified.indices.size(), target);
+    EXPECT_GT(simplified.indices.size(), 0U);
+    EXPECT_NEAR(simplified.error, 0.0F, 1e-5F);
+}
+
+float wave(const float x, const float y)
+{
+    return 0.05F * std::sin(6.0F * x) * std::cos(5.0F * y);
+}
+
+TEST(MeshSimplifier, TrianglesKeepTheirWinding)
+{
+    const auto grid = make_grid(16, wave);
+    const auto simplified = simplify(grid.positions, grid.indices, grid.indices.size() / 4, 0.01F);
+
+    expect_valid_triangles(simplified, grid.positions.size());
+    EXPECT_LT(simplified.indices.size(), grid.indices.size());
+    for (std::size_t first = 0; first < simplified.indices.size(); first += 3)
+    {
+        // a thin triangle on a slope may end up upright, but never facing down
+        EXPECT_GE(face_normal(grid.positions, &simplified.indices[first]).z, 0.0F) << first;
+    }
+}
+
+TEST(MeshSimplifier, BordersDoNotGrowFins)
+{
+    // an interior vertex collapsed onto a border one must not leave a
+    // triangle standing on the border, folded over by 90 degrees
+    const auto grid = make_grid(16, wave);
+    const auto simplified = simplify(grid.positions, grid.indices, grid.indices.size() / 4, 0.01F);
+
+    for (std::size_t first = 0; first < simplified.indices.size(); first += 3)
+    {
+        const auto* triangle = &simplified.indices[first];
+        for (const auto side : {0.0F, 1.0F})
+        {
+            const auto onSideX = [&](std::uint32_t index) { return grid.positions[index].x == side; };
+            const auto onSideY = [&](std::uint32_t index) { return grid.positions[index].y == side; };
+            EXPECT_FALSE(std::ranges::all_of(triangle, triangle + 3, onSideX)) << first;
+            EXPECT_FALSE(std::ranges::all_of(triangle, triangle + 3, onSideY)) << first;
+        }
+    }
+}
+
+TEST(MeshSimplifier, OpenBordersStay)
+{
+    const auto cells = 12U;
+    const auto grid = make_grid(cells, [](float, float) { return 0.0F; });
+    const auto simplified = simplify(grid.positions, grid.indices, 0, 1.0F);
+
+    const std::set<std::uint32_t> used(simplified.indices.begin(), simplified.indices.end());
+    const auto side = cells + 1;
+    for (std::uint32_t index = 0; index < side; ++index)
+    {
+        for (const auto border : {index, (side - 1) * side + index, index * side, index * side + side - 1})
+        {
+            EXPECT_TRUE(used.contains(border)) << border;
+        }
+    }
+    // the border alone is 4 * cells vertices, every triangle fills at most one side
+    EXPECT_LT(simplified.indices.size(), grid.indices.size());
+}
+
+TEST(MeshSimplifier, SeamVerticesStay)
+{
+    // the right half of the grid uses copies of the vertices on x = 0.5, as
+    // for a texture seam
+    const auto cells = 8U;
+    auto grid = make_grid(cells, [](float, float) { return 0.0F; });
+    const auto side = cells + 1;
+    const auto seamColumn = cells / 2;
+    std::vector<std::uint32_t> copies(side);
+    for (std::uint32_t row = 0; row < side; ++row)
+    {
+        copies[row] = static_cast<std::uint32_t>(grid.positions.size());
+        grid.positions.push_back(grid.positions[row * side + seamColumn]);
+    }
+    for (std::size_t first = 0; first < grid.indices.size(); first += 3)
+    {
+        const auto* triangle = &grid.indices[first];
+        const auto rightHalf = std::ranges::any_of(triangle, triangle + 3,
+                                                   [&](std::uint32_t index) { return index % side > seamColumn; });
+        for (std::size_t corner = first; rightHalf && corner < first + 3; ++corner)
+        {
+            if (grid.indices[corner] % side == seamColumn)
+            {
+                grid.indices[corner] = copies[grid.indices[corner] / side];
+            }
+        }
+    }
+
+    const auto simplified = simplify(grid.positions, grid.indices, 0, 1.0F);
+    expect_valid_triangles(simplified, grid.positions.size());
+    const std::set<std::uint32_t> used(simplified.indices.begin(), simplified.indices.end());
+    for (std::uint32_t row = 0; row < side; ++row)
+    {
+        EXPECT_TRUE(used.contains(row * side + seamColumn)) << row;
+        EXPECT_TRUE(used.contains(copies[row])) << row;
+    }
+}
+
+TEST(MeshSimplifier, ErrorStaysWithinTheLimit)
+{
+    const auto grid = make_grid(24, [](float x, float y) { return 0.2F * (x * x + y * y); });
+    for (const auto maxError : {0.0F, 0.001F, 0.01F})
+    {
+        const auto simplified = simplify(grid.positions, grid.indices, 0, maxError);
+        expect_valid_triangles(simplified, grid.positions.size());
+        EXPECT_LE(simplified.error, maxError);
+        EXPECT_LE(simplified.indices.size(), grid.indices.size());
+    }
+    // a curved surface without any error allowed keeps every interior vertex
+    EXPECT_EQ(simplify(grid.positions, grid.indices, 0, 0.0F).indices.size(), grid.indices.size());
+}
+
+TEST(MeshSimplifier, TargetAboveTheInputKeepsTheMesh)
+{
+    const auto grid = make_grid(4, [](float, float) { return 0.0F; });
+    const auto simplified = simplify(grid.positions, grid.indices, grid.indices.size(), 1.0F);
+    EXPECT_EQ(simplified.indices, grid.indices);
+    EXPECT_EQ(simplified.error, 0.0F);
+}
+} // namespace
+} // namespace vultex
@@ -0,0 +1,623 @@
+#include "pipeline_compiler.hpp"
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstring>
+#include <fmt/format.h>
+#include <fstream>
+#include <iterator>
+#include <span>
+#include <spdlog/spdlog.h>
+#include <stdexcept>
+#include <string_view>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "hash.hpp"
+#include "host_allocator.hpp"
+
+namespace vultex
+{
+namespace
+{
+struct PipelineCacheHeader
+{
+    std::uint32_t header_size;
+    std::uint32_t header_version;
+    std::uint32_t vendor_id;
+    std::uint32_t device_id;
+    std::array<std::uint8_t, VK_UUID_SIZE> uuid;
+};
+
+// cache created by another driver or GPU is rejected by the driver anyway,
+// checking it here avoids passing garbage to vkCreatePipelineCache
+std::vector<char> load_cache_data(VkPhysicalDevice physical_device, const std::filesystem::path& cache_file)
+{
+    std::ifstream file{cache_file, std::ios::binary};
+    std::vector<char> data{std::istreambuf_iterator<char>{file}, std::istreambuf_iterator<char>{}};
+    if (data.size() < sizeof(PipelineCacheHeader))
+    {
+        return {};
+    }
+
+    PipelineCacheHeader header{};
+    std::memcpy(&header, data.data(), sizeof(header));
+
+    VkPhysicalDeviceProperties properties{};
+    vkGetPhysicalDeviceProperties(physical_device, &properties);
+
+    if (header.header_version != VK_PIPELINE_CACHE_HEADER_VERSION_ONE || header.vendor_id != properties.vendorID ||
+        header.device_id != properties.deviceID ||
+        0 != std::memcmp(header.uuid.data(), std::data(properties.pipelineCacheUUID), VK_UUID_SIZE))
+    {
+        spdlog::info("Pipeline cache {} was created for another device, ignore it", cache_file.string());
+        return {};
+    }
+    return data;
+}
+
+#ifdef VK_EXT_graphics_pipeline_library
+// Hash of the state a library part is compiled from, field by field since
+// Vulkan structs have padding and pNext pointers
+class StateHash
+{
+public:
+    StateHash(const VkGraphicsPipelineLibraryFlagsEXT part, const VkGraphicsPipelineCreateInfo& create_info)
+    {
+        add(part);
+        add(create_info.flags);
+        if (nullptr != create_info.pDynamicState)
+        {
+            add(std::span{create_info.pDynamicState->pDynamicStates, create_info.pDynamicState->dynamicStateCount});
+        }
+    }
+
+    template <typename T>
+    void add(const T& value)
+    {
+        static_assert(std::is_trivially_copyable_v<T>);
+        hash = fnv1a(std::as_bytes(std::span{&value, 1}), hash);
+    }
+
+    template <typename T>
+    void add(const std::span<const T> values)
+    {
+        add(values.size());
+        for (const auto& value : values)
+        {
+            add(value);
+        }
+    }
+
+    void add_bytes(const void* data, const std::size_t size)
+    {
+        add(size);
+        hash = fnv1a(std::span{static_cast<const std::byte*>(data), size}, hash);
+    }
+
+    void add_stages(const std::span<const VkPipelineShaderStageCreateInfo> stages)
+    {
+        add(stages.size());
+        for (const auto& stage : stages)
+        {
+            add(stage.flags);
+            add(stage.stage);
+            add(stage.module);
+            hash = fnv1a(std::string_view{stage.pName}, hash);
+            const auto* specialization = stage.pSpecializationInfo;
+            add(nullptr != specialization);
+            if (nullptr != specialization)
+            {
+                add(std::span{specialization->pMapEntries, specialization->mapEntryCount});
+                add_bytes(specialization->pData, specialization->dataSize);
+            }
+        }
+    }
+
+    void add_multisample(const VkPipelineMultisampleStateCreateInfo* multisample)
+    {
+        add(nullptr != multisample);
+        if (nullptr != multisample)
+        {
+            add(multisample->rasterizationSamples);
+            add(multisample->sampleShadingEnable);
+            add(multisample->minSampleShading);
+            if (nullptr != multisample->pSampleMask)
+            {
+                add(std::span{multisample->pSampleMask, (multisample->rasterizationSamples + 31U) / 32U});
+            }
+            add(multisample->alphaToCoverageEnable);
+            add(multisample->alphaToOneEnable);
+        }
+    }
+
+    void add_render_pass(const VkGraphicsPipelineCreateInfo& create_info)
+    {
+        add(create_info.renderPass);
+        add(create_info.subpass);
+    }
+
+    [[nodiscard]] std::uint64_t value() const
+    {
+        return hash;
+    }
+
+private:
+    std::uint64_t hash{fnv1a_offset_basis};
+};
+
+[[nodiscard]] std::uint64_t vertex_input_key(const VkGraphicsPipelineCreateInfo& create_info)
+{
+    StateHash hash{VK_GRAPHICS_PIPELINE_LIBRARY_VERTEX_INPUT_INTERFACE_BIT_EXT, create_info};
+    if (const auto* vertexInput = create_info.pVertexInputState; nullptr != vertexInput)
+    {
+        hash.add(std::span{vertexInput->pVertexBindingDescriptions, vertexInput->vertexBindingDescriptionCount});
+        hash.add(std::span{vertexInput->pVertexAttributeDescriptions, vertexInput->vertexAttributeDescriptionCount});
+    }
+    if (const auto* inputAssembly = create_info.pInputAssemblyState; nullptr != inputAssembly)
+    {
+        hash.add(inputAssembly->topology);
+        hash.add(inputAssembly->primitiveRestartEnable);
+    }
+    return hash.value();
+}
+
+[[nodiscard]] std::uint64_t pre_rasterization_key(const VkGraphicsPipelineCreateInfo& create_info,
+                                                  const std::span<const VkPipelineShaderStageCreateInfo> stages)
+{
+    StateHash hash{VK_GRAPHICS_PIPELINE_LIBRARY_PRE_RASTERIZATION_SHADERS_BIT_EXT, create_info};
+    hash.add_stages(stages);
+    hash.add(create_info.layout);
+    hash.add_render_pass(create_info);
+    if (const auto* tessellation = create_info.pTessellationState; nullptr != tessellation)
+    {
+        hash.add(tessellation->patchControlPoints);
+    }
+    if (const auto* viewport = create_info.pViewportState; nullptr != viewport)
+    {
+        // null arrays are dynamic state
+        hash.add(viewport->viewportCount);
+        hash.add(viewport->scissorCount);
+        if (nullptr != viewport->pViewports)
+        {
+            hash.add(std::span{viewport->pViewports, viewport->viewportCount});
+        }
+        if (nullptr != viewport->pScissors)
+        {
+            hash.add(std::span{viewport->pScissors, viewport->scissorCount});
+        }
+    }
+    if (const auto* rasterization = create_info.pRasterizationState; nullptr != rasterization)
+    {
+        hash.add(rasterization->depthClampEnable);
+        hash.add(rasterization->rasterizerDiscardEnable);
+        hash.add(rasterization->polygonMode);
+        hash.add(rasterization->cullMode);
+        hash.add(rasterization->frontFace);
+        hash.add(rasterization->depthBiasEnable);
+        hash.add(rasterization->depthBiasConstantFactor);
+        hash.add(rasterization->depthBiasClamp);
+        hash.add(rasterization->depthBiasSlopeFactor);
+        hash.add(rasterization->lineWidth);
+    }
+    return hash.value();
+}
+
+[[nodiscard]] std::uint64_t fragment_shader_key(const VkGraphicsPipelineCreateInfo& create_info,
+                                                const std::span<const VkPipelineShaderStageCreateInfo> stages)
+{
+    StateHash hash{VK_GRAPHICS_PIPELINE_LIBRARY_FRAGMENT_SHADER_BIT_EXT, create_info};
+    hash.add_stages(stages);
+    hash.add(create_info.layout);
+    hash.add_render_pass(create_info);
+    hash.add_multisample(create_info.pMultisampleState);
+    if (const auto* depthStencil = create_info.pDepthStencilState; nullptr != depthStencil)
+    {
+        hash.add(depthStencil->flags);
+        hash.add(depthStencil->depthTestEnable);
+        hash.add(depthStencil->depthWriteEnable);
+        hash.add(depthStencil->depthCompareOp);
+        hash.add(depthStencil->depthBoundsTestEnable);
+        hash.add(depthStencil->stencilTestEnable);
+        hash.add(depthStencil->front);
+        hash.add(depthStencil->back);
+        hash.add(depthStencil->minDepthBounds);
+        hash.add(depthStencil->maxDepthBounds);
+    }
+    return hash.value();
+}
+
+[[nodiscard]] std::uint64_t fragment_output_key(const VkGraphicsPipelineCreateInfo& create_info)
+{
+    StateHash hash{VK_GRAPHICS_PIPELINE_LIBRARY_FRAGMENT_OUTPUT_INTERFACE_BIT_EXT, create_info};
+    hash.add_render_pass(create_info);
+    hash.add_multisample(create_info.pMultisampleState);
+    if (const auto* colorBlend = create_info.pColorBlendState; nullptr != colorBlend)
+    {
+        hash.add(colorBlend->flags);
+        hash.add(colorBlend->logicOpEnable);
+        hash.add(colorBlend->logicOp);
+        hash.add(std::span{colorBlend->pAttachments, colorBlend->attachmentCount});
+        hash.add(colorBlend->blendConstants);
+    }
+    return hash.value();
+}
+
+// Parts are taken from context.libraries, only the ones no earlier pipeline
+// shares are compiled. The linked pipeline doesn't need them anymore.
+[[nodiscard]] VkPipeline link_graphics_pipeline(const PipelineBuildContext& context,
+                                                const VkGraphicsPipelineCreateInfo& create_info)
+{
+    std::vector<VkPipelineShaderStageCreateInfo> preRasterizationStages{};
+    std::vector<VkPipelineShaderStageCreateInfo> fragmentStages{};
+    for (const auto& stage : std::span{create_info.pStages, create_info.stageCount})
+    {
+        (VK_SHADER_STAGE_FRAGMENT_BIT == stage.stage ? fragmentStages : preRasterizationStages).push_back(stage);
+    }
+    const auto modulesOf = [](const std::vector<VkPipelineShaderStageCreateInfo>& stages)
+    {
+        std::vector<VkShaderModule> modules{};
+        for (const auto& stage : stages)
+        {
+            modules.push_back(stage.module);
+        }
+        return modules;
+    };
+
+    struct LibraryPart
+    {
+        VkGraphicsPipelineLibraryFlagsEXT flags;
+        VkGraphicsPipelineCreateInfo create_info;
+        std::uint64_t key;
+        std::vector<VkShaderModule> modules;
+    };
+    const std::array parts{
+        LibraryPart{.flags = VK_GRAPHICS_PIPELINE_LIBRARY_VERTEX_INPUT_INTERFACE_BIT_EXT,
+                    .create_info = VkGraphicsPipelineCreateInfo{.pVertexInputState = create_info.pVertexInputState,
+                                                                .pInputAssemblyState = create_info.pInputAssemblyState},
+                    .key = vertex_input_key(create_info),
+                    .modules = {}},
+        LibraryPart{
+            .flags = VK_GRAPHICS_PIPELINE_LIBRARY_PRE_RASTERIZATION_SHADERS_BIT_EXT,
+            .create_info =
+                VkGraphicsPipelineCreateInfo{.stageCount = static_cast<std::uint32_t>(preRasterizationStages.size()),
+                                             .pStages = preRasterizationStages.data(),
+                                             .pTessellationState = create_info.pTessellationState,
+                                             .pViewportState = create_info.pViewportState,
+                                             .pRasterizationState = create_info.pRasterizationState,
+                                             .layout = create_info.layout,
+                                             .renderPass = create_info.renderPass,
+                                             .subpass = create_info.subpass},
+            .key = pre_rasterization_key(create_info, preRasterizationStages),
+            .modules = modulesOf(preRasterizationStages)},
+        LibraryPart{.flags = VK_GRAPHICS_PIPELINE_LIBRARY_FRAGMENT_SHADER_BIT_EXT,
+                    .create_info =
+                        VkGraphicsPipelineCreateInfo{.stageCount = static_cast<std::uint32_t>(fragmentStages.size()),
+                                                     .pStages = fragmentStages.data(),
+                                                     .pMultisampleState = create_info.pMultisampleState,
+                                                     .pDepthStencilState = create_info.pDepthStencilState,
+                                                     .layout = create_info.layout,
+                                                     .renderPass = create_info.renderPass,
+                                                     .subpass = create_info.subpass},
+                    .key = fragment_shader_key(create_info, fragmentStages),
+                    .modules = modulesOf(fragmentStages)},
+        LibraryPart{.flags = VK_GRAPHICS_PIPELINE_LIBRARY_FRAGMENT_OUTPUT_INTERFACE_BIT_EXT,
+                    .create_info = VkGraphicsPipelineCreateInfo{.pMultisampleState = create_info.pMultisampleState,
+                                                                .pColorBlendState = create_info.pColorBlendState,
+                                                                .renderPass = create_info.renderPass,
+                                                                .subpass = create_info.subpass},
+                    .key = fragment_output_key(create_info),
+                    .modules = {}}};
+
+    std::array<VkPipeline, parts.size()> libraries{};
+    for (std::size_t part = 0; part < parts.size(); ++part)
+    {
+        libraries[part] = context.libraries->get(
+            parts[part].key,
+            parts[part].modules,
+            [&context, &create_info, &libraryPart = parts[part]]
+            {
+                const VkGraphicsPipelineLibraryCreateInfoEXT libraryInfo{
+                    .sType = VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_LIBRARY_CREATE_INFO_EXT, .flags = libraryPart.flags};
+                auto partInfo = libraryPart.create_info;
+                partInfo.sType = VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_CREATE_INFO;
+                partInfo.pNext = &libraryInfo;
+                partInfo.flags = create_info.flags | VK_PIPELINE_CREATE_LIBRARY_BIT_KHR;
+                partInfo.pDynamicState = create_info.pDynamicState;
+                VkPipeline library{nullptr};
+                if (VK_SUCCESS != vkCreateGraphicsPipelines(context.logical_device,
+                                                            context.pipeline_cache,
+                                                            1,
+                                                            &partInfo,
+                                                            allocation_callbacks(),
+                                                            &library))
+                {
+                    throw std::runtime_error("Failed to create graphics pipeline library!");
+                }
+                return library;
+            });
+    }
+
+    const VkPipelineLibraryCreateInfoKHR linkInfo{.sType = VK_STRUCTURE_TYPE_PIPELINE_LIBRARY_CREATE_INFO_KHR,
+                                                  .libraryCount = static_cast<std::uint32_t>(libraries.size()),
+                                                  .pLibraries = libraries.data()};
+    const VkGraphicsPipelineCreateInfo pipelineInfo{.sType = VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_CREATE_INFO,
+                                                    .pNext = &linkInfo,
+                                                    .flags = create_info.flags,
+                                                    .layout = create_info.layout};
+    VkPipeline pipeline{nullptr};
+    if (VK_SUCCESS != vkCreateGraphicsPipelines(context.logical_device,
+                                                context.pipeline_cache,
+                                                1,
+                                                &pipelineInfo,
+                                                allocation_callbacks(),
+                                                &pipeline))
+    {
+        throw std::runtime_error("Failed to link graphics pipeline!");
+    }
+    return pipeline;
+}
+#endif
+} // namespace
+
+VkPipeline create_compute_pipeline(const PipelineBuildContext& context, const VkComputePipelineCreateInfo& create_info)
+{
+    VkPipeline pipeline{nullptr};
+    if (VK_SUCCESS != vkCreateComputePipelines(context.logical_device,
+                                               context.pipeline_cache,
+                                               1,
+                                               &create_info,
+                                               allocation_callbacks(),
+                                               &pipeline))
+    {
+        throw std::runtime_error("Failed to create compute pipeline!");
+    }
+    return pipeline;
+}
+
+std::shared_future<VkPipeline> compile_compute_kernel(PipelineCompiler& compiler,
+                                                      const std::uint64_t key,
+                                                      VkShaderModule module,
+                                                      VkPipelineLayout layout)
+{
+    const VkComputePipelineCreateInfo pipelineInfo{
+        .sType = VK_STRUCTURE_TYPE_COMPUTE_PIPELINE_CREATE_INFO,
+        .stage = {.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO,
+                  .stage = VK_SHADER_STAGE_COMPUTE_BIT,
+                  .module = module,
+                  .pName = "main"},
+        .layout = layout};
+    return compiler.compile(key,
+                            [pipelineInfo](const PipelineBuildContext& context)
+                            { return create_compute_pipeline(context, pipelineInfo); });
+}
+
+VkPipeline create_graphics_pipeline(const PipelineBuildContext& context,
+                                    const VkGraphicsPipelineCreateInfo& create_info)
+{
+#ifdef VK_EXT_graphics_pipeline_library
+    if (context.fast_link && nullptr == create_info.pNext)
+    {
+        return link_graphics_pipeline(context, create_info);
+    }
+#endif
+
+    VkPipeline pipeline{nullptr};
+    if (VK_SUCCESS != vkCreateGraphicsPipelines(context.logical_device,
+                                                context.pipeline_cache,
+                                                1,
+                                                &create_info,
+                                                allocation_callbacks(),
+                                                &pipeline))
+    {
+        throw std::runtime_error("Failed to create graphics pipeline!");
+    }
+    return pipeline;
+}
+
+PipelineLibraryCache::PipelineLibraryCache(VkDevice logical_device) : logical_device{logical_device}
+{
+}
+
+PipelineLibraryCache::~PipelineLibraryCache()
+{
+    for (const auto& [key, part] : parts)
+    {
+        vkDestroyPipeline(logical_device, part.library, allocation_callbacks());
+    }
+    for (const auto library : released)
+    {
+        vkDestroyPipeline(logical_device, library, allocation_callbacks());
+    }
+}
+
+VkPipeline PipelineLibraryCache::get(const std::uint64_t key,
+                                     const std::span<const VkShaderModule> modules,
+                                     const std::function<VkPipeline()>& create)
+{
+    {
+        const std::scoped_lock lock{mutex};
+        if (const auto it = parts.find(key); it != parts.end())
+        {
+            return it->second.library;
+        }
+    }
+
+    // not under the lock, parts of other pipelines compile meanwhile
+    const auto library = create();
+
+    const std::scoped_lock lock{mutex};
+    const auto [it, inserted] =
+        parts.try_emplace(key, Part{.library = library, .modules = {modules.begin(), modules.end()}});
+    if (!inserted)
+    {
+        vkDestroyPipeline(logical_device, library, allocation_callbacks());
+    }
+    return it->second.library;
+}
+
+void PipelineLibraryCache::release(VkShaderModule module)
+{
+    const std::scoped_lock lock{mutex};
+    std::erase_if(parts,
+                  [this, module](const auto& entry)
+                  {
+                      if (std::ranges::find(entry.second.modules, module) == entry.second.modules.end())
+                      {
+                          return false;
+                      }
+                      released.push_back(entry.second.library);
+                      return true;
+                  });
+}
+
+PipelineCompiler::PipelineCompiler(VkPhysicalDevice physical_device,
+                                   VkDevice logical_device,
+                                   JobSystem& job_system,
+                                   const bool fast_link,
+                                   std::filesystem::path cache_file)
+    : logical_device{logical_device},
+      job_system{job_system},
+      libraries{logical_device},
+      cache_file{std::move(cache_file)}
+{
+    const auto data = load_cache_data(physical_device, this->cache_file);
+    spdlog::info("Load pipeline cache: {} bytes", data.size());
+
+    const VkPipelineCacheCreateInfo createInfo{.sType = VK_STRUCTURE_TYPE_PIPELINE_CACHE_CREATE_INFO,
+                                               .initialDataSize = data.size(),
+                                               .pInitialData = data.empty() ? nullptr : data.data()};
+
+    VkPipelineCache pipeline_cache{nullptr};
+    if (VK_SUCCESS != vkCreatePipelineCache(logical_device, &createInfo, allocation_callbacks(), &pipeline_cache))
+    {
+        throw std::runtime_error("Failed to create pipeline cache!");
+    }
+
+    context = PipelineBuildContext{.logical_device = logical_device,
+                                   .pipeline_cache = pipeline_cache,
+                                   .fast_link = fast_link,
+                                   .libraries = &libraries};
+}
+
+PipelineCompiler::~PipelineCompiler()
+{
+    const std::scoped_lock lock{mutex};
+
+    for (const auto& [key, pipeline] : pipelines)
+    {
+        // waits for pipelines still being compiled
+        vkDestroyPipeline(logical_device, pipeline.get(), allocation_callbacks());
+    }
+    for (const auto& entry : retiring)
+    {
+        vkDestroyPipeline(logical_device, entry.pipeline.get(), allocation_callbacks());
+    }
+
+    save_cache();
+    vkDestroyPipelineCache(logical_device, context.pipeline_cache, allocation_callbacks());
+}
+
+std::shared_future<VkPipeline> PipelineCompiler::compile(const std::uint64_t key, Builder builder)
+{
+    const std::scoped_lock lock{mutex};
+    if (const auto it = pipelines.find(key); it != pipelines.end())
+    {
+        return it->second;
+    }
+
+    auto pipeline = job_system
+                        .submit(
+                            [context = context, builder = std::move(builder), key]() -> VkPipeline
+                            {
+                                try
+                                {
+                                    return builder(context);
+                                }
+                                catch (const std::exception& e)
+                                {
+                                    // draws keep skipping the pipeline instead of failing every frame
+                                    spdlog::error("Cannot compile pipeline {:016x}: {}", key, e.what());
+                                    return nullptr;
+                                }
+                            })
+                        .share();
+
+    pipelines.emplace(key, pipeline);
+    return pipeline;
+}
+
+VkPipeline PipelineCompiler::try_get(const std::uint64_t key) const
+{
+    const std::scoped_lock lock{mutex};
+    const auto it = pipelines.find(key);
+    if (it == pipelines.end() || std::future_status::ready != it->second.wait_for(std::chrono::seconds{0}))
+    {
+        return nullptr;
+    }
+    return it->second.get();
+}
+
+VkPipeline PipelineCompiler::wait(const std::shared_future<VkPipeline>& pipeline, const std::string_view name)
+{
+    // builders log their errors and return nullptr
+    const auto handle = pipeline.get();
+    if (nullptr == handle)
+    {
+        throw std::runtime_error(fmt::format("Failed to create {} pipeline!", name));
+    }
+    return handle;
+}
+
+void PipelineCompiler::invalidate(const std::uint64_t key,
+                                  DeletionQueue& deletion_queue,
+                                  const TimelineKind timeline,
+                                  const std::uint64_t timeline_value)
+{
+    const std::scoped_lock lock{mutex};
+    if (const auto it = pipelines.find(key); it != pipelines.end())
+    {
+        retiring.push_back(
+            Retiring{.pipeline = std::move(it->second), .timeline = timeline, .timeline_value = timeline_value});
+        pipelines.erase(it);
+    }
+
+    // a pipeline compiled after its invalidation was never used by a frame,
+    // the value it was retired with is late enough
+    std::erase_if(retiring,
+                  [&deletion_queue](const Retiring& entry)
+                  {
+                      if (std::future_status::ready != entry.pipeline.wait_for(std::chrono::seconds{0}))
+                      {
+                          return false;
+                      }
+                      // previous pipeline can still be used by frames in flight
+                      deletion_queue.retire(entry.pipeline.get(), entry.timeline, entry.timeline_value);
+                      return true;
+                  });
+}
+
+void PipelineCompiler::release_libraries(VkShaderModule module)
+{
+    libraries.release(module);
+}
+
+void PipelineCompiler::save_cache() const
+{
+    std::size_t size{0};
+    vkGetPipelineCacheData(logical_device, context.pipeline_cache, &size, nullptr);
+
+    std::vector<char> data(size);
+    if (VK_SUCCESS != vkGetPipelineCacheData(logical_device, context.pipeline_cache, &size, data.data()))
+    {
+        spdlog::warn("Cannot read pipeline cache data");
+        return;
+    }
+
+    std::ofstream file{cache_file, std::ios::binary | std::ios::trunc};
+    file.write(data.data(), static_cast<std::streamsize>(size));
+    spdlog::info("Save pipeline cache: {} bytes", size);
+}
+} // namespace vultex
@@ -0,0 +1,150 @@
+#pragma once
+
+#define GLFW_INCLUDE_VULKAN
+#include <GLFW/glfw3.h>
+
+#include <cstdint>
+#include <filesystem>
+#include <functional>
+#include <future>
+#include <map>
+#include <mutex>
+#include <span>
+#include <string_view>
+#include <vector>
+
+#include "deletion_queue.hpp"
+#include "job_system.hpp"
+
+namespace vultex
+{
+
+// Graphics pipeline library parts shared by every pipeline linked from them.
+// Vertex input and fragment output parts are keyed by their state, the shader
+// parts by their modules, specialization, layout and state, so a pipeline
+// which differs from earlier ones in one part compiles only that part.
+class PipelineLibraryCache
+{
+public:
+    explicit PipelineLibraryCache(VkDevice logical_device);
+    PipelineLibraryCache(const PipelineLibraryCache&) = delete;
+    PipelineLibraryCache(PipelineLibraryCache&&) = delete;
+    PipelineLibraryCache& operator=(const PipelineLibraryCache&) = delete;
+    PipelineLibraryCache& operator=(PipelineLibraryCache&&) = delete;
+    ~PipelineLibraryCache();
+
+    // part of key, made by create on the first request. Concurrent requests
+    // of a new key may both create it, one of them is kept.
+    [[nodiscard]] VkPipeline get(std::uint64_t key,
+                                 std::span<const VkShaderModule> modules,
+                                 const std::function<VkPipeline()>& create);
+
+    // parts compiled from module are not handed out anymore since a new
+    // module can get its handle; a link in flight may still use them, they
+    // are destroyed with the cache
+    void release(VkShaderModule module);
+
+private:
+    struct Part
+    {
+        VkPipeline library;
+        std::vector<VkShaderModule> modules;
+    };
+
+    VkDevice logical_device{nullptr};
+    std::mutex mutex{};
+    std::map<std::uint64_t, Part> parts{};
+    std::vector<VkPipeline> released{};
+};
+
+class PipelineCompiler;
+
+struct PipelineBuildContext
+{
+    VkDevice logical_device;
+    VkPipelineCache pipeline_cache;
+    // VK_EXT_graphics_pipeline_library is enabled, pipelines can be fast
+    // linked from precompiled vertex input / shader / output libraries
+    bool fast_link;
+    // owned by the PipelineCompiler
+    PipelineLibraryCache* libraries;
+};
+
+// Builders of PipelineCompiler, both create the pipeline with the shared
+// cache. With fast_link the graphics pipeline is linked without link time
+// optimization from its four library parts (vertex input, pre-rasterization,
+// fragment shader, fragment output), taken from context.libraries. Create
+// infos with a pNext chain are not split, they are created in one piece.
+[[nodiscard]] VkPipeline create_compute_pipeline(const PipelineBuildContext& context,
+                                                 const VkComputePipelineCreateInfo& create_info);
+[[nodiscard]] VkPipeline create_graphics_pipeline(const PipelineBuildContext& context,
+                                                  const VkGraphicsPipelineCreateInfo& create_info);
+
+// Compute pipeline of the main entry point of module, compiled by compiler
+// in parallel with other kernels; the pipeline belongs to compiler
+[[nodiscard]] std::shared_future<VkPipeline> compile_compute_kernel(PipelineCompiler& compiler,
+                                                                    std::uint64_t key,
+                                                                    VkShaderModule module,
+                                                                    VkPipelineLayout layout);
+
+// Builds pipelines on job threads against a VkPipelineCache shared by all of
+// them and persisted on disk between runs. Draws query try_get every frame
+// and skip (or use a fallback) until their pipeline is ready.
+class PipelineCompiler
+{
+public:
+    using Builder = std::function<VkPipeline(const PipelineBuildContext&)>;
+
+    PipelineCompiler(VkPhysicalDevice physical_device,
+                     VkDevice logical_device,
+                     JobSystem& job_system,
+                     bool fast_link,
+                     std::filesystem::path cache_file);
+    PipelineCompiler(const PipelineCompiler&) = delete;
+    PipelineCompiler(PipelineCompiler&&) = delete;
+    PipelineCompiler& operator=(const PipelineCompiler&) = delete;
+    PipelineCompiler& operator=(PipelineCompiler&&) = delete;
+    ~PipelineCompiler();
+
+    // the same key is compiled only once, later calls share the future
+    [[nodiscard]] std::shared_future<VkPipeline> compile(std::uint64_t key, Builder builder);
+
+    // never blocks, nullptr while the pipeline is still compiling
+    [[nodiscard]] VkPipeline try_get(std::uint64_t key) const;
+
+    // blocks until the pipeline is compiled, for setup code which cannot go
+    // on without it; throws when the build failed
+    [[nodiscard]] static VkPipeline wait(const std::shared_future<VkPipeline>& pipeline, std::string_view name);
+
+    // drops the pipeline so the next compile rebuilds it (e.g. shader reload),
+    // the old one is destroyed once frames using it complete. Never blocks, a
+    // pipeline still compiling is retired by a later invalidate once done.
+    void invalidate(std::uint64_t key,
+                    DeletionQueue& deletion_queue,
+                    TimelineKind timeline,
+                    std::uint64_t timeline_value);
+
+    // call before a shader module is destroyed (e.g. shader reload), see
+    // PipelineLibraryCache::release
+    void release_libraries(VkShaderModule module);
+
+private:
+    struct Retiring
+    {
+        std::shared_future<VkPipeline> pipeline;
+        TimelineKind timeline;
+        std::uint64_t timeline_value;
+    };
+
+    void save_cache() const;
+
+    VkDevice logical_device{nullptr};
+    JobSystem& job_system;
+    PipelineLibraryCache libraries;
+    PipelineBuildContext context{};
+    std::filesystem::path cache_file;
+    mutable std::mutex mutex{};
+    std::map<std::uint64_t, std::shared_future<VkPipeline>> pipelines{};
+    std::vector<Retiring> retiring{};
+};
+} // namespace vultex
@@ -0,0 +1,87 @@
+#include "pipeline_permutations.hpp"
+
+#include <fmt/format.h>
+#include <fstream>
+#include <spdlog/spdlog.h>
+
+#include "hash.hpp"
+
+namespace vultex
+{
+
+PipelinePermutations::PipelinePermutations(PipelineCompiler& compiler,
+                                           const std::uint64_t material_key,
+                                           Builder builder)
+    : compiler{compiler}, material_key{material_key}, builder{std::move(builder)}
+{
+}
+
+VkPipeline PipelinePermutations::get(const std::uint32_t mask)
+{
+    if (const auto pipeline = compiler.try_get(key(mask)); nullptr != pipeline)
+    {
+        return pipeline;
+    }
+    // not compiled yet or invalidated since, compile shares a build in flight
+    request(mask);
+    return compiler.try_get(key(mask));
+}
+
+VkPipeline PipelinePermutations::wait(const std::uint32_t mask)
+{
+    used_masks.insert(mask);
+    return PipelineCompiler::wait(compiler.compile(key(mask), mask_builder(mask)),
+                                  fmt::format("permutation {:08x} of material {:016x}", mask, material_key));
+}
+
+void PipelinePermutations::prewarm(const std::span<const std::uint32_t> masks)
+{
+    for (const auto mask : masks)
+    {
+        request(mask);
+    }
+}
+
+void PipelinePermutations::prewarm(const std::filesystem::path& used_masks_file)
+{
+    std::ifstream file{used_masks_file};
+    std::uint32_t mask{0};
+    while (file >> std::hex >> mask)
+    {
+        request(mask);
+    }
+    spdlog::info("Prewarm {} permutations of material {:016x}", used_masks.size(), material_key);
+}
+
+void PipelinePermutations::save_used(const std::filesystem::path& used_masks_file) const
+{
+    std::ofstream file{used_masks_file, std::ios::trunc};
+    for (const auto mask : used_masks)
+    {
+        file << fmt::format("{:08x}\n", mask);
+    }
+}
+
+const std::set<std::uint32_t>& PipelinePermutations::used() const
+{
+    return used_masks;
+}
+
+std::uint64_t PipelinePermutations::key(const std::uint32_t mask) const
+{
+    return fnv1a(fmt::format("{:016x}:{:08x}", material_key, mask));
+}
+
+void PipelinePermutations::request(const std::uint32_t mask)
+{
+    used_masks.insert(mask);
+
+    // compiler keeps the future, the pipeline is picked up by a later get
+    static_cast<void>(compiler.compile(key(mask), mask_builder(mask)));
+}
+
+PipelineCompiler::Builder PipelinePermutations::mask_builder(const std::uint32_t mask) const
+{
+    return [builder = builder, mask](const PipelineBuildContext& context) { return builder(context, mask); };
+}
+} // namespace vultex
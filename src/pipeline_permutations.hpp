@@ -0,0 +1,55 @@
+#pragma once
+
+#define GLFW_INCLUDE_VULKAN
+#include <GLFW/glfw3.h>
+
+#include <cstdint>
+#include <filesystem>
+#include <functional>
+#include <set>
+#include <span>
+
+#include "pipeline_compiler.hpp"
+
+namespace vultex
+{
+
+// Pipelines of one material, one per feature mask that is actually used.
+// Only requested masks are compiled (never all 2^N of them) and the used
+// ones can be stored to prewarm the pipeline compiler at the next start.
+class PipelinePermutations
+{
+public:
+    // builder bakes the mask as specialization constants. info() points into
+    // the FeatureSpecialization, keep it in a named local until the pipeline
+    // is created:
+    //   const FeatureSpecialization<N> features{mask};
+    //   const auto specialization = features.info();
+    using Builder = std::function<VkPipeline(const PipelineBuildContext&, std::uint32_t)>;
+
+    PipelinePermutations(PipelineCompiler& compiler, std::uint64_t material_key, Builder builder);
+
+    // nullptr until the permutation is compiled, draw is skipped or uses fallback
+    [[nodiscard]] VkPipeline get(std::uint32_t mask);
+
+    // blocks until the permutation is compiled, for setup code; throws when
+    // the build failed
+    [[nodiscard]] VkPipeline wait(std::uint32_t mask);
+
+    void prewarm(std::span<const std::uint32_t> masks);
+    void prewarm(const std::filesystem::path& used_masks_file);
+    void save_used(const std::filesystem::path& used_masks_file) const;
+
+    [[nodiscard]] const std::set<std::uint32_t>& used() const;
+
+private:
+    [[nodiscard]] std::uint64_t key(std::uint32_t mask) const;
+    void request(std::uint32_t mask);
+    [[nodiscard]] PipelineCompiler::Builder mask_builder(std::uint32_t mask) const;
+
+    PipelineCompiler& compiler;
+    std::uint64_t material_key;
+    Builder builder;
+    std::set<std::uint32_t> used_masks{};
+};
+} // namespace vultex
@@ -0,0 +1,131 @@
+#include "queue_ownership.hpp"
+
+namespace vultex
+{
+namespace
+{
+bool is_transfer(const QueueUsage& source, const QueueUsage& target)
+{
+    return source.family_index != target.family_index;
+}
+
+VkBufferMemoryBarrier make_buffer_barrier(VkBuffer buffer,
+                                          const QueueUsage& source,
+                                          const QueueUsage& target,
+                                          const VkAccessFlags src_access,
+                                          const VkAccessFlags dst_access)
+{
+    const auto transfer = is_transfer(source, target);
+    return VkBufferMemoryBarrier{.sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER,
+                                 .srcAccessMask = src_access,
+                                 .dstAccessMask = dst_access,
+                                 .srcQueueFamilyIndex = transfer ? source.family_index : VK_QUEUE_FAMILY_IGNORED,
+                                 .dstQueueFamilyIndex = transfer ? target.family_index : VK_QUEUE_FAMILY_IGNORED,
+                                 .buffer = buffer,
+                                 .offset = 0,
+                                 .size = VK_WHOLE_SIZE};
+}
+
+VkImageMemoryBarrier make_image_barrier(VkImage image,
+                                        const VkImageSubresourceRange& range,
+                                        const VkImageLayout old_layout,
+                                        const VkImageLayout new_layout,
+                                        const QueueUsage& source,
+                                        const QueueUsage& target,
+                                        const VkAccessFlags src_access,
+                                        const VkAccessFlags dst_access)
+{
+    const auto transfer = is_transfer(source, target);
+    return VkImageMemoryBarrier{.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER,
+                                .srcAccessMask = src_access,
+                                .dstAccessMask = dst_access,
+                                .oldLayout = old_layout,
+                                .newLayout = new_layout,
+                                .srcQueueFamilyIndex = transfer ? source.family_index : VK_QUEUE_FAMILY_IGNORED,
+                                .dstQueueFamilyIndex = transfer ? target.family_index : VK_QUEUE_FAMILY_IGNORED,
+                                .image = image,
+                                .subresourceRange = range};
+}
+} // namespace
+
+void release_buffer(VkCommandBuffer command_buffer,
+                    VkBuffer buffer,
+                    const QueueUsage& source,
+                    const QueueUsage& target)
+{
+    // same family: the whole dependency is done by the acquire barrier
+    if (!is_transfer(source, target))
+    {
+        return;
+    }
+
+    // destination access is ignored by the release operation
+    const auto barrier = make_buffer_barrier(buffer, source, target, source.access, 0);
+    vkCmdPipelineBarrier(
+        command_buffer, source.stage, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, 0, 0, nullptr, 1, &barrier, 0, nullptr);
+}
+
+void acquire_buffer(VkCommandBuffer command_buffer,
+                    VkBuffer buffer,
+                    const QueueUsage& source,
+                    const QueueUsage& target)
+{
+    const auto transfer = is_transfer(source, target);
+
+    // source access is ignored by the acquire operation, the timeline wait
+    // made the released writes available
+    const auto barrier = make_buffer_barrier(buffer, source, target, transfer ? 0 : source.access, target.access);
+    vkCmdPipelineBarrier(command_buffer,
+                         transfer ? VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT : source.stage,
+                         target.stage,
+                         0,
+                         0,
+                         nullptr,
+                         1,
+                         &barrier,
+                         0,
+                         nullptr);
+}
+
+void release_image(VkCommandBuffer command_buffer,
+                   VkImage image,
+                   const VkImageSubresourceRange& range,
+                   const VkImageLayout old_layout,
+                   const VkImageLayout new_layout,
+                   const QueueUsage& source,
+                   const QueueUsage& target)
+{
+    if (!is_transfer(source, target))
+    {
+        return;
+    }
+
+    // layout transition is done once, the acquire barrier repeats the same layouts
+    const auto barrier = make_image_barrier(image, range, old_layout, new_layout, source, target, source.access, 0);
+    vkCmdPipelineBarrier(
+        command_buffer, source.stage, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, 0, 0, nullptr, 0, nullptr, 1, &barrier);
+}
+
+void acquire_image(VkCommandBuffer command_buffer,
+                   VkImage image,
+                   const VkImageSubresourceRange& range,
+                   const VkImageLayout old_layout,
+                   const VkImageLayout new_layout,
+                   const QueueUsage& source,
+                   const QueueUsage& target)
+{
+    const auto transfer = is_transfer(source, target);
+    const auto barrier = make_image_barrier(
+        image, range, old_layout, new_layout, source, target, transfer ? 0 : source.access, target.access);
+    vkCmdPipelineBarrier(command_buffer,
+                         transfer ? VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT : source.stage,
+                         target.stage,
+                         0,
+                         0,
+                         nullptr,
+                         0,
+                         nullptr,
+                         1,
+                         &barrier);
+}
+} // namespace vultex
@@ -0,0 +1,45 @@
+#pragma once
+
+#define GLFW_INCLUDE_VULKAN
+#include <GLFW/glfw3.h>
+
+#include <cstdint>
+
+namespace vultex
+{
+
+struct QueueUsage
+{
+    std::uint32_t family_index;
+    VkPipelineStageFlags stage;
+    VkAccessFlags access;
+};
+
+// Hands a resource with exclusive sharing mode over from one queue family to
+// another: the release half is recorded on the source queue, the acquire
+// half on the destination queue whose submit waits for the source timeline.
+// Both are plain memory barriers when the families are the same.
+void release_buffer(VkCommandBuffer command_buffer,
+                    VkBuffer buffer,
+                    const QueueUsage& source,
+                    const QueueUsage& target);
+void acquire_buffer(VkCommandBuffer command_buffer,
+                    VkBuffer buffer,
+                    const QueueUsage& source,
+                    const QueueUsage& target);
+
+void release_image(VkCommandBuffer command_buffer,
+                   VkImage image,
+                   const VkImageSubresourceRange& range,
+                   VkImageLayout old_layout,
+                   VkImageLayout new_layout,
+                   const QueueUsage& source,
+                   const QueueUsage& target);
+void acquire_image(VkCommandBuffer command_buffer,
+                   VkImage image,
+                   const VkImageSubresourceRange& range,
+                   VkImageLayout old_layout,
+                   VkImageLayout new_layout,
+                   const QueueUsage& source,
+                   const QueueUsage& target);
+} // namespace vultex
@@ -0,0 +1,212 @@
+#include "queue_scheduler.hpp"
+
+#include <map>
+#include <span>
+#include <stdexcept>
+#include <utility>
+
+#include "host_allocator.hpp"
+
+namespace vultex
+{
+
+QueueScheduler::QueueScheduler(VkDevice logical_device,
+                               QueueTimeline& graphics,
+                               QueueTimeline& compute,
+                               const std::uint32_t frames_in_flight)
+    : logical_device{logical_device},
+      graphics{graphics},
+      compute{compute},
+      command_pools(frames_in_flight, nullptr),
+      command_buffers(frames_in_flight, nullptr),
+      submitted(frames_in_flight, 0)
+{
+    for (std::uint32_t slot = 0; slot < frames_in_flight; ++slot)
+    {
+        const VkCommandPoolCreateInfo poolInfo{.sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO,
+                                               .flags = VK_COMMAND_POOL_CREATE_TRANSIENT_BIT,
+                                               .queueFamilyIndex = compute.family_index()};
+        if (VK_SUCCESS != vkCreateCommandPool(logical_device, &poolInfo, allocation_callbacks(), &command_pools[slot]))
+        {
+            throw std::runtime_error("Failed to create async compute command pool!");
+        }
+
+        const VkCommandBufferAllocateInfo allocateInfo{.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO,
+                                                       .commandPool = command_pools[slot],
+                                                       .level = VK_COMMAND_BUFFER_LEVEL_PRIMARY,
+                                                       .commandBufferCount = 1};
+        if (VK_SUCCESS != vkAllocateCommandBuffers(logical_device, &allocateInfo, &command_buffers[slot]))
+        {
+            throw std::runtime_error("Failed to allocate async compute command buffer!");
+        }
+    }
+}
+
+QueueScheduler::~QueueScheduler()
+{
+    compute.wait(compute.last_submitted_value());
+    for (auto* pool : command_pools)
+    {
+        vkDestroyCommandPool(logical_device, pool, allocation_callbacks());
+    }
+}
+
+void QueueScheduler::add_pass(QueuePass pass)
+{
+    passes.push_back(std::move(pass));
+    planned = false;
+}
+
+std::optional<TimelineWait> QueueScheduler::submit_compute()
+{
+    plan();
+
+    bool anyCompute = false;
+    for (const auto& pass : passes)
+    {
+        anyCompute = anyCompute || pass.queue == PassQueue::async_compute;
+    }
+    if (!anyCompute)
+    {
+        return std::nullopt;
+    }
+
+    const auto slot = frame++ % command_buffers.size();
+    compute.wait(submitted[slot]);
+    vkResetCommandPool(logical_device, command_pools[slot], 0);
+
+    auto* commandBuffer = command_buffers[slot];
+    const VkCommandBufferBeginInfo beginInfo{.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO,
+                                             .flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT};
+    vkBeginCommandBuffer(commandBuffer, &beginInfo);
+    for (std::size_t index = 0; index < passes.size(); ++index)
+    {
+        if (passes[index].queue == PassQueue::async_compute)
+        {
+            record_pass(commandBuffer, index);
+        }
+    }
+    vkEndCommandBuffer(commandBuffer);
+
+    // the previous frame's graphics passes released what this one acquires
+    std::optional<TimelineWait> graphicsWait{};
+    if (0 != compute_wait_stage && !first_frame)
+    {
+        graphicsWait = graphics.wait_for_last_submit(compute_wait_stage);
+    }
+    submitted[slot] = compute.submit(std::span{&commandBuffer, 1},
+                                     graphicsWait ? std::span{&graphicsWait.value(), 1}
+                                                  : std::span<const TimelineWait>{});
+
+    if (0 == graphics_wait_stage)
+    {
+        return std::nullopt;
+    }
+    return compute.wait_for_last_submit(graphics_wait_stage);
+}
+
+void QueueScheduler::record_graphics(VkCommandBuffer command_buffer)
+{
+    plan();
+    for (std::size_t index = 0; index < passes.size(); ++index)
+    {
+        if (passes[index].queue == PassQueue::graphics)
+        {
+            record_pass(command_buffer, index);
+        }
+    }
+    first_frame = false;
+}
+
+void QueueScheduler::plan()
+{
+    if (planned)
+    {
+        return;
+    }
+
+    // compute passes first, then graphics ones
+    std::vector<std::size_t> order{};
+    for (const auto queue : {PassQueue::async_compute, PassQueue::graphics})
+    {
+        for (std::size_t index = 0; index < passes.size(); ++index)
+        {
+            if (passes[index].queue == queue)
+            {
+                order.push_back(index);
+            }
+        }
+    }
+
+    // uses of every buffer in frame order
+    std::map<VkBuffer, std::vector<std::pair<std::size_t, PassBuffer>>> uses{};
+    for (const auto index : order)
+    {
+        for (const auto& buffer : passes[index].buffers)
+        {
+            uses[buffer.buffer].emplace_back(index, buffer);
+        }
+    }
+
+    plans.assign(passes.size(), PassPlan{});
+    compute_wait_stage = 0;
+    graphics_wait_stage = 0;
+    for (const auto& [buffer, bufferUses] : uses)
+    {
+        // the first use of a frame follows the last one of the previous frame
+        for (std::size_t use = 0; use < bufferUses.size(); ++use)
+        {
+            const auto previousUse = use == 0 ? bufferUses.size() - 1 : use - 1;
+            const auto& [sourceIndex, sourceBuffer] = bufferUses[previousUse];
+            const auto& [targetIndex, targetBuffer] = bufferUses[use];
+            const auto& source = passes[sourceIndex];
+            const auto& target = passes[targetIndex];
+            const Transfer transfer{.buffer = buffer,
+                                    .source = usage(source, sourceBuffer),
+                                    .target = usage(target, targetBuffer),
+                                    .previous_frame = use == 0};
+
+            if (source.queue == target.queue)
+            {
+                plans[targetIndex].acquires.push_back(transfer);
+                continue;
+            }
+
+            // another queue of the same family: the semaphore wait is the whole dependency
+            if (transfer.source.family_index != transfer.target.family_index)
+            {
+                plans[sourceIndex].releases.push_back(transfer);
+                plans[targetIndex].acquires.push_back(transfer);
+            }
+            auto& waitStage = target.queue == PassQueue::async_compute ? compute_wait_stage : graphics_wait_stage;
+            waitStage |= targetBuffer.stage;
+        }
+    }
+    planned = true;
+}
+
+void QueueScheduler::record_pass(VkCommandBuffer command_buffer, const std::size_t index) const
+{
+    const auto& passPlan = plans[index];
+    for (const auto& transfer : passPlan.acquires)
+    {
+        if (!transfer.previous_frame || !first_frame)
+        {
+            acquire_buffer(command_buffer, transfer.buffer, transfer.source, transfer.target);
+        }
+    }
+    passes[index].record(command_buffer);
+    for (const auto& transfer : passPlan.releases)
+    {
+        release_buffer(command_buffer, transfer.buffer, transfer.source, transfer.target);
+    }
+}
+
+QueueUsage QueueScheduler::usage(const QueuePass& pass, const PassBuffer& buffer) const
+{
+    return QueueUsage{
+        .family_index = pass.queue == PassQueue::graphics ? graphics.family_index() : compute.family_index(),
+        .stage = buffer.stage,
+        .access = buffer.access};
+}
+} // namespace vultex
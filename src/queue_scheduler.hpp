@@ -0,0 +1,113 @@
+#pragma once
+
+#define GLFW_INCLUDE_VULKAN
+#include <GLFW/glfw3.h>
+
+#include <cstdint>
+#include <functional>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include "queue_ownership.hpp"
+#include "queue_timeline.hpp"
+
+namespace vultex
+{
+
+enum class PassQueue : std::uint8_t
+{
+    graphics,
+    async_compute
+};
+
+// a buffer with exclusive sharing mode and how a pass uses it
+struct PassBuffer
+{
+    VkBuffer buffer;
+    VkPipelineStageFlags stage;
+    VkAccessFlags access;
+};
+
+struct QueuePass
+{
+    std::string name;
+    PassQueue queue;
+    std::vector<PassBuffer> buffers;
+    // outside of a render pass, a graphics pass begins and ends its own
+    std::function<void(VkCommandBuffer)> record;
+};
+
+// Passes of a frame tagged with the queue they run on. The async compute
+// passes of a frame are submitted on the compute queue ahead of the graphics
+// ones; between two passes using the same buffer the scheduler records the
+// barrier, or the release / acquire pair of queue_ownership when the queue
+// changes, and makes the submission of the later pass wait for the timeline
+// of the earlier one.
+// A frame runs its compute passes, then its graphics passes, in the order
+// they were added: compute passes read what graphics passes wrote in the
+// previous frame, graphics passes what compute passes wrote in this one.
+// Buffers are not copied per frame, so with a buffer shared by both queues
+// the GPU runs the graphics submission of frame N, the compute one of N + 1
+// and the graphics one of N + 1 one after the other, nothing overlaps. Only
+// when no buffer is shared the compute submission runs alongside the raster
+// work of the previous frame.
+class QueueScheduler
+{
+public:
+    QueueScheduler(VkDevice logical_device,
+                   QueueTimeline& graphics,
+                   QueueTimeline& compute,
+                   std::uint32_t frames_in_flight);
+    QueueScheduler(const QueueScheduler&) = delete;
+    QueueScheduler(QueueScheduler&&) = delete;
+    QueueScheduler& operator=(const QueueScheduler&) = delete;
+    QueueScheduler& operator=(QueueScheduler&&) = delete;
+    // waits for the compute submissions
+    ~QueueScheduler();
+
+    void add_pass(QueuePass pass);
+
+    // records and submits the async compute passes of the frame, the
+    // returned wait is for the graphics submission of the frame
+    [[nodiscard]] std::optional<TimelineWait> submit_compute();
+    // the graphics passes of the frame with their barriers and the releases
+    // to the next frame's compute passes, after submit_compute()
+    void record_graphics(VkCommandBuffer command_buffer);
+
+private:
+    struct Transfer
+    {
+        VkBuffer buffer;
+        QueueUsage source;
+        QueueUsage target;
+        // the source is a pass of the previous frame, there is none in the first
+        bool previous_frame;
+    };
+
+    struct PassPlan
+    {
+        std::vector<Transfer> acquires;
+        std::vector<Transfer> releases;
+    };
+
+    void plan();
+    void record_pass(VkCommandBuffer command_buffer, std::size_t index) const;
+    [[nodiscard]] QueueUsage usage(const QueuePass& pass, const PassBuffer& buffer) const;
+
+    VkDevice logical_device{nullptr};
+    QueueTimeline& graphics;
+    QueueTimeline& compute;
+    std::vector<QueuePass> passes{};
+    std::vector<PassPlan> plans{};
+    // stage flags the compute submission waits for the graphics queue with, and the other way around
+    VkPipelineStageFlags compute_wait_stage{0};
+    VkPipelineStageFlags graphics_wait_stage{0};
+    bool planned{false};
+    bool first_frame{true};
+    std::vector<VkCommandPool> command_pools{};
+    std::vector<VkCommandBuffer> command_buffers{};
+    std::vector<std::uint64_t> submitted{};
+    std::uint64_t frame{0};
+};
+} // namespace vultex
@@ -0,0 +1,118 @@
+#include "queue_timeline.hpp"
+
+#include <fmt/format.h>
+#include <stdexcept>
+#include <vector>
+
+#include "host_allocator.hpp"
+
+namespace vultex
+{
+
+QueueTimeline::QueueTimeline(VkDevice logical_device, VkQueue queue, const std::uint32_t family_index)
+    : logical_device{logical_device}, submit_queue{queue}, queue_family_index{family_index}
+{
+    const VkSemaphoreTypeCreateInfo typeInfo{.sType = VK_STRUCTURE_TYPE_SEMAPHORE_TYPE_CREATE_INFO,
+                                             .semaphoreType = VK_SEMAPHORE_TYPE_TIMELINE,
+                                             .initialValue = 0};
+    const VkSemaphoreCreateInfo createInfo{.sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO, .pNext = &typeInfo};
+
+    if (VK_SUCCESS != vkCreateSemaphore(logical_device, &createInfo, allocation_callbacks(), &semaphore))
+    {
+        throw std::runtime_error("Failed to create timeline semaphore!");
+    }
+}
+
+QueueTimeline::~QueueTimeline()
+{
+    vkDestroySemaphore(logical_device, semaphore, allocation_callbacks());
+}
+
+std::uint64_t QueueTimeline::submit(const std::span<const VkCommandBuffer> command_buffers,
+                                    const std::span<const TimelineWait> waits)
+{
+    std::vector<VkSemaphore> waitSemaphores{};
+    std::vector<std::uint64_t> waitValues{};
+    std::vector<VkPipelineStageFlags> waitStages{};
+    for (const auto& wait : waits)
+    {
+        waitSemaphores.push_back(wait.semaphore);
+        waitValues.push_back(wait.value);
+        waitStages.push_back(wait.stage);
+    }
+
+    const auto signalValue = submitted_value + 1;
+    const VkTimelineSemaphoreSubmitInfo timelineInfo{.sType = VK_STRUCTURE_TYPE_TIMELINE_SEMAPHORE_SUBMIT_INFO,
+                                                     .waitSemaphoreValueCount =
+                                                         static_cast<std::uint32_t>(waitValues.size()),
+                                                     .pWaitSemaphoreValues = waitValues.data(),
+                                                     .signalSemaphoreValueCount = 1,
+                                                     .pSignalSemaphoreValues = &signalValue};
+
+    const VkSubmitInfo submitInfo{.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO,
+                                  .pNext = &timelineInfo,
+                                  .waitSemaphoreCount = static_cast<std::uint32_t>(waitSemaphores.size()),
+                                  .pWaitSemaphores = waitSemaphores.data(),
+                                  .pWaitDstStageMask = waitStages.data(),
+                                  .commandBufferCount = static_cast<std::uint32_t>(command_buffers.size()),
+                                  .pCommandBuffers = command_buffers.data(),
+                                  .signalSemaphoreCount = 1,
+                                  .pSignalSemaphores = &semaphore};
+
+    const auto status = vkQueueSubmit(submit_queue, 1, &submitInfo, VK_NULL_HANDLE);
+    if (VK_SUCCESS != status)
+    {
+        throw std::runtime_error{fmt::format("Cannot submit to queue family {}: {}", queue_family_index, status)};
+    }
+
+    submitted_value = signalValue;
+    return signalValue;
+}
+
+std::uint64_t QueueTimeline::completed_value() const
+{
+    std::uint64_t value{0};
+    vkGetSemaphoreCounterValue(logical_device, semaphore, &value);
+    return value;
+}
+
+bool QueueTimeline::is_complete(const std::uint64_t value) const
+{
+    return completed_value() >= value;
+}
+
+std::uint64_t QueueTimeline::last_submitted_value() const
+{
+    return submitted_value;
+}
+
+bool QueueTimeline::wait(const std::uint64_t value, const std::uint64_t timeout) const
+{
+    const VkSemaphoreWaitInfo waitInfo{.sType = VK_STRUCTURE_TYPE_SEMAPHORE_WAIT_INFO,
+                                       .semaphoreCount = 1,
+                                       .pSemaphores = &semaphore,
+                                       .pValues = &value};
+
+    const auto status = vkWaitSemaphores(logical_device, &waitInfo, timeout);
+    if (VK_SUCCESS != status && VK_TIMEOUT != status)
+    {
+        throw std::runtime_error{fmt::format("Cannot wait for timeline value {}: {}", value, status)};
+    }
+    return VK_SUCCESS == status;
+}
+
+TimelineWait QueueTimeline::wait_for_last_submit(const VkPipelineStageFlags stage) const
+{
+    return TimelineWait{.semaphore = semaphore, .value = submitted_value, .stage = stage};
+}
+
+VkQueue QueueTimeline::queue() const
+{
+    return submit_queue;
+}
+
+std::uint32_t QueueTimeline::family_index() const
+{
+    return queue_family_index;
+}
+} // namespace vultex
@@ -0,0 +1,57 @@
+#pragma once
+
+#define GLFW_INCLUDE_VULKAN
+#include <GLFW/glfw3.h>
+
+#include <cstdint>
+#include <limits>
+#include <span>
+
+namespace vultex
+{
+
+struct TimelineWait
+{
+    VkSemaphore semaphore;
+    std::uint64_t value;
+    VkPipelineStageFlags stage;
+};
+
+// A queue with its own timeline semaphore. Every submit signals the next
+// value, so "work done" is a single number: frames, uploads and resource
+// lifetimes are tracked by the value they were submitted with, and other
+// queues wait for it without fences or binary semaphore pairs.
+class QueueTimeline
+{
+public:
+    QueueTimeline(VkDevice logical_device, VkQueue queue, std::uint32_t family_index);
+    QueueTimeline(const QueueTimeline&) = delete;
+    QueueTimeline(QueueTimeline&&) = delete;
+    QueueTimeline& operator=(const QueueTimeline&) = delete;
+    QueueTimeline& operator=(QueueTimeline&&) = delete;
+    ~QueueTimeline();
+
+    // returns the value signaled when the command buffers complete
+    std::uint64_t submit(std::span<const VkCommandBuffer> command_buffers, std::span<const TimelineWait> waits = {});
+
+    [[nodiscard]] std::uint64_t completed_value() const;
+    [[nodiscard]] bool is_complete(std::uint64_t value) const;
+    [[nodiscard]] std::uint64_t last_submitted_value() const;
+
+    // false on timeout
+    bool wait(std::uint64_t value, std::uint64_t timeout = std::numeric_limits<std::uint64_t>::max()) const;
+
+    // for another queue, waiting on the last submission of this one
+    [[nodiscard]] TimelineWait wait_for_last_submit(VkPipelineStageFlags stage) const;
+
+    [[nodiscard]] VkQueue queue() const;
+    [[nodiscard]] std::uint32_t family_index() const;
+
+private:
+    VkDevice logical_device{nullptr};
+    VkQueue submit_queue{nullptr};
+    std::uint32_t queue_family_index{0};
+    VkSemaphore semaphore{nullptr};
+    std::uint64_t submitted_value{0};
+};
+} // namespace vultex
@@ -0,0 +1,216 @@
+#include "radix_sort.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <functional>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+namespace vultex
+{
+namespace
+{
+constexpr std::size_t digit_bits = 8;
+constexpr std::size_t digit_values = 1U << digit_bits;
+constexpr std::size_t key_digit_count = 64 / digit_bits;
+constexpr std::size_t value_digit_count = 32 / digit_bits;
+constexpr std::size_t max_digit_count = key_digit_count + value_digit_count;
+// below this a block is not worth a job
+constexpr std::size_t min_block_size = 64 * 1024;
+
+using Histogram = std::array<std::uint32_t, digit_values>;
+
+[[nodiscard]] std::size_t digit_count(const SortOrder order)
+{
+    return SortOrder::key_value == order ? max_digit_count : key_digit_count;
+}
+
+// with SortOrder::key_value the value digits come first, least significant first
+[[nodiscard]] std::size_t digit_of(const SortItem& item, std::size_t digit, const SortOrder order)
+{
+    if (SortOrder::key_value == order)
+    {
+        if (digit < value_digit_count)
+        {
+            return static_cast<std::size_t>(item.value >> (digit * digit_bits)) & (digit_values - 1);
+        }
+        digit -= value_digit_count;
+    }
+    return static_cast<std::size_t>(item.key >> (digit * digit_bits)) & (digit_values - 1);
+}
+
+void check_scratch(const std::span<SortItem> items, const std::span<SortItem> scratch)
+{
+    if (scratch.size() < items.size())
+    {
+        throw std::invalid_argument("Radix sort scratch is smaller than the items!");
+    }
+}
+
+[[nodiscard]] bool is_uniform(const Histogram& histogram, const std::size_t item_count)
+{
+    return std::ranges::any_of(histogram, [item_count](const auto count) { return count == item_count; });
+}
+} // namespace
+
+void radix_sort(std::span<SortItem> items, std::span<SortItem> scratch, const SortOrder order)
+{
+    check_scratch(items, scratch);
+
+    const auto digitCount = digit_count(order);
+    std::array<Histogram, max_digit_count> histograms{};
+    for (const auto& item : items)
+    {
+        for (std::size_t digit = 0; digit < digitCount; ++digit)
+        {
+            ++histograms[digit][digit_of(item, digit, order)];
+        }
+    }
+
+    auto source = items;
+    auto destination = scratch.first(items.size());
+    for (std::size_t digit = 0; digit < digitCount; ++digit)
+    {
+        auto& histogram = histograms[digit];
+        if (is_uniform(histogram, items.size()))
+        {
+            continue;
+        }
+
+        // counts to the first position of every digit value
+        std::uint32_t offset = 0;
+        for (auto& count : histogram)
+        {
+            offset += std::exchange(count, offset);
+        }
+
+        for (const auto& item : source)
+        {
+            destination[histogram[digit_of(item, digit, order)]++] = item;
+        }
+        std::swap(source, destination);
+    }
+
+    if (source.data() != items.data())
+    {
+        std::ranges::copy(source, items.begin());
+    }
+}
+
+void radix_sort(JobSystem& job_system,
+                std::span<SortItem> items,
+                std::span<SortItem> scratch,
+                const SortOrder order)
+{
+    check_scratch(items, scratch);
+
+    const auto blockCount =
+        std::min<std::size_t>(job_system.worker_count() + 1, std::max<std::size_t>(items.size() / min_block_size, 1));
+    if (blockCount == 1)
+    {
+        radix_sort(items, scratch, order);
+        return;
+    }
+    const auto blockSize = (items.size() + blockCount - 1) / blockCount;
+    const auto forEachBlock = [&](const std::function<void(std::size_t, std::size_t, std::size_t)>& body)
+    {
+        job_system.parallel_for(blockCount,
+                                1,
+                                [&](const std::size_t first, const std::size_t last)
+                                {
+                                    for (auto block = first; block < last; ++block)
+                                    {
+                                        const auto begin = block * blockSize;
+                                        body(block, begin, std::min(begin + blockSize, items.size()));
+                                    }
+                                });
+    };
+
+    // all digits of every block in one pass, summed up to find uniform digits
+    const auto digitCount = digit_count(order);
+    std::vector<std::array<Histogram, max_digit_count>> initialHistograms(blockCount);
+    forEachBlock(
+        [&](const std::size_t block, const std::size_t begin, const std::size_t end)
+        {
+            auto& histograms = initialHistograms[block];
+            for (const auto& item : items.subspan(begin, end - begin))
+            {
+                for (std::size_t digit = 0; digit < digitCount; ++digit)
+                {
+                    ++histograms[digit][digit_of(item, digit, order)];
+                }
+            }
+        });
+
+    auto source = items;
+    auto destination = scratch.first(items.size());
+    auto firstPass = true;
+    std::vector<Histogram> offsets(blockCount);
+    for (std::size_t digit = 0; digit < digitCount; ++digit)
+    {
+        Histogram total{};
+        for (const auto& histograms : initialHistograms)
+        {
+            std::ranges::transform(total, histograms[digit], total.begin(), std::plus{});
+        }
+        if (is_uniform(total, items.size()))
+        {
+            continue;
+        }
+
+        // the block histograms of later digits change with the order of the items
+        if (firstPass)
+        {
+            for (std::size_t block = 0; block < blockCount; ++block)
+            {
+                offsets[block] = initialHistograms[block][digit];
+            }
+        }
+        else
+        {
+            forEachBlock(
+                [&](const std::size_t block, const std::size_t begin, const std::size_t end)
+                {
+                    auto& histogram = offsets[block];
+                    histogram.fill(0);
+                    for (const auto& item : source.subspan(begin, end - begin))
+                    {
+                        ++histogram[digit_of(item, digit, order)];
+                    }
+                });
+        }
+        firstPass = false;
+
+        // a block writes each digit value after the same value of the blocks before it
+        std::uint32_t offset = 0;
+        for (std::size_t value = 0; value < digit_values; ++value)
+        {
+            for (auto& histogram : offsets)
+            {
+                offset += std::exchange(histogram[value], offset);
+            }
+        }
+
+        forEachBlock(
+            [&](const std::size_t block, const std::size_t begin, const std::size_t end)
+            {
+                auto& histogram = offsets[block];
+                for (const auto& item : source.subspan(begin, end - begin))
+                {
+                    destination[histogram[digit_of(item, digit, order)]++] = item;
+                }
+            });
+        std::swap(source, destination);
+    }
+
+    if (source.data() != items.data())
+    {
+        job_system.parallel_for(items.size(),
+                                blockSize,
+                                [&](const std::size_t begin, const std::size_t end)
+                                { std::ranges::copy(source.subspan(begin, end - begin), items.begin() + begin); });
+    }
+}
+} // namespace vultex
@@ -0,0 +1,39 @@
+#pragma once
+
+#include <cstdint>
+#include <span>
+
+#include "job_system.hpp"
+
+namespace vultex
+{
+
+struct SortItem
+{
+    std::uint64_t key;
+    std::uint32_t value;
+};
+
+enum class SortOrder : std::uint8_t
+{
+    // equal keys keep their order
+    key,
+    // equal keys by value, the value digits are sorted before the key digits
+    key_value
+};
+
+// Stable LSD radix sort by key with 8 bit digits. The histograms of all
+// digits are counted in one pass, a digit that is the same in every key
+// costs nothing, so keys using only a few of their bits sort in few passes.
+// scratch needs room for items.size() elements, its content is undefined
+// afterwards.
+void radix_sort(std::span<SortItem> items, std::span<SortItem> scratch, SortOrder order = SortOrder::key);
+
+// Same result as above, every pass counts and scatters contiguous blocks of
+// the items on all workers. Falls back to the single threaded sort for few
+// items.
+void radix_sort(JobSystem& job_system,
+                std::span<SortItem> items,
+                std::span<SortItem> scratch,
+                SortOrder order = SortOrder::key);
+} // namespace vultex
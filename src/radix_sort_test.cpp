@@ -0,0 +1,151 @@
+#include "radix_sort.hpp"
+
+#include <algorithm>
+#include <cstdint>
+#include <gtest/gtest.h>
+#include <random>
+#include <stdexcept>
+#include <vector>
+
+namespace vultex
+{
+namespace
+{
+// values are the input positions, so equal keys show whether the sort is stable
+std::vector<SortItem> random_items(const std::size_t count, const std::uint64_t key_mask, const unsigned seed)
+{
+    std::mt19937_64 random{seed};
+    std::vector<SortItem> items(count);
+    for (std::size_t index = 0; index < count; ++index)
+    {
+        items[index] = SortItem{.key = random() & key_mask, .value = static_cast<std::uint32_t>(index)};
+    }
+    return items;
+}
+
+std::vector<SortItem> stable_sorted(std::vector<SortItem> items)
+{
+    std::ranges::stable_sort(items, {}, &SortItem::key);
+    return items;
+}
+
+void expect_same_items(const std::vector<SortItem>& actual, const std::vector<SortItem>& expected)
+{
+    ASSERT_EQ(actual.size(), expected.size());
+    for (std::size_t index = 0; index < actual.size(); ++index)
+    {
+        ASSERT_EQ(actual[index].key, expected[index].key) << index;
+        ASSERT_EQ(actual[index].value, expected[index].value) << index;
+    }
+}
+
+// full 64 bit keys, draw keys using a few of their bits and keys with many duplicates
+const std::vector<std::uint64_t> key_masks{~std::uint64_t{0}, 0xFFFF'00FF'0000'0FFFULL, 0x7ULL, 0x0ULL};
+
+TEST(RadixSort, MatchesStableSort)
+{
+    for (const auto count : {std::size_t{0}, std::size_t{1}, std::size_t{2}, std::size_t{255}, std::size_t{10000}})
+    {
+        for (const auto mask : key_masks)
+        {
+            auto items = random_items(count, mask, 5);
+            const auto expected = stable_sorted(items);
+            std::vector<SortItem> scratch(count);
+            radix_sort(items, scratch);
+            expect_same_items(items, expected);
+        }
+    }
+}
+
+TEST(RadixSort, ParallelMatchesStableSort)
+{
+    // enough items for several blocks, and few enough for the single threaded fallback
+    JobSystem jobSystem{4};
+    for (const auto count : {std::size_t{1000}, std::size_t{300001}})
+    {
+        for (const auto mask : key_masks)
+        {
+            auto items = random_items(count, mask, 9);
+            const auto expected = stable_sorted(items);
+            std::vector<SortItem> scratch(count);
+            radix_sort(jobSystem, items, scratch);
+            expect_same_items(items, expected);
+        }
+    }
+}
+
+TEST(RadixSort, ParallelMatchesSerial)
+{
+    JobSystem jobSystem{3};
+    auto serial = random_items(500000, 0xFF00'0000'FFFF'FFFFULL, 13);
+    auto parallel = serial;
+    std::vector<SortItem> scratch(serial.size());
+    radix_sort(serial, scratch);
+    radix_sort(jobSystem, parallel, scratch);
+    expect_same_items(parallel, serial);
+}
+
+// values in random order, equal keys have to end up ordered by them
+std::vector<SortItem> shuffled_values(const std::size_t count, const std::uint64_t key_mask, const unsigned seed)
+{
+    auto items = random_items(count, key_mask, seed);
+    std::mt19937 random{seed};
+    std::vector<std::uint32_t> values(count);
+    for (std::size_t index = 0; index < count; ++index)
+    {
+        values[index] = static_cast<std::uint32_t>(index * 2654435761U);
+    }
+    std::ranges::shuffle(values, random);
+    for (std::size_t index = 0; index < count; ++index)
+    {
+        items[index].value = values[index];
+    }
+    return items;
+}
+
+std::vector<SortItem> sorted_by_key_value(std::vector<SortItem> items)
+{
+    std::ranges::sort(items,
+                      [](const SortItem& left, const SortItem& right)
+                      { return left.key != right.key ? left.key < right.key : left.value < right.value; });
+    return items;
+}
+
+TEST(RadixSort, KeyValueOrdersEqualKeysByValue)
+{
+    JobSystem jobSystem{4};
+    for (const auto count : {std::size_t{0}, std::size_t{1}, std::size_t{10000}, std::size_t{300001}})
+    {
+        for (const auto mask : key_masks)
+        {
+            auto serial = shuffled_values(count, mask, 23);
+            auto parallel = serial;
+            const auto expected = sorted_by_key_value(serial);
+            std::vector<SortItem> scratch(count);
+            radix_sort(serial, scratch, SortOrder::key_value);
+            expect_same_items(serial, expected);
+            radix_sort(jobSystem, parallel, scratch, SortOrder::key_value);
+            expect_same_items(parallel, expected);
+        }
+    }
+}
+
+TEST(RadixSort, LargerScratchIsFine)
+{
+    auto items = random_items(100, ~std::uint64_t{0}, 17);
+    const auto expected = stable_sorted(items);
+    std::vector<SortItem> scratch(1000);
+    radix_sort(items, scratch);
+    expect_same_items(items, expected);
+}
+
+TEST(RadixSort, SmallScratchThrows)
+{
+    auto items = random_items(100, ~std::uint64_t{0}, 19);
+    std::vector<SortItem> scratch(99);
+    JobSystem jobSystem{2};
+    EXPECT_THROW(radix_sort(items, scratch), std::invalid_argument);
+    EXPECT_THROW(radix_sort(jobSystem, items, scratch), std::invalid_argument);
+}
+} // namespace
+} // namespace vultex
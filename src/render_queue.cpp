@@ -0,0 +1,86 @@
+#include "render_queue.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+namespace vultex
+{
+namespace
+{
+constexpr std::uint32_t depth_bits = 24;
+constexpr std::uint32_t max_depth = (1U << depth_bits) - 1;
+} // namespace
+
+std::uint64_t RenderKey::pack() const
+{
+    const auto quantizedDepth =
+        static_cast<std::uint64_t>(std::lround(std::clamp(depth, 0.0F, 1.0F) * static_cast<float>(max_depth)));
+    return (static_cast<std::uint64_t>(layer) << 56U) | (static_cast<std::uint64_t>(pipeline) << 40U) |
+           (static_cast<std::uint64_t>(material) << depth_bits) | quantizedDepth;
+}
+
+RenderQueue::RenderQueue(JobSystem& job_system) : job_system{job_system}, buckets(job_system.worker_count() + 1)
+{
+}
+
+void RenderQueue::push(const RenderKey& key, const std::uint32_t value)
+{
+    push(key.pack(), value);
+}
+
+void RenderQueue::push(const std::uint64_t key, const std::uint32_t value)
+{
+    const auto thread = job_system.current_thread_index();
+    if (thread >= buckets.size())
+    {
+        throw std::out_of_range("Render queue bucket index out of range!");
+    }
+    if (0 != thread)
+    {
+        buckets[thread].items.push_back(SortItem{.key = key, .value = value});
+        return;
+    }
+
+    const std::scoped_lock lock{external_mutex};
+    buckets.front().items.push_back(SortItem{.key = key, .value = value});
+}
+
+void RenderQueue::clear()
+{
+    for (auto& bucket : buckets)
+    {
+        bucket.items.clear();
+    }
+    items.clear();
+}
+
+void RenderQueue::sort()
+{
+    std::vector<std::size_t> offsets(buckets.size() + 1, 0);
+    for (std::size_t bucket = 0; bucket < buckets.size(); ++bucket)
+    {
+        offsets[bucket + 1] = offsets[bucket] + buckets[bucket].items.size();
+    }
+    items.resize(offsets.back());
+    scratch.resize(items.size());
+
+    job_system.parallel_for(buckets.size(),
+                            1,
+                            [&](const std::size_t begin, const std::size_t end)
+                            {
+                                for (auto bucket = begin; bucket < end; ++bucket)
+                                {
+                                    std::ranges::copy(buckets[bucket].items, items.begin() + offsets[bucket]);
+                                }
+                            });
+    // which thread pushed an item decides its place among equal keys, sorting
+    // by the values too fixes it
+    radix_sort(job_system, items, scratch, SortOrder::key_value);
+}
+
+std::span<const SortItem> RenderQueue::sorted() const
+{
+    return items;
+}
+} // namespace vultex
@@ -0,0 +1,70 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <span>
+#include <vector>
+
+#include "job_system.hpp"
+#include "radix_sort.hpp"
+
+namespace vultex
+{
+
+// Sort order of a queued item, packed by pack() into 64 bits from the most
+// to the least significant: 8 bit layer, 16 bit pipeline, 16 bit material and
+// depth in [0, 1] quantized to 24 bits. Translucent layers pass 1 - depth to
+// sort back to front.
+struct RenderKey
+{
+    std::uint8_t layer;
+    std::uint16_t pipeline;
+    std::uint16_t material;
+    float depth;
+
+    [[nodiscard]] std::uint64_t pack() const;
+};
+
+// Items of a frame, pushed from any thread of the JobSystem into a bucket of
+// that thread and sorted together by sort(). Threads outside of the pool
+// share one bucket behind a mutex. Items with equal keys are
+// ordered by their value (SortOrder::key_value), so with unique values the
+// order does not depend on which thread pushed what.
+class RenderQueue
+{
+public:
+    explicit RenderQueue(JobSystem& job_system);
+    RenderQueue(const RenderQueue&) = delete;
+    RenderQueue(RenderQueue&&) = delete;
+    RenderQueue& operator=(const RenderQueue&) = delete;
+    RenderQueue& operator=(RenderQueue&&) = delete;
+    ~RenderQueue() = default;
+
+    // Safe from any thread, but not concurrently with clear() or sort()
+    void push(const RenderKey& key, std::uint32_t value);
+    void push(std::uint64_t key, std::uint32_t value);
+
+    void clear();
+
+    // Merges the buckets and sorts them on all workers
+    void sort();
+
+    // Items in order after sort(), the value of each is what was pushed with it
+    [[nodiscard]] std::span<const SortItem> sorted() const;
+
+private:
+    // a cache line each, so pushes of different threads do not share one
+    struct alignas(64) Bucket
+    {
+        std::vector<SortItem> items{};
+    };
+
+    JobSystem& job_system;
+    // bucket 0 is the one of the threads outside of the pool
+    std::mutex external_mutex{};
+    std::vector<Bucket> buckets{};
+    std::vector<SortItem> items{};
+    std::vector<SortItem> scratch{};
+};
+} // namespace vultex
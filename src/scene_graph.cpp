@@ -0,0 +1,208 @@
+#include "scene_graph.hpp"
+
+#include <algorithm>
+#include <stdexcept>
+#include <utility>
+
+#if defined(__SSE__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 1)
+#include <immintrin.h>
+#define VULTEX_SCENE_GRAPH_SSE 1
+#endif
+
+namespace vultex
+{
+namespace
+{
+// big enough to amortize a job, small enough to spread a level over all workers
+constexpr std::size_t batch_size = 2048;
+
+glm::mat4 compose(const glm::vec3& translation, const glm::quat& rotation, const glm::vec3& scale)
+{
+    auto matrix = glm::mat4_cast(rotation);
+    matrix[0] *= scale.x;
+    matrix[1] *= scale.y;
+    matrix[2] *= scale.z;
+    matrix[3] = glm::vec4{translation, 1.0F};
+    return matrix;
+}
+
+// Column j of the result is the parent's columns weighted by column j of
+// local, four lanes at a time. glm matrices are column major and packed.
+void multiply(const glm::mat4& parent, const glm::mat4& local, glm::mat4& result)
+{
+#ifdef VULTEX_SCENE_GRAPH_SSE
+    const auto column0 = _mm_loadu_ps(&parent[0][0]);
+    const auto column1 = _mm_loadu_ps(&parent[1][0]);
+    const auto column2 = _mm_loadu_ps(&parent[2][0]);
+    const auto column3 = _mm_loadu_ps(&parent[3][0]);
+    for (int column = 0; column < 4; ++column)
+    {
+        const auto* weights = &local[column][0];
+#ifdef __FMA__
+        auto sum = _mm_mul_ps(column0, _mm_set1_ps(weights[0]));
+        sum = _mm_fmadd_ps(column1, _mm_set1_ps(weights[1]), sum);
+        sum = _mm_fmadd_ps(column2, _mm_set1_ps(weights[2]), sum);
+        sum = _mm_fmadd_ps(column3, _mm_set1_ps(weights[3]), sum);
+#else
+        auto sum = _mm_mul_ps(column0, _mm_set1_ps(weights[0]));
+        sum = _mm_add_ps(sum, _mm_mul_ps(column1, _mm_set1_ps(weights[1])));
+        sum = _mm_add_ps(sum, _mm_mul_ps(column2, _mm_set1_ps(weights[2])));
+        sum = _mm_add_ps(sum, _mm_mul_ps(column3, _mm_set1_ps(weights[3])));
+#endif
+        _mm_storeu_ps(&result[column][0], sum);
+    }
+#else
+    result = parent * local;
+#endif
+}
+} // namespace
+
+NodeId SceneGraph::create_node(const LocalTransform& local, const std::optional<NodeId> parent)
+{
+    if (parent && *parent >= indices.size())
+    {
+        throw std::out_of_range("Parent of a scene graph node doesn't exist!");
+    }
+
+    const auto id = static_cast<NodeId>(indices.size());
+    const auto index = static_cast<std::uint32_t>(ids.size());
+    const auto parentIndex = parent ? indices[*parent] : no_parent;
+
+    translations.push_back(local.translation);
+    rotations.push_back(local.rotation);
+    scales.push_back(local.scale);
+    parents.push_back(parentIndex);
+    depths.push_back(parent ? depths[parentIndex] + 1 : 0);
+    ids.push_back(id);
+    world_transforms.emplace_back(1.0F);
+    indices.push_back(index);
+
+    structure_changed = true;
+    return id;
+}
+
+void SceneGraph::set_local(const NodeId node, const LocalTransform& local)
+{
+    const auto index = indices.at(node);
+    translations[index] = local.translation;
+    rotations[index] = local.rotation;
+    scales[index] = local.scale;
+}
+
+LocalTransform SceneGraph::local(const NodeId node) const
+{
+    const auto index = indices.at(node);
+    return LocalTransform{.translation = translations[index], .rotation = rotations[index], .scale = scales[index]};
+}
+
+void SceneGraph::update(JobSystem& job_system)
+{
+    if (structure_changed)
+    {
+        sort_by_depth();
+        structure_changed = false;
+    }
+
+    // a level only reads world matrices of the previous ones
+    for (std::size_t depth = 0; depth + 1 < depth_offsets.size(); ++depth)
+    {
+        const auto first = depth_offsets[depth];
+        const auto count = depth_offsets[depth + 1] - first;
+        job_system.parallel_for(count,
+                                batch_size,
+                                [this, first](const std::size_t begin, const std::size_t end)
+                                {
+                                    for (auto index = first + begin; index < first + end; ++index)
+                                    {
+                                        const auto local =
+                                            compose(translations[index], rotations[index], scales[index]);
+                                        if (no_parent == parents[index])
+                                        {
+                                            world_transforms[index] = local;
+                                        }
+                                        else
+                                        {
+                                            multiply(world_transforms[parents[index]], local, world_transforms[index]);
+                                        }
+                                    }
+                                });
+    }
+}
+
+const glm::mat4& SceneGraph::world(const NodeId node) const
+{
+    return world_transforms[indices.at(node)];
+}
+
+const std::vector<glm::mat4>& SceneGraph::world_matrices() const
+{
+    return world_transforms;
+}
+
+std::uint32_t SceneGraph::index_of(const NodeId node) const
+{
+    return indices.at(node);
+}
+
+std::size_t SceneGraph::size() const
+{
+    return ids.size();
+}
+
+std::size_t SceneGraph::depth_count() const
+{
+    return depth_offsets.empty() ? 0 : depth_offsets.size() - 1;
+}
+
+// Stable counting sort by depth, O(n) and only after nodes were added.
+// A parent keeps its place before its children since its depth is smaller.
+void SceneGraph::sort_by_depth()
+{
+    const auto count = ids.size();
+    const auto maxDepth = count == 0 ? 0 : *std::ranges::max_element(depths);
+
+    depth_offsets.assign(maxDepth + 2, 0);
+    for (const auto depth : depths)
+    {
+        ++depth_offsets[depth + 1];
+    }
+    for (std::size_t depth = 1; depth < depth_offsets.size(); ++depth)
+    {
+        depth_offsets[depth] += depth_offsets[depth - 1];
+    }
+
+    std::vector<std::uint32_t> newIndices(count);
+    auto cursors = depth_offsets;
+    for (std::size_t index = 0; index < count; ++index)
+    {
+        newIndices[index] = cursors[depths[index]]++;
+    }
+
+    const auto permute = [&newIndices](auto& values)
+    {
+        auto sortedValues = values;
+        for (std::size_t index = 0; index < newIndices.size(); ++index)
+        {
+            sortedValues[newIndices[index]] = values[index];
+        }
+        values = std::move(sortedValues);
+    };
+    permute(translations);
+    permute(rotations);
+    permute(scales);
+    permute(depths);
+    permute(ids);
+    permute(world_transforms);
+
+    for (auto& parent : parents)
+    {
+        parent = no_parent == parent ? no_parent : newIndices[parent];
+    }
+    permute(parents);
+
+    for (std::size_t index = 0; index < count; ++index)
+    {
+        indices[ids[index]] = static_cast<std::uint32_t>(index);
+    }
+}
+} // namespace vultex
@@ -0,0 +1,73 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <glm/glm.hpp>
+#include <glm/gtc/quaternion.hpp>
+#include <optional>
+#include <vector>
+
+#include "job_system.hpp"
+
+namespace vultex
+{
+
+using NodeId = std::uint32_t;
+
+struct LocalTransform
+{
+    glm::vec3 translation{0.0F};
+    glm::quat rotation{1.0F, 0.0F, 0.0F, 0.0F};
+    glm::vec3 scale{1.0F};
+};
+
+// Transform hierarchy stored as structure of arrays. Nodes are kept sorted by
+// depth, so a parent is always stored before its children and every depth
+// level is a contiguous range. update() walks the levels in order, inside a
+// level nodes are independent and run in batches on the job system with SSE
+// matrix products, without chasing a pointer per node.
+//
+// NodeIds stay valid while the arrays are reordered by depth. Not thread safe,
+// update() is the only call which uses other threads.
+class SceneGraph
+{
+public:
+    // parent has to exist, nodes without one are roots
+    NodeId create_node(const LocalTransform& local, std::optional<NodeId> parent = std::nullopt);
+    void set_local(NodeId node, const LocalTransform& local);
+    [[nodiscard]] LocalTransform local(NodeId node) const;
+
+    // recomputes local and world matrices of every node
+    void update(JobSystem& job_system);
+
+    // result of the last update()
+    [[nodiscard]] const glm::mat4& world(NodeId node) const;
+    // all world matrices in depth order, see index_of
+    [[nodiscard]] const std::vector<glm::mat4>& world_matrices() const;
+    [[nodiscard]] std::uint32_t index_of(NodeId node) const;
+
+    [[nodiscard]] std::size_t size() const;
+    [[nodiscard]] std::size_t depth_count() const;
+
+private:
+    static constexpr std::uint32_t no_parent = ~0U;
+
+    void sort_by_depth();
+
+    // indexed by position in depth order
+    std::vector<glm::vec3> translations{};
+    std::vector<glm::quat> rotations{};
+    std::vector<glm::vec3> scales{};
+    std::vector<std::uint32_t> parents{};
+    std::vector<std::uint32_t> depths{};
+    std::vector<NodeId> ids{};
+    std::vector<glm::mat4> world_transforms{};
+
+    // first index of every depth, plus the end
+    std::vector<std::uint32_t> depth_offsets{};
+    // indexed by NodeId
+    std::vector<std::uint32_t> indices{};
+    // new nodes are appended, the order is restored by the next update()
+    bool structure_changed{false};
+};
+} // namespace vultex
@@ -0,0 +1,141 @@
+#include "scene_graph.hpp"
+
+#include <cstdint>
+#include <gtest/gtest.h>
+#include <random>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+#include "job_system.hpp"
+
+namespace vultex
+{
+namespace
+{
+void expect_near(const glm::vec4& actual, const glm::vec4& expected)
+{
+    for (int component = 0; component < 4; ++component)
+    {
+        EXPECT_NEAR(actual[component], expected[component], 1e-5F) << "component " << component;
+    }
+}
+
+glm::quat quarter_turn_z()
+{
+    return glm::angleAxis(glm::radians(90.0F), glm::vec3{0.0F, 0.0F, 1.0F});
+}
+
+TEST(SceneGraph, LocalMatrixScalesThenRotatesThenTranslates)
+{
+    JobSystem jobSystem{0};
+    SceneGraph graph{};
+    const auto node = graph.create_node(LocalTransform{.translation = glm::vec3{1.0F, 2.0F, 3.0F},
+                                                       .rotation = quarter_turn_z(),
+                                                       .scale = glm::vec3{2.0F, 3.0F, 4.0F}});
+    graph.update(jobSystem);
+
+    const auto& world = graph.world(node);
+    expect_near(world[0], glm::vec4{0.0F, 2.0F, 0.0F, 0.0F});
+    expect_near(world[1], glm::vec4{-3.0F, 0.0F, 0.0F, 0.0F});
+    expect_near(world[2], glm::vec4{0.0F, 0.0F, 4.0F, 0.0F});
+    expect_near(world[3], glm::vec4{1.0F, 2.0F, 3.0F, 1.0F});
+}
+
+TEST(SceneGraph, ChildWorldIsParentWorldTimesLocal)
+{
+    JobSystem jobSystem{0};
+    SceneGraph graph{};
+    const auto root = graph.create_node(LocalTransform{
+        .translation = glm::vec3{10.0F, 0.0F, 0.0F}, .rotation = quarter_turn_z(), .scale = glm::vec3{2.0F}});
+    const auto child = graph.create_node(LocalTransform{.translation = glm::vec3{1.0F, 0.0F, 0.0F}}, root);
+    const auto grandchild = graph.create_node(LocalTransform{.translation = glm::vec3{0.0F, 1.0F, 0.0F}}, child);
+    graph.update(jobSystem);
+
+    // the child's offset is scaled and rotated by the parent, then moved with it
+    expect_near(graph.world(child)[3], glm::vec4{10.0F, 2.0F, 0.0F, 1.0F});
+    expect_near(graph.world(child)[0], glm::vec4{0.0F, 2.0F, 0.0F, 0.0F});
+    expect_near(graph.world(grandchild)[3], glm::vec4{8.0F, 2.0F, 0.0F, 1.0F});
+}
+
+TEST(SceneGraph, SetLocalTakesEffectOnTheNextUpdate)
+{
+    JobSystem jobSystem{0};
+    SceneGraph graph{};
+    const auto root = graph.create_node(LocalTransform{});
+    const auto child = graph.create_node(LocalTransform{.translation = glm::vec3{0.0F, 1.0F, 0.0F}}, root);
+    graph.update(jobSystem);
+
+    graph.set_local(root, LocalTransform{.translation = glm::vec3{5.0F, 0.0F, 0.0F}});
+    expect_near(graph.world(child)[3], glm::vec4{0.0F, 1.0F, 0.0F, 1.0F});
+    graph.update(jobSystem);
+    expect_near(graph.world(child)[3], glm::vec4{5.0F, 1.0F, 0.0F, 1.0F});
+    EXPECT_EQ(graph.local(root).translation, (glm::vec3{5.0F, 0.0F, 0.0F}));
+}
+
+TEST(SceneGraph, NodesAddedLaterAreSortedByDepth)
+{
+    JobSystem jobSystem{0};
+    SceneGraph graph{};
+    std::vector<std::pair<NodeId, NodeId>> edges{};
+    const auto first = graph.create_node(LocalTransform{});
+    const auto child = graph.create_node(LocalTransform{}, first);
+    edges.emplace_back(first, child);
+    graph.update(jobSystem);
+
+    const auto second = graph.create_node(LocalTransform{.translation = glm::vec3{0.0F, 0.0F, 7.0F}});
+    const auto grandchild = graph.create_node(LocalTransform{.translation = glm::vec3{1.0F, 0.0F, 0.0F}}, child);
+    const auto secondChild = graph.create_node(LocalTransform{.translation = glm::vec3{1.0F, 0.0F, 0.0F}}, second);
+    edges.emplace_back(child, grandchild);
+    edges.emplace_back(second, secondChild);
+    graph.update(jobSystem);
+
+    EXPECT_EQ(graph.size(), 5U);
+    EXPECT_EQ(graph.depth_count(), 3U);
+    for (const auto& [parent, node] : edges)
+    {
+        EXPECT_LT(graph.index_of(parent), graph.index_of(node));
+    }
+    for (const auto node : {first, child, second, grandchild, secondChild})
+    {
+        EXPECT_EQ(graph.world_matrices()[graph.index_of(node)], graph.world(node));
+    }
+    expect_near(graph.world(grandchild)[3], glm::vec4{1.0F, 0.0F, 0.0F, 1.0F});
+    expect_near(graph.world(secondChild)[3], glm::vec4{1.0F, 0.0F, 7.0F, 1.0F});
+}
+
+TEST(SceneGraph, ParallelUpdateMatchesSerialUpdate)
+{
+    // a random forest, wide enough that every level spans several batches
+    std::mt19937 random{42};
+    std::uniform_real_distribution<float> offset{-1.0F, 1.0F};
+    SceneGraph serial{};
+    SceneGraph parallel{};
+    for (std::uint32_t node = 0; node < 20000; ++node)
+    {
+        const LocalTransform local{.translation = glm::vec3{offset(random), offset(random), offset(random)},
+                                   .rotation = glm::angleAxis(offset(random), glm::vec3{0.0F, 1.0F, 0.0F}),
+                                   .scale = glm::vec3{1.0F + 0.1F * offset(random)}};
+        std::optional<NodeId> parent{};
+        if (node >= 100)
+        {
+            parent = std::uniform_int_distribution<NodeId>{0, node - 1}(random);
+        }
+        EXPECT_EQ(serial.create_node(local, parent), parallel.create_node(local, parent));
+    }
+
+    JobSystem serialJobs{0};
+    JobSystem parallelJobs{4};
+    serial.update(serialJobs);
+    parallel.update(parallelJobs);
+    EXPECT_EQ(serial.world_matrices(), parallel.world_matrices());
+}
+
+TEST(SceneGraph, MissingParentThrows)
+{
+    SceneGraph graph{};
+    const auto root = graph.create_node(LocalTransform{});
+    EXPECT_THROW(static_cast<void>(graph.create_node(LocalTransform{}, root + 1)), std::out_of_range);
+}
+} // namespace
+} // namespace vultex
@@ -0,0 +1,285 @@
+#include "shader_module_cache.hpp"
+
+#include <cstring>
+#include <fmt/format.h>
+#include <fstream>
+#include <iterator>
+#include <span>
+#include <spdlog/spdlog.h>
+#include <stdexcept>
+
+#ifdef VULTEX_HAS_SHADERC
+#include <shaderc/shaderc.hpp>
+#endif
+
+#include "hash.hpp"
+#include "host_allocator.hpp"
+
+namespace vultex
+{
+namespace
+{
+std::string read_text(const std::filesystem::path& path)
+{
+    std::ifstream file{path, std::ios::binary};
+    if (!file)
+    {
+        throw std::runtime_error(fmt::format("Cannot open shader: {}", path.string()));
+    }
+    return {std::istreambuf_iterator<char>{file}, std::istreambuf_iterator<char>{}};
+}
+
+std::vector<std::uint32_t> read_spirv(const std::filesystem::path& path)
+{
+    const auto bytes = read_text(path);
+    if (bytes.empty() || 0 != bytes.size() % sizeof(std::uint32_t))
+    {
+        throw std::runtime_error(fmt::format("Invalid SPIR-V file: {}", path.string()));
+    }
+
+    std::vector<std::uint32_t> spirv(bytes.size() / sizeof(std::uint32_t));
+    std::memcpy(spirv.data(), bytes.data(), bytes.size());
+    return spirv;
+}
+
+void write_spirv(const std::filesystem::path& path, const std::vector<std::uint32_t>& spirv)
+{
+    std::error_code error{};
+    std::filesystem::create_directories(path.parent_path(), error);
+
+    std::ofstream file{path, std::ios::binary | std::ios::trunc};
+    file.write(reinterpret_cast<const char*>(spirv.data()),
+               static_cast<std::streamsize>(spirv.size() * sizeof(std::uint32_t)));
+    if (!file)
+    {
+        spdlog::warn("Cannot store shader in cache: {}", path.string());
+    }
+}
+
+std::uint64_t hash_spirv(const std::vector<std::uint32_t>& spirv)
+{
+    return fnv1a(std::as_bytes(std::span{spirv}));
+}
+
+std::uint64_t hash_request(const std::string& text,
+                           const VkShaderStageFlagBits stage,
+                           const std::vector<std::string>& defines)
+{
+    auto hash = fnv1a(text);
+    hash = fnv1a(fmt::format("stage:{}", static_cast<std::uint32_t>(stage)), hash);
+    for (const auto& define : defines)
+    {
+        hash = fnv1a(fmt::format("define:{}", define), hash);
+    }
+    return hash;
+}
+
+#ifdef VULTEX_HAS_SHADERC
+shaderc_shader_kind to_shader_kind(const VkShaderStageFlagBits stage)
+{
+    switch (stage)
+    {
+    case VK_SHADER_STAGE_VERTEX_BIT:
+        return shaderc_vertex_shader;
+    case VK_SHADER_STAGE_FRAGMENT_BIT:
+        return shaderc_fragment_shader;
+    case VK_SHADER_STAGE_GEOMETRY_BIT:
+        return shaderc_geometry_shader;
+    case VK_SHADER_STAGE_COMPUTE_BIT:
+        return shaderc_compute_shader;
+    default:
+        throw std::runtime_error(fmt::format("Unsupported shader stage: {}", static_cast<std::uint32_t>(stage)));
+    }
+}
+#endif
+
+// only the path is used without shaderc
+std::vector<std::uint32_t> compile(const std::filesystem::path& path,
+                                   [[maybe_unused]] const std::string& text,
+                                   [[maybe_unused]] const VkShaderStageFlagBits stage,
+                                   [[maybe_unused]] const std::vector<std::string>& defines)
+{
+#ifdef VULTEX_HAS_SHADERC
+    shaderc::CompileOptions options{};
+    options.SetTargetEnvironment(shaderc_target_env_vulkan, shaderc_env_version_vulkan_1_2);
+    options.SetOptimizationLevel(shaderc_optimization_level_performance);
+    if (path.extension() == ".hlsl")
+    {
+        options.SetSourceLanguage(shaderc_source_language_hlsl);
+    }
+    for (const auto& define : defines)
+    {
+        // NAME or NAME=VALUE
+        const auto separator = define.find('=');
+        if (separator == std::string::npos)
+        {
+            options.AddMacroDefinition(define);
+        }
+        else
+        {
+            options.AddMacroDefinition(define.substr(0, separator), define.substr(separator + 1));
+        }
+    }
+
+    const shaderc::Compiler compiler{};
+    const auto result = compiler.CompileGlslToSpv(text, to_shader_kind(stage), path.string().c_str(), options);
+    if (shaderc_compilation_status_success != result.GetCompilationStatus())
+    {
+        throw std::runtime_error(fmt::format("Cannot compile shader {}:\n{}", path.string(), result.GetErrorMessage()));
+    }
+    return {result.cbegin(), result.cend()};
+#else
+    throw std::runtime_error(
+        fmt::format("Cannot compile shader {}, vultex was built without shaderc", path.string()));
+#endif
+}
+} // namespace
+
+ShaderModuleCache::ShaderModuleCache(VkDevice logical_device, std::filesystem::path cache_directory)
+    : logical_device{logical_device}, cache_directory{std::move(cache_directory)}
+{
+}
+
+ShaderModuleCache::~ShaderModuleCache()
+{
+    for (const auto& [hash, module] : modules)
+    {
+        vkDestroyShaderModule(logical_device, module.handle, allocation_callbacks());
+    }
+}
+
+VkShaderModule ShaderModuleCache::load(const std::filesystem::path& source,
+                                       const VkShaderStageFlagBits stage,
+                                       const std::vector<std::string>& defines)
+{
+    std::error_code error{};
+    Request request{.source = std::filesystem::weakly_canonical(source, error),
+                    .stage = stage,
+                    .defines = defines,
+                    .spirv_hash = 0};
+
+    const auto key = hash_request(request.source.string(), stage, defines);
+    if (const auto it = requests.find(key); it != requests.end())
+    {
+        return modules.at(it->second.spirv_hash).handle;
+    }
+
+    request.spirv_hash = acquire_module(get_spirv(request));
+    watcher.watch(request.source);
+
+    const auto spirv_hash = request.spirv_hash;
+    requests.emplace(key, std::move(request));
+    return modules.at(spirv_hash).handle;
+}
+
+void ShaderModuleCache::on_reload(VkShaderModule module, ReloadCallback callback)
+{
+    for (const auto& [key, request] : requests)
+    {
+        if (modules.at(request.spirv_hash).handle == module)
+        {
+            reload_callbacks.emplace(key, callback);
+        }
+    }
+}
+
+void ShaderModuleCache::process_file_changes()
+{
+    for (const auto& changed : watcher.poll())
+    {
+        spdlog::info("Shader source changed: {}", changed.string());
+
+        for (auto& [key, request] : requests)
+        {
+            if (request.source != changed)
+            {
+                continue;
+            }
+
+            std::uint64_t spirv_hash{0};
+            try
+            {
+                spirv_hash = acquire_module(get_spirv(request));
+            }
+            catch (const std::exception& e)
+            {
+                // keep the previous module, the source is probably being edited
+                spdlog::error("{}", e.what());
+                continue;
+            }
+
+            if (spirv_hash == request.spirv_hash)
+            {
+                release_module(spirv_hash);
+                continue;
+            }
+
+            const auto [first, last] = reload_callbacks.equal_range(key);
+            for (auto it = first; it != last; ++it)
+            {
+                it->second(modules.at(spirv_hash).handle);
+            }
+
+            // pipelines are already recreated so the old module is not referenced
+            release_module(request.spirv_hash);
+            request.spirv_hash = spirv_hash;
+        }
+    }
+}
+
+std::vector<std::uint32_t> ShaderModuleCache::get_spirv(const Request& request) const
+{
+    if (request.source.extension() == ".spv")
+    {
+        return read_spirv(request.source);
+    }
+
+    const auto text = read_text(request.source);
+    const auto key = hash_request(text, request.stage, request.defines);
+    const auto cached = cache_directory / fmt::format("{:016x}.spv", key);
+    if (std::filesystem::exists(cached))
+    {
+        return read_spirv(cached);
+    }
+
+    spdlog::info("Compile shader: {}", request.source.string());
+    auto spirv = compile(request.source, text, request.stage, request.defines);
+    write_spirv(cached, spirv);
+    return spirv;
+}
+
+std::uint64_t ShaderModuleCache::acquire_module(const std::vector<std::uint32_t>& spirv)
+{
+    const auto spirv_hash = hash_spirv(spirv);
+    if (auto it = modules.find(spirv_hash); it != modules.end())
+    {
+        ++it->second.references;
+        return spirv_hash;
+    }
+
+    const VkShaderModuleCreateInfo createInfo{.sType = VK_STRUCTURE_TYPE_SHADER_MODULE_CREATE_INFO,
+                                              .codeSize = spirv.size() * sizeof(std::uint32_t),
+                                              .pCode = spirv.data()};
+
+    VkShaderModule module{nullptr};
+    if (VK_SUCCESS != vkCreateShaderModule(logical_device, &createInfo, allocation_callbacks(), &module))
+    {
+        throw std::runtime_error("Failed to create shader module!");
+    }
+
+    modules.emplace(spirv_hash, Module{.handle = module, .references = 1});
+    return spirv_hash;
+}
+
+void ShaderModuleCache::release_module(const std::uint64_t spirv_hash)
+{
+    auto it = modules.find(spirv_hash);
+    if (it == modules.end() || 0 != --it->second.references)
+    {
+        return;
+    }
+
+    vkDestroyShaderModule(logical_device, it->second.handle, allocation_callbacks());
+    modules.erase(it);
+}
+} // namespace vultex
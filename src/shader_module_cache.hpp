@@ -0,0 +1,74 @@
+#pragma once
+
+#define GLFW_INCLUDE_VULKAN
+#include <GLFW/glfw3.h>
+
+#include <cstdint>
+#include <filesystem>
+#include <functional>
+#include <map>
+#include <string>
+#include <vector>
+
+#include "file_watcher.hpp"
+
+namespace vultex
+{
+
+// Owns every VkShaderModule of the application.
+//  - GLSL / HLSL sources are compiled to SPIR-V with shaderc, results are
+//    stored on disk under a hash of the source, stage and defines
+//  - modules with identical SPIR-V are created only once
+//  - changed sources are recompiled and only pipelines registered for them
+//    through on_reload are rebuilt
+// #include directives are not tracked, only the main source file is watched
+class ShaderModuleCache
+{
+public:
+    using ReloadCallback = std::function<void(VkShaderModule)>;
+
+    ShaderModuleCache(VkDevice logical_device, std::filesystem::path cache_directory);
+    ShaderModuleCache(const ShaderModuleCache&) = delete;
+    ShaderModuleCache(ShaderModuleCache&&) = delete;
+    ShaderModuleCache& operator=(const ShaderModuleCache&) = delete;
+    ShaderModuleCache& operator=(ShaderModuleCache&&) = delete;
+    ~ShaderModuleCache();
+
+    // *.spv files are loaded as they are, other files are compiled
+    [[nodiscard]] VkShaderModule load(const std::filesystem::path& source,
+                                      VkShaderStageFlagBits stage,
+                                      const std::vector<std::string>& defines = {});
+
+    // callback receives the new module when a source of the module changes
+    void on_reload(VkShaderModule module, ReloadCallback callback);
+
+    // call once per frame, outside of command recording
+    void process_file_changes();
+
+private:
+    struct Request
+    {
+        std::filesystem::path source;
+        VkShaderStageFlagBits stage;
+        std::vector<std::string> defines;
+        std::uint64_t spirv_hash;
+    };
+
+    struct Module
+    {
+        VkShaderModule handle;
+        std::uint32_t references;
+    };
+
+    [[nodiscard]] std::vector<std::uint32_t> get_spirv(const Request& request) const;
+    [[nodiscard]] std::uint64_t acquire_module(const std::vector<std::uint32_t>& spirv);
+    void release_module(std::uint64_t spirv_hash);
+
+    VkDevice logical_device{nullptr};
+    std::filesystem::path cache_directory;
+    FileWatcher watcher{};
+    std::map<std::uint64_t, Request> requests{};
+    std::map<std::uint64_t, Module> modules{};
+    std::multimap<std::uint64_t, ReloadCallback> reload_callbacks{};
+};
+} // namespace vultex
@@ -0,0 +1,118 @@
+// Lights binned into froxels by ClusteredLighting (clustered_lighting.hpp).
+// A fragment shader defines CLUSTER_SET to the set it binds
+// ClusteredLighting::descriptor_set() to, includes this file and calls
+// clustered_point_lights(). The binning kernels define CLUSTER_BINNING.
+
+#ifndef CLUSTER_SET
+#define CLUSTER_SET 0
+#endif
+
+#ifdef CLUSTER_BINNING
+#define CLUSTER_LISTS
+#else
+#define CLUSTER_LISTS readonly
+#endif
+
+struct PointLight
+{
+    vec3 position;
+    float radius;
+    vec3 color;
+    float intensity;
+};
+
+layout(std430, set = CLUSTER_SET, binding = 0) readonly buffer ClusterLights
+{
+    PointLight lights[];
+};
+
+layout(std430, set = CLUSTER_SET, binding = 1) CLUSTER_LISTS buffer ClusterLightCounts
+{
+    uint cluster_light_counts[];
+};
+
+// first entry of every froxel in cluster_light_indices
+layout(std430, set = CLUSTER_SET, binding = 2) CLUSTER_LISTS buffer ClusterLightOffsets
+{
+    uint cluster_light_offsets[];
+};
+
+layout(std430, set = CLUSTER_SET, binding = 3) CLUSTER_LISTS buffer ClusterLightIndices
+{
+    uint cluster_light_indices[];
+};
+
+layout(std140, set = CLUSTER_SET, binding = 4) uniform ClusterParameters
+{
+    mat4 view;
+    mat4 inverse_projection;
+    uvec4 grid;   // tiles x, tiles y, depth slices, light count
+    vec4 depth;   // near, far, slice scale, slice bias
+    vec4 screen;  // tile width and height in pixels, target width and height
+    uvec4 limits; // light index capacity
+} cluster;
+
+#ifdef CLUSTER_BINNING
+// view space AABB of every froxel, written by cluster_bounds.comp
+struct FroxelBounds
+{
+    vec4 low;
+    vec4 high;
+};
+
+layout(std430, set = CLUSTER_SET, binding = 5) buffer ClusterBounds
+{
+    FroxelBounds bounds[];
+};
+#endif
+
+// froxel of a fragment, view_depth is the positive distance along the view direction
+uint cluster_index(const vec2 frag_coord, const float view_depth)
+{
+    const float slice = log(max(view_depth, cluster.depth.x)) * cluster.depth.z + cluster.depth.w;
+    const uint z = min(uint(max(slice, 0.0)), cluster.grid.z - 1u);
+    const uvec2 tile = min(uvec2(frag_coord / cluster.screen.xy), cluster.grid.xy - 1u);
+    return (z * cluster.grid.y + tile.y) * cluster.grid.x + tile.x;
+}
+
+// view space depth where a slice begins
+float cluster_slice_depth(const uint slice)
+{
+    return cluster.depth.x * pow(cluster.depth.y / cluster.depth.x, float(slice) / float(cluster.grid.z));
+}
+
+// windowed inverse square falloff, exactly zero at the radius lights are binned with
+float light_attenuation(const float light_distance, const float radius)
+{
+    const float ratio = light_distance / radius;
+    const float window = clamp(1.0 - ratio * ratio * ratio * ratio, 0.0, 1.0);
+    return window * window / (light_distance * light_distance + 1.0);
+}
+
+// diffuse light of one point light, position and normal in world space
+vec3 point_light(const PointLight light, const vec3 position, const vec3 normal)
+{
+    const vec3 toLight = light.position - position;
+    const float lightDistance = length(toLight);
+    const float lambert = max(dot(normal, toLight / max(lightDistance, 1e-4)), 0.0);
+    return light.color * (light.intensity * lambert * light_attenuation(lightDistance, light.radius));
+}
+
+#ifndef CLUSTER_BINNING
+// sum of the lights binned into the froxel of a fragment
+vec3 clustered_point_lights(const vec3 position, const vec3 normal, const vec2 frag_coord)
+{
+    const float viewDepth = -(cluster.view * vec4(position, 1.0)).z;
+    const uint index = cluster_index(frag_coord, viewDepth);
+    // froxels past the end of a full index list lose their lights
+    const uint offset = min(cluster_light_offsets[index], cluster.limits.x);
+    const uint count = min(cluster_light_counts[index], cluster.limits.x - offset);
+
+    vec3 light = vec3(0.0);
+    for (uint entry = 0u; entry < count; ++entry)
+    {
+        light += point_light(lights[cluster_light_indices[offset + entry]], position, normal);
+    }
+    return light;
+}
+#endif
@@ -0,0 +1,96 @@
+// Shared by the compute primitives, included first. Every kernel is built
+// twice: with VULTEX_SUBGROUPS a workgroup scans and reduces within subgroups
+// and combines one partial result per subgroup, without it only shared memory
+// is used. Subgroups are counted with gl_NumSubgroups and their partials
+// written by subgroupElect(), so a pipeline may get another subgroup size
+// than the device reports, or a last subgroup which is not full.
+
+#ifdef VULTEX_SUBGROUPS
+#extension GL_KHR_shader_subgroup_basic : require
+#extension GL_KHR_shader_subgroup_arithmetic : require
+#endif
+
+const uint WORKGROUP_SIZE = 256u;
+const uint ITEMS_PER_INVOCATION = 4u;
+const uint TILE_SIZE = WORKGROUP_SIZE * ITEMS_PER_INVOCATION;
+
+layout(local_size_x = 256) in;
+
+layout(push_constant) uniform Dispatch
+{
+    uint count;
+    uint shift;
+    uint pass_index;
+} dispatch;
+
+shared uint workgroup_partials[WORKGROUP_SIZE];
+
+// inclusive scan of workgroup_partials[0, count), called by the whole workgroup
+void scan_partials(const uint count)
+{
+    const uint index = gl_LocalInvocationIndex;
+    for (uint offset = 1u; offset < count; offset <<= 1u)
+    {
+        const uint before = index < count && index >= offset ? workgroup_partials[index - offset] : 0u;
+        barrier();
+        if (index < count)
+        {
+            workgroup_partials[index] += before;
+        }
+        barrier();
+    }
+}
+
+// sum of the values of all invocations before this one, total of all of them
+uint workgroup_exclusive_add(const uint value, out uint total)
+{
+#ifdef VULTEX_SUBGROUPS
+    const uint subgroupExclusive = subgroupExclusiveAdd(value);
+    const uint subgroupTotal = subgroupAdd(value);
+    if (subgroupElect())
+    {
+        workgroup_partials[gl_SubgroupID] = subgroupTotal;
+    }
+    barrier();
+    scan_partials(gl_NumSubgroups);
+    const uint exclusive = subgroupExclusive + (gl_SubgroupID == 0u ? 0u : workgroup_partials[gl_SubgroupID - 1u]);
+    total = workgroup_partials[gl_NumSubgroups - 1u];
+#else
+    workgroup_partials[gl_LocalInvocationIndex] = value;
+    barrier();
+    scan_partials(WORKGROUP_SIZE);
+    const uint exclusive = workgroup_partials[gl_LocalInvocationIndex] - value;
+    total = workgroup_partials[WORKGROUP_SIZE - 1u];
+#endif
+    barrier();
+    return exclusive;
+}
+
+uint workgroup_add(const uint value)
+{
+#ifdef VULTEX_SUBGROUPS
+    const uint sum = subgroupAdd(value);
+    if (subgroupElect())
+    {
+        workgroup_partials[gl_SubgroupID] = sum;
+    }
+    const uint count = gl_NumSubgroups;
+#else
+    workgroup_partials[gl_LocalInvocationIndex] = value;
+    const uint count = WORKGROUP_SIZE;
+#endif
+    barrier();
+    // halves of the next power of two, the upper one may be cut short
+    const uint width = count > 1u ? 2u << findMSB(count - 1u) : 1u;
+    for (uint stride = width / 2u; stride > 0u; stride /= 2u)
+    {
+        if (gl_LocalInvocationIndex < stride && gl_LocalInvocationIndex + stride < count)
+        {
+            workgroup_partials[gl_LocalInvocationIndex] += workgroup_partials[gl_LocalInvocationIndex + stride];
+        }
+        barrier();
+    }
+    const uint total = workgroup_partials[0];
+    barrier();
+    return total;
+}
@@ -0,0 +1,95 @@
+// Particle state of GpuParticles (gpu_particles.hpp). A vertex shader
+// drawing the particles defines PARTICLE_SET to the set it binds
+// GpuParticles::descriptor_set() to and reads drawn_particle(); the
+// simulation kernels define PARTICLE_SIMULATION.
+
+#ifndef PARTICLE_SET
+#define PARTICLE_SET 0
+#endif
+
+#ifdef PARTICLE_SIMULATION
+#define PARTICLE_ACCESS
+#else
+#define PARTICLE_ACCESS readonly
+#endif
+
+struct Particle
+{
+    vec3 position;
+    float age;
+    vec3 velocity;
+    float lifetime;
+};
+
+layout(std140, set = PARTICLE_SET, binding = 0) uniform ParticleParameters
+{
+    mat4 view;
+    vec4 emitter_position; // xyz, w spawn radius
+    vec4 emitter_velocity; // xyz, w velocity variance
+    vec4 gravity;          // xyz, w drag
+    vec4 timing;           // delta time, lifetime, lifetime variance, size
+    uvec4 frame;           // emit count, random seed, current alive list, first drawn entry of particle_order
+    uvec4 limits;          // capacity
+} parameters;
+
+layout(std430, set = PARTICLE_SET, binding = 2) PARTICLE_ACCESS buffer Particles
+{
+    Particle particles[];
+};
+
+// both alive lists of capacity entries each, then the sorted draw order from
+// frame.w of the parameters
+layout(std430, set = PARTICLE_SET, binding = 4) PARTICLE_ACCESS buffer ParticleOrder
+{
+    uint particle_order[];
+};
+
+#ifdef PARTICLE_SIMULATION
+const uint WORKGROUP_SIZE = 256u;
+
+// indirect arguments first, see GpuParticles::dispatch_indirect() and draw()
+layout(std430, set = PARTICLE_SET, binding = 1) buffer ParticleCounters
+{
+    uvec3 dispatch_size;
+    uint unused;
+    uvec4 draw;          // vertex count, instance count, first vertex, first instance
+    uint alive_count[2];
+    int dead_count;
+} counters;
+
+layout(std430, set = PARTICLE_SET, binding = 3) buffer DeadParticles
+{
+    uint dead_particles[];
+};
+
+layout(std430, set = PARTICLE_SET, binding = 5) buffer ParticleKeys
+{
+    uint particle_keys[];
+};
+
+// PCG hash, random numbers per particle and step without state in memory
+uint random_hash(const uint value)
+{
+    const uint state = value * 747796405u + 2891336453u;
+    const uint word = ((state >> ((state >> 28u) + 4u)) ^ state) * 277803737u;
+    return (word >> 22u) ^ word;
+}
+
+// in [0, 1)
+float random_unit(inout uint seed)
+{
+    seed = random_hash(seed);
+    return float(seed >> 8u) / 16777216.0;
+}
+
+vec3 random_signed(inout uint seed)
+{
+    return vec3(random_unit(seed), random_unit(seed), random_unit(seed)) * 2.0 - 1.0;
+}
+#else
+// particle of an instance of GpuParticles::draw()
+Particle drawn_particle(const uint instance)
+{
+    return particles[particle_order[parameters.frame.w + instance]];
+}
+#endif
@@ -0,0 +1,122 @@
+#pragma once
+
+#define GLFW_INCLUDE_VULKAN
+#include <GLFW/glfw3.h>
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <iterator>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+namespace vultex
+{
+
+// Describes `layout(constant_id = Id) const T name` of a shader.
+// Booleans have to be declared as VkBool32, SPIR-V bool is 32 bit wide.
+template <std::uint32_t Id, typename T>
+struct SpecializationConstant
+{
+    static_assert(std::is_trivially_copyable_v<T> && sizeof(T) % 4 == 0,
+                  "specialization constant has to be a 32 or 64 bit scalar");
+    static constexpr std::uint32_t id = Id;
+    using value_type = T;
+};
+
+// CPU side mirror of the specialization constants of a shader. Layout and map
+// entries are computed at compile time, only the values are set at runtime.
+template <typename... Constants>
+class SpecializationConstants
+{
+public:
+    static constexpr std::size_t size = (sizeof(typename Constants::value_type) + ... + 0);
+
+    template <std::size_t Index>
+    using value_type = std::tuple_element_t<Index, std::tuple<typename Constants::value_type...>>;
+
+    template <std::size_t Index>
+    void set(const value_type<Index>& value)
+    {
+        std::memcpy(std::next(data.data(), map_entries[Index].offset), &value, sizeof(value));
+    }
+
+    template <std::size_t Index>
+    [[nodiscard]] value_type<Index> get() const
+    {
+        value_type<Index> value{};
+        std::memcpy(&value, std::next(data.data(), map_entries[Index].offset), sizeof(value));
+        return value;
+    }
+
+    // returned structure points into this object
+    [[nodiscard]] VkSpecializationInfo info() const
+    {
+        return VkSpecializationInfo{.mapEntryCount = static_cast<std::uint32_t>(map_entries.size()),
+                                    .pMapEntries = map_entries.data(),
+                                    .dataSize = data.size(),
+                                    .pData = data.data()};
+    }
+
+private:
+    static constexpr std::array<VkSpecializationMapEntry, sizeof...(Constants)> make_map_entries()
+    {
+        std::array<VkSpecializationMapEntry, sizeof...(Constants)> entries{};
+        std::uint32_t offset = 0;
+        std::size_t index = 0;
+        ((entries[index++] = VkSpecializationMapEntry{.constantID = Constants::id,
+                                                      .offset = std::exchange(
+                                                          offset, offset + sizeof(typename Constants::value_type)),
+                                                      .size = sizeof(typename Constants::value_type)}),
+         ...);
+        return entries;
+    }
+
+    static constexpr auto map_entries = make_map_entries();
+    std::array<std::byte, size> data{};
+};
+
+// Feature toggles of an uber shader baked as VkBool32 constants, bit N of the
+// mask is `layout(constant_id = N) const bool` in the shader. The compiler
+// removes disabled branches, so permutations cost no GPU occupancy.
+template <std::uint32_t FeatureCount>
+class FeatureSpecialization
+{
+public:
+    static_assert(FeatureCount <= 32, "feature mask is 32 bit wide");
+
+    explicit constexpr FeatureSpecialization(const std::uint32_t mask)
+    {
+        for (std::uint32_t bit = 0; bit < FeatureCount; ++bit)
+        {
+            values[bit] = (mask >> bit) & 1U;
+        }
+    }
+
+    [[nodiscard]] VkSpecializationInfo info() const
+    {
+        return VkSpecializationInfo{.mapEntryCount = FeatureCount,
+                                    .pMapEntries = map_entries.data(),
+                                    .dataSize = sizeof(values),
+                                    .pData = values.data()};
+    }
+
+private:
+    static constexpr std::array<VkSpecializationMapEntry, FeatureCount> make_map_entries()
+    {
+        std::array<VkSpecializationMapEntry, FeatureCount> entries{};
+        for (std::uint32_t bit = 0; bit < FeatureCount; ++bit)
+        {
+            entries[bit] = VkSpecializationMapEntry{.constantID = bit,
+                                                    .offset = bit * static_cast<std::uint32_t>(sizeof(VkBool32)),
+                                                    .size = sizeof(VkBool32)};
+        }
+        return entries;
+    }
+
+    static constexpr auto map_entries = make_map_entries();
+    std::array<VkBool32, FeatureCount> values{};
+};
+} // namespace vultex
@@ -0,0 +1,127 @@
+#include "texture_format_support.hpp"
+
+#include <array>
+#include <spdlog/spdlog.h>
+
+namespace vultex
+{
+namespace
+{
+constexpr std::array all_targets = {TranscodeTarget::bc7,
+                                    TranscodeTarget::astc_4x4,
+                                    TranscodeTarget::bc3,
+                                    TranscodeTarget::bc1,
+                                    TranscodeTarget::etc2_rgba,
+                                    TranscodeTarget::etc2_rgb,
+                                    TranscodeTarget::rgba8};
+
+// texture has to be sampled in shaders and filled by a copy command
+constexpr VkFormatFeatureFlags required_features =
+    VK_FORMAT_FEATURE_SAMPLED_IMAGE_BIT | VK_FORMAT_FEATURE_TRANSFER_DST_BIT;
+
+bool has_alpha_channel(const TranscodeTarget target)
+{
+    switch (target)
+    {
+    case TranscodeTarget::bc1:
+    case TranscodeTarget::etc2_rgb:
+        return false;
+    default:
+        return true;
+    }
+}
+} // namespace
+
+const char* to_string(const TranscodeTarget target)
+{
+    switch (target)
+    {
+    case TranscodeTarget::bc7:
+        return "BC7";
+    case TranscodeTarget::astc_4x4:
+        return "ASTC 4x4";
+    case TranscodeTarget::bc3:
+        return "BC3";
+    case TranscodeTarget::bc1:
+        return "BC1";
+    case TranscodeTarget::etc2_rgba:
+        return "ETC2 RGBA";
+    case TranscodeTarget::etc2_rgb:
+        return "ETC2 RGB";
+    case TranscodeTarget::rgba8:
+        return "RGBA8";
+    }
+    return "Unknown";
+}
+
+VkFormat to_vk_format(const TranscodeTarget target, const bool srgb)
+{
+    switch (target)
+    {
+    case TranscodeTarget::bc7:
+        return srgb ? VK_FORMAT_BC7_SRGB_BLOCK : VK_FORMAT_BC7_UNORM_BLOCK;
+    case TranscodeTarget::astc_4x4:
+        return srgb ? VK_FORMAT_ASTC_4x4_SRGB_BLOCK : VK_FORMAT_ASTC_4x4_UNORM_BLOCK;
+    case TranscodeTarget::bc3:
+        return srgb ? VK_FORMAT_BC3_SRGB_BLOCK : VK_FORMAT_BC3_UNORM_BLOCK;
+    case TranscodeTarget::bc1:
+        return srgb ? VK_FORMAT_BC1_RGB_SRGB_BLOCK : VK_FORMAT_BC1_RGB_UNORM_BLOCK;
+    case TranscodeTarget::etc2_rgba:
+        return srgb ? VK_FORMAT_ETC2_R8G8B8A8_SRGB_BLOCK : VK_FORMAT_ETC2_R8G8B8A8_UNORM_BLOCK;
+    case TranscodeTarget::etc2_rgb:
+        return srgb ? VK_FORMAT_ETC2_R8G8B8_SRGB_BLOCK : VK_FORMAT_ETC2_R8G8B8_UNORM_BLOCK;
+    case TranscodeTarget::rgba8:
+        return srgb ? VK_FORMAT_R8G8B8A8_SRGB : VK_FORMAT_R8G8B8A8_UNORM;
+    }
+    return VK_FORMAT_UNDEFINED;
+}
+
+TextureFormatSupport::TextureFormatSupport(VkPhysicalDevice physical_device)
+    : physical_device{physical_device}
+{
+    for (const auto target : all_targets)
+    {
+        // color textures are sRGB and data textures (normals etc.) are linear,
+        // so the target is usable only when both variants are available
+        targets[target] = is_supported(to_vk_format(target, true)) && is_supported(to_vk_format(target, false));
+    }
+}
+
+bool TextureFormatSupport::is_supported(const VkFormat format) const
+{
+    VkFormatProperties properties{};
+    vkGetPhysicalDeviceFormatProperties(physical_device, format, &properties);
+
+    return (properties.optimalTilingFeatures & required_features) == required_features;
+}
+
+bool TextureFormatSupport::is_supported(const TranscodeTarget target) const
+{
+    const auto it = targets.find(target);
+    return it != targets.end() && it->second;
+}
+
+TranscodeTarget TextureFormatSupport::select_transcode_target(const bool has_alpha) const
+{
+    for (const auto target : all_targets)
+    {
+        if (is_supported(target) && (!has_alpha || has_alpha_channel(target)))
+        {
+            return target;
+        }
+    }
+    return TranscodeTarget::rgba8;
+}
+
+void TextureFormatSupport::log_properties() const
+{
+    spdlog::info("Texture formats status:");
+    for (const auto& [target, supported] : targets)
+    {
+        spdlog::info("\t {} {}", supported ? "[x]" : "[ ]", to_string(target));
+    }
+    spdlog::info("Transcode target for opaque textures: {}, with alpha: {}",
+                 to_string(select_transcode_target(false)),
+                 to_string(select_transcode_target(true)));
+}
+} // namespace vultex
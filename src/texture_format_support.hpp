@@ -0,0 +1,43 @@
+#pragma once
+
+#define GLFW_INCLUDE_VULKAN
+#include <GLFW/glfw3.h>
+
+#include <map>
+
+namespace vultex
+{
+
+// GPU native formats a Basis Universal (ETC1S / UASTC) payload can be
+// transcoded into, ordered from the best quality to the worst one
+enum class TranscodeTarget
+{
+    bc7,
+    astc_4x4,
+    bc3,
+    bc1,
+    etc2_rgba,
+    etc2_rgb,
+    rgba8 // last resort, texture is decompressed
+};
+
+[[nodiscard]] const char* to_string(TranscodeTarget target);
+[[nodiscard]] VkFormat to_vk_format(TranscodeTarget target, bool srgb);
+
+// Checks with vkGetPhysicalDeviceFormatProperties which block compressed
+// formats can be sampled and uploaded on the selected device
+class TextureFormatSupport
+{
+public:
+    explicit TextureFormatSupport(VkPhysicalDevice physical_device);
+
+    [[nodiscard]] bool is_supported(VkFormat format) const;
+    [[nodiscard]] bool is_supported(TranscodeTarget target) const;
+    [[nodiscard]] TranscodeTarget select_transcode_target(bool has_alpha) const;
+    void log_properties() const;
+
+private:
+    VkPhysicalDevice physical_device{VK_NULL_HANDLE};
+    std::map<TranscodeTarget, bool> targets{};
+};
+} // namespace vultex
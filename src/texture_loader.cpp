@@ -0,0 +1,320 @@
+#include "texture_loader.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <exception>
+#include <fmt/format.h>
+#include <iterator>
+#include <mutex>
+#include <spdlog/spdlog.h>
+#include <stdexcept>
+#include <utility>
+
+#ifdef VULTEX_HAS_BASISU
+#include <basisu_transcoder.h>
+#endif
+
+#include "host_allocator.hpp"
+#include "vulkan_memory.hpp"
+
+namespace vultex
+{
+namespace
+{
+#ifdef VULTEX_HAS_BASISU
+basist::transcoder_texture_format to_basis_format(const TranscodeTarget target)
+{
+    switch (target)
+    {
+    case TranscodeTarget::bc7:
+        return basist::transcoder_texture_format::cTFBC7_RGBA;
+    case TranscodeTarget::astc_4x4:
+        return basist::transcoder_texture_format::cTFASTC_4x4_RGBA;
+    case TranscodeTarget::bc3:
+        return basist::transcoder_texture_format::cTFBC3_RGBA;
+    case TranscodeTarget::bc1:
+        return basist::transcoder_texture_format::cTFBC1_RGB;
+    case TranscodeTarget::etc2_rgba:
+        return basist::transcoder_texture_format::cTFETC2_RGBA;
+    case TranscodeTarget::etc2_rgb:
+        // ETC1 blocks are valid ETC2 RGB blocks
+        return basist::transcoder_texture_format::cTFETC1_RGB;
+    case TranscodeTarget::rgba8:
+        break;
+    }
+    return basist::transcoder_texture_format::cTFRGBA32;
+}
+
+TextureData transcode_basis(const Ktx2Texture& texture, const TextureFormatSupport& support)
+{
+    static std::once_flag initialized{};
+    std::call_once(initialized, [] { basist::basisu_transcoder_init(); });
+
+    const auto file = texture.bytes();
+    basist::ktx2_transcoder transcoder{};
+    if (!transcoder.init(file.data(), static_cast<std::uint32_t>(file.size())) || !transcoder.start_transcoding())
+    {
+        throw std::runtime_error("Cannot start transcoding the Basis Universal texture!");
+    }
+
+    const auto target = support.select_transcode_target(transcoder.get_has_alpha());
+    const auto format = to_basis_format(target);
+    const auto uncompressed = basist::basis_transcoder_format_is_uncompressed(format);
+    const auto unitSize = basist::basis_get_bytes_per_block_or_pixel(format);
+
+    TextureData result{.format = to_vk_format(target, texture.is_srgb()),
+                       .extent = texture.extent(),
+                       .layer_count = texture.layer_count(),
+                       .face_count = texture.face_count(),
+                       .bytes = {},
+                       .levels = {}};
+    for (std::uint32_t level = 0; level < transcoder.get_levels(); ++level)
+    {
+        const auto levelOffset = result.bytes.size();
+        for (std::uint32_t layer = 0; layer < result.layer_count; ++layer)
+        {
+            for (std::uint32_t face = 0; face < result.face_count; ++face)
+            {
+                basist::ktx2_image_level_info info{};
+                if (!transcoder.get_image_level_info(info, level, layer, face))
+                {
+                    throw std::runtime_error(fmt::format("Cannot read Basis Universal level {}!", level));
+                }
+
+                // whole blocks, or texels of the original size for RGBA8
+                const auto units = uncompressed ? info.m_orig_width * info.m_orig_height : info.m_total_blocks;
+                const auto offset = result.bytes.size();
+                result.bytes.resize(offset + std::size_t{units} * unitSize);
+                if (!transcoder.transcode_image_level(
+                        level, layer, face, std::next(result.bytes.data(), offset), units, format))
+                {
+                    throw std::runtime_error(fmt::format("Cannot transcode Basis Universal level {}!", level));
+                }
+            }
+        }
+        result.levels.push_back(TextureLevel{.offset = levelOffset, .size = result.bytes.size() - levelOffset});
+    }
+    return result;
+}
+#endif
+
+VkImageViewType view_type(const TextureData& data)
+{
+    if (data.face_count == 6)
+    {
+        return data.layer_count > 1 ? VK_IMAGE_VIEW_TYPE_CUBE_ARRAY : VK_IMAGE_VIEW_TYPE_CUBE;
+    }
+    if (data.extent.depth > 1)
+    {
+        return VK_IMAGE_VIEW_TYPE_3D;
+    }
+    return data.layer_count > 1 ? VK_IMAGE_VIEW_TYPE_2D_ARRAY : VK_IMAGE_VIEW_TYPE_2D;
+}
+} // namespace
+
+TextureData decode_ktx2(const Ktx2Texture& texture, const TextureFormatSupport& support)
+{
+    if (texture.is_basis_universal())
+    {
+#ifdef VULTEX_HAS_BASISU
+        return transcode_basis(texture, support);
+#else
+        throw std::runtime_error("Basis Universal textures need vultex built with the basisu transcoder!");
+#endif
+    }
+
+    if (texture.supercompression() != Ktx2Supercompression::none)
+    {
+        throw std::runtime_error(fmt::format("KTX2 supercompression scheme {} is not supported!",
+                                             static_cast<std::uint32_t>(texture.supercompression())));
+    }
+    if (!texture.can_upload_directly(support))
+    {
+        throw std::runtime_error(
+            fmt::format("KTX2 format {} is not supported by the device!", static_cast<int>(texture.format())));
+    }
+
+    TextureData result{.format = texture.format(),
+                       .extent = texture.extent(),
+                       .layer_count = texture.layer_count(),
+                       .face_count = texture.face_count(),
+                       .bytes = {},
+                       .levels = {}};
+    for (std::uint32_t level = 0; level < texture.level_count(); ++level)
+    {
+        const auto data = texture.level_data(level);
+        result.levels.push_back(TextureLevel{.offset = result.bytes.size(), .size = data.size()});
+        result.bytes.insert(result.bytes.end(), data.begin(), data.end());
+    }
+    return result;
+}
+
+TextureLoader::TextureLoader(const VulkanContext& context,
+                             JobSystem& jobs,
+                             const TextureFormatSupport& support,
+                             UploadBatcher& batcher)
+    : physical_device{context.physical_device()},
+      logical_device{context.logical_device()},
+      jobs{jobs},
+      support{support},
+      batcher{batcher}
+{
+}
+
+TextureLoader::~TextureLoader()
+{
+    // the decode jobs reference the format support
+    for (auto& texture : pending_textures)
+    {
+        texture.data.wait();
+    }
+    for (const auto& texture : textures)
+    {
+        vkDestroyImageView(logical_device, texture.view, allocation_callbacks());
+        vkDestroyImage(logical_device, texture.image, allocation_callbacks());
+        vkFreeMemory(logical_device, texture.memory, allocation_callbacks());
+    }
+}
+
+std::uint32_t TextureLoader::load(const std::filesystem::path& path)
+{
+    const auto index = static_cast<std::uint32_t>(textures.size());
+    textures.push_back(Texture{});
+    pending_textures.push_back(PendingTexture{
+        .index = index,
+        .path = path,
+        .data = jobs.submit([path, this] { return decode_ktx2(Ktx2Texture{path}, support); })});
+    return index;
+}
+
+void TextureLoader::upload_ready()
+{
+    const auto ready = std::ranges::partition(
+        pending_textures,
+        [](const PendingTexture& texture)
+        { return texture.data.wait_for(std::chrono::seconds{0}) != std::future_status::ready; });
+
+    for (auto& pendingTexture : ready)
+    {
+        try
+        {
+            const auto data = pendingTexture.data.get();
+            auto& texture = textures[pendingTexture.index];
+            texture = create_texture(data);
+            upload(texture, data);
+            spdlog::info("Texture {}: {}x{}, {} levels, format {}",
+                         pendingTexture.path.string(),
+                         data.extent.width,
+                         data.extent.height,
+                         data.levels.size(),
+                         static_cast<int>(data.format));
+        }
+        catch (const std::exception& e)
+        {
+            spdlog::error("Cannot load texture {}: {}", pendingTexture.path.string(), e.what());
+        }
+    }
+    pending_textures.erase(ready.begin(), ready.end());
+}
+
+const Texture& TextureLoader::texture(const std::uint32_t index) const
+{
+    return textures.at(index);
+}
+
+std::size_t TextureLoader::pending() const
+{
+    return pending_textures.size();
+}
+
+Texture TextureLoader::create_texture(const TextureData& data) const
+{
+    const bool cube = data.face_count == 6;
+    const VkImageCreateInfo imageInfo{
+        .sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO,
+        .flags = cube ? VkImageCreateFlags{VK_IMAGE_CREATE_CUBE_COMPATIBLE_BIT} : VkImageCreateFlags{0},
+        .imageType = data.extent.depth > 1 ? VK_IMAGE_TYPE_3D : VK_IMAGE_TYPE_2D,
+        .format = data.format,
+        .extent = data.extent,
+        .mipLevels = static_cast<std::uint32_t>(data.levels.size()),
+        .arrayLayers = data.layer_count * data.face_count,
+        .samples = VK_SAMPLE_COUNT_1_BIT,
+        .tiling = VK_IMAGE_TILING_OPTIMAL,
+        .usage = VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_SAMPLED_BIT | batcher.image_usage(),
+        .sharingMode = VK_SHARING_MODE_EXCLUSIVE,
+        .initialLayout = VK_IMAGE_LAYOUT_UNDEFINED};
+
+    Texture texture{.image = VK_NULL_HANDLE,
+                    .memory = VK_NULL_HANDLE,
+                    .view = VK_NULL_HANDLE,
+                    .format = data.format,
+                    .extent = data.extent};
+    if (VK_SUCCESS != vkCreateImage(logical_device, &imageInfo, allocation_callbacks(), &texture.image))
+    {
+        throw std::runtime_error("Failed to create texture image!");
+    }
+
+    VkMemoryRequirements requirements{};
+    vkGetImageMemoryRequirements(logical_device, texture.image, &requirements);
+    const auto memoryType =
+        find_memory_type(physical_device, requirements.memoryTypeBits, {VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, 0});
+    const VkMemoryAllocateInfo allocateInfo{.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO,
+                                            .allocationSize = requirements.size,
+                                            .memoryTypeIndex = memoryType.value_or(0)};
+    if (!memoryType ||
+        VK_SUCCESS != vkAllocateMemory(logical_device, &allocateInfo, allocation_callbacks(), &texture.memory))
+    {
+        vkDestroyImage(logical_device, texture.image, allocation_callbacks());
+        throw std::runtime_error("Failed to allocate texture memory!");
+    }
+    vkBindImageMemory(logical_device, texture.image, texture.memory, 0);
+
+    const VkImageViewCreateInfo viewInfo{.sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO,
+                                         .image = texture.image,
+                                         .viewType = view_type(data),
+                                         .format = data.format,
+                                         .subresourceRange = {.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT,
+                                                              .baseMipLevel = 0,
+                                                              .levelCount = imageInfo.mipLevels,
+                                                              .baseArrayLayer = 0,
+                                                              .layerCount = imageInfo.arrayLayers}};
+    if (VK_SUCCESS != vkCreateImageView(logical_device, &viewInfo, allocation_callbacks(), &texture.view))
+    {
+        vkDestroyImage(logical_device, texture.image, allocation_callbacks());
+        vkFreeMemory(logical_device, texture.memory, allocation_callbacks());
+        throw std::runtime_error("Failed to create texture image view!");
+    }
+    return texture;
+}
+
+void TextureLoader::upload(const Texture& texture, const TextureData& data)
+{
+    // every level of the new image starts from UNDEFINED, so the whole chain is copied in one batch
+    for (std::uint32_t level = 0; level < data.levels.size(); ++level)
+    {
+        const auto& range = data.levels[level];
+        const ImageUpload upload{
+            .image = texture.image,
+            .old_layout = VK_IMAGE_LAYOUT_UNDEFINED,
+            .new_layout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
+            .subresource = {.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT,
+                            .mipLevel = level,
+                            .baseArrayLayer = 0,
+                            .layerCount = data.layer_count * data.face_count},
+            .offset = {0, 0, 0},
+            .extent = {std::max(data.extent.width >> level, 1U),
+                       std::max(data.extent.height >> level, 1U),
+                       std::max(data.extent.depth >> level, 1U)},
+            .host_transfer = 0 != batcher.image_usage()};
+        if (!batcher.upload_image(upload, std::span{data.bytes}.subspan(range.offset, range.size)))
+        {
+            // the texture is incomplete either way
+            spdlog::warn("Levels from {} of a {}x{} texture are not uploaded",
+                         level,
+                         data.extent.width,
+                         data.extent.height);
+            return;
+        }
+    }
+}
+} // namespace vultex
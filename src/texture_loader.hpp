@@ -0,0 +1,101 @@
+#pragma once
+
+#define GLFW_INCLUDE_VULKAN
+#include <GLFW/glfw3.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <future>
+#include <vector>
+
+#include "job_system.hpp"
+#include "ktx2_texture.hpp"
+#include "texture_format_support.hpp"
+#include "upload_batcher.hpp"
+#include "vulkan_context.hpp"
+
+namespace vultex
+{
+
+struct TextureLevel
+{
+    std::size_t offset;
+    std::size_t size;
+};
+
+// Texture in the format it is uploaded in. Every level holds all of its
+// layers and faces tightly packed, the levels are ranges of bytes.
+struct TextureData
+{
+    VkFormat format;
+    VkExtent3D extent;
+    std::uint32_t layer_count;
+    std::uint32_t face_count;
+    std::vector<std::byte> bytes;
+    std::vector<TextureLevel> levels;
+};
+
+// Payloads stored in a GPU format the device supports are copied as they
+// are, Basis Universal payloads are transcoded to the best target of support
+// (VULTEX_HAS_BASISU). CPU only, meant for job threads.
+[[nodiscard]] TextureData decode_ktx2(const Ktx2Texture& texture, const TextureFormatSupport& support);
+
+struct Texture
+{
+    VkImage image;
+    VkDeviceMemory memory;
+    VkImageView view;
+    VkFormat format;
+    VkExtent3D extent;
+};
+
+// Reads and decodes KTX2 files on job threads, the frame loop uploads the
+// finished ones level by level through the UploadBatcher. Block compressed
+// data stays compressed, RGBA8 only when the device samples none of the
+// transcode targets. Textures are in SHADER_READ_ONLY_OPTIMAL once the flush
+// of their uploads completed.
+class TextureLoader
+{
+public:
+    TextureLoader(const VulkanContext& context,
+                  JobSystem& jobs,
+                  const TextureFormatSupport& support,
+                  UploadBatcher& batcher);
+    TextureLoader(const TextureLoader&) = delete;
+    TextureLoader(TextureLoader&&) = delete;
+    TextureLoader& operator=(const TextureLoader&) = delete;
+    TextureLoader& operator=(TextureLoader&&) = delete;
+    // waits for the pending decodes, the device has to be idle
+    ~TextureLoader();
+
+    // index of the texture, its image is VK_NULL_HANDLE until uploaded
+    std::uint32_t load(const std::filesystem::path& path);
+
+    // creates and uploads the textures decoded since the last call, before
+    // UploadBatcher::flush(); failed loads are logged and stay empty
+    void upload_ready();
+
+    [[nodiscard]] const Texture& texture(std::uint32_t index) const;
+    [[nodiscard]] std::size_t pending() const;
+
+private:
+    struct PendingTexture
+    {
+        std::uint32_t index;
+        std::filesystem::path path;
+        std::future<TextureData> data;
+    };
+
+    [[nodiscard]] Texture create_texture(const TextureData& data) const;
+    void upload(const Texture& texture, const TextureData& data);
+
+    VkPhysicalDevice physical_device{VK_NULL_HANDLE};
+    VkDevice logical_device{nullptr};
+    JobSystem& jobs;
+    const TextureFormatSupport& support;
+    UploadBatcher& batcher;
+    std::vector<PendingTexture> pending_textures{};
+    std::vector<Texture> textures{};
+};
+} // namespace vultex
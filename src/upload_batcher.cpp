@@ -0,0 +1,647 @@
+#include "upload_batcher.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <functional>
+#include <iterator>
+#include <set>
+#include <spdlog/spdlog.h>
+#include <stdexcept>
+#include <utility>
+
+#include "host_allocator.hpp"
+#include "vulkan_memory.hpp"
+
+namespace vultex
+{
+std::uint32_t group_buffer_copies(std::vector<StagedBufferCopy>& copies)
+{
+    const auto byDestination = [](const StagedBufferCopy& left, const StagedBufferCopy& right)
+    {
+        if (left.group != right.group)
+        {
+            return left.group < right.group;
+        }
+        if (left.buffer != right.buffer)
+        {
+            return std::less<VkBuffer>{}(left.buffer, right.buffer);
+        }
+        return left.region.dstOffset < right.region.dstOffset;
+    };
+
+    // destinations in order, so the copies of one buffer are neighbours
+    std::ranges::sort(copies, byDestination);
+    bool overlapping = false;
+    for (std::size_t index = 1; index < copies.size() && !overlapping; ++index)
+    {
+        const auto& previous = copies[index - 1];
+        const auto& copy = copies[index];
+        overlapping =
+            previous.buffer == copy.buffer && copy.region.dstOffset < previous.region.dstOffset + previous.region.size;
+    }
+
+    std::uint32_t groups = copies.empty() ? 0 : 1;
+    if (overlapping)
+    {
+        // the arena is filled front to back, staging offsets are the submission order
+        std::ranges::sort(copies, {}, [](const StagedBufferCopy& copy) { return copy.region.srcOffset; });
+
+        // ranges of the current group, they don't overlap each other
+        const auto rangeLess = [](const StagedBufferCopy* left, const StagedBufferCopy* right)
+        {
+            if (left->buffer != right->buffer)
+            {
+                return std::less<VkBuffer>{}(left->buffer, right->buffer);
+            }
+            return left->region.dstOffset < right->region.dstOffset;
+        };
+        std::set<const StagedBufferCopy*, decltype(rangeLess)> ranges{rangeLess};
+        for (auto& copy : copies)
+        {
+            const auto next = ranges.lower_bound(&copy);
+            const bool overlapsNext = next != ranges.end() && (*next)->buffer == copy.buffer &&
+                                      (*next)->region.dstOffset < copy.region.dstOffset + copy.region.size;
+            const bool overlapsPrevious = next != ranges.begin() && (*std::prev(next))->buffer == copy.buffer &&
+                                          copy.region.dstOffset < (*std::prev(next))->region.dstOffset +
+                                                                      (*std::prev(next))->region.size;
+            if (overlapsNext || overlapsPrevious)
+            {
+                ranges.clear();
+                ++groups;
+            }
+            copy.group = groups - 1;
+            ranges.insert(&copy);
+        }
+        std::ranges::sort(copies, byDestination);
+    }
+
+    // regions adjacent in the arena and in the buffer become one
+    if (!copies.empty())
+    {
+        auto merged = copies.begin();
+        for (auto copy = std::next(merged); copy != copies.end(); ++copy)
+        {
+            if (merged->group == copy->group && merged->buffer == copy->buffer &&
+                merged->region.srcOffset + merged->region.size == copy->region.srcOffset &&
+                merged->region.dstOffset + merged->region.size == copy->region.dstOffset)
+            {
+                merged->region.size += copy->region.size;
+            }
+            else
+            {
+                *++merged = *copy;
+            }
+        }
+        copies.erase(std::next(merged), copies.end());
+    }
+    return groups;
+}
+
+std::uint32_t group_image_copies(std::vector<StagedImageCopy>& copies)
+{
+    // in submission order, a copy conflicting with one of the current group starts the next group:
+    // the layouts of an image differ or the regions overlap
+    std::uint32_t groups = copies.empty() ? 0 : 1;
+    auto groupBegin = copies.begin();
+    for (auto copy = copies.begin(); copy != copies.end(); ++copy)
+    {
+        const auto& upload = copy->upload;
+        const auto conflicts = [&upload](const StagedImageCopy& earlier)
+        {
+            const auto& other = earlier.upload;
+            if (other.image != upload.image)
+            {
+                return false;
+            }
+            if (other.old_layout != upload.old_layout || other.new_layout != upload.new_layout)
+            {
+                return true;
+            }
+            const auto overlaps = [](const std::int64_t begin, const std::uint32_t size, const std::int64_t otherBegin,
+                                     const std::uint32_t otherSize)
+            { return begin < otherBegin + otherSize && otherBegin < begin + size; };
+            return other.subresource.mipLevel == upload.subresource.mipLevel &&
+                   0 != (other.subresource.aspectMask & upload.subresource.aspectMask) &&
+                   overlaps(upload.subresource.baseArrayLayer,
+                            upload.subresource.layerCount,
+                            other.subresource.baseArrayLayer,
+                            other.subresource.layerCount) &&
+                   overlaps(upload.offset.x, upload.extent.width, other.offset.x, other.extent.width) &&
+                   overlaps(upload.offset.y, upload.extent.height, other.offset.y, other.extent.height) &&
+                   overlaps(upload.offset.z, upload.extent.depth, other.offset.z, other.extent.depth);
+        };
+        if (std::any_of(groupBegin, copy, conflicts))
+        {
+            groupBegin = copy;
+            ++groups;
+        }
+        copy->group = groups - 1;
+    }
+
+    // the copies of one image and mip level are neighbours, in submission order within the group
+    std::ranges::stable_sort(copies,
+                             [](const StagedImageCopy& left, const StagedImageCopy& right)
+                             {
+                                 if (left.group != right.group)
+                                 {
+                                     return left.group < right.group;
+                                 }
+                                 if (left.upload.image != right.upload.image)
+                                 {
+                                     return std::less<VkImage>{}(left.upload.image, right.upload.image);
+                                 }
+                                 return left.upload.subresource.mipLevel < right.upload.subresource.mipLevel;
+                             });
+    return groups;
+}
+
+UploadBatcher::UploadBatcher(const VulkanContext& context,
+                             QueueTimeline& timeline,
+                             const VkDeviceSize arena_size,
+                             const std::uint32_t batch_count)
+    : logical_device{context.logical_device()}, timeline{timeline}, unified{context.unified_memory()}
+{
+    if (arena_size == 0 || batch_count == 0)
+    {
+        throw std::invalid_argument("Upload arena needs a size and at least one batch!");
+    }
+
+    auto* physical_device = context.physical_device();
+#ifdef VK_EXT_host_image_copy
+    if (context.host_image_copy())
+    {
+        copy_memory_to_image = reinterpret_cast<PFN_vkCopyMemoryToImageEXT>(
+            vkGetDeviceProcAddr(logical_device, "vkCopyMemoryToImageEXT"));
+        transition_image_layout = reinterpret_cast<PFN_vkTransitionImageLayoutEXT>(
+            vkGetDeviceProcAddr(logical_device, "vkTransitionImageLayoutEXT"));
+
+        // first the count, then the layouts
+        VkPhysicalDeviceHostImageCopyPropertiesEXT hostCopyProperties{
+            .sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_HOST_IMAGE_COPY_PROPERTIES_EXT};
+        VkPhysicalDeviceProperties2 properties2{.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PROPERTIES_2,
+                                                .pNext = &hostCopyProperties};
+        vkGetPhysicalDeviceProperties2(physical_device, &properties2);
+        host_copy_layouts.resize(hostCopyProperties.copyDstLayoutCount);
+        hostCopyProperties.pCopyDstLayouts = host_copy_layouts.data();
+        vkGetPhysicalDeviceProperties2(physical_device, &properties2);
+        host_copy_layouts.resize(hostCopyProperties.copyDstLayoutCount);
+        if (nullptr == copy_memory_to_image || nullptr == transition_image_layout)
+        {
+            host_copy_layouts.clear();
+        }
+    }
+#endif
+
+    VkPhysicalDeviceProperties properties{};
+    vkGetPhysicalDeviceProperties(physical_device, &properties);
+
+    non_coherent_atom_size = std::max(properties.limits.nonCoherentAtomSize, VkDeviceSize{1});
+    // image data starts at a multiple of texel blocks of up to 16 bytes
+    image_alignment = std::max(properties.limits.optimalBufferCopyOffsetAlignment, VkDeviceSize{16});
+    region_size = align_up(arena_size, image_alignment);
+
+    const VkBufferCreateInfo bufferInfo{.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO,
+                                        .size = region_size * batch_count,
+                                        .usage = VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
+                                        .sharingMode = VK_SHARING_MODE_EXCLUSIVE};
+    if (VK_SUCCESS != vkCreateBuffer(logical_device, &bufferInfo, allocation_callbacks(), &arena))
+    {
+        throw std::runtime_error("Failed to create upload arena!");
+    }
+
+    VkMemoryRequirements requirements{};
+    vkGetBufferMemoryRequirements(logical_device, arena, &requirements);
+    const auto memoryType =
+        find_memory_type(physical_device,
+                         requirements.memoryTypeBits,
+                         {VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT});
+    if (!memoryType)
+    {
+        throw std::runtime_error("Cannot find host visible memory for upload arena!");
+    }
+
+    const VkMemoryAllocateInfo allocateInfo{.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO,
+                                            .allocationSize = requirements.size,
+                                            .memoryTypeIndex = memoryType.value()};
+    if (VK_SUCCESS != vkAllocateMemory(logical_device, &allocateInfo, allocation_callbacks(), &memory))
+    {
+        throw std::runtime_error("Failed to allocate upload arena memory!");
+    }
+    vkBindBufferMemory(logical_device, arena, memory, 0);
+
+    // persistently mapped, coherent memory needs no flush
+    void* data{nullptr};
+    if (VK_SUCCESS != vkMapMemory(logical_device, memory, 0, VK_WHOLE_SIZE, 0, &data))
+    {
+        throw std::runtime_error("Failed to map upload arena memory!");
+    }
+    mapped = static_cast<std::byte*>(data);
+
+    batches.resize(batch_count);
+    for (auto& batch : batches)
+    {
+        const VkCommandPoolCreateInfo poolInfo{.sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO,
+                                               .flags = VK_COMMAND_POOL_CREATE_TRANSIENT_BIT,
+                                               .queueFamilyIndex = timeline.family_index()};
+        if (VK_SUCCESS != vkCreateCommandPool(logical_device, &poolInfo, allocation_callbacks(), &batch.command_pool))
+        {
+            throw std::runtime_error("Failed to create upload command pool!");
+        }
+
+        const VkCommandBufferAllocateInfo commandBufferInfo{.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO,
+                                                            .commandPool = batch.command_pool,
+                                                            .level = VK_COMMAND_BUFFER_LEVEL_PRIMARY,
+                                                            .commandBufferCount = 1};
+        vkAllocateCommandBuffers(logical_device, &commandBufferInfo, &batch.command_buffer);
+    }
+
+    spdlog::info("Upload batcher: {} batches of {} bytes, unified memory: {}, host image copy layouts: {}",
+                 batch_count,
+                 region_size,
+                 unified,
+                 host_copy_layouts.size());
+}
+
+UploadBatcher::~UploadBatcher()
+{
+    timeline.wait(flushed_value);
+    for (const auto& batch : batches)
+    {
+        vkDestroyCommandPool(logical_device, batch.command_pool, allocation_callbacks());
+    }
+    vkUnmapMemory(logical_device, memory);
+    vkDestroyBuffer(logical_device, arena, allocation_callbacks());
+    vkFreeMemory(logical_device, memory, allocation_callbacks());
+}
+
+bool UploadBatcher::unified_memory() const
+{
+    return unified;
+}
+
+VkImageUsageFlags UploadBatcher::image_usage() const
+{
+#ifdef VK_EXT_host_image_copy
+    if (!host_copy_layouts.empty())
+    {
+        return VK_IMAGE_USAGE_HOST_TRANSFER_BIT_EXT;
+    }
+#endif
+    return 0;
+}
+
+void UploadBatcher::register_buffer(const MappedBuffer& buffer)
+{
+    mapped_buffers.insert_or_assign(buffer.buffer, buffer);
+}
+
+void UploadBatcher::unregister_buffer(VkBuffer buffer)
+{
+    mapped_buffers.erase(buffer);
+}
+
+bool UploadBatcher::upload_buffer(VkBuffer buffer, const VkDeviceSize offset, const std::span<const std::byte> data)
+{
+    // the GPU reads host visible memory as fast as its own, there is nothing to copy
+    if (unified)
+    {
+        if (const auto it = mapped_buffers.find(buffer); it != mapped_buffers.end())
+        {
+            return write_mapped(it->second, offset, data);
+        }
+    }
+
+    // buffer copies have no alignment, consecutive uploads stay adjacent in the arena
+    VkDeviceSize stagingOffset = 0;
+    if (data.empty() || !allocate(data.size(), 1, stagingOffset))
+    {
+        return data.empty();
+    }
+
+    std::memcpy(std::next(mapped, static_cast<std::ptrdiff_t>(stagingOffset)), data.data(), data.size());
+    buffer_copies.push_back(StagedBufferCopy{.buffer = buffer,
+                                       .region = {.srcOffset = stagingOffset, .dstOffset = offset, .size = data.size()},
+                                       .group = 0});
+    ++statistics.uploads;
+    statistics.bytes += data.size();
+    return true;
+}
+
+bool UploadBatcher::upload_image(const ImageUpload& upload, const std::span<const std::byte> texels)
+{
+    if (upload.host_transfer && !texels.empty() && copy_on_host(upload, texels))
+    {
+        ++statistics.uploads;
+        ++statistics.direct_uploads;
+        statistics.bytes += texels.size();
+        return true;
+    }
+
+    VkDeviceSize stagingOffset = 0;
+    if (texels.empty() || !allocate(texels.size(), image_alignment, stagingOffset))
+    {
+        return texels.empty();
+    }
+
+    std::memcpy(std::next(mapped, static_cast<std::ptrdiff_t>(stagingOffset)), texels.data(), texels.size());
+    image_copies.push_back(StagedImageCopy{.upload = upload, .staging_offset = stagingOffset, .group = 0});
+    ++statistics.uploads;
+    statistics.bytes += texels.size();
+    return true;
+}
+
+std::uint64_t UploadBatcher::flush()
+{
+    if (!flush_ranges.empty())
+    {
+        vkFlushMappedMemoryRanges(logical_device, static_cast<std::uint32_t>(flush_ranges.size()), flush_ranges.data());
+        flush_ranges.clear();
+    }
+
+    // the next batch starts again from the levels' old_layout
+    host_written_levels.clear();
+    return submit();
+}
+
+std::uint64_t UploadBatcher::submit()
+{
+    if (buffer_copies.empty() && image_copies.empty())
+    {
+        return flushed_value;
+    }
+
+    // a destination written twice is copied in submission order, the later write wins
+    const auto bufferGroups = group_buffer_copies(buffer_copies);
+    const auto imageGroups = group_image_copies(image_copies);
+
+    auto& batch = batches[current_batch];
+    vkResetCommandPool(logical_device, batch.command_pool, 0);
+    const VkCommandBufferBeginInfo beginInfo{.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO,
+                                             .flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT};
+    vkBeginCommandBuffer(batch.command_buffer, &beginInfo);
+    auto bufferCopy = buffer_copies.begin();
+    auto imageCopy = image_copies.begin();
+    for (std::uint32_t group = 0; group < std::max(bufferGroups, imageGroups); ++group)
+    {
+        const auto bufferEnd = std::find_if(
+            bufferCopy, buffer_copies.end(), [group](const StagedBufferCopy& copy) { return copy.group != group; });
+        const auto imageEnd = std::find_if(
+            imageCopy, image_copies.end(), [group](const StagedImageCopy& copy) { return copy.group != group; });
+        record(batch.command_buffer, {bufferCopy, bufferEnd}, {imageCopy, imageEnd});
+        bufferCopy = bufferEnd;
+        imageCopy = imageEnd;
+    }
+    vkEndCommandBuffer(batch.command_buffer);
+
+    flushed_value = timeline.submit(std::span{&batch.command_buffer, 1});
+    batch.timeline_value = flushed_value;
+    ++statistics.submits;
+
+    buffer_copies.clear();
+    image_copies.clear();
+    next_batch();
+    return flushed_value;
+}
+
+UploadStatistics UploadBatcher::take_statistics()
+{
+    return std::exchange(statistics, UploadStatistics{});
+}
+
+bool UploadBatcher::write_mapped(const MappedBuffer& buffer,
+                                 const VkDeviceSize offset,
+                                 const std::span<const std::byte> data)
+{
+    if (offset > buffer.size || data.size() > buffer.size - offset)
+    {
+        spdlog::warn("Upload of {} bytes at {} is out of the {} byte buffer", data.size(), offset, buffer.size);
+        return false;
+    }
+
+    std::memcpy(std::next(buffer.mapped, static_cast<std::ptrdiff_t>(offset)), data.data(), data.size());
+    if (!buffer.coherent && !data.empty())
+    {
+        // whole atoms, up to the end of the allocation when the last one passes the buffer's end
+        const auto begin = buffer.memory_offset + offset;
+        const auto flushBegin = begin / non_coherent_atom_size * non_coherent_atom_size;
+        const auto flushEnd = align_up(begin + data.size(), non_coherent_atom_size);
+        flush_ranges.push_back(VkMappedMemoryRange{.sType = VK_STRUCTURE_TYPE_MAPPED_MEMORY_RANGE,
+                                                   .memory = buffer.memory,
+                                                   .offset = flushBegin,
+                                                   .size = flushEnd > buffer.memory_offset + buffer.size
+                                                               ? VK_WHOLE_SIZE
+                                                               : flushEnd - flushBegin});
+    }
+    ++statistics.uploads;
+    ++statistics.direct_uploads;
+    statistics.bytes += data.size();
+    return true;
+}
+
+bool UploadBatcher::allocate(const VkDeviceSize size, const VkDeviceSize alignment, VkDeviceSize& offset)
+{
+    if (size > region_size)
+    {
+        spdlog::warn("Upload of {} bytes doesn't fit into the {} byte upload arena", size, region_size);
+        return false;
+    }
+
+    auto begin = align_up(head, alignment);
+    if (begin + size > region_size)
+    {
+        submit();
+        begin = 0;
+    }
+    offset = current_batch * region_size + begin;
+    head = begin + size;
+    return true;
+}
+
+void UploadBatcher::record(VkCommandBuffer command_buffer,
+                           const std::span<const StagedBufferCopy> buffer_group,
+                           const std::span<const StagedImageCopy> image_group)
+{
+    // previous reads and writes of the destinations, on this queue, are done before the copies
+    image_barriers.clear();
+    // one barrier per written mip level, the others keep their layout and contents
+    const auto sameLevel = [](const StagedImageCopy& left, const StagedImageCopy& right)
+    {
+        return left.upload.image == right.upload.image &&
+               left.upload.subresource.mipLevel == right.upload.subresource.mipLevel;
+    };
+    for (auto copy = image_group.begin(); copy != image_group.end();)
+    {
+        const auto& first = *copy;
+        const auto level = first.upload.subresource.mipLevel;
+        VkImageAspectFlags aspects = 0;
+        for (; copy != image_group.end() && sameLevel(*copy, first); ++copy)
+        {
+            aspects |= copy->upload.subresource.aspectMask;
+        }
+        image_barriers.push_back(VkImageMemoryBarrier{.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER,
+                                                      .srcAccessMask = VK_ACCESS_MEMORY_WRITE_BIT,
+                                                      .dstAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT,
+                                                      .oldLayout = first.upload.old_layout,
+                                                      .newLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+                                                      .srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+                                                      .dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+                                                      .image = first.upload.image,
+                                                      .subresourceRange = {.aspectMask = aspects,
+                                                                           .baseMipLevel = level,
+                                                                           .levelCount = 1,
+                                                                           .baseArrayLayer = 0,
+                                                                           .layerCount = VK_REMAINING_ARRAY_LAYERS}});
+    }
+    const VkMemoryBarrier before{.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER,
+                                 .srcAccessMask = VK_ACCESS_MEMORY_WRITE_BIT,
+                                 .dstAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT};
+    vkCmdPipelineBarrier(command_buffer,
+                         VK_PIPELINE_STAGE_ALL_COMMANDS_BIT,
+                         VK_PIPELINE_STAGE_TRANSFER_BIT,
+                         0,
+                         1,
+                         &before,
+                         0,
+                         nullptr,
+                         static_cast<std::uint32_t>(image_barriers.size()),
+                         image_barriers.data());
+
+    // one command per destination with all of its regions
+    for (auto copy = buffer_group.begin(); copy != buffer_group.end();)
+    {
+        const auto buffer = copy->buffer;
+        buffer_regions.clear();
+        for (; copy != buffer_group.end() && copy->buffer == buffer; ++copy)
+        {
+            buffer_regions.push_back(copy->region);
+        }
+        vkCmdCopyBuffer(
+            command_buffer, arena, buffer, static_cast<std::uint32_t>(buffer_regions.size()), buffer_regions.data());
+        ++statistics.copy_commands;
+        statistics.regions += static_cast<std::uint32_t>(buffer_regions.size());
+    }
+    for (auto copy = image_group.begin(); copy != image_group.end();)
+    {
+        const auto image = copy->upload.image;
+        image_regions.clear();
+        for (; copy != image_group.end() && copy->upload.image == image; ++copy)
+        {
+            image_regions.push_back(VkBufferImageCopy{.bufferOffset = copy->staging_offset,
+                                                      .bufferRowLength = 0,
+                                                      .bufferImageHeight = 0,
+                                                      .imageSubresource = copy->upload.subresource,
+                                                      .imageOffset = copy->upload.offset,
+                                                      .imageExtent = copy->upload.extent});
+        }
+        vkCmdCopyBufferToImage(command_buffer,
+                               arena,
+                               image,
+                               VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+                               static_cast<std::uint32_t>(image_regions.size()),
+                               image_regions.data());
+        ++statistics.copy_commands;
+        statistics.regions += static_cast<std::uint32_t>(image_regions.size());
+    }
+
+    // the data is visible to everything submitted later on this queue, including the next group
+    auto copy = image_group.begin();
+    for (auto& barrier : image_barriers)
+    {
+        barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+        barrier.dstAccessMask = VK_ACCESS_MEMORY_READ_BIT | VK_ACCESS_MEMORY_WRITE_BIT;
+        barrier.oldLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+        barrier.newLayout = copy->upload.new_layout;
+        const auto& first = *copy;
+        copy = std::find_if(copy,
+                            image_group.end(),
+                            [&first, &sameLevel](const StagedImageCopy& next) { return !sameLevel(next, first); });
+    }
+    const VkMemoryBarrier after{.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER,
+                                .srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT,
+                                .dstAccessMask = VK_ACCESS_MEMORY_READ_BIT | VK_ACCESS_MEMORY_WRITE_BIT};
+    vkCmdPipelineBarrier(command_buffer,
+                         VK_PIPELINE_STAGE_TRANSFER_BIT,
+                         VK_PIPELINE_STAGE_ALL_COMMANDS_BIT,
+                         0,
+                         1,
+                         &after,
+                         0,
+                         nullptr,
+                         static_cast<std::uint32_t>(image_barriers.size()),
+                         image_barriers.data());
+}
+
+bool UploadBatcher::copy_on_host([[maybe_unused]] const ImageUpload& upload,
+                                 [[maybe_unused]] const std::span<const std::byte> texels)
+{
+#ifdef VK_EXT_host_image_copy
+    // new_layout when the host can copy into it, GENERAL otherwise
+    auto copyLayout = upload.new_layout;
+    if (std::ranges::find(host_copy_layouts, copyLayout) == host_copy_layouts.end())
+    {
+        copyLayout = VK_IMAGE_LAYOUT_GENERAL;
+        if (std::ranges::find(host_copy_layouts, copyLayout) == host_copy_layouts.end())
+        {
+            return false;
+        }
+    }
+
+    // the first upload of a level in the batch transitions it from old_layout, the later ones find new_layout
+    const auto level = std::pair{upload.image, upload.subresource.mipLevel};
+    const bool written = std::ranges::find(host_written_levels, level) != host_written_levels.end();
+    const auto currentLayout = written ? upload.new_layout : upload.old_layout;
+    VkHostImageLayoutTransitionInfoEXT transition{.sType = VK_STRUCTURE_TYPE_HOST_IMAGE_LAYOUT_TRANSITION_INFO_EXT,
+                                                  .image = upload.image,
+                                                  .oldLayout = currentLayout,
+                                                  .newLayout = copyLayout,
+                                                  .subresourceRange = {.aspectMask = upload.subresource.aspectMask,
+                                                                       .baseMipLevel = upload.subresource.mipLevel,
+                                                                       .levelCount = 1,
+                                                                       .baseArrayLayer = 0,
+                                                                       .layerCount = VK_REMAINING_ARRAY_LAYERS}};
+    if (currentLayout != copyLayout && VK_SUCCESS != transition_image_layout(logical_device, 1, &transition))
+    {
+        return false;
+    }
+
+    const VkMemoryToImageCopyEXT region{.sType = VK_STRUCTURE_TYPE_MEMORY_TO_IMAGE_COPY_EXT,
+                                        .pHostPointer = texels.data(),
+                                        .memoryRowLength = 0,
+                                        .memoryImageHeight = 0,
+                                        .imageSubresource = upload.subresource,
+                                        .imageOffset = upload.offset,
+                                        .imageExtent = upload.extent};
+    const VkCopyMemoryToImageInfoEXT copyInfo{.sType = VK_STRUCTURE_TYPE_COPY_MEMORY_TO_IMAGE_INFO_EXT,
+                                              .dstImage = upload.image,
+                                              .dstImageLayout = copyLayout,
+                                              .regionCount = 1,
+                                              .pRegions = &region};
+    if (VK_SUCCESS != copy_memory_to_image(logical_device, &copyInfo))
+    {
+        throw std::runtime_error("Failed to copy texels to image on the host!");
+    }
+
+    transition.oldLayout = copyLayout;
+    transition.newLayout = upload.new_layout;
+    if (copyLayout != upload.new_layout && VK_SUCCESS != transition_image_layout(logical_device, 1, &transition))
+    {
+        throw std::runtime_error("Failed to transition image layout on the host!");
+    }
+    if (!written)
+    {
+        host_written_levels.push_back(level);
+    }
+    return true;
+#else
+    return false;
+#endif
+}
+
+void UploadBatcher::next_batch()
+{
+    // the region is reused once the GPU has copied out of it
+    current_batch = (current_batch + 1) % static_cast<std::uint32_t>(batches.size());
+    timeline.wait(batches[current_batch].timeline_value);
+    head = 0;
+}
+} // namespace vultex
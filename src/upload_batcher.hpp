@@ -0,0 +1,189 @@
+#pragma once
+
+#define GLFW_INCLUDE_VULKAN
+#include <GLFW/glfw3.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "queue_timeline.hpp"
+#include "vulkan_context.hpp"
+
+namespace vultex
+{
+
+// Texels of one image region, tightly packed. The mip levels a batch writes
+// go from old_layout to TRANSFER_DST_OPTIMAL and after the copies to
+// new_layout, all of their layers; the levels of a new image all start from
+// UNDEFINED.
+struct ImageUpload
+{
+    VkImage image;
+    VkImageLayout old_layout;
+    VkImageLayout new_layout;
+    VkImageSubresourceLayers subresource;
+    VkOffset3D offset;
+    VkExtent3D extent;
+    // created with UploadBatcher::image_usage(), the host may write it directly
+    bool host_transfer;
+};
+
+// Host visible memory a buffer is bound to, persistently mapped
+struct MappedBuffer
+{
+    VkBuffer buffer;
+    VkDeviceMemory memory;
+    // of the buffer in memory
+    VkDeviceSize memory_offset;
+    VkDeviceSize size;
+    // the buffer's first byte
+    std::byte* mapped;
+    // without HOST_COHERENT the written ranges are flushed by flush()
+    bool coherent;
+};
+
+// Counted since the last take_statistics(), usually once per frame
+struct UploadStatistics
+{
+    // upload_buffer() and upload_image() calls
+    std::uint32_t uploads{0};
+    // vkCmdCopyBuffer and vkCmdCopyBufferToImage, one per destination
+    std::uint32_t copy_commands{0};
+    // after adjacent buffer regions were merged
+    std::uint32_t regions{0};
+    std::uint32_t submits{0};
+    VkDeviceSize bytes{0};
+    // written in place by the host, without staging nor copy command
+    std::uint32_t direct_uploads{0};
+};
+
+// An upload copied into the staging arena, waiting for the flush. Copies of
+// a group are recorded together, groups in submission order.
+struct StagedBufferCopy
+{
+    VkBuffer buffer;
+    VkBufferCopy region;
+    std::uint32_t group;
+};
+
+struct StagedImageCopy
+{
+    ImageUpload upload;
+    VkDeviceSize staging_offset;
+    std::uint32_t group;
+};
+
+// Groups of a flush, returns their count. Buffer copies were submitted in
+// the order of their staging offsets, image copies are passed in submission
+// order. A copy overlapping one of the current group starts the next group,
+// as does an image copy giving its image other layouts. Afterwards the copies
+// are sorted by group and destination (buffer copies by offset, image copies
+// by mip level and else in submission order), buffer regions adjacent in the
+// arena and in the buffer are merged into one.
+[[nodiscard]] std::uint32_t group_buffer_copies(std::vector<StagedBufferCopy>& copies);
+[[nodiscard]] std::uint32_t group_image_copies(std::vector<StagedImageCopy>& copies);
+
+// Collects the uploads of a frame in a staging arena and submits them with
+// one command buffer. Data is copied into the persistently mapped arena right
+// away; flush() sorts the buffer uploads by destination, merges regions which
+// are adjacent in both the arena and the destination, records one copy
+// command per destination and submits once on the timeline's queue. Later
+// submissions on that queue see the data, other queues wait for the returned
+// timeline value. The arena is split into batch_count regions reused when the
+// timeline reaches their submission; when the current one is full, upload_*
+// flushes early. Uploads overlapping an earlier one of the batch, or giving an
+// image other layouts, are copied after it with a barrier in between, so the
+// later write wins.
+// With unified memory registered host visible buffers are written in place,
+// with VK_EXT_host_image_copy images created with image_usage() too: the
+// data lands immediately, the GPU must not be using the destination.
+// Not thread safe.
+class UploadBatcher
+{
+public:
+    UploadBatcher(const VulkanContext& context,
+                  QueueTimeline& timeline,
+                  VkDeviceSize arena_size,
+                  std::uint32_t batch_count);
+    UploadBatcher(const UploadBatcher&) = delete;
+    UploadBatcher(UploadBatcher&&) = delete;
+    UploadBatcher& operator=(const UploadBatcher&) = delete;
+    UploadBatcher& operator=(UploadBatcher&&) = delete;
+    ~UploadBatcher();
+
+    // Destinations of uploads belong into host visible device local memory
+    // and are registered, uploads to them skip the staging arena
+    [[nodiscard]] bool unified_memory() const;
+    void register_buffer(const MappedBuffer& buffer);
+    void unregister_buffer(VkBuffer buffer);
+    // added to the usage of images which should be written by the host
+    [[nodiscard]] VkImageUsageFlags image_usage() const;
+
+    // false when the data doesn't fit into an empty arena region, or out of
+    // the bounds of a registered buffer
+    bool upload_buffer(VkBuffer buffer, VkDeviceSize offset, std::span<const std::byte> data);
+    bool upload_image(const ImageUpload& upload, std::span<const std::byte> texels);
+
+    // timeline value the uploads are complete with, without pending uploads
+    // nothing is submitted and the value of the previous flush is returned
+    std::uint64_t flush();
+
+    [[nodiscard]] UploadStatistics take_statistics();
+
+private:
+    struct Batch
+    {
+        VkCommandPool command_pool;
+        VkCommandBuffer command_buffer;
+        std::uint64_t timeline_value;
+    };
+
+    [[nodiscard]] bool write_mapped(const MappedBuffer& buffer, VkDeviceSize offset, std::span<const std::byte> data);
+    // flush() without ending the batch of host writes, timeline value of the copies
+    std::uint64_t submit();
+    // arena offset of size bytes, submits when the current region is full
+    [[nodiscard]] bool allocate(VkDeviceSize size, VkDeviceSize alignment, VkDeviceSize& offset);
+    void record(VkCommandBuffer command_buffer,
+                std::span<const StagedBufferCopy> buffer_group,
+                std::span<const StagedImageCopy> image_group);
+    void next_batch();
+    // false when the device can't copy into a layout on the host
+    [[nodiscard]] bool copy_on_host(const ImageUpload& upload, std::span<const std::byte> texels);
+
+    VkDevice logical_device{nullptr};
+    QueueTimeline& timeline;
+    bool unified{false};
+#ifdef VK_EXT_host_image_copy
+    PFN_vkCopyMemoryToImageEXT copy_memory_to_image{nullptr};
+    PFN_vkTransitionImageLayoutEXT transition_image_layout{nullptr};
+#endif
+    // layouts the host can copy into, empty without host image copy
+    std::vector<VkImageLayout> host_copy_layouts{};
+    // mip levels written on the host in this batch, they are in new_layout
+    std::vector<std::pair<VkImage, std::uint32_t>> host_written_levels{};
+    std::unordered_map<VkBuffer, MappedBuffer> mapped_buffers{};
+    // host writes to non coherent memory, flushed with the next flush()
+    std::vector<VkMappedMemoryRange> flush_ranges{};
+    VkDeviceSize non_coherent_atom_size{1};
+    VkBuffer arena{nullptr};
+    VkDeviceMemory memory{nullptr};
+    std::byte* mapped{nullptr};
+    VkDeviceSize region_size{0};
+    VkDeviceSize image_alignment{16};
+    std::vector<Batch> batches{};
+    std::uint32_t current_batch{0};
+    VkDeviceSize head{0};
+    std::uint64_t flushed_value{0};
+    std::vector<StagedBufferCopy> buffer_copies{};
+    std::vector<StagedImageCopy> image_copies{};
+    // reused by record(), no allocation per flush once they have grown
+    std::vector<VkBufferCopy> buffer_regions{};
+    std::vector<VkBufferImageCopy> image_regions{};
+    std::vector<VkImageMemoryBarrier> image_barriers{};
+    UploadStatistics statistics{};
+};
+} // namespace vultex
@@ -0,0 +1,136 @@
+#include "upload_batcher.hpp"
+
+#include <algorithm>
+#include <bit>
+#include <cstdint>
+#include <gtest/gtest.h>
+#include <vector>
+
+namespace vultex
+{
+namespace
+{
+template <typename Handle>
+Handle handle(const std::uint64_t value)
+{
+    return std::bit_cast<Handle>(value);
+}
+
+StagedBufferCopy buffer_copy(const VkBuffer buffer,
+                             const VkDeviceSize staging_offset,
+                             const VkDeviceSize offset,
+                             const VkDeviceSize size)
+{
+    return StagedBufferCopy{
+        .buffer = buffer, .region = {.srcOffset = staging_offset, .dstOffset = offset, .size = size}, .group = 0};
+}
+
+StagedImageCopy image_copy(const VkImage image,
+                           const std::uint32_t level,
+                           const VkImageLayout old_layout,
+                           const VkDeviceSize staging_offset)
+{
+    const ImageUpload upload{.image = image,
+                             .old_layout = old_layout,
+                             .new_layout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
+                             .subresource = {.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT,
+                                             .mipLevel = level,
+                                             .baseArrayLayer = 0,
+                                             .layerCount = 1},
+                             .offset = {0, 0, 0},
+                             .extent = {.width = 64U >> level, .height = 64U >> level, .depth = 1},
+                             .host_transfer = false};
+    return StagedImageCopy{.upload = upload, .staging_offset = staging_offset, .group = 0};
+}
+
+TEST(UploadBatcher, MergesRegionsAdjacentInArenaAndBuffer)
+{
+    const auto buffer = handle<VkBuffer>(1);
+    const auto other = handle<VkBuffer>(2);
+    std::vector<StagedBufferCopy> copies = {buffer_copy(buffer, 0, 256, 64),
+                                            buffer_copy(other, 64, 0, 16),
+                                            buffer_copy(buffer, 80, 320, 32),
+                                            buffer_copy(buffer, 112, 352, 16),
+                                            // adjacent in the buffer only
+                                            buffer_copy(buffer, 256, 368, 8)};
+
+    ASSERT_EQ(group_buffer_copies(copies), 1U);
+    ASSERT_EQ(copies.size(), 4U);
+    const auto find = [&copies](const VkBuffer target, const VkDeviceSize offset)
+    {
+        return std::ranges::find_if(copies,
+                                    [&](const StagedBufferCopy& copy)
+                                    { return copy.buffer == target && copy.region.dstOffset == offset; });
+    };
+    ASSERT_NE(find(buffer, 256), copies.end());
+    EXPECT_EQ(find(buffer, 256)->region.size, 64U);
+    ASSERT_NE(find(buffer, 320), copies.end());
+    EXPECT_EQ(find(buffer, 320)->region.srcOffset, 80U);
+    EXPECT_EQ(find(buffer, 320)->region.size, 48U);
+    ASSERT_NE(find(buffer, 368), copies.end());
+    EXPECT_EQ(find(buffer, 368)->region.size, 8U);
+    ASSERT_NE(find(other, 0), copies.end());
+    for (const auto& copy : copies)
+    {
+        EXPECT_EQ(copy.group, 0U);
+    }
+}
+
+TEST(UploadBatcher, OverlappingWritesKeepSubmissionOrder)
+{
+    const auto buffer = handle<VkBuffer>(1);
+    // staged in this order: the second and third write over the first, the third over the second
+    std::vector<StagedBufferCopy> copies = {buffer_copy(buffer, 256, 32, 16),
+                                            buffer_copy(buffer, 0, 0, 64),
+                                            buffer_copy(buffer, 128, 48, 32),
+                                            buffer_copy(buffer, 64, 16, 32)};
+
+    ASSERT_EQ(group_buffer_copies(copies), 3U);
+    ASSERT_EQ(copies.size(), 4U);
+    // sorted by group, each later write in a later group
+    EXPECT_EQ(copies[0].region.srcOffset, 0U);
+    EXPECT_EQ(copies[0].group, 0U);
+    EXPECT_EQ(copies[1].region.srcOffset, 64U);
+    EXPECT_EQ(copies[1].group, 1U);
+    // no overlap with the second write, recorded together with it
+    EXPECT_EQ(copies[2].region.srcOffset, 128U);
+    EXPECT_EQ(copies[2].group, 1U);
+    EXPECT_EQ(copies[3].region.srcOffset, 256U);
+    EXPECT_EQ(copies[3].group, 2U);
+}
+
+TEST(UploadBatcher, GroupsImageCopiesByLevelAndLayout)
+{
+    const auto image = handle<VkImage>(1);
+    const auto other = handle<VkImage>(2);
+    // a new texture: every level from UNDEFINED, the levels in any order
+    std::vector<StagedImageCopy> copies = {image_copy(image, 2, VK_IMAGE_LAYOUT_UNDEFINED, 0),
+                                           image_copy(other, 0, VK_IMAGE_LAYOUT_UNDEFINED, 64),
+                                           image_copy(image, 0, VK_IMAGE_LAYOUT_UNDEFINED, 128),
+                                           image_copy(image, 1, VK_IMAGE_LAYOUT_UNDEFINED, 192)};
+
+    ASSERT_EQ(group_image_copies(copies), 1U);
+    ASSERT_EQ(copies.size(), 4U);
+    // images in handle order, the levels of one image in level order
+    for (std::uint32_t level = 0; level < 3; ++level)
+    {
+        EXPECT_EQ(copies[level].upload.image, image);
+        EXPECT_EQ(copies[level].upload.subresource.mipLevel, level);
+    }
+    EXPECT_EQ(copies[3].upload.image, other);
+
+    // an update of level 0 after it was uploaded comes from another layout
+    copies = {image_copy(image, 0, VK_IMAGE_LAYOUT_UNDEFINED, 0),
+              image_copy(image, 1, VK_IMAGE_LAYOUT_UNDEFINED, 64),
+              image_copy(image, 0, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, 128),
+              image_copy(other, 0, VK_IMAGE_LAYOUT_UNDEFINED, 192)};
+    ASSERT_EQ(group_image_copies(copies), 2U);
+    EXPECT_EQ(copies[0].group, 0U);
+    EXPECT_EQ(copies[1].group, 0U);
+    EXPECT_EQ(copies[2].group, 1U);
+    EXPECT_EQ(copies[2].staging_offset, 128U);
+    EXPECT_EQ(copies[3].group, 1U);
+    EXPECT_EQ(copies[3].upload.image, other);
+}
+} // namespace
+} // namespace vultex
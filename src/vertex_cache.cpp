@@ -0,0 +1,244 @@
+#include "vertex_cache.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <limits>
+
+namespace vultex
+{
+namespace
+{
+// Simulated LRU cache size and score weights from Forsyth's paper
+constexpr std::size_t forsyth_cache_size = 32;
+constexpr float cache_decay_power = 1.5F;
+constexpr float last_triangle_score = 0.75F;
+constexpr float valence_boost_scale = 2.0F;
+constexpr float valence_boost_power = 0.5F;
+
+constexpr auto no_triangle = std::numeric_limits<std::uint32_t>::max();
+
+// a repeated corner, the triangle draws nothing
+[[nodiscard]] bool is_degenerate(std::span<const std::uint32_t> indices, const std::size_t triangle)
+{
+    const auto first = indices[triangle * 3];
+    const auto second = indices[triangle * 3 + 1];
+    const auto third = indices[triangle * 3 + 2];
+    return first == second || second == third || first == third;
+}
+
+[[nodiscard]] float vertex_score(const int cache_position, const std::uint32_t remaining_triangles)
+{
+    if (0 == remaining_triangles)
+    {
+        return -1.0F;
+    }
+
+    auto score = 0.0F;
+    if (cache_position >= 0)
+    {
+        // the vertices of the last triangle get a fixed score, so its neighbours don't win by default
+        score = cache_position < 3 ? last_triangle_score
+                                   : std::pow(1.0F - static_cast<float>(cache_position - 3) /
+                                                         static_cast<float>(forsyth_cache_size - 3),
+                                              cache_decay_power);
+    }
+
+    // vertices with few triangles left are finished first, otherwise they end up alone later
+    return score +
+           valence_boost_scale * std::pow(static_cast<float>(remaining_triangles), -valence_boost_power);
+}
+} // namespace
+
+void optimize_vertex_cache(std::span<std::uint32_t> indices, const std::size_t vertex_count)
+{
+    const auto triangleCount = indices.size() / 3;
+    if (0 == triangleCount)
+    {
+        return;
+    }
+
+    // degenerate triangles would be listed twice around their repeated vertex,
+    // they stay out of the adjacency and are appended last
+    std::vector<bool> emitted(triangleCount, false);
+    std::size_t degenerateCount = 0;
+    for (std::size_t triangle = 0; triangle < triangleCount; ++triangle)
+    {
+        if (is_degenerate(indices, triangle))
+        {
+            emitted[triangle] = true;
+            ++degenerateCount;
+        }
+    }
+
+    // triangles around every vertex, the not yet emitted ones first
+    std::vector<std::uint32_t> offsets(vertex_count + 1, 0);
+    for (std::size_t index = 0; index < indices.size(); ++index)
+    {
+        if (!emitted[index / 3])
+        {
+            ++offsets[indices[index] + 1];
+        }
+    }
+    for (std::size_t vertex = 0; vertex < vertex_count; ++vertex)
+    {
+        offsets[vertex + 1] += offsets[vertex];
+    }
+    std::vector<std::uint32_t> remaining(vertex_count);
+    std::vector<std::uint32_t> vertexTriangles(offsets.back());
+    for (std::size_t index = 0; index < indices.size(); ++index)
+    {
+        if (!emitted[index / 3])
+        {
+            const auto vertex = indices[index];
+            vertexTriangles[offsets[vertex] + remaining[vertex]++] = static_cast<std::uint32_t>(index / 3);
+        }
+    }
+
+    std::vector<int> cachePosition(vertex_count, -1);
+    std::vector<float> vertexScores(vertex_count);
+    for (std::size_t vertex = 0; vertex < vertex_count; ++vertex)
+    {
+        vertexScores[vertex] = vertex_score(-1, remaining[vertex]);
+    }
+
+    std::vector<float> triangleScores(triangleCount);
+    auto best = no_triangle;
+    for (std::size_t triangle = 0; triangle < triangleCount; ++triangle)
+    {
+        if (emitted[triangle])
+        {
+            continue;
+        }
+        triangleScores[triangle] = vertexScores[indices[triangle * 3]] + vertexScores[indices[triangle * 3 + 1]] +
+                                   vertexScores[indices[triangle * 3 + 2]];
+        if (no_triangle == best || triangleScores[triangle] > triangleScores[best])
+        {
+            best = static_cast<std::uint32_t>(triangle);
+        }
+    }
+
+    std::vector<std::uint32_t> output(indices.size());
+    std::vector<std::uint32_t> cache{};
+    std::vector<std::uint32_t> nextCache{};
+    std::size_t scanCursor = 0;
+    for (std::size_t written = 0; written < triangleCount - degenerateCount; ++written)
+    {
+        // nothing in the cache has triangles left, continue with the first unfinished one
+        if (no_triangle == best)
+        {
+            while (emitted[scanCursor])
+            {
+                ++scanCursor;
+            }
+            best = static_cast<std::uint32_t>(scanCursor);
+        }
+
+        const std::array corners{indices[best * 3], indices[best * 3 + 1], indices[best * 3 + 2]};
+        std::ranges::copy(corners, std::next(output.begin(), static_cast<std::ptrdiff_t>(written * 3)));
+        emitted[best] = true;
+
+        for (const auto vertex : corners)
+        {
+            const auto first = std::next(vertexTriangles.begin(), offsets[vertex]);
+            const auto last = std::next(first, remaining[vertex]);
+            std::iter_swap(std::find(first, last, best), std::prev(last));
+            --remaining[vertex];
+        }
+
+        // the emitted triangle moves to the front of the LRU cache
+        nextCache.assign(corners.begin(), corners.end());
+        for (const auto vertex : cache)
+        {
+            if (std::ranges::find(corners, vertex) == corners.end())
+            {
+                nextCache.push_back(vertex);
+            }
+        }
+        for (std::size_t position = 0; position < nextCache.size(); ++position)
+        {
+            const auto vertex = nextCache[position];
+            cachePosition[vertex] = position < forsyth_cache_size ? static_cast<int>(position) : -1;
+            vertexScores[vertex] = vertex_score(cachePosition[vertex], remaining[vertex]);
+        }
+
+        // only triangles of vertices whose score changed can become the best one
+        best = no_triangle;
+        for (const auto vertex : nextCache)
+        {
+            for (std::uint32_t slot = 0; slot < remaining[vertex]; ++slot)
+            {
+                const auto triangle = vertexTriangles[offsets[vertex] + slot];
+                triangleScores[triangle] = vertexScores[indices[triangle * 3]] +
+                                           vertexScores[indices[triangle * 3 + 1]] +
+                                           vertexScores[indices[triangle * 3 + 2]];
+                if (no_triangle == best || triangleScores[triangle] > triangleScores[best])
+                {
+                    best = triangle;
+                }
+            }
+        }
+
+        nextCache.resize(std::min(nextCache.size(), forsyth_cache_size));
+        std::swap(cache, nextCache);
+    }
+
+    // degenerate triangles in their original order
+    auto written = triangleCount - degenerateCount;
+    for (std::size_t triangle = 0; degenerateCount > 0 && triangle < triangleCount; ++triangle)
+    {
+        if (is_degenerate(indices, triangle))
+        {
+            const auto corners = indices.subspan(triangle * 3, 3);
+            std::ranges::copy(corners, std::next(output.begin(), static_cast<std::ptrdiff_t>(written++ * 3)));
+        }
+    }
+
+    std::ranges::copy(output, indices.begin());
+}
+
+std::vector<std::uint32_t> vertex_fetch_remap(std::span<const std::uint32_t> indices, const std::size_t vertex_count)
+{
+    constexpr auto unused = std::numeric_limits<std::uint32_t>::max();
+
+    std::vector<std::uint32_t> remap(vertex_count, unused);
+    std::uint32_t next = 0;
+    for (const auto index : indices)
+    {
+        if (unused == remap[index])
+        {
+            remap[index] = next++;
+        }
+    }
+    for (auto& index : remap)
+    {
+        if (unused == index)
+        {
+            index = next++;
+        }
+    }
+    return remap;
+}
+
+float average_cache_miss_ratio(std::span<const std::uint32_t> indices,
+                               const std::size_t vertex_count,
+                               const std::uint32_t cache_size)
+{
+    if (indices.size() < 3)
+    {
+        return 0.0F;
+    }
+
+    // FIFO like the post transform caches of most GPUs, an entry knows when it was pushed
+    std::vector<std::uint64_t> pushedAt(vertex_count, 0);
+    std::uint64_t pushes = 0;
+    for (const auto index : indices)
+    {
+        if (0 == pushedAt[index] || pushes - pushedAt[index] >= cache_size)
+        {
+            pushedAt[index] = ++pushes;
+        }
+    }
+    return static_cast<float>(pushes) / static_cast<float>(indices.size() / 3);
+}
+} // namespace vultex
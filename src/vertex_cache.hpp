@@ -0,0 +1,27 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+namespace vultex
+{
+
+// Reorders the triangles of an indexed triangle list with Forsyth's linear
+// speed algorithm, so consecutive triangles reuse the vertices still in the
+// post transform cache. The triangles themselves and their winding stay,
+// degenerate ones (a repeated corner) are moved to the end.
+void optimize_vertex_cache(std::span<std::uint32_t> indices, std::size_t vertex_count);
+
+// New index of every vertex, numbered in order of first use by indices so
+// the vertex fetch walks the buffer forward. Unused vertices go to the end.
+[[nodiscard]] std::vector<std::uint32_t> vertex_fetch_remap(std::span<const std::uint32_t> indices,
+                                                            std::size_t vertex_count);
+
+// Vertices transformed per triangle with a FIFO cache of cache_size entries:
+// 3 without any reuse, about 0.5 for an ideal order of a regular grid.
+[[nodiscard]] float average_cache_miss_ratio(std::span<const std::uint32_t> indices,
+                                             std::size_t vertex_count,
+                                             std::uint32_t cache_size = 32);
+} // namespace vultex
@@ -0,0 +1,106 @@
+#include "vertex_cache.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <gtest/gtest.h>
+#include <random>
+#include <vector>
+
+namespace vultex
+{
+namespace
+{
+using Triangle = std::array<std::uint32_t, 3>;
+
+// triangles with their winding, rotated to start at the smallest index
+std::vector<Triangle> sorted_triangles(const std::vector<std::uint32_t>& indices)
+{
+    std::vector<Triangle> triangles{};
+    for (std::size_t first = 0; first + 2 < indices.size(); first += 3)
+    {
+        Triangle triangle{indices[first], indices[first + 1], indices[first + 2]};
+        std::ranges::rotate(triangle, std::ranges::min_element(triangle));
+        triangles.push_back(triangle);
+    }
+    std::ranges::sort(triangles);
+    return triangles;
+}
+
+// cells x cells quads with their triangles shuffled
+std::vector<std::uint32_t> shuffled_grid(const std::uint32_t cells)
+{
+    const auto side = cells + 1;
+    std::vector<Triangle> triangles{};
+    for (std::uint32_t row = 0; row < cells; ++row)
+    {
+        for (std::uint32_t column = 0; column < cells; ++column)
+        {
+            const auto corner = row * side + column;
+            triangles.push_back({corner, corner + 1, corner + side + 1});
+            triangles.push_back({corner, corner + side + 1, corner + side});
+        }
+    }
+    std::ranges::shuffle(triangles, std::mt19937{3});
+
+    std::vector<std::uint32_t> indices{};
+    for (const auto& triangle : triangles)
+    {
+        indices.insert(indices.end(), triangle.begin(), triangle.end());
+    }
+    return indices;
+}
+
+TEST(VertexCache, KeepsEveryTriangleAndItsWinding)
+{
+    const auto cells = 32U;
+    const auto original = shuffled_grid(cells);
+    auto indices = original;
+    optimize_vertex_cache(indices, (cells + 1) * (cells + 1));
+    EXPECT_EQ(sorted_triangles(indices), sorted_triangles(original));
+}
+
+TEST(VertexCache, LowersTheMissRatio)
+{
+    const auto cells = 64U;
+    const auto vertexCount = (cells + 1) * (cells + 1);
+    auto indices = shuffled_grid(cells);
+    const auto before = average_cache_miss_ratio(indices, vertexCount);
+    optimize_vertex_cache(indices, vertexCount);
+    const auto after = average_cache_miss_ratio(indices, vertexCount);
+
+    EXPECT_GT(before, 2.0F);
+    EXPECT_LT(after, 0.8F);
+}
+
+TEST(VertexCache, DegenerateTrianglesGoLastInTheirOrder)
+{
+    std::vector<std::uint32_t> indices{0, 0, 1, 0, 1, 2, 5, 5, 5, 1, 3, 2, 4, 2, 4};
+    optimize_vertex_cache(indices, 6);
+
+    ASSERT_EQ(indices.size(), 15U);
+    EXPECT_EQ(sorted_triangles({indices.begin(), indices.begin() + 6}), sorted_triangles({0, 1, 2, 1, 3, 2}));
+    EXPECT_EQ((std::vector<std::uint32_t>{indices.begin() + 6, indices.end()}),
+              (std::vector<std::uint32_t>{0, 0, 1, 5, 5, 5, 4, 2, 4}));
+}
+
+TEST(VertexCache, FetchRemapNumbersVerticesByFirstUse)
+{
+    const std::vector<std::uint32_t> indices{4, 2, 0, 2, 4, 5};
+    const auto remap = vertex_fetch_remap(indices, 7);
+
+    ASSERT_EQ(remap.size(), 7U);
+    EXPECT_EQ(remap[4], 0U);
+    EXPECT_EQ(remap[2], 1U);
+    EXPECT_EQ(remap[0], 2U);
+    EXPECT_EQ(remap[5], 3U);
+    // unused vertices go to the end, the remap stays a permutation
+    auto sorted = remap;
+    std::ranges::sort(sorted);
+    EXPECT_EQ(sorted, (std::vector<std::uint32_t>{0, 1, 2, 3, 4, 5, 6}));
+    EXPECT_GE(remap[1], 4U);
+    EXPECT_GE(remap[3], 4U);
+    EXPECT_GE(remap[6], 4U);
+}
+} // namespace
+} // namespace vultex
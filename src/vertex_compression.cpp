@@ -0,0 +1,112 @@
+#include "vertex_compression.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <glm/gtc/packing.hpp>
+
+namespace vultex
+{
+namespace
+{
+[[nodiscard]] float sign_not_zero(const float value)
+{
+    return value >= 0.0F ? 1.0F : -1.0F;
+}
+
+[[nodiscard]] std::uint16_t to_unorm16(const float value)
+{
+    return static_cast<std::uint16_t>(std::lround(std::clamp(value, 0.0F, 1.0F) * 65535.0F));
+}
+
+[[nodiscard]] std::int16_t to_snorm16(const float value)
+{
+    return static_cast<std::int16_t>(std::lround(std::clamp(value, -1.0F, 1.0F) * 32767.0F));
+}
+
+[[nodiscard]] std::array<std::int16_t, 2> pack_direction(const glm::vec3& direction)
+{
+    const auto encoded = octahedral_encode(direction);
+    return {to_snorm16(encoded.x), to_snorm16(encoded.y)};
+}
+} // namespace
+
+VertexQuantization VertexQuantization::from_bounds(const glm::vec3& lower, const glm::vec3& upper)
+{
+    return VertexQuantization{.offset = lower, .scale = upper - lower};
+}
+
+glm::vec2 octahedral_encode(const glm::vec3& direction)
+{
+    const auto sum = std::abs(direction.x) + std::abs(direction.y) + std::abs(direction.z);
+    if (0.0F == sum)
+    {
+        return glm::vec2{0.0F, 0.0F};
+    }
+
+    const glm::vec2 projected{direction.x / sum, direction.y / sum};
+    if (direction.z >= 0.0F)
+    {
+        return projected;
+    }
+    // the lower half folds over the diagonals
+    return glm::vec2{(1.0F - std::abs(projected.y)) * sign_not_zero(projected.x),
+                     (1.0F - std::abs(projected.x)) * sign_not_zero(projected.y)};
+}
+
+glm::vec3 octahedral_decode(const glm::vec2& encoded)
+{
+    glm::vec3 direction{encoded.x, encoded.y, 1.0F - std::abs(encoded.x) - std::abs(encoded.y)};
+    const auto fold = std::max(-direction.z, 0.0F);
+    direction.x -= fold * sign_not_zero(direction.x);
+    direction.y -= fold * sign_not_zero(direction.y);
+    return glm::normalize(direction);
+}
+
+PackedVertex pack_vertex(const VertexQuantization& quantization,
+                         const glm::vec3& position,
+                         const glm::vec3& normal,
+                         const glm::vec4& tangent,
+                         const glm::vec2& uv)
+{
+    PackedVertex vertex{};
+    for (int axis = 0; axis < 3; ++axis)
+    {
+        // a flat axis has a zero scale, every value on it is the offset
+        vertex.position[static_cast<std::size_t>(axis)] =
+            quantization.scale[axis] > 0.0F
+                ? to_unorm16((position[axis] - quantization.offset[axis]) / quantization.scale[axis])
+                : 0;
+    }
+    vertex.position[3] = tangent.w < 0.0F ? 0 : 65535;
+    vertex.normal = pack_direction(normal);
+    vertex.tangent = pack_direction(glm::vec3{tangent.x, tangent.y, tangent.z});
+
+    const auto halves = glm::packHalf2x16(uv);
+    vertex.uv = {static_cast<std::uint16_t>(halves & 0xFFFFU), static_cast<std::uint16_t>(halves >> 16U)};
+    return vertex;
+}
+
+PackedVertexInput packed_vertex_input(const std::uint32_t binding)
+{
+    // all four formats are mandatory for vertex buffers in Vulkan 1.0
+    return PackedVertexInput{
+        .binding = {.binding = binding, .stride = sizeof(PackedVertex), .inputRate = VK_VERTEX_INPUT_RATE_VERTEX},
+        .attributes = {VkVertexInputAttributeDescription{.location = 0,
+                                                         .binding = binding,
+                                                         .format = VK_FORMAT_R16G16B16A16_UNORM,
+                                                         .offset = offsetof(PackedVertex, position)},
+                       VkVertexInputAttributeDescription{.location = 1,
+                                                         .binding = binding,
+                                                         .format = VK_FORMAT_R16G16_SNORM,
+                                                         .offset = offsetof(PackedVertex, normal)},
+                       VkVertexInputAttributeDescription{.location = 2,
+                                                         .binding = binding,
+                                                         .format = VK_FORMAT_R16G16_SNORM,
+                                                         .offset = offsetof(PackedVertex, tangent)},
+                       VkVertexInputAttributeDescription{.location = 3,
+                                                         .binding = binding,
+                                                         .format = VK_FORMAT_R16G16_SFLOAT,
+                                                         .offset = offsetof(PackedVertex, uv)}}};
+}
+} // namespace vultex
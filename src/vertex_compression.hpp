@@ -0,0 +1,59 @@
+#pragma once
+
+#define GLFW_INCLUDE_VULKAN
+#include <GLFW/glfw3.h>
+
+#include <array>
+#include <cstdint>
+#include <glm/glm.hpp>
+
+namespace vultex
+{
+
+// 20 bytes per vertex instead of 48 for float positions, normals, tangents
+// and texture coordinates. Every attribute is read by the fixed function
+// vertex fetch, the vertex shader only has to dequantize the position and
+// decode both octahedral directions.
+struct PackedVertex
+{
+    // unorm16 within the mesh bounds, w is 1 for a positive bitangent sign and 0 for a negative one
+    std::array<std::uint16_t, 4> position;
+    // octahedral snorm16
+    std::array<std::int16_t, 2> normal;
+    std::array<std::int16_t, 2> tangent;
+    // half float
+    std::array<std::uint16_t, 2> uv;
+};
+
+static_assert(sizeof(PackedVertex) == 20);
+
+// object space position = offset + scale * unorm16 position
+struct VertexQuantization
+{
+    glm::vec3 offset;
+    glm::vec3 scale;
+
+    [[nodiscard]] static VertexQuantization from_bounds(const glm::vec3& lower, const glm::vec3& upper);
+};
+
+// unit direction onto the octahedron unfolded into [-1, 1]^2
+[[nodiscard]] glm::vec2 octahedral_encode(const glm::vec3& direction);
+[[nodiscard]] glm::vec3 octahedral_decode(const glm::vec2& encoded);
+
+// tangent.w is the bitangent sign, as in cross(normal, tangent.xyz) * tangent.w
+[[nodiscard]] PackedVertex pack_vertex(const VertexQuantization& quantization,
+                                       const glm::vec3& position,
+                                       const glm::vec3& normal,
+                                       const glm::vec4& tangent,
+                                       const glm::vec2& uv);
+
+// Vertex input of a pipeline reading PackedVertex, locations 0 to 3 are
+// position, normal, tangent and uv in the order of the struct.
+struct PackedVertexInput
+{
+    VkVertexInputBindingDescription binding;
+    std::array<VkVertexInputAttributeDescription, 4> attributes;
+};
+
+[[nodiscard]] PackedVertexInput packed_vertex_input(std::uint32_t binding);
+} // namespace vultex
@@ -0,0 +1,192 @@
+#include "vertex_compression.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <glm/gtc/packing.hpp>
+#include <gtest/gtest.h>
+#include <vector>
+
+namespace vultex
+{
+namespace
+{
+// what the vertex fetch and mesh.vert make of a PackedVertex
+glm::vec3 decode_position(const VertexQuantization& quantization, const PackedVertex& vertex)
+{
+    glm::vec3 position{};
+    for (int axis = 0; axis < 3; ++axis)
+    {
+        const auto unorm = static_cast<float>(vertex.position[static_cast<std::size_t>(axis)]) / 65535.0F;
+        position[axis] = quantization.offset[axis] + quantization.scale[axis] * unorm;
+    }
+    return position;
+}
+
+glm::vec3 decode_direction(const std::array<std::int16_t, 2>& packed)
+{
+    return octahedral_decode(glm::vec2{std::max(static_cast<float>(packed[0]) / 32767.0F, -1.0F),
+                                       std::max(static_cast<float>(packed[1]) / 32767.0F, -1.0F)});
+}
+
+// the axes, the octant diagonals, directions on the folds and a spiral over the sphere
+std::vector<glm::vec3> test_directions()
+{
+    std::vector<glm::vec3> directions{glm::vec3{1.0F, 0.0F, 0.0F},  glm::vec3{-1.0F, 0.0F, 0.0F},
+                                      glm::vec3{0.0F, 1.0F, 0.0F},  glm::vec3{0.0F, -1.0F, 0.0F},
+                                      glm::vec3{0.0F, 0.0F, 1.0F},  glm::vec3{0.0F, 0.0F, -1.0F},
+                                      glm::vec3{1.0F, 1.0F, 0.0F},  glm::vec3{-1.0F, 0.0F, -1.0F},
+                                      glm::vec3{0.0F, -1.0F, -1.0F}};
+    for (const auto x : {-1.0F, 1.0F})
+    {
+        for (const auto y : {-1.0F, 1.0F})
+        {
+            for (const auto z : {-1.0F, 1.0F})
+            {
+                directions.emplace_back(x, y, z);
+            }
+        }
+    }
+    constexpr int spiral = 2000;
+    for (int index = 0; index < spiral; ++index)
+    {
+        const auto z = 1.0F - 2.0F * (static_cast<float>(index) + 0.5F) / spiral;
+        const auto radius = std::sqrt(1.0F - z * z);
+        const auto angle = 2.39996323F * static_cast<float>(index);
+        directions.emplace_back(radius * std::cos(angle), radius * std::sin(angle), z);
+    }
+    for (auto& direction : directions)
+    {
+        direction = glm::normalize(direction);
+    }
+    return directions;
+}
+
+TEST(VertexCompression, OctahedralEncodingRoundTrips)
+{
+    for (const auto& direction : test_directions())
+    {
+        const auto encoded = octahedral_encode(direction);
+        // the upper half maps inside the diamond |x| + |y| <= 1, the lower one onto the corners of the square
+        EXPECT_LE(std::max(std::abs(encoded.x), std::abs(encoded.y)), 1.0F);
+        if (direction.z > 0.0F)
+        {
+            EXPECT_LE(std::abs(encoded.x) + std::abs(encoded.y), 1.0F + 1e-6F) << direction.z;
+        }
+        EXPECT_GT(glm::dot(octahedral_decode(encoded), direction), 0.99999F)
+            << direction.x << " " << direction.y << " " << direction.z;
+    }
+}
+
+TEST(VertexCompression, PackedDirectionsStayWithinSnorm16Precision)
+{
+    // 16 bit octahedral directions are accurate to a few hundredths of a degree
+    const auto maxAngle = 0.0005F;
+    const VertexQuantization quantization{.offset = glm::vec3{0.0F}, .scale = glm::vec3{1.0F}};
+    for (const auto& direction : test_directions())
+    {
+        const auto vertex =
+            pack_vertex(quantization, glm::vec3{0.0F}, direction, glm::vec4{direction, 1.0F}, glm::vec2{0.0F});
+        const auto normalAngle = std::acos(std::min(glm::dot(decode_direction(vertex.normal), direction), 1.0F));
+        const auto tangentAngle = std::acos(std::min(glm::dot(decode_direction(vertex.tangent), direction), 1.0F));
+        EXPECT_LT(normalAngle, maxAngle) << direction.x << " " << direction.y << " " << direction.z;
+        EXPECT_LT(tangentAngle, maxAngle) << direction.x << " " << direction.y << " " << direction.z;
+    }
+}
+
+TEST(VertexCompression, PositionsQuantizeWithinHalfAStep)
+{
+    const glm::vec3 lower{-2.0F, 0.5F, -100.0F};
+    const glm::vec3 upper{3.0F, 0.75F, 100.0F};
+    const auto quantization = VertexQuantization::from_bounds(lower, upper);
+    const glm::vec3 up{0.0F, 0.0F, 1.0F};
+
+    EXPECT_EQ(pack_vertex(quantization, lower, up, glm::vec4{1.0F}, glm::vec2{0.0F}).position,
+              (std::array<std::uint16_t, 4>{0, 0, 0, 65535}));
+    EXPECT_EQ(pack_vertex(quantization, upper, up, glm::vec4{1.0F}, glm::vec2{0.0F}).position,
+              (std::array<std::uint16_t, 4>{65535, 65535, 65535, 65535}));
+
+    for (int step = 0; step <= 100; ++step)
+    {
+        const auto t = static_cast<float>(step) / 100.0F;
+        const glm::vec3 position{lower.x + t * (upper.x - lower.x),
+                                 lower.y + (1.0F - t) * (upper.y - lower.y),
+                                 lower.z + t * t * (upper.z - lower.z)};
+        const auto vertex = pack_vertex(quantization, position, up, glm::vec4{1.0F}, glm::vec2{0.0F});
+        const auto decoded = decode_position(quantization, vertex);
+        for (int axis = 0; axis < 3; ++axis)
+        {
+            // half a unorm16 step plus float rounding
+            EXPECT_LE(std::abs(decoded[axis] - position[axis]), quantization.scale[axis] / 65535.0F * 0.51F)
+                << "axis " << axis << " at " << t;
+        }
+    }
+}
+
+TEST(VertexCompression, FlatAxisDecodesToTheOffset)
+{
+    const auto quantization = VertexQuantization::from_bounds(glm::vec3{0.0F, 4.0F, 0.0F}, glm::vec3{1.0F, 4.0F, 1.0F});
+    const auto vertex = pack_vertex(
+        quantization, glm::vec3{0.5F, 4.0F, 0.25F}, glm::vec3{0.0F, 1.0F, 0.0F}, glm::vec4{1.0F}, glm::vec2{0.0F});
+    EXPECT_EQ(vertex.position[1], 0);
+    EXPECT_EQ(decode_position(quantization, vertex).y, 4.0F);
+}
+
+TEST(VertexCompression, BitangentSignGoesToPositionW)
+{
+    const VertexQuantization quantization{.offset = glm::vec3{0.0F}, .scale = glm::vec3{1.0F}};
+    const glm::vec3 origin{0.0F};
+    const glm::vec3 normal{0.0F, 0.0F, 1.0F};
+    const glm::vec2 uv{0.0F};
+    EXPECT_EQ(pack_vertex(quantization, origin, normal, glm::vec4{1.0F, 0.0F, 0.0F, 1.0F}, uv).position[3], 65535);
+    EXPECT_EQ(pack_vertex(quantization, origin, normal, glm::vec4{1.0F, 0.0F, 0.0F, -1.0F}, uv).position[3], 0);
+}
+
+TEST(VertexCompression, UvsRoundTripThroughHalfFloats)
+{
+    const VertexQuantization quantization{.offset = glm::vec3{0.0F}, .scale = glm::vec3{1.0F}};
+    const glm::vec3 origin{0.0F};
+    const glm::vec3 normal{0.0F, 0.0F, 1.0F};
+    for (const auto& uv : {glm::vec2{0.0F, 1.0F}, glm::vec2{0.5F, 0.25F}, glm::vec2{-3.0F, 17.5F}})
+    {
+        const auto vertex = pack_vertex(quantization, origin, normal, glm::vec4{1.0F}, uv);
+        const auto decoded = glm::unpackHalf2x16(static_cast<unsigned>(vertex.uv[0]) |
+                                                 (static_cast<unsigned>(vertex.uv[1]) << 16U));
+        EXPECT_EQ(decoded.x, uv.x);
+        EXPECT_EQ(decoded.y, uv.y);
+    }
+    for (int step = 0; step < 64; ++step)
+    {
+        const glm::vec2 uv{static_cast<float>(step) / 63.0F * 1.7F, 1.0F - static_cast<float>(step) / 91.0F};
+        const auto vertex = pack_vertex(quantization, origin, normal, glm::vec4{1.0F}, uv);
+        const auto decoded = glm::unpackHalf2x16(static_cast<unsigned>(vertex.uv[0]) |
+                                                 (static_cast<unsigned>(vertex.uv[1]) << 16U));
+        // 11 significant bits
+        EXPECT_LE(std::abs(decoded.x - uv.x), std::abs(uv.x) / 2048.0F) << step;
+        EXPECT_LE(std::abs(decoded.y - uv.y), std::abs(uv.y) / 2048.0F) << step;
+    }
+}
+
+TEST(VertexCompression, VertexInputMatchesThePackedLayout)
+{
+    const auto input = packed_vertex_input(2);
+    EXPECT_EQ(input.binding.binding, 2U);
+    EXPECT_EQ(input.binding.stride, sizeof(PackedVertex));
+    EXPECT_EQ(input.binding.inputRate, VK_VERTEX_INPUT_RATE_VERTEX);
+
+    const std::array<std::uint32_t, 4> offsets{0, 8, 12, 16};
+    const std::array<VkFormat, 4> formats{
+        VK_FORMAT_R16G16B16A16_UNORM, VK_FORMAT_R16G16_SNORM, VK_FORMAT_R16G16_SNORM, VK_FORMAT_R16G16_SFLOAT};
+    for (std::uint32_t location = 0; location < 4; ++location)
+    {
+        const auto& attribute = input.attributes[location];
+        EXPECT_EQ(attribute.location, location);
+        EXPECT_EQ(attribute.binding, 2U);
+        EXPECT_EQ(attribute.offset, offsets[location]);
+        EXPECT_EQ(attribute.format, formats[location]);
+    }
+}
+} // namespace
+} // namespace vultex
@@ -0,0 +1,591 @@
+#include "vulkan_context.hpp"
+
+#include <algorithm>
+#include <fmt/format.h>
+#include <iterator>
+#include <map>
+#include <optional>
+#include <set>
+#include <spdlog/spdlog.h>
+#include <stdexcept>
+#include <vector>
+
+#include "host_allocator.hpp"
+#include "vulkan_debug.hpp"
+#include "vulkan_memory.hpp"
+#include "vulkan_property_support_info.hpp"
+
+namespace vultex
+{
+namespace
+{
+template <typename Stage>
+auto timed(std::vector<StartupStage>& stages, const std::string_view name, Stage stage)
+{
+    const auto start = std::chrono::steady_clock::now();
+    auto result = stage();
+    stages.push_back(StartupStage{.name = name, .duration = std::chrono::steady_clock::now() - start});
+    return result;
+}
+
+struct QueueFaimilyIndices
+{
+    std::optional<std::uint32_t> graphicsFamily;
+    // compute only family runs concurrently with graphics work, when there is
+    // none it is the graphics family and compute passes are serialized
+    std::optional<std::uint32_t> computeFamily;
+
+    [[nodiscard]] auto isComplete() const -> bool
+    {
+        return graphicsFamily.has_value();
+    }
+};
+
+[[nodiscard]] auto findQueueFamilies(VkPhysicalDevice device) -> QueueFaimilyIndices
+{
+    QueueFaimilyIndices indices{};
+
+    std::uint32_t queueFamilyCount = 0;
+    vkGetPhysicalDeviceQueueFamilyProperties(device, &queueFamilyCount, nullptr);
+
+    std::vector<VkQueueFamilyProperties> queueFamilies(queueFamilyCount);
+    vkGetPhysicalDeviceQueueFamilyProperties(device, &queueFamilyCount, queueFamilies.data());
+
+    const auto it = std::ranges::find_if(
+        queueFamilies,
+        [](const auto& queueFamily)
+        { return queueFamily.queueFlags & static_cast<std::uint32_t>(VK_QUEUE_GRAPHICS_BIT); });
+
+    if (it != queueFamilies.end())
+    {
+        indices.graphicsFamily = std::distance(queueFamilies.begin(), it);
+    }
+
+    const auto asyncCompute = std::ranges::find_if(
+        queueFamilies,
+        [](const auto& queueFamily)
+        {
+            return (queueFamily.queueFlags & static_cast<std::uint32_t>(VK_QUEUE_COMPUTE_BIT)) &&
+                   !(queueFamily.queueFlags & static_cast<std::uint32_t>(VK_QUEUE_GRAPHICS_BIT));
+        });
+
+    if (asyncCompute != queueFamilies.end())
+    {
+        indices.computeFamily = std::distance(queueFamilies.begin(), asyncCompute);
+    }
+    else
+    {
+        indices.computeFamily = indices.graphicsFamily;
+    }
+
+    return indices;
+}
+
+[[nodiscard]] auto supportsTimelineSemaphore(VkPhysicalDevice device, const VkPhysicalDeviceProperties& properties)
+    -> bool
+{
+    if (properties.apiVersion < VK_API_VERSION_1_2)
+    {
+        return false;
+    }
+
+    VkPhysicalDeviceVulkan12Features vulkan12Features{.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_2_FEATURES};
+    VkPhysicalDeviceFeatures2 features{.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2,
+                                       .pNext = &vulkan12Features};
+    vkGetPhysicalDeviceFeatures2(device, &features);
+
+    return VK_TRUE == vulkan12Features.timelineSemaphore;
+}
+
+[[nodiscard]] auto rateDeviceSuitability(const auto& device) -> std::int32_t
+{
+    // get device properties
+    VkPhysicalDeviceProperties deviceProperties{};
+    vkGetPhysicalDeviceProperties(device, &deviceProperties);
+    spdlog::info("Device GPU {} of type: {}, max image dimension 2d: {}",
+                 deviceProperties.deviceName,
+                 deviceProperties.deviceType,
+                 deviceProperties.limits.maxImageDimension2D);
+
+    // get device feature
+    VkPhysicalDeviceFeatures deviceFeatures{};
+    vkGetPhysicalDeviceFeatures(device, &deviceFeatures);
+    spdlog::info("Device GPU {} support geometry shader: {}",
+                 deviceProperties.deviceName,
+                 deviceFeatures.geometryShader);
+
+    // Application can't function without geomtry shaders
+    if (!deviceFeatures.geometryShader)
+    {
+        return 0;
+    }
+
+    // Application can't function without timeline semaphores (core in Vulkan 1.2)
+    if (!supportsTimelineSemaphore(device, deviceProperties))
+    {
+        spdlog::info("Device GPU {} doesn't support timeline semaphores", deviceProperties.deviceName);
+        return 0;
+    }
+
+    const auto queueFamilyIndices = findQueueFamilies(device);
+    spdlog::info("Device GPU {} support graphics queue: {}",
+                 deviceProperties.deviceName,
+                 queueFamilyIndices.isComplete());
+    if (!queueFamilyIndices.isComplete())
+    {
+        return 0;
+    }
+
+    // -----
+
+    auto score = 0;
+
+    // Discrete GPUs have a significant performance advantage
+    if (deviceProperties.deviceType == VK_PHYSICAL_DEVICE_TYPE_DISCRETE_GPU)
+    {
+        constexpr auto discrete_gpu_score = 1000;
+        score += discrete_gpu_score;
+    }
+
+    // Maximum possible size of textures affects graphics quality
+    score += deviceProperties.limits.maxImageDimension2D;
+
+    spdlog::info("Device GPU {} got score: {}", deviceProperties.deviceName, score);
+
+    return score;
+}
+
+[[nodiscard]] auto getRequiredExtensions(const std::vector<const char*>& surfaceExtensions) -> std::vector<const char*>
+{
+    std::vector<const char*> extensions{surfaceExtensions};
+
+    if constexpr (enableValidationLayers)
+    {
+        extensions.push_back(VK_EXT_DEBUG_UTILS_EXTENSION_NAME);
+    }
+    return extensions;
+}
+
+auto configureValidationLayers(auto& createInfo,
+                               const auto& required_validation_layer_names,
+                               auto& debugCreateInfo) -> void
+{
+    const auto required_validation_layers = utility::check_required_validation_layers(
+        required_validation_layer_names.size(), required_validation_layer_names.data());
+
+    required_validation_layers.log_properties();
+    if (!required_validation_layers.all_supported())
+
+    {
+        throw std::runtime_error("validation layers requested, but not available!");
+    }
+    createInfo.enabledLayerCount = required_validation_layer_names.size();
+    createInfo.ppEnabledLayerNames = required_validation_layer_names.data();
+
+    populateDebugMessengerCreateInfo(debugCreateInfo);
+    createInfo.pNext = &debugCreateInfo;
+}
+
+static auto getRequiredByGlfwVulkanExtensions(auto& createInfo, const auto& glfwExtensions) -> void
+{
+    const auto glfw_required_extensions =
+        utility::check_glfw_required_extensions(glfwExtensions.size(), glfwExtensions.data());
+
+    spdlog::info("EnabledExtensionCount: {}", glfwExtensions.size());
+    createInfo.enabledExtensionCount = glfwExtensions.size();
+    createInfo.ppEnabledExtensionNames = glfwExtensions.data();
+
+    glfw_required_extensions.log_properties();
+    if (!glfw_required_extensions.all_supported())
+    {
+        throw std::runtime_error(fmt::format("Cannot create vulkan instance! glfw all supported: {}",
+                                             glfw_required_extensions.all_supported()));
+    }
+}
+
+[[nodiscard]] auto createInstance(const std::vector<const char*>& surfaceExtensions) -> VkInstance
+{
+    // fill an optional struct with application information
+    VkApplicationInfo appInfo{.sType = VK_STRUCTURE_TYPE_APPLICATION_INFO,
+                              .pApplicationName = "Hello vultex!",
+                              .applicationVersion = VK_MAKE_VERSION(1, 0, 0),
+                              .pEngineName = "No Engine",
+                              .engineVersion = VK_MAKE_VERSION(1, 0, 0),
+                              .apiVersion = VK_API_VERSION_1_2};
+
+    // global information about the entire program about extensions etc.
+    VkInstanceCreateInfo createInfo{.sType = VK_STRUCTURE_TYPE_INSTANCE_CREATE_INFO,
+                                    .pApplicationInfo = &appInfo};
+
+    const auto glfwExtensions = getRequiredExtensions(surfaceExtensions);
+
+    { // get vulkan extensions required by GLFW
+        getRequiredByGlfwVulkanExtensions(createInfo, glfwExtensions);
+    }
+
+    const std::vector<char const*> required_validation_layer_names = {"VK_LAYER_KHRONOS_validation"};
+    VkDebugUtilsMessengerCreateInfoEXT debugCreateInfo{};
+
+    { // configure validation layers
+        if constexpr (enableValidationLayers)
+        {
+            configureValidationLayers(createInfo, required_validation_layer_names, debugCreateInfo);
+        }
+    }
+
+    VkInstance instance{nullptr};
+    const auto create_instance_status = vkCreateInstance(&createInfo, allocation_callbacks(), &instance);
+    if (VK_SUCCESS != create_instance_status)
+    {
+        throw std::runtime_error{fmt::format("Cannot create vulkan instance: {}", create_instance_status)};
+    }
+
+    spdlog::info("Instance created");
+    return instance;
+}
+
+[[nodiscard]] auto setupDebugMessenger(auto* const instance) -> VkDebugUtilsMessengerEXT
+{
+    if constexpr (!enableValidationLayers)
+    {
+        return nullptr;
+    }
+
+    spdlog::info("Initialize debug messenger");
+
+    VkDebugUtilsMessengerCreateInfoEXT createInfo{};
+    populateDebugMessengerCreateInfo(createInfo);
+
+    VkDebugUtilsMessengerEXT debugMessenger{nullptr};
+    if (VK_SUCCESS !=
+        CreateDebugUtilsMessengerEXT(instance, &createInfo, allocation_callbacks(), &debugMessenger))
+    {
+        throw std::runtime_error("failed to set up debug messenger!");
+    }
+    return debugMessenger;
+}
+
+[[nodiscard]] auto pickPhysicalDevice(auto* const instance) -> VkPhysicalDevice
+{
+    std::uint32_t deviceCount = 0;
+    vkEnumeratePhysicalDevices(instance, &deviceCount, nullptr);
+
+    if (0 == deviceCount)
+    {
+        throw std::runtime_error("failed to find GPUs with Vulkan support!");
+    }
+
+    spdlog::info("Detected {} devices", deviceCount);
+
+    std::vector<VkPhysicalDevice> devices(deviceCount);
+    vkEnumeratePhysicalDevices(instance, &deviceCount, devices.data());
+
+    std::multimap<int, VkPhysicalDevice> candidates{};
+    std::ranges::transform(devices,
+                           std::inserter(candidates, candidates.begin()),
+                           [](const auto& device)
+                           { return std::make_pair(rateDeviceSuitability(device), device); });
+
+    if (candidates.empty())
+    {
+        throw std::runtime_error("Cannot found any GPU device!");
+    }
+    if (candidates.rbegin()->first == 0)
+    {
+        throw std::runtime_error("Cannot found any suitable GPU!");
+    }
+
+    spdlog::info("Device choosen with score: {}", candidates.rbegin()->first);
+    auto* physicalDevice = candidates.rbegin()->second;
+    return physicalDevice;
+}
+
+[[nodiscard]] auto supportsGraphicsPipelineLibrary(VkPhysicalDevice physicalDevice) -> bool
+{
+#ifdef VK_EXT_graphics_pipeline_library
+    if (!utility::is_device_extension_supported(physicalDevice, VK_EXT_GRAPHICS_PIPELINE_LIBRARY_EXTENSION_NAME))
+    {
+        return false;
+    }
+
+    VkPhysicalDeviceGraphicsPipelineLibraryFeaturesEXT graphicsPipelineLibraryFeatures{
+        .sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_GRAPHICS_PIPELINE_LIBRARY_FEATURES_EXT};
+    VkPhysicalDeviceFeatures2 features{.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2,
+                                       .pNext = &graphicsPipelineLibraryFeatures};
+    vkGetPhysicalDeviceFeatures2(physicalDevice, &features);
+
+    return VK_TRUE == graphicsPipelineLibraryFeatures.graphicsPipelineLibrary;
+#else
+    return false;
+#endif
+}
+
+// Counter pools are reset on the host, a performance query cannot be reset
+// in the command buffer which begins it
+[[nodiscard]] auto supportsPerformanceQuery(VkPhysicalDevice physicalDevice) -> bool
+{
+#ifdef VK_KHR_performance_query
+    if (!utility::is_device_extension_supported(physicalDevice, VK_KHR_PERFORMANCE_QUERY_EXTENSION_NAME))
+    {
+        return false;
+    }
+
+    VkPhysicalDevicePerformanceQueryFeaturesKHR performanceQueryFeatures{
+        .sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PERFORMANCE_QUERY_FEATURES_KHR};
+    VkPhysicalDeviceVulkan12Features vulkan12Features{.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_2_FEATURES,
+                                                      .pNext = &performanceQueryFeatures};
+    VkPhysicalDeviceFeatures2 features{.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2,
+                                       .pNext = &vulkan12Features};
+    vkGetPhysicalDeviceFeatures2(physicalDevice, &features);
+
+    return VK_TRUE == performanceQueryFeatures.performanceCounterQueryPools &&
+           VK_TRUE == vulkan12Features.hostQueryReset;
+#else
+    return false;
+#endif
+}
+
+// Texels go from host memory straight into the image, without a staging
+// buffer nor a transfer queue submission. Vulkan 1.2 devices need the
+// extensions it depends on as well.
+[[nodiscard]] auto supportsHostImageCopy(VkPhysicalDevice physicalDevice) -> bool
+{
+#ifdef VK_EXT_host_image_copy
+    for (const auto* extension : {VK_EXT_HOST_IMAGE_COPY_EXTENSION_NAME,
+                                  VK_KHR_COPY_COMMANDS_2_EXTENSION_NAME,
+                                  VK_KHR_FORMAT_FEATURE_FLAGS_2_EXTENSION_NAME})
+    {
+        if (!utility::is_device_extension_supported(physicalDevice, extension))
+        {
+            return false;
+        }
+    }
+
+    VkPhysicalDeviceHostImageCopyFeaturesEXT hostImageCopyFeatures{
+        .sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_HOST_IMAGE_COPY_FEATURES_EXT};
+    VkPhysicalDeviceFeatures2 features{.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2,
+                                       .pNext = &hostImageCopyFeatures};
+    vkGetPhysicalDeviceFeatures2(physicalDevice, &features);
+
+    return VK_TRUE == hostImageCopyFeatures.hostImageCopy;
+#else
+    return false;
+#endif
+}
+
+[[nodiscard]] auto supportsPipelineStatisticsQuery(VkPhysicalDevice physicalDevice) -> bool
+{
+    VkPhysicalDeviceFeatures features{};
+    vkGetPhysicalDeviceFeatures(physicalDevice, &features);
+    return VK_TRUE == features.pipelineStatisticsQuery;
+}
+
+[[nodiscard]] auto createLogicalDevice(const auto physicalDevice) -> VkDevice
+{
+
+    auto indices = findQueueFamilies(physicalDevice);
+
+    float queuePriority = 1.0F;
+    std::vector<VkDeviceQueueCreateInfo> queueCreateInfos{};
+    for (const auto family : std::set{indices.graphicsFamily.value(), indices.computeFamily.value()})
+    {
+        queueCreateInfos.push_back(VkDeviceQueueCreateInfo{.sType = VK_STRUCTURE_TYPE_DEVICE_QUEUE_CREATE_INFO,
+                                                           .queueFamilyIndex = family,
+                                                           .queueCount = 1,
+                                                           .pQueuePriorities = &queuePriority});
+    }
+
+    VkPhysicalDeviceFeatures supportedFeatures{};
+    vkGetPhysicalDeviceFeatures(physicalDevice, &supportedFeatures);
+
+    // Block compressed formats can be used only when enabled, textures are
+    // uploaded in a GPU native format instead of being decompressed to RGBA8
+    VkPhysicalDeviceFeatures deviceFeatures{.textureCompressionETC2 = supportedFeatures.textureCompressionETC2,
+                                           .textureCompressionASTC_LDR = supportedFeatures.textureCompressionASTC_LDR,
+                                           .textureCompressionBC = supportedFeatures.textureCompressionBC,
+                                           // per pass vertex / fragment invocations of GpuCounters
+                                           .pipelineStatisticsQuery = supportedFeatures.pipelineStatisticsQuery};
+
+    // All CPU-GPU and queue to queue synchronization is built on timeline semaphores
+    VkPhysicalDeviceVulkan12Features vulkan12Features{.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_2_FEATURES,
+                                                      .timelineSemaphore = VK_TRUE};
+
+    // For older implementation there is a need to configure validation layers
+    // as like for instance !
+    VkDeviceCreateInfo createInfo{.sType = VK_STRUCTURE_TYPE_DEVICE_CREATE_INFO,
+                                  .pNext = &vulkan12Features,
+                                  .queueCreateInfoCount = static_cast<std::uint32_t>(queueCreateInfos.size()),
+                                  .pQueueCreateInfos = queueCreateInfos.data(),
+                                  .pEnabledFeatures = &deviceFeatures};
+
+    std::vector<const char*> deviceExtensions{};
+
+#ifdef VK_EXT_graphics_pipeline_library
+    // pipelines of new materials are fast linked instead of compiled from scratch
+    VkPhysicalDeviceGraphicsPipelineLibraryFeaturesEXT graphicsPipelineLibraryFeatures{
+        .sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_GRAPHICS_PIPELINE_LIBRARY_FEATURES_EXT,
+        .graphicsPipelineLibrary = VK_TRUE};
+
+    if (supportsGraphicsPipelineLibrary(physicalDevice))
+    {
+        deviceExtensions.push_back(VK_KHR_PIPELINE_LIBRARY_EXTENSION_NAME);
+        deviceExtensions.push_back(VK_EXT_GRAPHICS_PIPELINE_LIBRARY_EXTENSION_NAME);
+        vulkan12Features.pNext = &graphicsPipelineLibraryFeatures;
+    }
+#endif
+
+#ifdef VK_KHR_performance_query
+    // vendor hardware counters of GpuCounters
+    VkPhysicalDevicePerformanceQueryFeaturesKHR performanceQueryFeatures{
+        .sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PERFORMANCE_QUERY_FEATURES_KHR,
+        .performanceCounterQueryPools = VK_TRUE};
+
+    if (supportsPerformanceQuery(physicalDevice))
+    {
+        deviceExtensions.push_back(VK_KHR_PERFORMANCE_QUERY_EXTENSION_NAME);
+        vulkan12Features.hostQueryReset = VK_TRUE;
+        performanceQueryFeatures.pNext = vulkan12Features.pNext;
+        vulkan12Features.pNext = &performanceQueryFeatures;
+    }
+#endif
+
+#ifdef VK_EXT_host_image_copy
+    // uploads of UploadBatcher skip the staging buffer
+    VkPhysicalDeviceHostImageCopyFeaturesEXT hostImageCopyFeatures{
+        .sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_HOST_IMAGE_COPY_FEATURES_EXT, .hostImageCopy = VK_TRUE};
+
+    if (supportsHostImageCopy(physicalDevice))
+    {
+        deviceExtensions.push_back(VK_KHR_COPY_COMMANDS_2_EXTENSION_NAME);
+        deviceExtensions.push_back(VK_KHR_FORMAT_FEATURE_FLAGS_2_EXTENSION_NAME);
+        deviceExtensions.push_back(VK_EXT_HOST_IMAGE_COPY_EXTENSION_NAME);
+        hostImageCopyFeatures.pNext = vulkan12Features.pNext;
+        vulkan12Features.pNext = &hostImageCopyFeatures;
+    }
+#endif
+
+    createInfo.enabledExtensionCount = deviceExtensions.size();
+    createInfo.ppEnabledExtensionNames = deviceExtensions.data();
+
+    VkDevice logicalDevice{nullptr};
+    if (VK_SUCCESS != vkCreateDevice(physicalDevice, &createInfo, allocation_callbacks(), &logicalDevice))
+    {
+        throw std::runtime_error("Failed to create logical device!");
+    }
+
+    return logicalDevice;
+}
+} // namespace
+
+VulkanContext::VulkanContext(const std::vector<const char*>& surface_extensions)
+    : vk_instance{timed(stages, "create_instance", [&] { return createInstance(surface_extensions); })},
+      debug_messenger{timed(stages, "setup_debug_messenger", [this] { return setupDebugMessenger(vk_instance); })},
+      vk_physical_device{timed(stages, "pick_physical_device", [this] { return pickPhysicalDevice(vk_instance); })},
+      vk_logical_device{
+          timed(stages, "create_logical_device", [this] { return createLogicalDevice(vk_physical_device); })}
+{
+    const auto indices = findQueueFamilies(vk_physical_device);
+    constexpr auto firstQueueIndex = 0;
+
+    graphics_family_index = indices.graphicsFamily.value();
+    vkGetDeviceQueue(vk_logical_device, graphics_family_index, firstQueueIndex, &vk_graphics_queue);
+
+    compute_family_index = indices.computeFamily.value();
+    vkGetDeviceQueue(vk_logical_device, compute_family_index, firstQueueIndex, &vk_compute_queue);
+    spdlog::info("Async compute queue family: {}, dedicated: {}",
+                 compute_family_index,
+                 compute_family_index != graphics_family_index);
+
+    fast_link = supportsGraphicsPipelineLibrary(vk_physical_device);
+    spdlog::info("Graphics pipeline library fast link: {}", fast_link);
+
+    pipeline_statistics_enabled = supportsPipelineStatisticsQuery(vk_physical_device);
+    performance_query_enabled = supportsPerformanceQuery(vk_physical_device);
+    spdlog::info("Pipeline statistics queries: {}, performance queries: {}",
+                 pipeline_statistics_enabled,
+                 performance_query_enabled);
+
+    // from the heaps, not the device type: an integrated GPU may still expose
+    // a device local heap the host cannot map
+    unified_memory_heaps = has_unified_memory(vk_physical_device);
+    host_image_copy_enabled = supportsHostImageCopy(vk_physical_device);
+    spdlog::info("Unified memory: {}, host image copy: {}", unified_memory_heaps, host_image_copy_enabled);
+}
+
+VulkanContext::~VulkanContext()
+{
+    vkDestroyDevice(vk_logical_device, allocation_callbacks());
+
+    if constexpr (enableValidationLayers)
+    {
+        DestroyDebugUtilsMessengerEXT(vk_instance, debug_messenger, allocation_callbacks());
+    }
+
+    vkDestroyInstance(vk_instance, allocation_callbacks());
+}
+
+VkInstance VulkanContext::instance() const
+{
+    return vk_instance;
+}
+
+VkPhysicalDevice VulkanContext::physical_device() const
+{
+    return vk_physical_device;
+}
+
+VkDevice VulkanContext::logical_device() const
+{
+    return vk_logical_device;
+}
+
+VkQueue VulkanContext::graphics_queue() const
+{
+    return vk_graphics_queue;
+}
+
+std::uint32_t VulkanContext::graphics_family() const
+{
+    return graphics_family_index;
+}
+
+VkQueue VulkanContext::compute_queue() const
+{
+    return vk_compute_queue;
+}
+
+std::uint32_t VulkanContext::compute_family() const
+{
+    return compute_family_index;
+}
+
+bool VulkanContext::graphics_pipeline_library() const
+{
+    return fast_link;
+}
+
+bool VulkanContext::pipeline_statistics_query() const
+{
+    return pipeline_statistics_enabled;
+}
+
+bool VulkanContext::performance_query() const
+{
+    return performance_query_enabled;
+}
+
+bool VulkanContext::unified_memory() const
+{
+    return unified_memory_heaps;
+}
+
+bool VulkanContext::host_image_copy() const
+{
+    return host_image_copy_enabled;
+}
+
+const std::vector<StartupStage>& VulkanContext::startup_stages() const
+{
+    return stages;
+}
+} // namespace vultex
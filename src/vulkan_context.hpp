@@ -0,0 +1,81 @@
+#pragma once
+
+#define GLFW_INCLUDE_VULKAN
+#include <GLFW/glfw3.h>
+
+#include <chrono>
+#include <cstdint>
+#include <string_view>
+#include <vector>
+
+namespace vultex
+{
+
+struct StartupStage
+{
+    std::string_view name;
+    std::chrono::nanoseconds duration;
+};
+
+// Instance, device and queues shared by the application and the tools.
+// Surface extensions are the ones from glfwGetRequiredInstanceExtensions,
+// the context doesn't call GLFW and can be created on any thread. Without
+// them it is headless and needs no window system (CI, software ICDs like
+// lavapipe).
+class VulkanContext
+{
+public:
+    explicit VulkanContext(const std::vector<const char*>& surface_extensions = {});
+    VulkanContext(const VulkanContext&) = delete;
+    VulkanContext(VulkanContext&&) = delete;
+    VulkanContext& operator=(const VulkanContext&) = delete;
+    VulkanContext& operator=(VulkanContext&&) = delete;
+    ~VulkanContext();
+
+    [[nodiscard]] VkInstance instance() const;
+    [[nodiscard]] VkPhysicalDevice physical_device() const;
+    [[nodiscard]] VkDevice logical_device() const;
+
+    [[nodiscard]] VkQueue graphics_queue() const;
+    [[nodiscard]] std::uint32_t graphics_family() const;
+
+    // same queue as graphics when the device has no compute only family
+    [[nodiscard]] VkQueue compute_queue() const;
+    [[nodiscard]] std::uint32_t compute_family() const;
+
+    // VK_EXT_graphics_pipeline_library is enabled
+    [[nodiscard]] bool graphics_pipeline_library() const;
+
+    // VkPhysicalDeviceFeatures::pipelineStatisticsQuery is enabled
+    [[nodiscard]] bool pipeline_statistics_query() const;
+    // VK_KHR_performance_query is enabled, together with host query reset
+    [[nodiscard]] bool performance_query() const;
+
+    // every device local heap is host writable (has_unified_memory), integrated
+    // GPUs and resizable BAR: resources are written in place instead of staged
+    [[nodiscard]] bool unified_memory() const;
+    // VK_EXT_host_image_copy is enabled, images with VK_IMAGE_USAGE_HOST_TRANSFER_BIT_EXT
+    // are written and transitioned by the host
+    [[nodiscard]] bool host_image_copy() const;
+
+    // wall time of each creation step, in the order they ran
+    [[nodiscard]] const std::vector<StartupStage>& startup_stages() const;
+
+private:
+    // declared first, filled by the initializers of the members below
+    std::vector<StartupStage> stages{};
+    VkInstance vk_instance{nullptr};
+    VkDebugUtilsMessengerEXT debug_messenger{nullptr};
+    VkPhysicalDevice vk_physical_device{VK_NULL_HANDLE};
+    VkDevice vk_logical_device{nullptr};
+    VkQueue vk_graphics_queue{nullptr};
+    std::uint32_t graphics_family_index{0};
+    VkQueue vk_compute_queue{nullptr};
+    std::uint32_t compute_family_index{0};
+    bool fast_link{false};
+    bool pipeline_statistics_enabled{false};
+    bool performance_query_enabled{false};
+    bool unified_memory_heaps{false};
+    bool host_image_copy_enabled{false};
+};
+} // namespace vultex
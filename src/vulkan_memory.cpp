@@ -0,0 +1,60 @@
+#include "vulkan_memory.hpp"
+
+#include <algorithm>
+#include <span>
+
+namespace vultex
+{
+
+std::optional<std::uint32_t> find_memory_type(VkPhysicalDevice physical_device,
+                                              const std::uint32_t type_bits,
+                                              const std::initializer_list<VkMemoryPropertyFlags> candidates)
+{
+    VkPhysicalDeviceMemoryProperties memory_properties{};
+    vkGetPhysicalDeviceMemoryProperties(physical_device, &memory_properties);
+
+    for (const auto properties : candidates)
+    {
+        for (std::uint32_t index = 0; index < memory_properties.memoryTypeCount; ++index)
+        {
+            const auto& memory_type = memory_properties.memoryTypes[index];
+            if (0 != (type_bits & (1U << index)) && (memory_type.propertyFlags & properties) == properties)
+            {
+                return index;
+            }
+        }
+    }
+    return std::nullopt;
+}
+
+bool has_unified_memory(VkPhysicalDevice physical_device)
+{
+    VkPhysicalDeviceMemoryProperties memory_properties{};
+    vkGetPhysicalDeviceMemoryProperties(physical_device, &memory_properties);
+
+    constexpr VkMemoryPropertyFlags host_writable = VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT |
+                                                    VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT |
+                                                    VK_MEMORY_PROPERTY_HOST_COHERENT_BIT;
+    bool device_local_heap = false;
+    for (std::uint32_t heap = 0; heap < memory_properties.memoryHeapCount; ++heap)
+    {
+        if (0 == (memory_properties.memoryHeaps[heap].flags & VK_MEMORY_HEAP_DEVICE_LOCAL_BIT))
+        {
+            continue;
+        }
+        device_local_heap = true;
+
+        const auto types = std::span{memory_properties.memoryTypes, memory_properties.memoryTypeCount};
+        if (std::ranges::none_of(types,
+                                 [heap](const VkMemoryType& memory_type)
+                                 {
+                                     return memory_type.heapIndex == heap &&
+                                            (memory_type.propertyFlags & host_writable) == host_writable;
+                                 }))
+        {
+            return false;
+        }
+    }
+    return device_local_heap;
+}
+} // namespace vultex
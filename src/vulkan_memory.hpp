@@ -0,0 +1,29 @@
+#pragma once
+
+#define GLFW_INCLUDE_VULKAN
+#include <GLFW/glfw3.h>
+
+#include <cstdint>
+#include <initializer_list>
+#include <optional>
+
+namespace vultex
+{
+
+// value rounded up to a multiple of alignment
+[[nodiscard]] constexpr VkDeviceSize align_up(const VkDeviceSize value, const VkDeviceSize alignment)
+{
+    return (value + alignment - 1) / alignment * alignment;
+}
+
+// Index of the first memory type allowed by type_bits which has all the
+// properties, candidates are tried in order of preference
+[[nodiscard]] std::optional<std::uint32_t> find_memory_type(VkPhysicalDevice physical_device,
+                                                            std::uint32_t type_bits,
+                                                            std::initializer_list<VkMemoryPropertyFlags> candidates);
+
+// Every device local heap has a host visible, coherent memory type: the GPU
+// works on memory the CPU writes directly (integrated GPUs, resizable BAR)
+// and uploads need no staging copy
+[[nodiscard]] bool has_unified_memory(VkPhysicalDevice physical_device);
+} // namespace vultex
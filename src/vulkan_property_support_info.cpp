@@ -1,8 +1,6 @@
 #include "vulkan_property_support_info.hpp"
 
-#define GLFW_INCLUDE_VULKAN
-#include <GLFW/glfw3.h>
-
+#include <algorithm>
 #include <iterator>
 #include <span>
 #include <spdlog/spdlog.h>
@@ -91,4 +89,17 @@ RequiredVulkanProperties check_required_validation_layers(const std::uint32_t co
     }
     return RequiredVulkanProperties("Layers", std::move(properties), count, names);
 }
+
+bool is_device_extension_supported(VkPhysicalDevice device, const std::string_view name)
+{
+    std::uint32_t extensionCount{0};
+    vkEnumerateDeviceExtensionProperties(device, nullptr, &extensionCount, nullptr);
+
+    std::vector<VkExtensionProperties> extension_properties(extensionCount);
+    vkEnumerateDeviceExtensionProperties(device, nullptr, &extensionCount, extension_properties.data());
+
+    return std::ranges::any_of(extension_properties,
+                               [name](const auto& extension)
+                               { return name == std::span<const char>{extension.extensionName}.data(); });
+}
 } // namespace utility
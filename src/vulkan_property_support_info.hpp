@@ -1,7 +1,11 @@
 #pragma once
 
+#define GLFW_INCLUDE_VULKAN
+#include <GLFW/glfw3.h>
+
 #include <map>
 #include <string>
+#include <string_view>
 
 namespace utility
 {
@@ -26,4 +30,5 @@ private:
 
 RequiredVulkanProperties check_glfw_required_extensions(std::uint32_t count, const char* const* names);
 RequiredVulkanProperties check_required_validation_layers(std::uint32_t count, const char* const* names);
+bool is_device_extension_supported(VkPhysicalDevice device, std::string_view name);
 } // namespace utility